@@ -0,0 +1,65 @@
+/* =========================================================================
+ * This file is part of CODA-OSS
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * CODA-OSS is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __PAGE_CACHE_H__
+#define __PAGE_CACHE_H__
+#pragma once
+
+// For the benchmarks under tests/, like TestCase.h, but not installed
+
+#include <string>
+
+#if defined(__linux) || defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*!
+ * Drops a file from the page cache, so that it is next read from disk.
+ * This is for timing cold reads in benchmarks.
+ *
+ * \param pathname Pathname of the file
+ *
+ * \return False where that can't be done, which is anywhere but Linux
+ */
+inline bool evictFromPageCache(const std::string& pathname)
+{
+#if defined(__linux) || defined(__linux__)
+    const int fd = ::open(pathname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // Dirty pages stay in the cache, so write them out first
+    ::fdatasync(fd);
+    const bool evicted =
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return evicted;
+#else
+    (void)pathname;
+    return false;
+#endif
+}
+
+#endif
@@ -51,6 +51,7 @@
  *
  */
 
+#include <io/AsyncOutputStream.h>
 #include <io/BidirectionalStream.h>
 #include <io/BufferViewStream.h>
 #include <io/ByteStream.h>
@@ -69,12 +70,15 @@
 #include <io/NullStreams.h>
 #include <io/ProxyStreams.h>
 #include <io/FileUtils.h>
+#include <io/MMapInputStream.h>
+#include <io/ReadUtils.h>
+#include <io/SegmentedByteStream.h>
 #include <io/SerializableArray.h>
 #include <io/CountingStreams.h>
+#include <io/InstrumentedStreams.h>
 #include <io/RotatingFileOutputStream.h>
 #include <io/StreamSplitter.h>
 
-//#include "io/MMapInputStream.h"
 //using namespace io;
 
 #endif
@@ -0,0 +1,194 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __IO_ASYNC_OUTPUT_STREAM_H__
+#define __IO_ASYNC_OUTPUT_STREAM_H__
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include "io/OutputStream.h"
+
+namespace io
+{
+
+/*!
+ *  \class AsyncOutputStream
+ *  \brief Hands writes off to a background thread
+ *
+ *  Each write() copies its bytes into a bounded in-memory buffer and
+ *  returns; a background thread writes the buffer to the proxied stream.
+ *  The caller therefore never waits on the disk, or on any work the
+ *  proxied stream does inline (such as a RotatingFileOutputStream
+ *  rolling over).  Memory use is capped at the buffer capacity.
+ *
+ *  Each write() is treated as a record, a vectored write() included, and
+ *  records from concurrent writers never interleave.  Under the DROP policy a record that doesn't
+ *  fit is discarded whole; under BLOCK the caller waits for room.  A
+ *  record larger than the whole buffer is split, reaching the proxied
+ *  stream in several writes, and other writers wait until all of it is in
+ *  the buffer.
+ *
+ *  Errors from the proxied stream are reported by the next write(),
+ *  flush() or close() call.
+ */
+class AsyncOutputStream : public OutputStream
+{
+public:
+    //! What write() does when the buffer has no room for a record
+    enum OverflowPolicy
+    {
+        BLOCK,  //!< Wait for the background thread to make room
+        DROP    //!< Discard the record and count it
+    };
+
+    //! When the background thread flushes (fsyncs) the proxied stream
+    enum SyncPolicy
+    {
+        SYNC_NEVER,     //!< Only on flush() and close()
+        SYNC_ALWAYS,    //!< After every batch of bytes it writes
+        SYNC_INTERVAL   //!< After every syncInterval bytes it writes
+    };
+
+    /*!
+     *  \param proxy The stream to write to on the background thread
+     *  \param ownPtr Whether this object owns (and deletes) the proxy
+     *  \param capacity Size of the buffer, in bytes
+     *  \param overflowPolicy What write() does when the buffer is full
+     *  \param syncPolicy When the background thread flushes the proxy
+     *  \param syncInterval Bytes between flushes for SYNC_INTERVAL
+     */
+    AsyncOutputStream(OutputStream* proxy,
+                      bool ownPtr = false,
+                      size_t capacity = 1048576,
+                      OverflowPolicy overflowPolicy = BLOCK,
+                      SyncPolicy syncPolicy = SYNC_NEVER,
+                      size_t syncInterval = 0);
+
+    //! Drains the buffer and stops the background thread
+    virtual ~AsyncOutputStream();
+
+    using OutputStream::write;
+
+    /*!
+     *  Queue bytes for the background thread
+     *  \param buffer The byte array to write to the stream
+     *  \param len The length of the byte array to write to the stream
+     *  \throw IOException
+     */
+    virtual void write(const void* buffer, size_t len);
+
+    /*!
+     *  Queue the buffers for the background thread as one record, so they
+     *  reach the proxied stream together
+     *  \param buffers The buffers to write, in order
+     *  \throw IOException
+     */
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers);
+
+    /*!
+     *  Wait until everything written so far has reached the proxied
+     *  stream, then flush it
+     */
+    virtual void flush();
+
+    /*!
+     *  Drain the buffer, stop the background thread and flush the proxied
+     *  stream.  The proxied stream is closed only if this object owns it.
+     */
+    virtual void close();
+
+    //! \return The number of records discarded under the DROP policy
+    size_t getNumRecordsDropped() const;
+
+    //! \return The number of bytes discarded under the DROP policy
+    sys::Off_T getNumBytesDropped() const;
+
+private:
+    class Drainer : public sys::Runnable
+    {
+    public:
+        Drainer(AsyncOutputStream& stream) :
+            mStream(stream)
+        {
+        }
+
+        virtual void run()
+        {
+            mStream.drain();
+        }
+
+    private:
+        AsyncOutputStream& mStream;
+    };
+
+    //! Queue the bytes of 'buffers' as one record of 'len' bytes
+    void writeRecord(const mem::BufferView<const sys::byte>* buffers,
+                     size_t len);
+
+    //! The background thread's loop
+    void drain();
+
+    //! Throws if the stream is closed or the background thread failed
+    void checkState() const;
+
+    // Noncopyable
+    AsyncOutputStream(const AsyncOutputStream& );
+    const AsyncOutputStream& operator=(const AsyncOutputStream& );
+
+    std::unique_ptr<OutputStream> mProxy;
+    bool mOwnPtr;
+    std::vector<sys::byte> mBuffer;
+    const OverflowPolicy mOverflowPolicy;
+    const SyncPolicy mSyncPolicy;
+    const size_t mSyncInterval;
+
+    mutable sys::Mutex mLock;
+    //! Signalled when there is data, a flush request or a stop request
+    sys::ConditionVar mWorkAvailable;
+    //! Signalled when space is freed or a flush completes
+    sys::ConditionVar mSpaceAvailable;
+
+    size_t mHead;
+    size_t mSize;
+    //! Sizes of the records in the buffer, oldest first
+    std::deque<size_t> mRecordSizes;
+    //! The record sizes the background thread is writing
+    std::vector<size_t> mBatch;
+    size_t mFlushesRequested;
+    size_t mFlushesDone;
+    //! True while a record bigger than the buffer is being copied in
+    bool mSplitting;
+    bool mStopping;
+    bool mFailed;
+    std::string mError;
+    size_t mNumRecordsDropped;
+    sys::Off_T mNumBytesDropped;
+    std::unique_ptr<sys::Thread> mThread;
+};
+}
+
+#endif
@@ -54,6 +54,19 @@ public:
         mByteCount += len;
     }
 
+    /*!
+     * \param buffers The buffers to write to the stream
+     */
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers)
+    {
+        ProxyOutputStream::write(buffers);
+        for (size_t ii = 0; ii < buffers.size(); ++ii)
+        {
+            mByteCount += buffers[ii].size;
+        }
+    }
+
     sys::Off_T getCount() const
     {
         return mByteCount;
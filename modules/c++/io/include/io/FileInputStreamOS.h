@@ -171,6 +171,17 @@ protected:
      *
      */
     virtual sys::SSize_T readImpl(void* buffer, size_t len);
+
+    /*!
+     * Read into a list of buffers with a single scatter read (readv)
+     * where the platform supports it.
+     *
+     * \param buffers Buffers to read into
+     * \throw except::IOException
+     * \return  The number of bytes read, or -1 if EOF
+     */
+    virtual sys::SSize_T readImpl(
+            const std::vector<mem::BufferView<sys::byte> >& buffers);
 };
 }
 
@@ -116,6 +116,15 @@ public:
      * \throw IoException
      */
     virtual void write(const void* buffer, size_t len);
+
+    /*!
+     * Write a list of buffers with a single gather write (writev) where
+     * the platform supports it.
+     * \param buffers The buffers to write to the stream
+     * \throw IoException
+     */
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers);
 };
 }
 
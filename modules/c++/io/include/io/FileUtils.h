@@ -34,15 +34,22 @@ namespace io
  *  Copy a file or directory to a new path. 
  *  Source and destination cannot be the same location
  *
- *  \param path      - source location
- *  \param newath    - destination location
- *  \param blockSize - files are copied in blocks (1MB default)
- *                     NOTE: This is a placeholder and is unused currently
+ *  Where the OS allows it the copy never leaves the kernel: the file is
+ *  reflinked (FICLONE) if the filesystem supports it, otherwise copied
+ *  with copy_file_range(), then sendfile(), and only then through a
+ *  user-space buffer of blockSize bytes.
+ *
+ *  \param path       - source location
+ *  \param newath     - destination location
+ *  \param blockSize  - files are copied in blocks (1MB default)
+ *  \param numThreads - if greater than one, large files are split into
+ *                      disjoint ranges which are copied concurrently
  *  \return True upon success, false if failure
  */
 void copy(const std::string& path, 
           const std::string& newPath,
-          size_t blockSize = 1048576);
+          size_t blockSize = 1048576,
+          size_t numThreads = 1);
 
 /*!
  *  Move file with this path name to the newPath
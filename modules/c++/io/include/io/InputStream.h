@@ -23,7 +23,10 @@
 #ifndef __IO_INPUT_STREAM_H__
 #define __IO_INPUT_STREAM_H__
 
+#include <vector>
+
 #include "sys/Dbg.h"
+#include "mem/BufferView.h"
 #include "io/OutputStream.h"
 
 /*!
@@ -94,6 +97,18 @@ public:
                       size_t len,
                       bool verifyFullRead = false);
 
+    /*!
+     * Read from the stream into a list of buffers, filling each one
+     * before moving on to the next (a scatter read).
+     * \param buffers Buffers to read into
+     * \param verifyFullRead If set to true, checks to see if every buffer
+     * was filled and, if not, throws.  Defaults to false.
+     * \throw IOException
+     * \return The total number of bytes read, or -1 if EOF.
+     */
+    sys::SSize_T read(const std::vector<mem::BufferView<sys::byte> >& buffers,
+                      bool verifyFullRead = false);
+
     /*!
      * Read either a buffer of len size, or up until a newline,
      * whichever comes first
@@ -126,6 +141,17 @@ protected:
      * \return  The number of bytes read, or -1 if EOF
      */
     virtual sys::SSize_T readImpl(void* buffer, size_t len) = 0;
+
+    /*!
+     * Read into a list of buffers.  The default implementation calls
+     * readImpl() for each buffer in turn, stopping at the first short
+     * read.  Streams with a native scatter read override this.
+     * \param buffers Buffers to read into
+     * \throw IOException
+     * \return The total number of bytes read, or -1 if EOF
+     */
+    virtual sys::SSize_T readImpl(
+            const std::vector<mem::BufferView<sys::byte> >& buffers);
 };
 }
 
@@ -0,0 +1,217 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __IO_INSTRUMENTED_STREAMS_H__
+#define __IO_INSTRUMENTED_STREAMS_H__
+
+#include <vector>
+
+#include <import/sys.h>
+#include "io/ProxyStreams.h"
+
+namespace io
+{
+
+/*!
+ *  \struct StreamStatistics
+ *  \brief A snapshot of the calls made through an instrumented stream
+ *
+ *  Histograms use power-of-two buckets.  Latency bucket i counts calls
+ *  that took less than 2^i microseconds (and at least 2^(i-1)); size
+ *  bucket 0 counts calls that moved no bytes, and bucket i > 0 counts
+ *  calls that moved [2^(i-1), 2^i) bytes.  The last bucket of each
+ *  histogram also holds everything larger.
+ */
+struct StreamStatistics
+{
+    //! Number of buckets in each histogram
+    static const size_t NUM_BUCKETS = 48;
+
+    //! Number of one-second slots in the throughput history
+    static const size_t NUM_SECONDS = 60;
+
+    StreamStatistics();
+
+    //! Number of read/write/flush calls made on the proxied stream
+    sys::Uint64_T numCalls;
+
+    //! Total bytes moved through the proxied stream
+    sys::Uint64_T numBytes;
+
+    //! Total time spent waiting on the proxied stream, in seconds
+    double blockedSeconds;
+
+    //! Time since the metrics were created or last reset, in seconds
+    double elapsedSeconds;
+
+    //! Longest single call, in seconds
+    double maxLatencySeconds;
+
+    //! Calls per latency bucket
+    std::vector<sys::Uint64_T> latencyHistogram;
+
+    //! Calls per size bucket
+    std::vector<sys::Uint64_T> sizeHistogram;
+
+    /*!
+     *  Bytes moved during each of the last NUM_SECONDS seconds.  Index 0 is
+     *  the current (partial) second, index 1 the second before it, etc.
+     */
+    std::vector<sys::Uint64_T> bytesPerSecond;
+
+    //! \return The mean time per call, in seconds
+    double getMeanLatency() const;
+
+    /*!
+     *  \param percentile In [0, 100]
+     *  \return An upper bound on the given latency percentile, in seconds
+     */
+    double getLatencyPercentile(double percentile) const;
+
+    /*!
+     *  \param seconds Size of the window, capped at NUM_SECONDS - 1
+     *  \return Mean bytes/sec over the last 'seconds' complete seconds
+     */
+    double getThroughput(size_t seconds) const;
+
+    //! \return The fraction of elapsed time spent in the proxied stream
+    double getBlockedFraction() const;
+};
+
+/*!
+ *  \class StreamMetrics
+ *  \brief Thread-safe accumulator behind the instrumented streams
+ *
+ *  record() is called on the I/O path and getStatistics() may be called
+ *  from any other thread; both hold an internal lock only long enough to
+ *  update or copy a few hundred counters.
+ */
+class StreamMetrics
+{
+public:
+    StreamMetrics();
+
+    //! \return A monotonic timestamp, in seconds
+    static double now();
+
+    /*!
+     *  Record one call on the proxied stream
+     *  \param numBytes The number of bytes the call moved
+     *  \param start The timestamp (from now()) when the call started
+     *  \param end The timestamp (from now()) when the call returned
+     */
+    void record(size_t numBytes, double start, double end);
+
+    //! \return A copy of the current statistics
+    StreamStatistics getStatistics() const;
+
+    //! Clear all statistics and restart the clock
+    void reset();
+
+private:
+    StreamMetrics(const StreamMetrics&);
+    StreamMetrics& operator=(const StreamMetrics&);
+
+    mutable sys::Mutex mLock;
+    double mStartTime;
+    StreamStatistics mTotals;
+    std::vector<sys::Int64_T> mSlotSeconds;
+};
+
+/*!
+ *  \class InstrumentedInputStream
+ *  \brief Proxies to an InputStream and records StreamMetrics for it
+ *
+ *  Each read on the proxy is timed.  Placing one of these between each
+ *  layer of a reader chain shows where the time goes: a layer's blocked
+ *  time includes that of every layer beneath it.
+ */
+class InstrumentedInputStream : public ProxyInputStream
+{
+public:
+    InstrumentedInputStream(InputStream* proxy, bool ownPtr = false) :
+        ProxyInputStream(proxy, ownPtr)
+    {
+    }
+
+    //! \return A snapshot of the statistics; safe to call from any thread
+    StreamStatistics getStatistics() const
+    {
+        return mMetrics.getStatistics();
+    }
+
+    void resetStatistics()
+    {
+        mMetrics.reset();
+    }
+
+protected:
+    virtual sys::SSize_T readImpl(void* buffer, size_t len);
+
+    virtual sys::SSize_T readImpl(
+            const std::vector<mem::BufferView<sys::byte> >& buffers);
+
+private:
+    StreamMetrics mMetrics;
+};
+
+/*!
+ *  \class InstrumentedOutputStream
+ *  \brief Proxies to an OutputStream and records StreamMetrics for it
+ *
+ *  Each write and flush on the proxy is timed.  A vectored write counts
+ *  as a single call.
+ */
+class InstrumentedOutputStream : public ProxyOutputStream
+{
+public:
+    InstrumentedOutputStream(OutputStream* proxy, bool ownPtr = false) :
+        ProxyOutputStream(proxy, ownPtr)
+    {
+    }
+
+    using ProxyOutputStream::write;
+
+    virtual void write(const void* buffer, size_t len);
+
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers);
+
+    virtual void flush();
+
+    //! \return A snapshot of the statistics; safe to call from any thread
+    StreamStatistics getStatistics() const
+    {
+        return mMetrics.getStatistics();
+    }
+
+    void resetStatistics()
+    {
+        mMetrics.reset();
+    }
+
+private:
+    StreamMetrics mMetrics;
+};
+}
+
+#endif
@@ -1,8 +1,8 @@
 /* =========================================================================
- * This file is part of io-c++ 
+ * This file is part of io-c++
  * =========================================================================
- * 
- * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
  *
  * io-c++ is free software; you can redistribute it and/or modify
  * it under the terms of the GNU Lesser General Public License as published by
@@ -14,8 +14,8 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Lesser General Public License for more details.
  *
- * You should have received a copy of the GNU Lesser General Public 
- * License along with this program; If not, 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
  * see <http://www.gnu.org/licenses/>.
  *
  */
@@ -23,67 +23,101 @@
 #ifndef __IO_MMAP_INPUT_STREAM_H__
 #define __IO_MMAP_INPUT_STREAM_H__
 
-#include <cstdio>
-#include "sys/OS.h"
-#include "io/SeekableStreams.h"
+#include <string>
 
+#include "sys/Conf.h"
+#include "sys/File.h"
+#include "io/SeekableStreams.h"
 
 namespace io
 {
-
+/*!
+ *  \class MMapInputStream
+ *  \brief An InputStream over a read-only memory mapping of a file
+ *
+ *  The whole file is mapped when it is opened.  Reads are memcpy()s out
+ *  of the mapping, and get() gives direct access to the file's bytes
+ *  without copying them at all.  Seeking follows ByteStream: offsets from
+ *  END count back from the end of the file, stopping at its start.
+ */
 class MMapInputStream : public SeekableInputStream
 {
 public:
-    MMapInputStream() : mFile(NULL), mLength(0), mData(NULL), mMark(0)
-    {}
-    MMapInputStream(const std::string& inputFile,
-                    char* flags = "r+b") :
-            mFile(NULL), mLength(0), mData(NULL), mMark(0)
+    MMapInputStream();
+
+    /*!
+     *  Open and map a file
+     *  \param inputFile The file to map
+     *  \param sequential Whether the file will be read front to back.  If
+     *         so, the OS is told to read ahead aggressively and drop pages
+     *         behind the reader, which hurts random access.
+     */
+    explicit MMapInputStream(const std::string& inputFile,
+                             bool sequential = false);
+
+    virtual ~MMapInputStream();
+
+    /*!
+     *  Open and map a file, closing any file that is already open
+     *  \param fname The file to map
+     *  \param sequential Whether the file will be read front to back
+     */
+    void open(const std::string& fname, bool sequential = false);
+
+    //! Unmap and close the file
+    void close();
+
+    bool isOpen()
     {
-        open(inputFile, flags);
-
+        return mFile.isOpen();
     }
 
-    virtual ~MMapInputStream()
+    virtual sys::Off_T available()
     {
-        if (mFile)
-        {
-            close();
-        }
+        return static_cast<sys::Off_T>(mLength - mMark);
     }
 
-    virtual void open(const std::string& fname, char* flags);
-
-    virtual void close();
+    virtual sys::Off_T seek(sys::Off_T offset, Whence whence);
 
-    sys::Handle_T getHandle();
-
-    virtual off_t available()
+    virtual sys::Off_T tell()
     {
-        return (mLength - mMark);
+        return static_cast<sys::Off_T>(mMark);
     }
 
-    virtual off_t seek(off_t off);
+    /*!
+     *  Get a pointer to the file's bytes.  The pointer is valid until
+     *  the stream is closed.
+     *  \return The start of the mapping, or NULL for an empty file
+     */
+    const sys::byte* get() const
+    {
+        return mData;
+    }
 
-    virtual off_t tell()
+    //! \return The size of the file in bytes
+    size_t getSize() const
     {
-        return mMark;
+        return mLength;
     }
 
 protected:
     virtual sys::SSize_T readImpl(void* buffer, size_t len);
 
-    virtual void _map();
-    virtual void _unmap();
-    sys::OS mOs;
+private:
+    MMapInputStream(const MMapInputStream&);
+    MMapInputStream& operator=(const MMapInputStream&);
+
+    void map(bool sequential);
+    void unmap();
 
-    FILE* mFile;
+    sys::File mFile;
     size_t mLength;
     sys::byte* mData;
     size_t mMark;
-
+#if defined(WIN32) || defined(_WIN32)
+    HANDLE mMapping;
+#endif
 };
-
 }
 
 #endif
@@ -23,8 +23,11 @@
 #ifndef __IO_OUTPUT_STREAM_H__
 #define __IO_OUTPUT_STREAM_H__
 
+#include <vector>
+
 #include "sys/Dbg.h"
 #include "sys/Conf.h"
+#include "mem/BufferView.h"
 
 /*!
  * \file OutputStream.h
@@ -94,6 +97,23 @@ public:
      */
     virtual void write(const void* buffer, size_t len) = 0;
 
+    /*!
+     * Write a list of buffers to the stream, in order (a gather write).
+     * The default implementation writes each buffer in turn.  Streams
+     * with a native vectored write (files, sockets) override this so
+     * that a header and its payload go out in a single system call.
+     * \param buffers The buffers to write to the stream
+     * \throw IOException
+     */
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers)
+    {
+        for (size_t ii = 0; ii < buffers.size(); ++ii)
+        {
+            write(buffers[ii].data, buffers[ii].size);
+        }
+    }
+
     /*!
      *  Flush the stream if needed
      */
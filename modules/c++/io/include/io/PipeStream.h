@@ -27,6 +27,7 @@
 #include <str/Convert.h>
 #include <sys/Err.h>
 #include <sys/Exec.h>
+#include <sys/File.h>
 #include <mem/ScopedArray.h>
 
 #include "io/InputStream.h"
@@ -44,21 +45,37 @@ class PipeStream : InputStream
 
 public:
 
+    enum
+    {
+        DEFAULT_STREAM_BUFFER_SIZE = 64 * 1024,
+        DEFAULT_PIPE_SIZE = 1024 * 1024
+    };
+
     /*!
     *  Constructor --
     *  Streams data from a pipe when available
     *
     *  \param pipe             - pipe for reading
     *  \param streamBufferSize - size of internal buffer for streaming
+    *  \param pipeSize         - size to grow the kernel's pipe buffer to,
+    *                            where supported (Linux); the system limit
+    *                            applies, and 0 leaves it alone
+    *  \param spawn            - launch the child with posix_spawn()
+    *                            rather than fork() (see sys::ExecPipe)
     */
     PipeStream(const std::string& cmd,
-               size_t streamBufferSize = DEFAULT_CHUNK_SIZE) : 
+               size_t streamBufferSize = DEFAULT_STREAM_BUFFER_SIZE,
+               size_t pipeSize = DEFAULT_PIPE_SIZE,
+               bool spawn = false) : 
         InputStream(),
-        mExecPipe(cmd),
+        mExecPipe(cmd, spawn),
         mCharString(new char[streamBufferSize]),
-        mBufferSize(streamBufferSize)
+        mBufferSize(streamBufferSize),
+        mPipeSize(0),
+        mUsedStdio(false)
     {
         mExecPipe.run();
+        growPipe(pipeSize);
     }
 
     //! cleanup the stream if not done already
@@ -95,16 +112,45 @@ public:
     virtual sys::SSize_T streamTo(OutputStream& soi,
                                   sys::SSize_T numBytes = IS_END);
 
+    /*!
+     * Like streamTo(), but writes to a file at its current offset.  On
+     * Linux the bytes are spliced from the pipe to the file inside the
+     * kernel, never being copied through user space; this is only
+     * possible before anything has been read through read(), readln() or
+     * streamTo(), and otherwise falls back to copying.
+     * \param file     File to write to
+     * \param numBytes The number of bytes to move
+     * \throw IOException
+     * \return         The number of bytes moved, or IS_EOF if none
+     */
+    sys::SSize_T spliceTo(sys::File& file, sys::SSize_T numBytes = IS_END);
+
+    //! \return The size of the kernel's pipe buffer, or 0 if unknown
+    size_t getPipeSize() const
+    {
+        return mPipeSize;
+    }
+
 protected:
     /*!
      *  \brief returns the requested size in bytes from the stream
      */
     virtual sys::SSize_T readImpl(void* buffer, size_t len);
 
+    //! ask the kernel for a larger pipe buffer
+    void growPipe(size_t pipeSize);
+
+    //! moves bytes by reading them into mCharString and writing them out
+    sys::SSize_T copyTo(sys::File& file, sys::SSize_T numBytes);
+
 
     sys::ExecPipe mExecPipe;
     mem::ScopedArray<char> mCharString;
     size_t mBufferSize;
+    size_t mPipeSize;
+
+    //! true once data may be sitting in the FILE*'s buffer
+    bool mUsedStdio;
 
 private:
 
@@ -91,6 +91,12 @@ public:
         mProxy->write(buffer, len);
     }
 
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers)
+    {
+        mProxy->write(buffers);
+    }
+
     virtual void flush()
     {
         mProxy->flush();
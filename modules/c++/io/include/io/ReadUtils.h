@@ -35,6 +35,10 @@ namespace io
  * 'buffer'.  These are the exact bytes of the file, so text files will not
  * contain a null terminator.
  *
+ * The file is sized once up front and read with a single large read.  To
+ * use a large file without copying it at all, map it with
+ * io::MMapInputStream instead.
+ *
  * \param pathname Pathname of the file to read in
  * \param buffer Raw bytes of the file
  */
@@ -65,6 +69,21 @@ std::string readFileContents(const std::string& pathname)
     readFileContents(pathname, str);
     return str;
 }
+
+/*!
+ * Reads the contents of many files into strings, several at a time.  This
+ * is meant for loading lots of small files (e.g. XML metadata), where the
+ * time goes to opening and waiting on each file rather than to copying.
+ *
+ * \param pathnames Pathnames of the files to read in
+ * \param[out] contents Contents of the files, in the same order as
+ *             'pathnames'
+ * \param numThreads Number of threads to read with.  If 0, uses the number
+ *        of available CPUs.
+ */
+void readFileContents(const std::vector<std::string>& pathnames,
+                      std::vector<std::string>& contents,
+                      size_t numThreads = 0);
 }
 
 #endif
@@ -25,6 +25,7 @@
 
 #include <import/sys.h>
 #include "io/CountingStreams.h"
+#include "io/AsyncOutputStream.h"
 
 namespace io
 {
@@ -48,6 +49,14 @@ public:
 
     virtual void write(const void* buffer, size_t len);
 
+    /*!
+     * The buffers are treated as a single record: the rollover check is
+     * made once for their combined size, so a record is never split
+     * across files.
+     */
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers);
+
 protected:
     std::string mFilename;
     unsigned long mMaxBytes;
@@ -58,6 +67,32 @@ protected:
 
 };
 
+/**
+ * A RotatingFileOutputStream whose writes, rollover checks, renames and
+ * syncs all happen on a background thread (see AsyncOutputStream), so
+ * write() only ever copies into memory.
+ */
+class AsyncRotatingFileOutputStream: public AsyncOutputStream
+{
+public:
+    AsyncRotatingFileOutputStream(
+            const std::string& filename,
+            unsigned long maxBytes = 0,
+            size_t backupCount = 0,
+            int creationFlags = sys::File::CREATE | sys::File::TRUNCATE,
+            size_t capacity = 1048576,
+            OverflowPolicy overflowPolicy = BLOCK,
+            SyncPolicy syncPolicy = SYNC_NEVER,
+            size_t syncInterval = 0) :
+        AsyncOutputStream(new RotatingFileOutputStream(filename, maxBytes,
+                                                       backupCount,
+                                                       creationFlags),
+                          true, capacity, overflowPolicy, syncPolicy,
+                          syncInterval)
+    {
+    }
+};
+
 }
 
 #endif
@@ -0,0 +1,157 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __IO_SEGMENTED_BYTE_STREAM_H__
+#define __IO_SEGMENTED_BYTE_STREAM_H__
+
+#include <memory>
+#include <vector>
+
+#include "sys/Conf.h"
+#include "except/Exception.h"
+#include "mem/BufferView.h"
+#include "io/SeekableStreams.h"
+
+namespace io
+{
+/*!
+ *  \class SegmentedByteStream
+ *  \brief ByteStream stored as a list of fixed-size segments
+ *
+ *  Behaves like ByteStream, but the bytes live in a list of equally sized
+ *  segments rather than one growable array.  Appending allocates a new
+ *  segment when the last one fills, and existing bytes never move, so:
+ *
+ *  - building a large message costs no reallocation or copying, and
+ *    never needs twice the message size in memory;
+ *  - views handed out by slice() and getSegments() stay valid until the
+ *    stream is cleared (bytes may of course be overwritten in place);
+ *  - the contents can be sent with a single vectored write (writeTo()).
+ *
+ *  Seeking is O(1) since a position maps directly to a segment.  Unlike
+ *  ByteStream there is no contiguous get(); use slice() instead.
+ */
+class SegmentedByteStream : public SeekableInputStream,
+                            public SeekableOutputStream
+{
+public:
+    /*!
+     *  \param segmentSize The size, in bytes, of each segment
+     */
+    SegmentedByteStream(size_t segmentSize = 65536);
+
+    //! Destructor
+    virtual ~SegmentedByteStream()
+    {
+    }
+
+    virtual
+    sys::Off_T tell()
+    {
+        return mPosition;
+    }
+
+    virtual
+    sys::Off_T seek(sys::Off_T offset, Whence whence);
+
+    /*!
+     *  Returns the available bytes to read from the stream
+     *  \return the available bytes to read
+     */
+    virtual
+    sys::Off_T available();
+
+    using OutputStream::write;
+    using InputStream::streamTo;
+
+    /*!
+     *  Writes the bytes in data to the stream.
+     *  \param buffer the data to write to the stream
+     *  \param size the number of bytes to write to the stream
+     */
+    virtual
+    void write(const void* buffer, size_t size);
+
+    void reset()
+    {
+        mPosition = 0;
+    }
+
+    //! Release all segments.  Any views into the stream become invalid.
+    void clear();
+
+    sys::Size_T getSize() const
+    {
+        return mSize;
+    }
+
+    size_t getSegmentSize() const
+    {
+        return mSegmentSize;
+    }
+
+    /*!
+     *  Get zero-copy views of a range of the stream, one per segment it
+     *  spans.
+     *  \param offset Offset of the first byte
+     *  \param length The number of bytes
+     *  \throw except::Exception if the range is past the end of the stream
+     */
+    std::vector<mem::BufferView<const sys::byte> >
+    slice(sys::Size_T offset, sys::Size_T length) const;
+
+    //! \return Zero-copy views of the whole stream
+    std::vector<mem::BufferView<const sys::byte> > getSegments() const
+    {
+        return slice(0, mSize);
+    }
+
+    /*!
+     *  Write the whole stream to another stream with one vectored write.
+     *  This does not move the stream position.
+     *  \param os The stream to write to
+     */
+    void writeTo(OutputStream& os) const
+    {
+        os.write(getSegments());
+    }
+
+protected:
+    /*!
+     * Read up to len bytes of data from this buffer into an array
+     * update the mark
+     * \param buffer Buffer to read into
+     * \param len The length to read
+     * \throw IoException
+     * \return  The number of bytes read
+     */
+    virtual sys::SSize_T readImpl(void* buffer, size_t len);
+
+private:
+    const size_t mSegmentSize;
+    std::vector<std::unique_ptr<sys::byte[]> > mSegments;
+    sys::Size_T mSize;
+    sys::Off_T mPosition;
+};
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include <vector>
 
 #include <sys/Conf.h>
+#include <mem/BufferView.h>
 #include <io/InputStream.h>
 
 namespace io
@@ -61,6 +62,19 @@ public:
      */
     bool getNext(std::string& substring);
 
+    /*!
+     * \brief Get the next substring from the stream without copying it.
+     *
+     * \param[out] substring A view of the substring which will be set if
+     *             this call succeeds. Otherwise it will NOT be modified
+     *             (return value should be checked). The view normally
+     *             points into the internal buffer (substrings longer than
+     *             the buffer are assembled in separate storage) and is
+     *             only valid until the next call to getNext.
+     * \return true if this call succeeded, false if this call failed.
+     */
+    bool getNext(mem::BufferView<const sys::byte>& substring);
+
     /*!
      * \brief Check if the stream has no more substrings to return.
      *
@@ -93,6 +107,25 @@ public:
     size_t getNumBytesProcessed() const;
 
 private:
+    /*!
+     * \brief Find the first delimiter starting at or after searchBegin in
+     *        the valid part of the buffer.
+     *
+     * \return The buffer position of the delimiter, or -1 if none is found
+     */
+    sys::SSize_T findDelimiter(sys::SSize_T searchBegin) const;
+
+    /*!
+     * \brief Append bytes from the stream to the first substringSize bytes
+     *        of substring, up to the next delimiter or the end of the stream.
+     */
+    void appendSubstring(std::string& substring, size_t substringSize);
+
+    /*!
+     * \brief Move the valid part of the buffer to the start of the buffer.
+     */
+    void shiftBuffer();
+
     /*!
      * \brief Append the buffer section from mBufferBegin to bufferSegmentEnd
      *        to the substring and remove it from the buffer.
@@ -117,6 +150,7 @@ private:
     sys::byte* const mBuffer;
     io::InputStream& mInputStream;
     bool mStreamEmpty;
+    std::string mOverflow;
 };
 }
 
@@ -24,17 +24,38 @@
 #ifndef __IO_TEMPFILE_H__
 #define __IO_TEMPFILE_H__
 
+#include <memory>
+#include <string>
+
+#include <sys/File.h>
 #include <sys/OS.h>
+#include "io/OutputStream.h"
 
 namespace io
 {
 /*!
  * RAII object for a temporary file that gets deleted
  * upon object destruction
+ *
+ * A TempFile may be kept in memory rather than on disk, for intermediate
+ * products that never need to persist.  On Linux it is then an anonymous
+ * memfd (or, failing that, a file under /dev/shm); elsewhere it falls back
+ * to disk.  Either way pathname() can be opened by downstream code as usual.
+ *
+ * A memory file only spills once it's past its spill size if it's written
+ * through write() or getOutputStream().  Writes through pathname() aren't
+ * seen; call checkSpill() after them.
  */
 class TempFile
 {
 public:
+    //! Where the file's bytes are kept
+    enum Storage
+    {
+        DISK,   //!< A regular file in the requested directory
+        MEMORY  //!< An in-memory file, if the platform supports one
+    };
+
     /*!
      * Constructor for TempFile object. Provided a directory,
      * this will find a random, unused filename, and create a file
@@ -43,9 +64,23 @@ public:
      * \param dirname The directory in which to create the file
      */
     TempFile(const std::string& dirname=".");
+
+    /*!
+     * \param dirname The directory for a disk file, including one that a
+     *        memory file spills to
+     * \param storage Where to keep the file's bytes
+     * \param spillSize Once write() or getOutputStream() grows a memory
+     *        file past this many bytes, its contents are moved to a disk
+     *        file in 'dirname'.  If 0, the file never spills.
+     */
+    TempFile(const std::string& dirname, Storage storage,
+             size_t spillSize = 0);
+
     ~TempFile();
+
     /*!
-     * Get pathname of temporary file.
+     * Get pathname of temporary file.  For a memfd this is a
+     * /proc/self/fd path.  The pathname changes if the file spills.
      *
      * \return The pathname of the created file
      */
@@ -53,12 +88,80 @@ public:
     {
         return mPathname;
     }
+
+    //! \return Whether the file's bytes are currently held in memory
+    inline bool isInMemory() const
+    {
+        return mInMemory;
+    }
+
+    /*!
+     * Append bytes to the end of the file, spilling it to disk if it has
+     * grown past the spill size.
+     *
+     * \param buffer The bytes to write
+     * \param len The number of bytes to write
+     */
+    void write(const void* buffer, size_t len);
+
+    /*!
+     * A stream that appends to the file through write(), so that it spills
+     * as it should.  It lives as long as this object, and closing it does
+     * nothing.
+     */
+    io::OutputStream& getOutputStream();
+
+    /*!
+     * Move an in-memory file to a new file on disk.  Does nothing if the
+     * file is already on disk.
+     */
+    void spill();
+
+    /*!
+     * Spill an in-memory file if it has grown past the spill size, such as
+     * through writes to pathname()
+     */
+    void checkSpill();
+
+    //! \return The current size of the file in bytes
+    sys::Off_T size();
+
 private:
+    class Stream : public io::OutputStream
+    {
+    public:
+        explicit Stream(TempFile& tempFile) :
+            mTempFile(tempFile)
+        {
+        }
+
+        using io::OutputStream::write;
+
+        virtual void write(const void* buffer, size_t len)
+        {
+            mTempFile.write(buffer, len);
+        }
+
+    private:
+        TempFile& mTempFile;
+    };
+
     // Noncopyable
     TempFile(const TempFile& );
     const TempFile& operator=(const TempFile& );
+
+    void createInMemory();
+    void openForWrite();
+    void removeFile();
+
     const sys::OS mOS;
-    const std::string mPathname;
+    const std::string mDirname;
+    const size_t mSpillSize;
+    std::string mPathname;
+    bool mInMemory;
+    int mMemFd;
+    std::unique_ptr<sys::File> mFile;
+    std::unique_ptr<Stream> mStream;
 };
 }
 
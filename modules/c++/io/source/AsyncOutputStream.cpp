@@ -0,0 +1,376 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include <except/Exception.h>
+#include <mt/CriticalSection.h>
+#include "io/AsyncOutputStream.h"
+
+namespace io
+{
+AsyncOutputStream::AsyncOutputStream(OutputStream* proxy,
+                                     bool ownPtr,
+                                     size_t capacity,
+                                     OverflowPolicy overflowPolicy,
+                                     SyncPolicy syncPolicy,
+                                     size_t syncInterval) :
+    mProxy(proxy),
+    mOwnPtr(ownPtr),
+    mBuffer(std::max<size_t>(capacity, 1)),
+    mOverflowPolicy(overflowPolicy),
+    mSyncPolicy(syncPolicy),
+    mSyncInterval(syncInterval),
+    mWorkAvailable(&mLock),
+    mSpaceAvailable(&mLock),
+    mHead(0),
+    mSize(0),
+    mFlushesRequested(0),
+    mFlushesDone(0),
+    mSplitting(false),
+    mStopping(false),
+    mFailed(false),
+    mNumRecordsDropped(0),
+    mNumBytesDropped(0)
+{
+    mThread.reset(new sys::Thread(new Drainer(*this)));
+    mThread->start();
+}
+
+AsyncOutputStream::~AsyncOutputStream()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // Don't throw out of the destructor
+    }
+
+    if (!mOwnPtr)
+    {
+        mProxy.release();
+    }
+}
+
+void AsyncOutputStream::write(const void* buffer, size_t len)
+{
+    const mem::BufferView<const sys::byte> view(
+            static_cast<const sys::byte*>(buffer), len);
+    writeRecord(&view, len);
+}
+
+void AsyncOutputStream::write(
+        const std::vector<mem::BufferView<const sys::byte> >& buffers)
+{
+    size_t len = 0;
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        len += buffers[ii].size;
+    }
+    if (!buffers.empty())
+    {
+        writeRecord(&buffers[0], len);
+    }
+}
+
+void AsyncOutputStream::writeRecord(
+        const mem::BufferView<const sys::byte>* buffers, size_t len)
+{
+    const size_t capacity = mBuffer.size();
+    size_t buffer = 0;
+    size_t bufferOffset = 0;
+
+    mt::CriticalSection<sys::Mutex> lock(&mLock);
+    checkState();
+
+    if (mOverflowPolicy == DROP && len > capacity - mSize)
+    {
+        ++mNumRecordsDropped;
+        mNumBytesDropped += len;
+        return;
+    }
+
+    // Wait for room for the whole record, and for any record that's
+    // bigger than the buffer to finish going in, so that concurrent
+    // writers' records don't interleave
+    while (mSplitting || capacity - mSize < std::min(len, capacity))
+    {
+        mSpaceAvailable.wait();
+        checkState();
+    }
+
+    // A record bigger than the buffer goes in as room is made for it,
+    // with other writers held off until it's done
+    mSplitting = len > capacity;
+    while (len > 0)
+    {
+        while (mSize == capacity)
+        {
+            mSpaceAvailable.wait();
+            checkState();
+        }
+
+        // copy as much of the record as fits, wrapping around the end of
+        // the buffer
+        const size_t numBytes = std::min(len, capacity - mSize);
+        size_t tail = (mHead + mSize) % capacity;
+        for (size_t copied = 0; copied < numBytes;)
+        {
+            while (bufferOffset == buffers[buffer].size)
+            {
+                ++buffer;
+                bufferOffset = 0;
+            }
+            const size_t part = std::min(
+                    std::min(numBytes - copied,
+                             buffers[buffer].size - bufferOffset),
+                    capacity - tail);
+            ::memcpy(&mBuffer[tail], buffers[buffer].data + bufferOffset,
+                     part);
+            tail = (tail + part) % capacity;
+            bufferOffset += part;
+            copied += part;
+        }
+
+        // the background thread only sleeps when the buffer is empty
+        const bool wasEmpty = (mSize == 0);
+        mSize += numBytes;
+        mRecordSizes.push_back(numBytes);
+        len -= numBytes;
+        if (wasEmpty)
+        {
+            mWorkAvailable.signal();
+        }
+    }
+
+    if (mSplitting)
+    {
+        mSplitting = false;
+        mSpaceAvailable.broadcast();
+    }
+}
+
+void AsyncOutputStream::flush()
+{
+    mt::CriticalSection<sys::Mutex> lock(&mLock);
+    checkState();
+
+    const size_t request = ++mFlushesRequested;
+    mWorkAvailable.signal();
+    while (mFlushesDone < request && !mFailed)
+    {
+        mSpaceAvailable.wait();
+    }
+    checkState();
+}
+
+void AsyncOutputStream::close()
+{
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mLock);
+        if (mStopping)
+        {
+            return;
+        }
+        mStopping = true;
+        mWorkAvailable.signal();
+    }
+
+    // The background thread has drained the buffer and exited, so the
+    // proxy is ours again
+    mThread->join();
+    if (mFailed)
+    {
+        if (mOwnPtr)
+        {
+            mProxy->close();
+        }
+        throw except::IOException(Ctxt(
+                "Background write failed: " + mError));
+    }
+    mProxy->flush();
+    if (mOwnPtr)
+    {
+        mProxy->close();
+    }
+}
+
+size_t AsyncOutputStream::getNumRecordsDropped() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mLock);
+    return mNumRecordsDropped;
+}
+
+sys::Off_T AsyncOutputStream::getNumBytesDropped() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mLock);
+    return mNumBytesDropped;
+}
+
+void AsyncOutputStream::checkState() const
+{
+    if (mFailed)
+    {
+        throw except::IOException(Ctxt(
+                "Background write failed: " + mError));
+    }
+    if (mStopping)
+    {
+        throw except::IOException(Ctxt("Stream is closed"));
+    }
+}
+
+void AsyncOutputStream::drain()
+{
+    const size_t capacity = mBuffer.size();
+    size_t numUnsynced = 0;
+
+    mt::CriticalSection<sys::Mutex> lock(&mLock);
+    while (true)
+    {
+        while (mSize == 0 && mFlushesDone == mFlushesRequested && !mStopping)
+        {
+            mWorkAvailable.wait();
+        }
+
+        if (mSize > 0 && mFailed)
+        {
+            // Nothing more can be written; discard so nobody waits forever
+            mHead = 0;
+            mSize = 0;
+            mRecordSizes.clear();
+            mSpaceAvailable.broadcast();
+        }
+        else if (mSize > 0)
+        {
+            // Writers only ever copy into free space, so the records queued
+            // so far can be written out without holding the lock.  They are
+            // written one at a time so that the proxy sees the same records
+            // the caller wrote (a RotatingFileOutputStream rolls over
+            // between records, never within one).
+            const size_t head = mHead;
+            mBatch.assign(mRecordSizes.begin(), mRecordSizes.end());
+            lock.manualUnlock();
+
+            bool failed = false;
+            std::string error;
+            size_t numBytes = 0;
+            try
+            {
+                std::vector<mem::BufferView<const sys::byte> > wrapped(2);
+                for (size_t ii = 0; ii < mBatch.size(); ++ii)
+                {
+                    const size_t pos = (head + numBytes) % capacity;
+                    const size_t recordSize = mBatch[ii];
+                    if (pos + recordSize <= capacity)
+                    {
+                        mProxy->write(&mBuffer[pos], recordSize);
+                    }
+                    else
+                    {
+                        wrapped[0] = mem::BufferView<const sys::byte>(
+                                &mBuffer[pos], capacity - pos);
+                        wrapped[1] = mem::BufferView<const sys::byte>(
+                                &mBuffer[0], pos + recordSize - capacity);
+                        mProxy->write(wrapped);
+                    }
+                    numBytes += recordSize;
+                }
+
+                numUnsynced += numBytes;
+                if (mSyncPolicy == SYNC_ALWAYS ||
+                    (mSyncPolicy == SYNC_INTERVAL &&
+                     numUnsynced >= mSyncInterval))
+                {
+                    mProxy->flush();
+                    numUnsynced = 0;
+                }
+            }
+            catch (const except::Exception& ex)
+            {
+                failed = true;
+                error = ex.getMessage();
+            }
+            catch (const std::exception& ex)
+            {
+                failed = true;
+                error = ex.what();
+            }
+
+            lock.manualLock();
+            if (failed)
+            {
+                mFailed = true;
+                mError = error;
+            }
+            else
+            {
+                mRecordSizes.erase(mRecordSizes.begin(),
+                                   mRecordSizes.begin() + mBatch.size());
+                mHead = (head + numBytes) % capacity;
+                mSize -= numBytes;
+            }
+            mSpaceAvailable.broadcast();
+        }
+        else if (mFlushesDone != mFlushesRequested)
+        {
+            const size_t request = mFlushesRequested;
+            lock.manualUnlock();
+
+            bool failed = false;
+            std::string error;
+            try
+            {
+                mProxy->flush();
+                numUnsynced = 0;
+            }
+            catch (const except::Exception& ex)
+            {
+                failed = true;
+                error = ex.getMessage();
+            }
+            catch (const std::exception& ex)
+            {
+                failed = true;
+                error = ex.what();
+            }
+
+            lock.manualLock();
+            if (failed)
+            {
+                mFailed = true;
+                mError = error;
+            }
+            mFlushesDone = request;
+            mSpaceAvailable.broadcast();
+        }
+        else
+        {
+            // Empty, nothing to flush, and asked to stop
+            return;
+        }
+    }
+}
+}
@@ -20,10 +20,22 @@
  *
  */
 
+#include <algorithm>
+
 #include "io/FileInputStreamOS.h"
 
 #if !defined(USE_IO_STREAMS)
 
+#if !(defined(WIN32) || defined(_WIN32))
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+#endif
+
 /*!
  * Returns the number of bytes that can be read
  * without blocking by the next caller of a method for this input
@@ -56,4 +68,67 @@ sys::SSize_T io::FileInputStreamOS::readImpl(void* buffer, size_t len)
     return static_cast<sys::SSize_T>(len);
 }
 
+sys::SSize_T io::FileInputStreamOS::readImpl(
+        const std::vector<mem::BufferView<sys::byte> >& buffers)
+{
+#if defined(WIN32) || defined(_WIN32)
+    return InputStream::readImpl(buffers);
+#else
+    sys::Off_T avail = available();
+    if (!avail)
+        return io::InputStream::IS_EOF;
+
+    // Clamp the request to what is left in the file, as readImpl() does
+    std::vector<struct iovec> iov;
+    iov.reserve(buffers.size());
+    size_t len = 0;
+    for (size_t ii = 0; ii < buffers.size() && avail > 0; ++ii)
+    {
+        if (buffers[ii].size == 0)
+            continue;
+
+        struct iovec vec;
+        vec.iov_base = buffers[ii].data;
+        vec.iov_len = std::min<size_t>(buffers[ii].size,
+                                       static_cast<size_t>(avail));
+        ::memset(vec.iov_base, 0, vec.iov_len);
+        iov.push_back(vec);
+        len += vec.iov_len;
+        avail -= vec.iov_len;
+    }
+
+    size_t next = 0;
+    while (next < iov.size())
+    {
+        const size_t count = std::min<size_t>(iov.size() - next, IOV_MAX);
+        const sys::SSize_T bytesRead =
+                ::readv(mFile.getHandle(), &iov[next], static_cast<int>(count));
+        if (bytesRead == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            throw sys::SystemException(Ctxt("While reading from file"));
+        }
+        if (bytesRead == 0)
+        {
+            throw sys::SystemException(Ctxt("Unexpected end of file"));
+        }
+
+        size_t remaining = static_cast<size_t>(bytesRead);
+        while (next < iov.size() && remaining >= iov[next].iov_len)
+        {
+            remaining -= iov[next].iov_len;
+            ++next;
+        }
+        if (remaining > 0)
+        {
+            iov[next].iov_base =
+                    static_cast<sys::byte*>(iov[next].iov_base) + remaining;
+            iov[next].iov_len -= remaining;
+        }
+    }
+    return static_cast<sys::SSize_T>(len);
+#endif
+}
+
 #endif
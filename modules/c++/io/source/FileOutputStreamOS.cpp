@@ -20,10 +20,22 @@
  *
  */
 
+#include <algorithm>
+
 #include "io/FileOutputStreamOS.h"
 
 #if !defined(USE_IO_STREAMS)
 
+#if !(defined(WIN32) || defined(_WIN32))
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+#endif
+
 io::FileOutputStreamOS::FileOutputStreamOS(const std::string& str,
         int creationFlags)
 {
@@ -48,6 +60,58 @@ void io::FileOutputStreamOS::write(const void* buffer, size_t len)
     mFile.writeFrom(buffer, len);
 }
 
+void io::FileOutputStreamOS::write(
+        const std::vector<mem::BufferView<const sys::byte> >& buffers)
+{
+#if defined(WIN32) || defined(_WIN32)
+    OutputStream::write(buffers);
+#else
+    std::vector<struct iovec> iov;
+    iov.reserve(buffers.size());
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        if (buffers[ii].size > 0)
+        {
+            struct iovec vec;
+            vec.iov_base = const_cast<sys::byte*>(buffers[ii].data);
+            vec.iov_len = buffers[ii].size;
+            iov.push_back(vec);
+        }
+    }
+
+    // writev() may write less than requested, so advance through the
+    // iovec array (at most IOV_MAX entries per call) until it is drained
+    size_t next = 0;
+    while (next < iov.size())
+    {
+        const size_t count = std::min<size_t>(iov.size() - next, IOV_MAX);
+        const sys::SSize_T bytesWritten =
+                ::writev(mFile.getHandle(), &iov[next], static_cast<int>(count));
+        if (bytesWritten == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw sys::SystemException(Ctxt("Writing to file"));
+        }
+
+        size_t remaining = static_cast<size_t>(bytesWritten);
+        while (next < iov.size() && remaining >= iov[next].iov_len)
+        {
+            remaining -= iov[next].iov_len;
+            ++next;
+        }
+        if (remaining > 0)
+        {
+            iov[next].iov_base =
+                    static_cast<sys::byte*>(iov[next].iov_base) + remaining;
+            iov[next].iov_len -= remaining;
+        }
+    }
+#endif
+}
+
 void io::FileOutputStreamOS::flush()
 {
     mFile.flush();
@@ -21,9 +21,23 @@
  */
 
 #include <sstream>
+#include <algorithm>
+#include <vector>
 #include <io/FileUtils.h>
 #include <io/FileInputStream.h>
 #include <io/FileOutputStream.h>
+#include <mt/Runnable1D.h>
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#if defined(__linux) || defined(__linux__)
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+#endif
 
 /*!
  *  Copy a file or directory permissions and ownership.
@@ -71,9 +85,332 @@ void copyPermissions(const std::string& src,
 #endif
 }
 
+namespace
+{
+#if !(defined(WIN32) || defined(_WIN32))
+//! The most we ask the kernel to move in a single call
+const sys::Off_T MAX_KERNEL_COPY = 0x40000000;
+
+//! Errors that mean "this kernel/filesystem can't do that copy"
+bool isUnsupported(int err)
+{
+    return err == ENOSYS || err == EXDEV || err == EINVAL ||
+           err == EOPNOTSUPP || err == EBADF || err == EPERM;
+}
+
+/*!
+ *  Share the source's extents with the destination (a reflink), which
+ *  copies no data at all on filesystems such as btrfs and XFS.
+ *
+ *  \return True if the destination is now a clone of the source
+ */
+bool cloneFile(int in, int out)
+{
+#if defined(FICLONE)
+    return ::ioctl(out, FICLONE, in) == 0;
+#else
+    (void)in;
+    (void)out;
+    return false;
+#endif
+}
+
+/*!
+ *  Copy length bytes at offset with copy_file_range().  Offsets are
+ *  explicit so disjoint ranges may be copied concurrently.
+ *
+ *  \return The number of bytes copied, which is short of length if the
+ *          kernel could not do (all of) the copy
+ */
+sys::Off_T copyFileRange(int in, int out, sys::Off_T offset, sys::Off_T length)
+{
+    sys::Off_T copied = 0;
+#if defined(SYS_copy_file_range)
+    loff_t inOffset = offset;
+    loff_t outOffset = offset;
+    while (copied < length)
+    {
+        const size_t request = static_cast<size_t>(
+                std::min(length - copied, MAX_KERNEL_COPY));
+        const long numBytes = ::syscall(SYS_copy_file_range, in, &inOffset,
+                                        out, &outOffset, request, 0u);
+        if (numBytes == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (isUnsupported(errno))
+            {
+                break;
+            }
+            throw sys::SystemException(Ctxt("Copying file range"));
+        }
+        if (numBytes == 0)
+        {
+            break;
+        }
+        copied += numBytes;
+    }
+#else
+    (void)in;
+    (void)out;
+    (void)offset;
+    (void)length;
+#endif
+    return copied;
+}
+
+/*!
+ *  Copy length bytes at offset with sendfile().  sendfile() writes at
+ *  the output's file position, so this is only used for serial copies.
+ *
+ *  \return The number of bytes copied
+ */
+sys::Off_T sendFileRange(int in, int out, sys::Off_T offset, sys::Off_T length)
+{
+    sys::Off_T copied = 0;
+#if defined(__linux) || defined(__linux__)
+    if (::lseek(out, offset, SEEK_SET) == (off_t) -1)
+    {
+        return 0;
+    }
+
+    off_t inOffset = offset;
+    while (copied < length)
+    {
+        const size_t request = static_cast<size_t>(
+                std::min(length - copied, MAX_KERNEL_COPY));
+        const ssize_t numBytes = ::sendfile(out, in, &inOffset, request);
+        if (numBytes == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (isUnsupported(errno) || errno == ENOSYS)
+            {
+                break;
+            }
+            throw sys::SystemException(Ctxt("Sending file range"));
+        }
+        if (numBytes == 0)
+        {
+            break;
+        }
+        copied += numBytes;
+    }
+#else
+    (void)in;
+    (void)out;
+    (void)offset;
+    (void)length;
+#endif
+    return copied;
+}
+
+//! Copy length bytes at offset through a user-space buffer
+void bufferedCopyRange(int in, int out, sys::Off_T offset, sys::Off_T length,
+                       size_t blockSize)
+{
+    std::vector<sys::byte> buffer(std::max<size_t>(blockSize, 1));
+    while (length > 0)
+    {
+        const size_t request = static_cast<size_t>(
+                std::min<sys::Off_T>(length, buffer.size()));
+        const ssize_t numRead = ::pread(in, &buffer[0], request, offset);
+        if (numRead == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw sys::SystemException(Ctxt("Reading from file"));
+        }
+        if (numRead == 0)
+        {
+            throw except::IOException(Ctxt("Unexpected end of file"));
+        }
+
+        ssize_t written = 0;
+        while (written < numRead)
+        {
+            const ssize_t numBytes = ::pwrite(out, &buffer[written],
+                                              numRead - written,
+                                              offset + written);
+            if (numBytes == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw sys::SystemException(Ctxt("Writing to file"));
+            }
+            written += numBytes;
+        }
+        offset += numRead;
+        length -= numRead;
+    }
+}
+
+//! Copy one range, falling back from the kernel paths to a buffer
+void copyRange(int in, int out, sys::Off_T offset, sys::Off_T length,
+               size_t blockSize, bool useSendFile)
+{
+    sys::Off_T copied = copyFileRange(in, out, offset, length);
+    if (copied < length && useSendFile)
+    {
+        copied += sendFileRange(in, out, offset + copied, length - copied);
+    }
+    if (copied < length)
+    {
+        bufferedCopyRange(in, out, offset + copied, length - copied,
+                          blockSize);
+    }
+}
+
+//! Copy from the file position of in until it ends, for files whose length
+//! isn't known up front
+sys::Off_T copyToEnd(int in, int out, size_t blockSize)
+{
+    std::vector<sys::byte> buffer(std::max<size_t>(blockSize, 1));
+    sys::Off_T copied = 0;
+    while (true)
+    {
+        const ssize_t numRead = ::read(in, &buffer[0], buffer.size());
+        if (numRead == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw sys::SystemException(Ctxt("Reading from file"));
+        }
+        if (numRead == 0)
+        {
+            return copied;
+        }
+
+        ssize_t written = 0;
+        while (written < numRead)
+        {
+            const ssize_t numBytes = ::write(out, &buffer[written],
+                                             numRead - written);
+            if (numBytes == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw sys::SystemException(Ctxt("Writing to file"));
+            }
+            written += numBytes;
+        }
+        copied += numRead;
+    }
+}
+
+//! Copies the ii'th range of a file, for use with mt::run1D()
+class CopyRangeOp
+{
+public:
+    CopyRangeOp(int in, int out, sys::Off_T fileSize, sys::Off_T rangeSize,
+                size_t blockSize) :
+        mIn(in),
+        mOut(out),
+        mFileSize(fileSize),
+        mRangeSize(rangeSize),
+        mBlockSize(blockSize)
+    {
+    }
+
+    void operator()(size_t ii) const
+    {
+        const sys::Off_T offset = static_cast<sys::Off_T>(ii) * mRangeSize;
+        copyRange(mIn, mOut, offset, std::min(mRangeSize, mFileSize - offset),
+                  mBlockSize, false);
+    }
+
+private:
+    const int mIn;
+    const int mOut;
+    const sys::Off_T mFileSize;
+    const sys::Off_T mRangeSize;
+    const size_t mBlockSize;
+};
+#endif
+
+/*!
+ *  Copy the contents of one file to another
+ *
+ *  \return The number of bytes copied, or -1 on failure
+ */
+sys::SSize_T copyFileContents(const std::string& src,
+                              const std::string& dest,
+                              size_t blockSize,
+                              size_t numThreads)
+{
+#if defined(WIN32) || defined(_WIN32)
+    (void)blockSize;
+    (void)numThreads;
+    io::FileInputStream fis(src);
+    io::FileOutputStream fos(dest);
+    const sys::SSize_T numBytes = fis.streamTo(fos);
+    fis.close();
+    fos.close();
+    return numBytes;
+#else
+    sys::File in(src, sys::File::READ_ONLY, sys::File::EXISTING);
+    sys::File out(dest, sys::File::WRITE_ONLY,
+                  sys::File::CREATE | sys::File::TRUNCATE);
+    sys::Off_T fileSize = in.length();
+    blockSize = std::max<size_t>(blockSize, 1);
+
+    if (fileSize == 0)
+    {
+        // procfs, sysfs and some FUSE files report no length but still
+        // have contents, so read those until they end
+        fileSize = copyToEnd(in.getHandle(), out.getHandle(), blockSize);
+    }
+    else if (!cloneFile(in.getHandle(), out.getHandle()))
+    {
+        if (numThreads > 1 && fileSize > static_cast<sys::Off_T>(blockSize))
+        {
+            // Size the output up front so the threads never race to
+            // extend it, and give each one a whole number of blocks
+            if (::ftruncate(out.getHandle(), fileSize) == -1)
+            {
+                throw sys::SystemException(Ctxt("Sizing output file"));
+            }
+
+            const sys::Off_T numBlocks = (fileSize + blockSize - 1) / blockSize;
+            const sys::Off_T rangeSize =
+                    (numBlocks + numThreads - 1) / numThreads * blockSize;
+            const size_t numRanges =
+                    static_cast<size_t>((fileSize + rangeSize - 1) / rangeSize);
+
+            mt::run1D(numRanges, numThreads,
+                      CopyRangeOp(in.getHandle(), out.getHandle(), fileSize,
+                                  rangeSize, blockSize));
+        }
+        else
+        {
+            copyRange(in.getHandle(), out.getHandle(), 0, fileSize, blockSize,
+                      true);
+        }
+    }
+
+    in.close();
+    out.close();
+    return static_cast<sys::SSize_T>(fileSize);
+#endif
+}
+}
+
 void io::copy(const std::string& path, 
               const std::string& newPath,
-              size_t blockSize)
+              size_t blockSize,
+              size_t numThreads)
 {
     //! list will find '.' and '..' in the directory
     const std::string item = sys::Path::splitPath(path).second;
@@ -99,17 +436,14 @@ void io::copy(const std::string& path,
         for (size_t ii = 0; ii < contents.size(); ++ii)
         {
             std::string srcFile  = sys::Path::joinPaths(path, contents[ii]);
-            io::copy(srcFile, destDir, blockSize);
+            io::copy(srcFile, destDir, blockSize, numThreads);
         }
     }
     else
     {
         std::string newFile = sys::Path::joinPaths(newPath, item);
-        io::FileInputStream fis(path);
-        io::FileOutputStream fos(newFile);
-        const sys::SSize_T numBytes = fis.streamTo(fos);
-        fis.close();
-        fos.close();
+        const sys::SSize_T numBytes =
+                copyFileContents(path, newFile, blockSize, numThreads);
 
         copyPermissions(path, newFile);
 
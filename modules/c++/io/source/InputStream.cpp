@@ -51,6 +51,64 @@ sys::SSize_T InputStream::read(void* buffer,
     return numBytes;
 }
 
+sys::SSize_T InputStream::read(
+        const std::vector<mem::BufferView<sys::byte> >& buffers,
+        bool verifyFullRead)
+{
+    const sys::SSize_T numBytes = readImpl(buffers);
+    if (verifyFullRead)
+    {
+        size_t len = 0;
+        for (size_t ii = 0; ii < buffers.size(); ++ii)
+        {
+            len += buffers[ii].size;
+        }
+
+        if (numBytes == -1)
+        {
+            std::ostringstream ostr;
+            ostr << "Tried to read " << len << " bytes but read failed";
+            throw except::IOException(Ctxt(ostr.str()));
+        }
+        else if (numBytes != static_cast<sys::SSize_T>(len))
+        {
+            std::ostringstream ostr;
+            ostr << "Tried to read " << len << " bytes but only read "
+                 << numBytes << " bytes";
+            throw except::IOException(Ctxt(ostr.str()));
+        }
+    }
+
+    return numBytes;
+}
+
+sys::SSize_T InputStream::readImpl(
+        const std::vector<mem::BufferView<sys::byte> >& buffers)
+{
+    sys::SSize_T total = 0;
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        if (buffers[ii].size == 0)
+        {
+            continue;
+        }
+
+        const sys::SSize_T numBytes =
+                readImpl(buffers[ii].data, buffers[ii].size);
+        if (numBytes == -1)
+        {
+            return (total == 0) ? -1 : total;
+        }
+
+        total += numBytes;
+        if (numBytes != static_cast<sys::SSize_T>(buffers[ii].size))
+        {
+            break;
+        }
+    }
+    return total;
+}
+
 sys::SSize_T InputStream::streamTo(OutputStream& soi, sys::SSize_T bytesToPipe)
 {
 
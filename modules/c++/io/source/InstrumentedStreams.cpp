@@ -0,0 +1,239 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <mt/CriticalSection.h>
+#include "io/InstrumentedStreams.h"
+
+namespace
+{
+// Index of the smallest power of two greater than value, capped to the
+// last bucket; 0 maps to bucket 0
+size_t getBucket(sys::Uint64_T value)
+{
+    size_t bucket = 0;
+    while (value != 0 && bucket < io::StreamStatistics::NUM_BUCKETS - 1)
+    {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+sys::Int64_T getSlotSecond(double seconds)
+{
+    return static_cast<sys::Int64_T>(std::floor(seconds));
+}
+}
+
+namespace io
+{
+StreamStatistics::StreamStatistics() :
+    numCalls(0),
+    numBytes(0),
+    blockedSeconds(0),
+    elapsedSeconds(0),
+    maxLatencySeconds(0),
+    latencyHistogram(NUM_BUCKETS, 0),
+    sizeHistogram(NUM_BUCKETS, 0),
+    bytesPerSecond(NUM_SECONDS, 0)
+{
+}
+
+double StreamStatistics::getMeanLatency() const
+{
+    return numCalls == 0 ? 0 : blockedSeconds / numCalls;
+}
+
+double StreamStatistics::getLatencyPercentile(double percentile) const
+{
+    if (numCalls == 0)
+    {
+        return 0;
+    }
+
+    const double target = std::max(percentile, 0.0) / 100 * numCalls;
+    sys::Uint64_T count = 0;
+    for (size_t ii = 0; ii < latencyHistogram.size(); ++ii)
+    {
+        count += latencyHistogram[ii];
+        if (count > 0 && count >= target)
+        {
+            // Bucket ii holds latencies below 2^ii microseconds
+            return std::min(std::ldexp(1e-6, static_cast<int>(ii)),
+                            maxLatencySeconds);
+        }
+    }
+    return maxLatencySeconds;
+}
+
+double StreamStatistics::getThroughput(size_t seconds) const
+{
+    seconds = std::min(seconds, bytesPerSecond.size() - 1);
+    if (seconds == 0)
+    {
+        return 0;
+    }
+
+    // Skip the partial current second, and don't average over time before
+    // the stream existed
+    const size_t available = std::max<size_t>(
+            static_cast<size_t>(elapsedSeconds), 1);
+    seconds = std::min(seconds, available);
+
+    sys::Uint64_T total = 0;
+    for (size_t ii = 1; ii <= seconds; ++ii)
+    {
+        total += bytesPerSecond[ii];
+    }
+    return static_cast<double>(total) / seconds;
+}
+
+double StreamStatistics::getBlockedFraction() const
+{
+    return elapsedSeconds <= 0 ? 0 : blockedSeconds / elapsedSeconds;
+}
+
+StreamMetrics::StreamMetrics() :
+    mStartTime(now()),
+    mSlotSeconds(StreamStatistics::NUM_SECONDS, -1)
+{
+}
+
+double StreamMetrics::now()
+{
+    typedef std::chrono::steady_clock Clock;
+    return std::chrono::duration<double>(
+            Clock::now().time_since_epoch()).count();
+}
+
+void StreamMetrics::record(size_t numBytes, double start, double end)
+{
+    const double latency = std::max(end - start, 0.0);
+    const size_t latencyBucket =
+            getBucket(static_cast<sys::Uint64_T>(latency * 1e6));
+    const size_t sizeBucket = getBucket(numBytes);
+
+    mt::CriticalSection<sys::Mutex> crit(&mLock);
+    const sys::Int64_T second = getSlotSecond(end - mStartTime);
+    const size_t slot = static_cast<size_t>(
+            std::max<sys::Int64_T>(second, 0) % mSlotSeconds.size());
+    if (mSlotSeconds[slot] != second)
+    {
+        mSlotSeconds[slot] = second;
+        mTotals.bytesPerSecond[slot] = 0;
+    }
+    mTotals.bytesPerSecond[slot] += numBytes;
+
+    ++mTotals.numCalls;
+    mTotals.numBytes += numBytes;
+    mTotals.blockedSeconds += latency;
+    mTotals.maxLatencySeconds = std::max(mTotals.maxLatencySeconds, latency);
+    ++mTotals.latencyHistogram[latencyBucket];
+    ++mTotals.sizeHistogram[sizeBucket];
+}
+
+StreamStatistics StreamMetrics::getStatistics() const
+{
+    const double current = now();
+
+    StreamStatistics stats;
+    {
+        mt::CriticalSection<sys::Mutex> crit(&mLock);
+        stats = mTotals;
+        stats.elapsedSeconds = current - mStartTime;
+
+        // mTotals.bytesPerSecond is a ring indexed by second; unroll it so
+        // index 0 is the current second
+        const sys::Int64_T second = getSlotSecond(stats.elapsedSeconds);
+        const size_t numSlots = mSlotSeconds.size();
+        for (size_t ii = 0; ii < numSlots; ++ii)
+        {
+            const sys::Int64_T wanted = second - static_cast<sys::Int64_T>(ii);
+            const size_t slot = wanted < 0 ? 0 :
+                    static_cast<size_t>(wanted % numSlots);
+            stats.bytesPerSecond[ii] = (wanted >= 0 &&
+                                        mSlotSeconds[slot] == wanted) ?
+                    mTotals.bytesPerSecond[slot] : 0;
+        }
+    }
+    return stats;
+}
+
+void StreamMetrics::reset()
+{
+    mt::CriticalSection<sys::Mutex> crit(&mLock);
+    mTotals = StreamStatistics();
+    std::fill(mSlotSeconds.begin(), mSlotSeconds.end(), -1);
+    mStartTime = now();
+}
+
+sys::SSize_T InstrumentedInputStream::readImpl(void* buffer, size_t len)
+{
+    const double start = StreamMetrics::now();
+    const sys::SSize_T numBytes = mProxy->read(buffer, len);
+    mMetrics.record(numBytes > 0 ? static_cast<size_t>(numBytes) : 0,
+                    start, StreamMetrics::now());
+    return numBytes;
+}
+
+sys::SSize_T InstrumentedInputStream::readImpl(
+        const std::vector<mem::BufferView<sys::byte> >& buffers)
+{
+    const double start = StreamMetrics::now();
+    const sys::SSize_T numBytes = mProxy->read(buffers);
+    mMetrics.record(numBytes > 0 ? static_cast<size_t>(numBytes) : 0,
+                    start, StreamMetrics::now());
+    return numBytes;
+}
+
+void InstrumentedOutputStream::write(const void* buffer, size_t len)
+{
+    const double start = StreamMetrics::now();
+    mProxy->write(buffer, len);
+    mMetrics.record(len, start, StreamMetrics::now());
+}
+
+void InstrumentedOutputStream::write(
+        const std::vector<mem::BufferView<const sys::byte> >& buffers)
+{
+    size_t len = 0;
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        len += buffers[ii].size;
+    }
+
+    const double start = StreamMetrics::now();
+    mProxy->write(buffers);
+    mMetrics.record(len, start, StreamMetrics::now());
+}
+
+void InstrumentedOutputStream::flush()
+{
+    const double start = StreamMetrics::now();
+    mProxy->flush();
+    mMetrics.record(0, start, StreamMetrics::now());
+}
+}
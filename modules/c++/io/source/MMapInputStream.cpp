@@ -1,8 +1,8 @@
 /* =========================================================================
- * This file is part of io-c++ 
+ * This file is part of io-c++
  * =========================================================================
- * 
- * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
  *
  * io-c++ is free software; you can redistribute it and/or modify
  * it under the terms of the GNU Lesser General Public License as published by
@@ -14,73 +14,206 @@
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Lesser General Public License for more details.
  *
- * You should have received a copy of the GNU Lesser General Public 
- * License along with this program; If not, 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
  * see <http://www.gnu.org/licenses/>.
  *
  */
 
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <sys/mman.h>
+#include <errno.h>
+#endif
+
+#include "except/Exception.h"
+#include "sys/Err.h"
 #include "io/MMapInputStream.h"
 
-void io::MMapInputStream::open(const std::string& fname, char* flags)
+namespace io
 {
-    mLength = mOs.getSize(fname);
-    //    std::cout << mLength << std::endl;
-    mFile = fopen(fname.c_str(), "r");
-    if (!mFile)
-        throw sys::SystemException(FmtX("Failure while opening file: %s", fname.c_str()));
+MMapInputStream::MMapInputStream() :
+    mLength(0),
+    mData(NULL),
+    mMark(0)
+#if defined(WIN32) || defined(_WIN32)
+    , mMapping(NULL)
+#endif
+{
+}
 
-    _map();
+MMapInputStream::MMapInputStream(const std::string& inputFile,
+                                 bool sequential) :
+    mLength(0),
+    mData(NULL),
+    mMark(0)
+#if defined(WIN32) || defined(_WIN32)
+    , mMapping(NULL)
+#endif
+{
+    open(inputFile, sequential);
+}
 
+MMapInputStream::~MMapInputStream()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
 }
 
-void io::MMapInputStream::close()
+void MMapInputStream::open(const std::string& fname, bool sequential)
 {
-    _unmap();
-    fclose(mFile);
-    mFile = NULL;
+    close();
+
+    mFile.create(fname, sys::File::READ_ONLY, sys::File::EXISTING);
+    mLength = static_cast<size_t>(mFile.length());
+    mMark = 0;
+    try
+    {
+        map(sequential);
+    }
+    catch (...)
+    {
+        mFile.close();
+        mLength = 0;
+        throw;
+    }
 }
 
-void io::MMapInputStream::_map()
+void MMapInputStream::close()
 {
-    sys::Handle_T handle = getHandle();
-    mData = (sys::byte*)mOs.mapFile(handle, mLength, PROT_READ, MAP_SHARED, 0);
+    unmap();
+    if (mFile.isOpen())
+    {
+        mFile.close();
+    }
+    mLength = 0;
+    mMark = 0;
 }
-void io::MMapInputStream::_unmap()
+
+#if defined(WIN32) || defined(_WIN32)
+void MMapInputStream::map(bool /*sequential*/)
 {
-    //     std::cout << "Unmapping file... ";
-    mOs.unmapFile(mData, mLength);
-    mData = NULL;
-    //    std::cout << "done!" << std::endl;
+    // Windows can't map an empty file
+    if (mLength == 0)
+    {
+        return;
+    }
+
+    mMapping = ::CreateFileMapping(mFile.getHandle(), NULL, PAGE_READONLY,
+                                   0, 0, NULL);
+    if (mMapping == NULL)
+    {
+        throw except::IOException(Ctxt("Failed to create file mapping: " +
+                                       sys::Err().toString()));
+    }
+
+    mData = static_cast<sys::byte*>(
+            ::MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+    if (mData == NULL)
+    {
+        const std::string err = sys::Err().toString();
+        ::CloseHandle(mMapping);
+        mMapping = NULL;
+        throw except::IOException(Ctxt("Failed to map file: " + err));
+    }
 }
 
-sys::Handle_T io::MMapInputStream::getHandle()
+void MMapInputStream::unmap()
 {
-    if (!mFile) throw except::NullPointerReference(Ctxt("Uninitialized memory mapped file stream!"));
-    return ::fileno(mFile);
+    if (mData)
+    {
+        ::UnmapViewOfFile(mData);
+        mData = NULL;
+    }
+    if (mMapping)
+    {
+        ::CloseHandle(mMapping);
+        mMapping = NULL;
+    }
 }
+#else
+void MMapInputStream::map(bool sequential)
+{
+    // mmap() rejects a zero length
+    if (mLength == 0)
+    {
+        return;
+    }
 
+    void* const data = ::mmap(NULL, mLength, PROT_READ, MAP_SHARED,
+                              mFile.getHandle(), 0);
+    if (data == MAP_FAILED)
+    {
+        throw except::IOException(Ctxt("Failed to map file: " +
+                                       sys::Err().toString()));
+    }
 
+    if (sequential)
+    {
+        ::madvise(data, mLength, MADV_SEQUENTIAL);
+    }
+    mData = static_cast<sys::byte*>(data);
+}
 
-long io::MMapInputStream::seek(long off)
+void MMapInputStream::unmap()
 {
-    long where = mMark;
-    mMark = off;
-    return mMark - where;
+    if (mData)
+    {
+        ::munmap(mData, mLength);
+        mData = NULL;
+    }
 }
+#endif
+
+sys::Off_T MMapInputStream::seek(sys::Off_T offset, Whence whence)
+{
+    sys::Off_T position;
+    switch (whence)
+    {
+    case START:
+        position = offset;
+        break;
+    case END:
+        // As in ByteStream, counting back from the end and stopping at
+        // the start
+        position = std::max<sys::Off_T>(
+                static_cast<sys::Off_T>(mLength) - offset, 0);
+        break;
+    default:
+        position = static_cast<sys::Off_T>(mMark) + offset;
+        break;
+    }
+
+    if (position < 0 || position > static_cast<sys::Off_T>(mLength))
+    {
+        std::ostringstream ostr;
+        ostr << "Invalid seek to " << position << " in a file of "
+             << mLength << " bytes";
+        throw except::IOException(Ctxt(ostr.str()));
+    }
 
+    mMark = static_cast<size_t>(position);
+    return tell();
+}
 
-sys::SSize_T io::MMapInputStream::readImpl(void* buffer, size_t len)
+sys::SSize_T MMapInputStream::readImpl(void* buffer, size_t len)
 {
-    int size = available();
-    //    std::cout << "Available: " << size << std::endl;
-    //     std::cout << "Len: " << len << std::endl;
+    const size_t size = std::min(len, mLength - mMark);
+    if (size == 0)
+    {
+        return len == 0 ? 0 : io::InputStream::IS_EOF;
+    }
 
-    if (len < size)
-        size = len;
-    memcpy(buffer, &mData[mMark], size);
+    ::memcpy(buffer, mData + mMark, size);
     mMark += size;
-    //    std::cout << "Used: " << size << std::endl;
-    return size;
+    return static_cast<sys::SSize_T>(size);
+}
 }
-
@@ -19,13 +19,42 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <algorithm>
+
+#if defined(__linux) || defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#endif
+
 #include "io/PipeStream.h"
 
 using namespace io;
 
+void io::PipeStream::growPipe(size_t pipeSize)
+{
+#if defined(__linux) || defined(__linux__)
+    const int fd = fileno(mExecPipe.getPipe());
+#ifdef F_SETPIPE_SZ
+    if (pipeSize > 0)
+    {
+        // This fails for sizes beyond /proc/sys/fs/pipe-max-size unless
+        // privileged; the pipe just keeps its current size
+        fcntl(fd, F_SETPIPE_SZ, static_cast<int>(pipeSize));
+    }
+#endif
+#ifdef F_GETPIPE_SZ
+    const int size = fcntl(fd, F_GETPIPE_SZ);
+    mPipeSize = (size > 0) ? static_cast<size_t>(size) : 0;
+#endif
+#else
+    (void)pipeSize;
+#endif
+}
+
 sys::SSize_T io::PipeStream::readImpl(void* buffer, size_t numBytes)
 {
     FILE* pipe = mExecPipe.getPipe();
+    mUsedStdio = true;
 
     char* cStr = static_cast<char*>(buffer);
 
@@ -55,6 +84,7 @@ sys::SSize_T io::PipeStream::readln(sys::byte *cStr,
                                     const sys::Size_T strLenPlusNullByte)
 {
     FILE* pipe = mExecPipe.getPipe();
+    mUsedStdio = true;
 
     while (!feof(pipe))
     {
@@ -111,3 +141,80 @@ sys::SSize_T io::PipeStream::streamTo(OutputStream& soi,
 
     return totalBytesRead;
 }
+
+sys::SSize_T io::PipeStream::spliceTo(sys::File& file, sys::SSize_T numBytes)
+{
+    sys::SSize_T totalBytesMoved = 0;
+
+#if defined(__linux) || defined(__linux__)
+    if (!mUsedStdio)
+    {
+        const int in = fileno(mExecPipe.getPipe());
+        const int out = file.getHandle();
+        const size_t maxChunk = std::max<size_t>(mPipeSize, mBufferSize);
+
+        while (numBytes == IS_END || totalBytesMoved < numBytes)
+        {
+            const size_t chunk = (numBytes == IS_END) ? maxChunk :
+                    std::min<size_t>(numBytes - totalBytesMoved, maxChunk);
+            const ssize_t bytesMoved = ::splice(in, NULL, out, NULL, chunk,
+                                                SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (bytesMoved > 0)
+            {
+                totalBytesMoved += bytesMoved;
+            }
+            else if (bytesMoved == 0)
+            {
+                // the child closed its end
+                return (totalBytesMoved == 0) ?
+                        static_cast<sys::SSize_T>(IS_EOF) : totalBytesMoved;
+            }
+            else if (errno == EINVAL)
+            {
+                // the file doesn't support splicing (e.g. O_APPEND)
+                break;
+            }
+            else if (errno != EINTR)
+            {
+                throw except::IOException(Ctxt(
+                        "Error splicing from command pipe: " +
+                        sys::Err().toString()));
+            }
+        }
+
+        if (numBytes != IS_END && totalBytesMoved == numBytes)
+        {
+            return totalBytesMoved;
+        }
+    }
+#endif
+
+    const sys::SSize_T bytesCopied = copyTo(
+            file, (numBytes == IS_END) ? static_cast<sys::SSize_T>(IS_END) :
+                                         numBytes - totalBytesMoved);
+    if (bytesCopied > 0)
+    {
+        totalBytesMoved += bytesCopied;
+    }
+    return (totalBytesMoved == 0) ? static_cast<sys::SSize_T>(IS_EOF) :
+                                    totalBytesMoved;
+}
+
+sys::SSize_T io::PipeStream::copyTo(sys::File& file, sys::SSize_T numBytes)
+{
+    sys::SSize_T totalBytesRead = 0;
+    while ((numBytes == IS_END || totalBytesRead < numBytes) &&
+           !feof(mExecPipe.getPipe()))
+    {
+        const size_t chunk = (numBytes == IS_END) ? mBufferSize :
+                std::min<size_t>(numBytes - totalBytesRead, mBufferSize);
+        const sys::SSize_T bytesRead = read(mCharString.get(), chunk);
+        if (bytesRead > 0)
+        {
+            file.writeFrom(mCharString.get(), bytesRead);
+            totalBytesRead += bytesRead;
+        }
+    }
+    return (totalBytesRead == 0) ? static_cast<sys::SSize_T>(IS_EOF) :
+                                   totalBytesRead;
+}
@@ -20,33 +20,191 @@
  *
  */
 
+#include <algorithm>
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <except/Exception.h>
+#include <sys/Err.h>
+#include <sys/OS.h>
+#include <mt/BalancedRunnable1D.h>
 #include <io/FileInputStream.h>
+#include <io/ReadUtils.h>
 
-namespace io
+namespace
 {
-void readFileContents(const std::string& pathname,
-                      std::vector<sys::byte>& buffer)
+#if defined(WIN32) || defined(_WIN32)
+template <typename BufferT>
+void readInto(const std::string& pathname, BufferT& buffer)
 {
     io::FileInputStream inStream(pathname);
-    buffer.resize(inStream.available());
+    buffer.resize(static_cast<size_t>(inStream.available()));
     if (!buffer.empty())
     {
         inStream.read(&buffer[0], buffer.size(), true);
     }
 }
+#else
+class ScopedFd
+{
+public:
+    explicit ScopedFd(int fd) :
+        mFd(fd)
+    {
+    }
 
-void readFileContents(const std::string& pathname, std::string& str)
+    ~ScopedFd()
+    {
+        ::close(mFd);
+    }
+
+    int get() const
+    {
+        return mFd;
+    }
+
+private:
+    ScopedFd(const ScopedFd&);
+    ScopedFd& operator=(const ScopedFd&);
+
+    const int mFd;
+};
+
+void throwError(const std::string& pathname, const std::string& what)
+{
+    throw except::IOException(Ctxt("Failed to " + what + " " + pathname +
+                                   ": " + sys::Err().toString()));
+}
+
+// Reads until EOF or 'len' bytes, whichever comes first
+size_t readFully(int fd, const std::string& pathname, char* buffer,
+                 size_t len)
+{
+    size_t total = 0;
+    while (total < len)
+    {
+        const ssize_t numBytes = ::read(fd, buffer + total, len - total);
+        if (numBytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throwError(pathname, "read");
+        }
+        if (numBytes == 0)
+        {
+            break;
+        }
+        total += static_cast<size_t>(numBytes);
+    }
+    return total;
+}
+
+template <typename BufferT>
+void readInto(const std::string& pathname, BufferT& buffer)
+{
+    int flags = O_RDONLY;
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+    const int fd = ::open(pathname.c_str(), flags);
+    if (fd < 0)
+    {
+        throwError(pathname, "open");
+    }
+    const ScopedFd scopedFd(fd);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        throwError(pathname, "stat");
+    }
+
+    const size_t size = static_cast<size_t>(info.st_size);
+    if (S_ISREG(info.st_mode) && size > 0)
+    {
+        buffer.resize(size);
+        // The file may have shrunk since we sized it
+        buffer.resize(readFully(
+                fd, pathname, reinterpret_cast<char*>(&buffer[0]), size));
+        return;
+    }
+
+    // Pipes and special files (e.g. in /proc) don't report a size, so read
+    // until EOF
+    buffer.clear();
+    size_t total = 0;
+    size_t chunk = 4096;
+    while (true)
+    {
+        buffer.resize(total + chunk);
+        const size_t numBytes = readFully(
+                fd, pathname, reinterpret_cast<char*>(&buffer[total]), chunk);
+        total += numBytes;
+        if (numBytes < chunk)
+        {
+            break;
+        }
+        chunk *= 2;
+    }
+    buffer.resize(total);
+}
+#endif
+
+struct ReadFileOp
 {
-    std::vector<sys::byte> buffer;
-    readFileContents(pathname, buffer);
+    ReadFileOp(const std::vector<std::string>& pathnames,
+               std::vector<std::string>& contents) :
+        mPathnames(pathnames),
+        mContents(contents)
+    {
+    }
 
-    if (buffer.empty())
+    void operator()(size_t index) const
     {
-        str.clear();
+        readInto(mPathnames[index], mContents[index]);
     }
-    else
+
+private:
+    const std::vector<std::string>& mPathnames;
+    std::vector<std::string>& mContents;
+};
+}
+
+namespace io
+{
+void readFileContents(const std::string& pathname,
+                      std::vector<sys::byte>& buffer)
+{
+    readInto(pathname, buffer);
+}
+
+void readFileContents(const std::string& pathname, std::string& str)
+{
+    readInto(pathname, str);
+}
+
+void readFileContents(const std::vector<std::string>& pathnames,
+                      std::vector<std::string>& contents,
+                      size_t numThreads)
+{
+    contents.clear();
+    contents.resize(pathnames.size());
+
+    if (numThreads == 0)
     {
-        str.assign(reinterpret_cast<char*>(&buffer[0]), buffer.size());
+        numThreads = sys::OS().getNumCPUs();
     }
+    numThreads = std::max<size_t>(
+            std::min(numThreads, pathnames.size()), 1);
+
+    mt::runBalanced1D(pathnames.size(), numThreads,
+                      ReadFileOp(pathnames, contents));
 }
 }
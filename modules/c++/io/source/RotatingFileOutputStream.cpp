@@ -93,3 +93,17 @@ void io::RotatingFileOutputStream::write(const void* buffer, size_t len)
         doRollover();
     io::CountingOutputStream::write(buffer, len);
 }
+
+void io::RotatingFileOutputStream::write(
+        const std::vector<mem::BufferView<const sys::byte> >& buffers)
+{
+    sys::Size_T len = 0;
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        len += buffers[ii].size;
+    }
+
+    if (shouldRollover(len))
+        doRollover();
+    io::CountingOutputStream::write(buffers);
+}
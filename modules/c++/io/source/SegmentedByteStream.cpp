@@ -0,0 +1,163 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include "io/SegmentedByteStream.h"
+
+io::SegmentedByteStream::SegmentedByteStream(size_t segmentSize) :
+    mSegmentSize(segmentSize),
+    mSize(0),
+    mPosition(0)
+{
+    if (mSegmentSize == 0)
+    {
+        throw except::InvalidArgumentException(
+                Ctxt("Segment size must be > 0"));
+    }
+}
+
+sys::Off_T io::SegmentedByteStream::seek(sys::Off_T offset, Whence whence)
+{
+    if (mPosition < 0)
+        throw except::Exception(Ctxt("Invalid seek on eof"));
+
+    switch (whence)
+    {
+    case START:
+        mPosition = offset;
+        break;
+    case END:
+        if (offset > static_cast<sys::Off_T>(mSize))
+        {
+            mPosition = 0;
+        }
+        else
+        {
+            mPosition = mSize - offset;
+        }
+        break;
+    default:
+        mPosition += offset;
+        break;
+    }
+
+    if (mPosition > static_cast<sys::Off_T>(mSize))
+        mPosition = -1;
+    return tell();
+}
+
+sys::Off_T io::SegmentedByteStream::available()
+{
+    if (mPosition < 0)
+        throw except::Exception(Ctxt("Invalid available bytes on eof"));
+
+    const sys::Off_T diff = static_cast<sys::Off_T>(mSize) - mPosition;
+    return (diff < 0) ? 0 : diff;
+}
+
+void io::SegmentedByteStream::write(const void* buffer, size_t size)
+{
+    if (mPosition < 0)
+        throw except::Exception(Ctxt("Invalid write on eof"));
+
+    const sys::Size_T newPos = mPosition + size;
+    while (mSegments.size() * mSegmentSize < newPos)
+    {
+        mSegments.push_back(
+                std::unique_ptr<sys::byte[]>(new sys::byte[mSegmentSize]));
+    }
+
+    const sys::byte* bufferPtr = static_cast<const sys::byte*>(buffer);
+    sys::Size_T pos = mPosition;
+    while (size > 0)
+    {
+        const size_t segment = static_cast<size_t>(pos / mSegmentSize);
+        const size_t segmentOffset = static_cast<size_t>(pos % mSegmentSize);
+        const size_t numBytes = std::min(size, mSegmentSize - segmentOffset);
+        ::memcpy(mSegments[segment].get() + segmentOffset, bufferPtr, numBytes);
+        bufferPtr += numBytes;
+        pos += numBytes;
+        size -= numBytes;
+    }
+
+    mPosition = newPos;
+    mSize = std::max(mSize, newPos);
+}
+
+void io::SegmentedByteStream::clear()
+{
+    mPosition = 0;
+    mSize = 0;
+    mSegments.clear();
+}
+
+std::vector<mem::BufferView<const sys::byte> >
+io::SegmentedByteStream::slice(sys::Size_T offset, sys::Size_T length) const
+{
+    if (offset > mSize || length > mSize - offset)
+    {
+        throw except::Exception(Ctxt("Slice is past the end of the stream"));
+    }
+
+    std::vector<mem::BufferView<const sys::byte> > views;
+    while (length > 0)
+    {
+        const size_t segment = static_cast<size_t>(offset / mSegmentSize);
+        const size_t segmentOffset = static_cast<size_t>(offset % mSegmentSize);
+        const size_t numBytes = static_cast<size_t>(
+                std::min<sys::Size_T>(length, mSegmentSize - segmentOffset));
+        views.push_back(mem::BufferView<const sys::byte>(
+                mSegments[segment].get() + segmentOffset, numBytes));
+        offset += numBytes;
+        length -= numBytes;
+    }
+    return views;
+}
+
+sys::SSize_T io::SegmentedByteStream::readImpl(void* buffer, size_t len)
+{
+    if (mPosition < 0)
+        throw except::Exception(Ctxt("Invalid read on eof"));
+
+    const sys::Off_T maxSize = available();
+    if (maxSize <= 0) return io::InputStream::IS_END;
+
+    if (maxSize < static_cast<sys::Off_T>(len)) len = maxSize;
+
+    sys::byte* bufferPtr = static_cast<sys::byte*>(buffer);
+    size_t remaining = len;
+    while (remaining > 0)
+    {
+        const size_t segment = static_cast<size_t>(mPosition / mSegmentSize);
+        const size_t segmentOffset =
+                static_cast<size_t>(mPosition % mSegmentSize);
+        const size_t numBytes =
+                std::min(remaining, mSegmentSize - segmentOffset);
+        ::memcpy(bufferPtr, mSegments[segment].get() + segmentOffset, numBytes);
+        bufferPtr += numBytes;
+        mPosition += numBytes;
+        remaining -= numBytes;
+    }
+    return len;
+}
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <sstream>
+#include <string.h>
 
 #include <io/StreamSplitter.h>
 #include <except/Exception.h>
@@ -72,29 +73,109 @@ bool StreamSplitter::getNext(std::string& substring)
         mBufferValidBegin += mDelimiter.size();
     }
 
-    size_t substringSize = 0;
+    appendSubstring(substring, 0);
+    return true;
+}
+
+bool StreamSplitter::getNext(mem::BufferView<const sys::byte>& substring)
+{
+    if (isEnd())
+    {
+        return false;
+    }
+
+    if (mNumDelimitersProcessed > 0)
+    {
+        // discard the delimiter before the start of the next substring
+        mBufferValidBegin += mDelimiter.size();
+    }
+
+    // number of bytes past mBufferValidBegin already known not to start
+    // a delimiter, so they aren't searched again after a read
+    sys::SSize_T numSearched = 0;
+    while (true)
+    {
+        const sys::SSize_T delimiterPos =
+                findDelimiter(mBufferValidBegin + numSearched);
+        if (delimiterPos >= 0)
+        {
+            substring = mem::BufferView<const sys::byte>(
+                    mBuffer + mBufferValidBegin,
+                    delimiterPos - mBufferValidBegin);
+            mBufferValidBegin = delimiterPos;
+            mNumDelimitersProcessed++;
+            mNumSubstringsReturned++;
+            mNumBytesReturned += substring.size;
+            return true;
+        }
+
+        if (mStreamEmpty)
+        {
+            // the rest of the buffer is the last substring
+            substring = mem::BufferView<const sys::byte>(
+                    mBuffer + mBufferValidBegin,
+                    mBufferValidEnd - mBufferValidBegin);
+            mBufferValidBegin = mBufferValidEnd;
+            mNumSubstringsReturned++;
+            mNumBytesReturned += substring.size;
+            return true;
+        }
+
+        numSearched = std::max<sys::SSize_T>(
+                0,
+                mBufferValidEnd - mBufferValidBegin -
+                        static_cast<sys::SSize_T>(mDelimiter.size() - 1));
+
+        if (mBufferValidBegin == 0 && mBufferValidEnd == mBufferCapacity)
+        {
+            // the substring is longer than the buffer, so finish it in
+            // separate storage
+            size_t overflowSize = 0;
+            transferBufferSegmentToSubstring(mOverflow, overflowSize,
+                                             numSearched);
+            appendSubstring(mOverflow, overflowSize);
+            substring = mem::BufferView<const sys::byte>(mOverflow.data(),
+                                                         mOverflow.size());
+            return true;
+        }
+
+        // keep the partial substring contiguous and read more behind it
+        if (mBufferValidEnd == mBufferCapacity)
+        {
+            shiftBuffer();
+        }
+        const sys::SSize_T numRead =
+                mInputStream.read(mBuffer + mBufferValidEnd,
+                                  mBufferCapacity - mBufferValidEnd);
+        if (numRead > 0)
+        {
+            mBufferValidEnd += numRead;
+        }
+        else
+        {
+            mStreamEmpty = true;
+        }
+    }
+}
+
+void StreamSplitter::appendSubstring(std::string& substring,
+                                     size_t substringSize)
+{
     while (true)
     {
         handleStreamRead();
 
         // search for delimiter in buffer
-        for (sys::SSize_T ii = mBufferValidBegin;
-             ii < mBufferValidEnd - static_cast<sys::SSize_T>(mDelimiter.size() - 1);
-             ++ii)
+        const sys::SSize_T delimiterPos = findDelimiter(mBufferValidBegin);
+        if (delimiterPos >= 0)
         {
-            if (0 == mDelimiter.compare(0,
-                                        mDelimiter.size(),
-                                        mBuffer + ii,
-                                        mDelimiter.size()))
-            {
-                // delimiter found starting at buffer position ii
-                // append the buffer contents preceding that point to output
-                transferBufferSegmentToSubstring(substring, substringSize, ii);
-                mNumDelimitersProcessed++;
-                mNumSubstringsReturned++;
-                mNumBytesReturned += substringSize;
-                return true;
-            }
+            // append the buffer contents preceding the delimiter to output
+            transferBufferSegmentToSubstring(substring, substringSize,
+                                             delimiterPos);
+            mNumDelimitersProcessed++;
+            mNumSubstringsReturned++;
+            mNumBytesReturned += substringSize;
+            return;
         }
 
         // no delimiter found in buffer
@@ -110,13 +191,39 @@ bool StreamSplitter::getNext(std::string& substring)
         {
             mNumSubstringsReturned++;
             mNumBytesReturned += substringSize;
-            return true;
+            return;
         }
 
         // still have some bytes in stream and/or buffer
     }
 }
 
+sys::SSize_T StreamSplitter::findDelimiter(sys::SSize_T searchBegin) const
+{
+    // memchr() for the first delimiter byte is vectorized (and dispatched
+    // on the CPU at runtime) by the C library, so this runs far faster than
+    // comparing the delimiter at every position
+    const size_t delimiterSize = mDelimiter.size();
+    const sys::byte* pos = mBuffer + searchBegin;
+    const sys::byte* const end = mBuffer + mBufferValidEnd;
+    while (pos < end && static_cast<size_t>(end - pos) >= delimiterSize)
+    {
+        pos = static_cast<const sys::byte*>(
+                ::memchr(pos, mDelimiter[0], (end - pos) - (delimiterSize - 1)));
+        if (pos == NULL)
+        {
+            return -1;
+        }
+        if (delimiterSize == 1 ||
+            ::memcmp(pos + 1, mDelimiter.data() + 1, delimiterSize - 1) == 0)
+        {
+            return pos - mBuffer;
+        }
+        ++pos;
+    }
+    return -1;
+}
+
 bool StreamSplitter::isEnd() const
 {
     return mStreamEmpty && mBufferValidBegin >= mBufferValidEnd;
@@ -145,11 +252,8 @@ void StreamSplitter::transferBufferSegmentToSubstring(
     const sys::SSize_T segmentSize = bufferSegmentEnd - mBufferValidBegin;
     if (segmentSize >= 0)
     {
-        substring.resize(substringSize + segmentSize);
-        substring.replace(substringSize,
-                          segmentSize,
-                          mBuffer + mBufferValidBegin,
-                          segmentSize);
+        substring.resize(substringSize);
+        substring.append(mBuffer + mBufferValidBegin, segmentSize);
         substringSize += segmentSize;
         mBufferValidBegin += segmentSize;
     }
@@ -161,11 +265,7 @@ void StreamSplitter::handleStreamRead()
     {
         // first half of buffer is no longer needed, shift the rest
         // down to make space for reading in more
-        std::copy(mBuffer + mBufferValidBegin,
-                  mBuffer + mBufferValidEnd,
-                  mBuffer);
-        mBufferValidEnd = mBufferValidEnd - mBufferValidBegin;
-        mBufferValidBegin = 0;
+        shiftBuffer();
     }
 
     // read more from stream if buffer has space
@@ -184,4 +284,13 @@ void StreamSplitter::handleStreamRead()
         }
     }
 }
+
+void StreamSplitter::shiftBuffer()
+{
+    std::copy(mBuffer + mBufferValidBegin,
+              mBuffer + mBufferValidEnd,
+              mBuffer);
+    mBufferValidEnd = mBufferValidEnd - mBufferValidBegin;
+    mBufferValidBegin = 0;
+}
 }
@@ -20,26 +20,203 @@
  *
  */
 
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#if defined(__linux) || defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif
+
 #include <io/TempFile.h>
 
 io::TempFile::TempFile(const std::string& dirname) :
     mOS(sys::OS()),
-    mPathname(mOS.getTempName(dirname))
+    mDirname(dirname),
+    mSpillSize(0),
+    mPathname(mOS.getTempName(dirname)),
+    mInMemory(false),
+    mMemFd(-1)
 {
 }
 
+io::TempFile::TempFile(const std::string& dirname, Storage storage,
+                       size_t spillSize) :
+    mOS(sys::OS()),
+    mDirname(dirname),
+    mSpillSize(spillSize),
+    mInMemory(false),
+    mMemFd(-1)
+{
+    if (storage == MEMORY)
+    {
+        createInMemory();
+    }
+    if (!mInMemory)
+    {
+        mPathname = mOS.getTempName(dirname);
+    }
+}
+
 io::TempFile::~TempFile()
 {
     try
     {
-        if (mOS.exists(mPathname))
+        removeFile();
+    }
+    catch (...)
+    {
+        // Do nothing
+    }
+}
+
+void io::TempFile::createInMemory()
+{
+#if defined(__linux) || defined(__linux__)
+#ifdef SYS_memfd_create
+    // An anonymous file that never touches a filesystem; it's reopened
+    // through /proc so callers still get a pathname
+    const int fd = static_cast<int>(
+            ::syscall(SYS_memfd_create, "io::TempFile", MFD_CLOEXEC));
+    if (fd >= 0)
+    {
+        std::ostringstream pathname;
+        pathname << "/proc/self/fd/" << fd;
+        if (mOS.exists(pathname.str()))
+        {
+            mMemFd = fd;
+            mPathname = pathname.str();
+            mInMemory = true;
+            return;
+        }
+        ::close(fd);
+    }
+#endif
+
+    // Kernels without memfd still have tmpfs
+    if (mOS.isDirectory("/dev/shm"))
+    {
+        try
+        {
+            mPathname = mOS.getTempName("/dev/shm");
+            mInMemory = true;
+        }
+        catch (const except::Exception&)
         {
-            mOS.remove(mPathname);
         }
     }
+#endif
+}
+
+void io::TempFile::openForWrite()
+{
+    if (!mFile.get())
+    {
+        mFile.reset(new sys::File(mPathname, sys::File::READ_AND_WRITE,
+                                  sys::File::EXISTING));
+    }
+}
+
+void io::TempFile::write(const void* buffer, size_t len)
+{
+    openForWrite();
+    mFile->seekTo(0, sys::File::FROM_END);
+    mFile->writeFrom(buffer, len);
+
+    if (mInMemory && mSpillSize > 0 &&
+        mFile->getCurrentOffset() > static_cast<sys::Off_T>(mSpillSize))
+    {
+        spill();
+    }
+}
+
+io::OutputStream& io::TempFile::getOutputStream()
+{
+    if (!mStream.get())
+    {
+        mStream.reset(new Stream(*this));
+    }
+    return *mStream;
+}
+
+void io::TempFile::checkSpill()
+{
+    if (mInMemory && mSpillSize > 0 &&
+        size() > static_cast<sys::Off_T>(mSpillSize))
+    {
+        spill();
+    }
+}
+
+void io::TempFile::spill()
+{
+    if (!mInMemory)
+    {
+        return;
+    }
+
+    const std::string diskPathname = mOS.getTempName(mDirname);
+    try
+    {
+        sys::File in(mPathname, sys::File::READ_ONLY, sys::File::EXISTING);
+        sys::File out(diskPathname, sys::File::WRITE_ONLY,
+                      sys::File::CREATE | sys::File::TRUNCATE);
+
+        sys::Off_T remaining = in.length();
+        std::vector<sys::byte> buffer(static_cast<size_t>(
+                std::min<sys::Off_T>(remaining, 4 * 1024 * 1024)));
+        while (remaining > 0)
+        {
+            const size_t numBytes = static_cast<size_t>(
+                    std::min<sys::Off_T>(remaining, buffer.size()));
+            in.readInto(&buffer[0], numBytes);
+            out.writeFrom(&buffer[0], numBytes);
+            remaining -= numBytes;
+        }
+        out.close();
+        in.close();
+    }
     catch (...)
     {
-        // Do nothing
+        mOS.remove(diskPathname);
+        throw;
+    }
+
+    removeFile();
+    mPathname = diskPathname;
+    mInMemory = false;
+}
+
+sys::Off_T io::TempFile::size()
+{
+    if (mFile.get())
+    {
+        return mFile->length();
     }
+    return mOS.getSize(mPathname);
 }
 
+void io::TempFile::removeFile()
+{
+    mFile.reset();
+
+#if defined(__linux) || defined(__linux__)
+    if (mMemFd >= 0)
+    {
+        // The memfd's memory is released once its last descriptor closes
+        ::close(mMemFd);
+        mMemFd = -1;
+        return;
+    }
+#endif
+
+    if (mOS.exists(mPathname))
+    {
+        mOS.remove(mPathname);
+    }
+}
@@ -0,0 +1,173 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/RotatingFileOutputStream.h>
+
+// Measures caller-side write() latency of RotatingFileOutputStream against
+// AsyncRotatingFileOutputStream.  Latencies are timed per call with
+// std::chrono::steady_clock, since sys::RealTimeStopWatch builds a
+// LocalDateTime on every start/stop.
+namespace
+{
+void cleanupFiles(const std::string& base, size_t backupCount)
+{
+    sys::OS os;
+    for (size_t ii = 1; ii <= backupCount; ++ii)
+    {
+        const std::string fname = base + "." + str::toString(ii);
+        if (os.isFile(fname))
+        {
+            os.remove(fname);
+        }
+    }
+    if (os.isFile(base))
+    {
+        os.remove(base);
+    }
+}
+
+// Returns the per-write latencies, in microseconds
+std::vector<double> timeWrites(io::OutputStream& out,
+                               size_t numRecords,
+                               const std::string& record)
+{
+    std::vector<double> latencies(numRecords);
+    for (size_t ii = 0; ii < numRecords; ++ii)
+    {
+        const std::chrono::steady_clock::time_point start =
+                std::chrono::steady_clock::now();
+        out.write(record.data(), record.size());
+        latencies[ii] = std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+    return latencies;
+}
+
+double percentile(std::vector<double>& values, double pct)
+{
+    const size_t index = std::min(values.size() - 1,
+            static_cast<size_t>(pct / 100.0 * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void printResult(const std::string& name, std::vector<double> latencies)
+{
+    std::cout << std::setw(24) << std::left << name << std::fixed
+              << std::setprecision(2)
+              << std::setw(12) << std::right << percentile(latencies, 50)
+              << std::setw(12) << std::right << percentile(latencies, 99)
+              << std::setw(12) << std::right << percentile(latencies, 99.9)
+              << std::setw(12) << std::right
+              << *std::max_element(latencies.begin(), latencies.end())
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " outputFile [numRecords] [recordSize] [maxBytes]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string outFile(argv[1]);
+        const size_t numRecords =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 200000;
+        const size_t recordSize =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 128;
+        const unsigned long maxBytes =
+                (argc > 4) ? str::toType<unsigned long>(argv[4]) : 1048576;
+        const size_t backupCount = 5;
+        const std::string record(recordSize, 'x');
+
+        std::cout << std::setw(24) << std::left << "Write latency (us)"
+                  << std::setw(12) << std::right << "p50"
+                  << std::setw(12) << std::right << "p99"
+                  << std::setw(12) << std::right << "p99.9"
+                  << std::setw(12) << std::right << "max" << std::endl;
+        std::cout << std::string(72, '-') << std::endl;
+
+        cleanupFiles(outFile, backupCount);
+        {
+            io::RotatingFileOutputStream out(outFile, maxBytes, backupCount);
+            printResult("sync", timeWrites(out, numRecords, record));
+        }
+
+        cleanupFiles(outFile, backupCount);
+        {
+            io::AsyncRotatingFileOutputStream out(outFile, maxBytes,
+                                                  backupCount);
+            printResult("async block", timeWrites(out, numRecords, record));
+        }
+
+        cleanupFiles(outFile, backupCount);
+        {
+            io::AsyncRotatingFileOutputStream out(
+                    outFile, maxBytes, backupCount,
+                    sys::File::CREATE | sys::File::TRUNCATE, 1048576,
+                    io::AsyncOutputStream::DROP);
+            printResult("async drop", timeWrites(out, numRecords, record));
+            std::cout << "  (" << out.getNumRecordsDropped()
+                      << " records dropped)" << std::endl;
+        }
+
+        cleanupFiles(outFile, backupCount);
+        {
+            io::AsyncRotatingFileOutputStream out(
+                    outFile, maxBytes, backupCount,
+                    sys::File::CREATE | sys::File::TRUNCATE, 1048576,
+                    io::AsyncOutputStream::BLOCK,
+                    io::AsyncOutputStream::SYNC_INTERVAL, 4 * 1048576);
+            printResult("async block+fsync", timeWrites(out, numRecords, record));
+        }
+        cleanupFiles(outFile, backupCount);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
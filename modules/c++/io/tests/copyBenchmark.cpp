@@ -0,0 +1,184 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/FileUtils.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+
+// Benchmarks io::copy() on many small files and on one huge file, against
+// streaming the same data through an io::InputStream::streamTo() buffer
+namespace
+{
+void writeFile(const std::string& pathname, size_t size)
+{
+    std::vector<sys::byte> block(1024 * 1024);
+    for (size_t ii = 0; ii < block.size(); ++ii)
+    {
+        block[ii] = static_cast<sys::byte>(ii % 251);
+    }
+
+    io::FileOutputStream out(pathname);
+    while (size > 0)
+    {
+        const size_t numBytes = std::min(size, block.size());
+        out.write(&block[0], numBytes);
+        size -= numBytes;
+    }
+    out.close();
+}
+
+void streamCopy(const std::string& src, const std::string& destDir)
+{
+    io::FileInputStream fis(src);
+    io::FileOutputStream fos(
+            sys::Path::joinPaths(destDir, sys::Path::basename(src)));
+    fis.streamTo(fos);
+    fis.close();
+    fos.close();
+}
+
+// Returns the elapsed time in ms
+double BM_StreamCopy(const std::vector<std::string>& files,
+                     const std::string& destDir)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t ii = 0; ii < files.size(); ++ii)
+    {
+        streamCopy(files[ii], destDir);
+    }
+    return sw.stop();
+}
+
+double BM_Copy(const std::vector<std::string>& files,
+               const std::string& destDir,
+               size_t numThreads)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t ii = 0; ii < files.size(); ++ii)
+    {
+        io::copy(files[ii], destDir, 1048576, numThreads);
+    }
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, double totalMB)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+
+void runBenchmarks(const std::string& label,
+                   const std::vector<std::string>& files,
+                   const std::string& destDir,
+                   double totalMB,
+                   size_t maxThreads)
+{
+    printResult(label + " streamTo", BM_StreamCopy(files, destDir), totalMB);
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        printResult(label + " copy (" + str::toString(numThreads) + " thr)",
+                    BM_Copy(files, destDir, numThreads), totalMB);
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [hugeFileMB] [numSmallFiles] [maxThreads]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t hugeFileMB =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1024;
+        const size_t numSmallFiles =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 1000;
+        const size_t maxThreads = (argc > 4) ?
+                str::toType<size_t>(argv[4]) : sys::OS().getNumCPUs();
+        const size_t smallFileSize = 16 * 1024;
+
+        sys::OS os;
+        const std::string srcDir = sys::Path::joinPaths(workDir, "copy_src");
+        const std::string destDir = sys::Path::joinPaths(workDir, "copy_dest");
+        os.makeDirectory(srcDir);
+        os.makeDirectory(destDir);
+
+        std::vector<std::string> smallFiles(numSmallFiles);
+        for (size_t ii = 0; ii < numSmallFiles; ++ii)
+        {
+            smallFiles[ii] = sys::Path::joinPaths(
+                    srcDir, "small_" + str::toString(ii) + ".bin");
+            writeFile(smallFiles[ii], smallFileSize);
+        }
+        std::vector<std::string> hugeFile(1,
+                sys::Path::joinPaths(srcDir, "huge.bin"));
+        writeFile(hugeFile[0], hugeFileMB * 1024 * 1024);
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(54, '-') << std::endl;
+
+        runBenchmarks("small", smallFiles, destDir,
+                      numSmallFiles * smallFileSize / (1024.0 * 1024.0),
+                      maxThreads);
+        runBenchmarks("huge", hugeFile, destDir,
+                      static_cast<double>(hugeFileMB), maxThreads);
+
+        os.remove(srcDir);
+        os.remove(destDir);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/FileOutputStream.h>
+#include <io/PipeStream.h>
+
+// Benchmarks reading bulk output from a child process through PipeStream
+// (small reads, large reads, and splicing straight into a file), and the
+// cost of launching a child from a process with a large resident set
+namespace
+{
+std::string makeCommand(size_t totalMB)
+{
+    return "head -c " + str::toString(totalMB * 1024 * 1024) + " /dev/zero";
+}
+
+// Returns the elapsed time in ms
+double BM_StreamTo(const std::string& cmd, const std::string& outPathname,
+                   size_t bufferSize, size_t pipeSize)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    io::PipeStream ps(cmd, bufferSize, pipeSize);
+    io::FileOutputStream out(outPathname);
+    ps.streamTo(out);
+    out.close();
+    ps.close();
+    return sw.stop();
+}
+
+double BM_SpliceTo(const std::string& cmd, const std::string& outPathname)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    io::PipeStream ps(cmd);
+    sys::File out(outPathname, sys::File::WRITE_ONLY,
+                  sys::File::CREATE | sys::File::TRUNCATE);
+    ps.spliceTo(out);
+    out.close();
+    ps.close();
+    return sw.stop();
+}
+
+double BM_Launch(size_t numLaunches, bool spawn)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t ii = 0; ii < numLaunches; ++ii)
+    {
+        io::PipeStream ps("true", 1, 0, spawn);
+        ps.close();
+    }
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, double totalMB)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [totalMB] [residentMB] [numLaunches]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t totalMB =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1024;
+        const size_t residentMB =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 2048;
+        const size_t numLaunches =
+                (argc > 4) ? str::toType<size_t>(argv[4]) : 100;
+        const std::string cmd = makeCommand(totalMB);
+        const std::string outPathname =
+                sys::Path::joinPaths(workDir, "pipe_out.bin");
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(54, '-') << std::endl;
+
+        printResult("streamTo (1 KiB reads)",
+                    BM_StreamTo(cmd, outPathname, 1024, 0), totalMB);
+        printResult("streamTo (64 KiB reads)",
+                    BM_StreamTo(cmd, outPathname,
+                                io::PipeStream::DEFAULT_STREAM_BUFFER_SIZE,
+                                io::PipeStream::DEFAULT_PIPE_SIZE),
+                    totalMB);
+        printResult("spliceTo", BM_SpliceTo(cmd, outPathname), totalMB);
+        sys::OS().remove(outPathname);
+
+        // Touch every page so the parent really is this big
+        std::vector<sys::byte> resident(residentMB * 1024 * 1024, 1);
+
+        std::cout << std::endl << std::setw(28) << std::left
+                  << ("Launch (" + str::toString(residentMB) + " MB RSS)")
+                  << " " << std::setw(12) << std::right << "Time (ms)"
+                  << " " << std::setw(12) << std::right << "Per launch"
+                  << std::endl;
+        std::cout << std::string(54, '-') << std::endl;
+
+        const double forkMS = BM_Launch(numLaunches, false);
+        std::cout << std::setw(28) << std::left << "fork + exec" << " "
+                  << std::setw(12) << std::right << forkMS << " "
+                  << std::setw(12) << std::right << forkMS / numLaunches
+                  << std::endl;
+        const double spawnMS = BM_Launch(numLaunches, true);
+        std::cout << std::setw(28) << std::left << "posix_spawn" << " "
+                  << std::setw(12) << std::right << spawnMS << " "
+                  << std::setw(12) << std::right << spawnMS / numLaunches
+                  << std::endl;
+        resident[resident.size() - 1] = 0;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include <io/ReadUtils.h>
+
+// Benchmarks io::readFileContents() on a directory of many small files (as
+// when loading XML metadata at startup), against reading each file through
+// a FileInputStream as readFileContents() used to
+namespace
+{
+void writeFile(const std::string& pathname, size_t size, size_t seed)
+{
+    std::vector<sys::byte> data(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<sys::byte>('a' + (ii + seed) % 26);
+    }
+
+    io::FileOutputStream out(pathname);
+    out.write(&data[0], data.size());
+    out.close();
+}
+
+void streamRead(const std::string& pathname, std::string& str)
+{
+    io::FileInputStream inStream(pathname);
+    std::vector<sys::byte> buffer(inStream.available());
+    if (!buffer.empty())
+    {
+        inStream.read(&buffer[0], buffer.size(), true);
+    }
+    str.assign(buffer.begin(), buffer.end());
+}
+
+// Returns the elapsed time in ms
+double BM_StreamRead(const std::vector<std::string>& files)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    std::string str;
+    for (size_t ii = 0; ii < files.size(); ++ii)
+    {
+        streamRead(files[ii], str);
+    }
+    return sw.stop();
+}
+
+double BM_ReadFileContents(const std::vector<std::string>& files)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    std::string str;
+    for (size_t ii = 0; ii < files.size(); ++ii)
+    {
+        io::readFileContents(files[ii], str);
+    }
+    return sw.stop();
+}
+
+double BM_ReadFileContentsBatch(const std::vector<std::string>& files,
+                                size_t numThreads)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    std::vector<std::string> contents;
+    io::readFileContents(files, contents, numThreads);
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, size_t numFiles)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(0) << numFiles / (elapsedMS / 1000.0)
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [numFiles] [fileSize] [maxThreads]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t numFiles =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 5000;
+        const size_t fileSize =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 4096;
+        const size_t maxThreads = (argc > 4) ?
+                str::toType<size_t>(argv[4]) : sys::OS().getNumCPUs();
+
+        sys::OS os;
+        const std::string srcDir = sys::Path::joinPaths(workDir, "read_src");
+        os.makeDirectory(srcDir);
+
+        std::vector<std::string> files(numFiles);
+        for (size_t ii = 0; ii < numFiles; ++ii)
+        {
+            files[ii] = sys::Path::joinPaths(
+                    srcDir, "meta_" + str::toString(ii) + ".xml");
+            writeFile(files[ii], fileSize, ii);
+        }
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "Files/s" << std::endl;
+        std::cout << std::string(54, '-') << std::endl;
+
+        printResult("FileInputStream", BM_StreamRead(files), numFiles);
+        printResult("readFileContents", BM_ReadFileContents(files), numFiles);
+        for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+        {
+            printResult("batch (" + str::toString(numThreads) + " thr)",
+                        BM_ReadFileContentsBatch(files, numThreads),
+                        numFiles);
+        }
+
+        os.remove(srcDir);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/ByteStream.h>
+#include <io/SegmentedByteStream.h>
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+// Appends totalMB of recordSize-byte records to a ByteStream and to a
+// SegmentedByteStream, reporting throughput and peak resident memory.
+// Each run happens in its own child process so the peak memory of one
+// doesn't hide the other's.
+namespace
+{
+template <typename StreamT>
+double BM_Append(StreamT& stream, size_t totalBytes, size_t recordSize)
+{
+    const std::vector<sys::byte> record(recordSize, 'x');
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t written = 0; written < totalBytes; written += recordSize)
+    {
+        stream.write(&record[0], recordSize);
+    }
+    return sw.stop();
+}
+
+double peakMemoryMB()
+{
+#if defined(WIN32) || defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+void printResult(const std::string& name, double elapsedMS, size_t totalMB)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0) << " "
+              << std::setw(14) << std::right << std::fixed
+              << std::setprecision(1) << peakMemoryMB() << std::endl;
+}
+
+void runBenchmark(bool segmented, size_t totalMB, size_t recordSize)
+{
+    const size_t totalBytes = totalMB * 1024 * 1024;
+    const std::string label = str::toString(recordSize) + "B records ";
+    if (segmented)
+    {
+        io::SegmentedByteStream stream;
+        printResult(label + "segmented",
+                    BM_Append(stream, totalBytes, recordSize), totalMB);
+    }
+    else
+    {
+        io::ByteStream stream;
+        printResult(label + "ByteStream",
+                    BM_Append(stream, totalBytes, recordSize), totalMB);
+    }
+}
+
+void runInChild(bool segmented, size_t totalMB, size_t recordSize)
+{
+#if defined(WIN32) || defined(_WIN32)
+    runBenchmark(segmented, totalMB, recordSize);
+#else
+    std::cout.flush();
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        runBenchmark(segmented, totalMB, recordSize);
+        std::cout.flush();
+        ::_exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+#endif
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t totalMB = (argc > 1) ? str::toType<size_t>(argv[1]) : 512;
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << " "
+                  << std::setw(14) << std::right << "Peak RSS (MB)"
+                  << std::endl;
+        std::cout << std::string(69, '-') << std::endl;
+
+        const size_t recordSizes[] = { 64, 65536 };
+        for (size_t ii = 0; ii < 2; ++ii)
+        {
+            runInChild(false, totalMB, recordSizes[ii]);
+            runInChild(true, totalMB, recordSizes[ii]);
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
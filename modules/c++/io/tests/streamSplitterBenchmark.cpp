@@ -0,0 +1,142 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/ByteStream.h>
+#include <io/StreamSplitter.h>
+
+// Measures StreamSplitter throughput, copying each record into a
+// std::string versus taking a view into the splitter's buffer
+namespace
+{
+void fillStream(io::ByteStream& stream, size_t totalBytes, size_t recordSize)
+{
+    std::string record(recordSize, 'x');
+    for (size_t ii = 0; ii < recordSize; ++ii)
+    {
+        record[ii] = static_cast<char>('a' + ii % 26);
+    }
+    record += '\n';
+
+    for (size_t written = 0; written < totalBytes; written += record.size())
+    {
+        stream.write(record.data(), record.size());
+    }
+}
+
+// Returns the elapsed time in ms
+double BM_SplitString(io::ByteStream& stream, size_t& numRecords)
+{
+    stream.seek(0, io::Seekable::START);
+    sys::RealTimeStopWatch sw;
+    sw.start();
+
+    io::StreamSplitter splitter(stream);
+    std::string substring;
+    while (splitter.getNext(substring))
+    {
+    }
+
+    const double elapsedMS = sw.stop();
+    numRecords = splitter.getNumSubstringsReturned();
+    return elapsedMS;
+}
+
+double BM_SplitView(io::ByteStream& stream, size_t& numRecords)
+{
+    stream.seek(0, io::Seekable::START);
+    sys::RealTimeStopWatch sw;
+    sw.start();
+
+    io::StreamSplitter splitter(stream);
+    mem::BufferView<const sys::byte> substring;
+    while (splitter.getNext(substring))
+    {
+    }
+
+    const double elapsedMS = sw.stop();
+    numRecords = splitter.getNumSubstringsReturned();
+    return elapsedMS;
+}
+
+void printResult(const std::string& name, double elapsedMS,
+                 size_t numRecords, double totalMB)
+{
+    std::cout << std::setw(24) << std::left << name << " "
+              << std::setw(12) << std::right << numRecords << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t totalMB = (argc > 1) ? str::toType<size_t>(argv[1]) : 256;
+        const size_t totalBytes = totalMB * 1024 * 1024;
+
+        std::cout << std::setw(24) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Records" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(63, '-') << std::endl;
+
+        const size_t recordSizes[] = { 16, 4096 };
+        for (size_t ii = 0; ii < 2; ++ii)
+        {
+            io::ByteStream stream;
+            fillStream(stream, totalBytes, recordSizes[ii]);
+            const std::string label = str::toString(recordSizes[ii]) + "B ";
+
+            size_t numRecords = 0;
+            double elapsedMS = BM_SplitString(stream, numRecords);
+            printResult(label + "string", elapsedMS, numRecords, totalMB);
+
+            elapsedMS = BM_SplitView(stream, numRecords);
+            printResult(label + "view", elapsedMS, numRecords, totalMB);
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
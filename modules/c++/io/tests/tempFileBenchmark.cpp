@@ -0,0 +1,127 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/ReadUtils.h>
+#include <io/TempFile.h>
+
+// Benchmarks an intermediate-product workflow: write a temporary file in
+// chunks, then read it all back, with the file on disk and in memory
+namespace
+{
+// Returns the elapsed time in ms
+double BM_WriteReread(const std::string& workDir,
+                      io::TempFile::Storage storage,
+                      size_t totalMB,
+                      size_t numFiles,
+                      bool& inMemory)
+{
+    std::vector<sys::byte> chunk(1024 * 1024);
+    for (size_t ii = 0; ii < chunk.size(); ++ii)
+    {
+        chunk[ii] = static_cast<sys::byte>(ii % 251);
+    }
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    std::vector<sys::byte> contents;
+    for (size_t ii = 0; ii < numFiles; ++ii)
+    {
+        io::TempFile tempFile(workDir, storage);
+        for (size_t jj = 0; jj < totalMB; ++jj)
+        {
+            tempFile.write(&chunk[0], chunk.size());
+        }
+        io::readFileContents(tempFile.pathname(), contents);
+        if (contents.size() != totalMB * chunk.size())
+        {
+            throw except::Exception(Ctxt("Reread the wrong number of bytes"));
+        }
+        inMemory = tempFile.isInMemory();
+    }
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, double totalMB)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [fileMB] [numFiles]" << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t fileMB = (argc > 2) ? str::toType<size_t>(argv[2]) : 64;
+        const size_t numFiles =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 16;
+        const double totalMB = static_cast<double>(fileMB * numFiles);
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(54, '-') << std::endl;
+
+        bool inMemory = false;
+        printResult("disk",
+                    BM_WriteReread(workDir, io::TempFile::DISK,
+                                   fileMB, numFiles, inMemory),
+                    totalMB);
+        const double memoryMS = BM_WriteReread(
+                workDir, io::TempFile::MEMORY, fileMB, numFiles, inMemory);
+        printResult(inMemory ? "memory" : "memory (fell back to disk)",
+                    memoryMS, totalMB);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include <io/FileUtils.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include "TestCase.h"
+
+namespace
+{
+struct CopyFixture
+{
+    CopyFixture(size_t size, const std::string& name) :
+        srcDir("test_copy_src_" + name),
+        destDir("test_copy_dest_" + name),
+        srcFile(sys::Path::joinPaths(srcDir, "source.bin")),
+        destFile(sys::Path::joinPaths(destDir, "source.bin")),
+        contents(size)
+    {
+        cleanup();
+        os.makeDirectory(srcDir);
+        os.makeDirectory(destDir);
+
+        for (size_t ii = 0; ii < contents.size(); ++ii)
+        {
+            contents[ii] = static_cast<sys::byte>((ii * 7) % 253);
+        }
+        io::FileOutputStream out(srcFile);
+        if (!contents.empty())
+        {
+            out.write(&contents[0], contents.size());
+        }
+        out.close();
+    }
+
+    ~CopyFixture()
+    {
+        cleanup();
+    }
+
+    void cleanup() const
+    {
+        if (os.exists(srcDir))
+        {
+            os.remove(srcDir);
+        }
+        if (os.exists(destDir))
+        {
+            os.remove(destDir);
+        }
+    }
+
+    bool matches() const
+    {
+        io::FileInputStream in(destFile);
+        if (in.available() != static_cast<sys::Off_T>(contents.size()))
+        {
+            return false;
+        }
+        std::vector<sys::byte> copied(contents.size());
+        if (!copied.empty())
+        {
+            in.read(&copied[0], copied.size(), true);
+        }
+        return copied == contents;
+    }
+
+    const sys::OS os;
+    const std::string srcDir;
+    const std::string destDir;
+    const std::string srcFile;
+    const std::string destFile;
+    std::vector<sys::byte> contents;
+};
+
+TEST_CASE(testCopyEmptyFile)
+{
+    CopyFixture fixture(0, "empty");
+    io::copy(fixture.srcFile, fixture.destDir);
+    TEST_ASSERT(fixture.matches());
+}
+
+TEST_CASE(testCopyFile)
+{
+    CopyFixture fixture(3 * 1024 * 1024 + 17, "serial");
+    io::copy(fixture.srcFile, fixture.destDir);
+    TEST_ASSERT(fixture.matches());
+}
+
+TEST_CASE(testCopyFileSmallBlocks)
+{
+    // Several blocks, with a partial one at the end
+    CopyFixture fixture(100000, "blocks");
+    io::copy(fixture.srcFile, fixture.destDir, 4096);
+    TEST_ASSERT(fixture.matches());
+}
+
+TEST_CASE(testParallelCopy)
+{
+    CopyFixture fixture(5 * 1024 * 1024 + 3, "parallel");
+    io::copy(fixture.srcFile, fixture.destDir, 65536, 4);
+    TEST_ASSERT(fixture.matches());
+
+    // More threads than blocks
+    CopyFixture small(70000, "small");
+    io::copy(small.srcFile, small.destDir, 65536, 8);
+    TEST_ASSERT(small.matches());
+}
+
+TEST_CASE(testCopyUnsizedFile)
+{
+    // procfs files report a length of 0 but aren't empty
+    const sys::OS os;
+    const std::string srcFile("/proc/self/status");
+    if (!os.exists(srcFile))
+    {
+        return;
+    }
+
+    const std::string destDir("test_copy_dest_unsized");
+    if (os.exists(destDir))
+    {
+        os.remove(destDir);
+    }
+    os.makeDirectory(destDir);
+    io::copy(srcFile, destDir);
+
+    io::FileInputStream in(sys::Path::joinPaths(destDir, "status"));
+    const sys::Off_T size = in.available();
+    std::vector<sys::byte> copied(5);
+    if (size >= 5)
+    {
+        in.read(&copied[0], copied.size(), true);
+    }
+    in.close();
+    os.remove(destDir);
+
+    TEST_ASSERT_GREATER(size, 0);
+    TEST_ASSERT_EQ(std::string(copied.begin(), copied.end()), "Name:");
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testCopyEmptyFile);
+    TEST_CHECK(testCopyFile);
+    TEST_CHECK(testCopyFileSmallBlocks);
+    TEST_CHECK(testParallelCopy);
+    TEST_CHECK(testCopyUnsizedFile);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <io/ByteStream.h>
+#include <io/MMapInputStream.h>
+#include <io/TempFile.h>
+#include "TestCase.h"
+
+namespace
+{
+std::string makeContents(size_t size)
+{
+    std::string contents(size, '\0');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        contents[ii] = static_cast<char>((ii * 31 + 3) % 251);
+    }
+    return contents;
+}
+
+void writeFile(const std::string& pathname, const std::string& contents)
+{
+    std::ofstream out(pathname.c_str(), std::ios::binary);
+    out.write(contents.data(), contents.size());
+}
+
+TEST_CASE(testMMapInputStream)
+{
+    const io::TempFile tempFile;
+    const std::string expected = makeContents(10000);
+    writeFile(tempFile.pathname(), expected);
+
+    io::MMapInputStream stream(tempFile.pathname());
+    TEST_ASSERT_EQ(stream.getSize(), expected.size());
+    TEST_ASSERT_EQ(stream.available(), 10000);
+    TEST_ASSERT_EQ(std::string(reinterpret_cast<const char*>(stream.get()),
+                               stream.getSize()), expected);
+
+    std::vector<sys::byte> buffer(100);
+    stream.seek(9950, io::Seekable::START);
+    TEST_ASSERT_EQ(stream.read(&buffer[0], buffer.size()), 50);
+    TEST_ASSERT_EQ(std::string(buffer.begin(), buffer.begin() + 50),
+                   expected.substr(9950));
+    TEST_ASSERT_EQ(stream.read(&buffer[0], buffer.size()),
+                   io::InputStream::IS_EOF);
+
+    TEST_EXCEPTION(stream.seek(10001, io::Seekable::START));
+    stream.seek(0, io::Seekable::START);
+    TEST_EXCEPTION(stream.seek(-1, io::Seekable::CURRENT));
+    stream.close();
+    TEST_ASSERT(stream.get() == NULL);
+}
+
+TEST_CASE(testSequentialMapping)
+{
+    // The access hint changes nothing about what is read
+    const io::TempFile tempFile;
+    const std::string expected = makeContents(10000);
+    writeFile(tempFile.pathname(), expected);
+
+    io::MMapInputStream stream(tempFile.pathname(), true);
+    std::vector<sys::byte> buffer(expected.size());
+    TEST_ASSERT_EQ(stream.read(&buffer[0], buffer.size()), 10000);
+    TEST_ASSERT_EQ(std::string(buffer.begin(), buffer.end()), expected);
+
+    stream.open(tempFile.pathname());
+    TEST_ASSERT_EQ(std::string(reinterpret_cast<const char*>(stream.get()),
+                               stream.getSize()), expected);
+}
+
+TEST_CASE(testSeekFromEnd)
+{
+    const io::TempFile tempFile;
+    const std::string contents = makeContents(1000);
+    writeFile(tempFile.pathname(), contents);
+
+    io::MMapInputStream stream(tempFile.pathname());
+    io::ByteStream byteStream;
+    byteStream.write(contents.data(), contents.size());
+
+    // Both count back from the end, and stop at the start
+    const sys::Off_T offsets[] = { 0, 1, 10, 999, 1000, 1001, 5000 };
+    for (size_t ii = 0; ii < sizeof(offsets) / sizeof(offsets[0]); ++ii)
+    {
+        TEST_ASSERT_EQ(stream.seek(offsets[ii], io::Seekable::END),
+                       byteStream.seek(offsets[ii], io::Seekable::END));
+        TEST_ASSERT_EQ(stream.tell(), byteStream.tell());
+    }
+
+    std::vector<sys::byte> buffer(10);
+    stream.seek(10, io::Seekable::END);
+    TEST_ASSERT_EQ(stream.read(&buffer[0], buffer.size()), 10);
+    TEST_ASSERT_EQ(std::string(buffer.begin(), buffer.end()),
+                   contents.substr(990));
+
+    // Past the end is still an error
+    TEST_EXCEPTION(stream.seek(-1, io::Seekable::END));
+    stream.close();
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testMMapInputStream);
+    TEST_CHECK(testSequentialMapping);
+    TEST_CHECK(testSeekFromEnd);
+    return 0;
+}
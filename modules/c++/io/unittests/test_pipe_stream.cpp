@@ -0,0 +1,102 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+
+#include <io/PipeStream.h>
+#include <io/ReadUtils.h>
+#include <io/TempFile.h>
+#include <io/StringStream.h>
+#include "TestCase.h"
+
+namespace
+{
+// The commands below need a POSIX shell
+#if !(defined(WIN32) || defined(_WIN32))
+TEST_CASE(testPipeStreamTo)
+{
+    io::PipeStream ps("printf 'line one\\nline two\\n'");
+    io::StringStream out;
+    TEST_ASSERT_EQ(ps.streamTo(out), 18);
+    TEST_ASSERT_EQ(out.stream().str(), "line one\nline two\n");
+    TEST_ASSERT_EQ(ps.close(), 0);
+}
+
+TEST_CASE(testPipeSpawn)
+{
+    // stdout and stderr both come back, as they do from a forked child
+    io::PipeStream ps("printf 'out\\n'; printf 'err\\n' >&2; exit 3",
+                      io::PipeStream::DEFAULT_STREAM_BUFFER_SIZE,
+                      io::PipeStream::DEFAULT_PIPE_SIZE, true);
+    io::StringStream out;
+    TEST_ASSERT_EQ(ps.streamTo(out), 8);
+    TEST_ASSERT_EQ(out.stream().str(), "out\nerr\n");
+    TEST_ASSERT_EQ(ps.close(), 3);
+}
+
+TEST_CASE(testPipeSpliceTo)
+{
+    const io::TempFile tempFile;
+    {
+        io::PipeStream ps("head -c 300000 /dev/zero");
+        sys::File file(tempFile.pathname(), sys::File::WRITE_ONLY,
+                       sys::File::CREATE | sys::File::TRUNCATE);
+        TEST_ASSERT_EQ(ps.spliceTo(file, 1000), 1000);
+        TEST_ASSERT_EQ(ps.spliceTo(file), 299000);
+        TEST_ASSERT_EQ(ps.spliceTo(file), io::InputStream::IS_EOF);
+        TEST_ASSERT_EQ(ps.close(), 0);
+    }
+    TEST_ASSERT_EQ(io::readFileContents(tempFile.pathname()),
+                   std::string(300000, '\0'));
+}
+
+TEST_CASE(testPipeSpliceAfterReadln)
+{
+    // Once readln() has buffered data, spliceTo() must not skip it
+    const io::TempFile tempFile;
+    {
+        io::PipeStream ps("printf 'first\\nsecond\\nthird\\n'");
+        sys::byte line[64];
+        TEST_ASSERT_EQ(ps.readln(line, sizeof(line)), 6);
+        TEST_ASSERT_EQ(std::string(line), "first\n");
+
+        sys::File file(tempFile.pathname(), sys::File::WRITE_ONLY,
+                       sys::File::CREATE | sys::File::TRUNCATE);
+        TEST_ASSERT_EQ(ps.spliceTo(file), 13);
+        ps.close();
+    }
+    TEST_ASSERT_EQ(io::readFileContents(tempFile.pathname()),
+                   "second\nthird\n");
+}
+#endif
+}
+
+int main(int, char**)
+{
+#if !(defined(WIN32) || defined(_WIN32))
+    TEST_CHECK(testPipeStreamTo);
+    TEST_CHECK(testPipeSpawn);
+    TEST_CHECK(testPipeSpliceTo);
+    TEST_CHECK(testPipeSpliceAfterReadln);
+#endif
+    return 0;
+}
@@ -0,0 +1,116 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <io/ReadUtils.h>
+#include <io/TempFile.h>
+#include "TestCase.h"
+
+namespace
+{
+void writeFile(const std::string& pathname, const std::string& contents)
+{
+    std::ofstream out(pathname.c_str(), std::ios::binary);
+    out.write(contents.data(), contents.size());
+}
+
+std::string makeContents(size_t size, size_t seed)
+{
+    std::string contents(size, '\0');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        contents[ii] = static_cast<char>((ii * 31 + seed) % 251);
+    }
+    return contents;
+}
+
+TEST_CASE(testReadFileContents)
+{
+    const io::TempFile tempFile;
+    const std::string expected = makeContents(100000, 7);
+    writeFile(tempFile.pathname(), expected);
+
+    TEST_ASSERT_EQ(io::readFileContents(tempFile.pathname()), expected);
+
+    std::vector<sys::byte> buffer;
+    io::readFileContents(tempFile.pathname(), buffer);
+    TEST_ASSERT_EQ(std::string(buffer.begin(), buffer.end()), expected);
+}
+
+TEST_CASE(testReadEmptyFile)
+{
+    const io::TempFile tempFile;
+    writeFile(tempFile.pathname(), "");
+
+    std::string str("stale");
+    io::readFileContents(tempFile.pathname(), str);
+    TEST_ASSERT(str.empty());
+}
+
+TEST_CASE(testReadMissingFile)
+{
+    std::string str;
+    TEST_EXCEPTION(io::readFileContents("no_such_file_for_read_utils", str));
+}
+
+TEST_CASE(testReadManyFiles)
+{
+    std::vector<io::TempFile*> files;
+    std::vector<std::string> pathnames;
+    std::vector<std::string> expected;
+    for (size_t ii = 0; ii < 25; ++ii)
+    {
+        files.push_back(new io::TempFile);
+        pathnames.push_back(files.back()->pathname());
+        expected.push_back(makeContents(ii * 37, ii));
+        writeFile(pathnames.back(), expected.back());
+    }
+
+    for (size_t numThreads = 0; numThreads < 4; ++numThreads)
+    {
+        std::vector<std::string> contents;
+        io::readFileContents(pathnames, contents, numThreads);
+        TEST_ASSERT_EQ(contents.size(), expected.size());
+        for (size_t ii = 0; ii < expected.size(); ++ii)
+        {
+            TEST_ASSERT_EQ(contents[ii], expected[ii]);
+        }
+    }
+
+    for (size_t ii = 0; ii < files.size(); ++ii)
+    {
+        delete files[ii];
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testReadFileContents);
+    TEST_CHECK(testReadEmptyFile);
+    TEST_CHECK(testReadMissingFile);
+    TEST_CHECK(testReadManyFiles);
+    return 0;
+}
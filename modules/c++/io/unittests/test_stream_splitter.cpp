@@ -50,7 +50,8 @@ std::string getTestLine(size_t length)
 bool streamSplitterTestRunner(size_t numLines,
                               size_t lineLength,
                               const std::string& delimiter,
-                              size_t bufferSize)
+                              size_t bufferSize,
+                              bool useView = false)
 {
     std::vector<std::string> inputLines;
     io::StringStream stream;
@@ -95,8 +96,13 @@ bool streamSplitterTestRunner(size_t numLines,
         return false;
     }
 
-    while (splitter.getNext(substring))
+    mem::BufferView<const sys::byte> view;
+    while (useView ? splitter.getNext(view) : splitter.getNext(substring))
     {
+        if (useView)
+        {
+            substring.assign(view.data, view.size);
+        }
         outputLines.push_back(substring);
 
         if (splitter.getNumSubstringsReturned() != outputLines.size())
@@ -189,6 +195,7 @@ TEST_CASE(testStreamSplitter)
                 {
                     const size_t bufferSize = bufferSizes[i_bufferSize];
                     TEST_ASSERT(streamSplitterTestRunner(lineCount, lineLength, delimiter, bufferSize));
+                    TEST_ASSERT(streamSplitterTestRunner(lineCount, lineLength, delimiter, bufferSize, true));
                 }
             }
         }
@@ -232,9 +239,41 @@ TEST_CASE(testStreamSplitterInputValidation)
     TEST_ASSERT(streamSplitterTestRunner(10, 10, "abc", 7));
 }
 
+TEST_CASE(testStreamSplitterViewEmpty)
+{
+    mem::BufferView<const sys::byte> substring;
+    io::StringStream stream;
+    io::StreamSplitter splitter(stream);
+    TEST_ASSERT(splitter.getNext(substring));
+    TEST_ASSERT_EQ(substring.size, 0);
+    TEST_ASSERT(!splitter.getNext(substring));
+    TEST_ASSERT(splitter.getNumSubstringsReturned() == 1);
+}
+
+TEST_CASE(testStreamSplitterViewLongLine)
+{
+    // lines much longer than the buffer can't be views into it
+    const std::string longLine(1000, 'x');
+    io::StringStream stream;
+    stream.write(longLine + "\nshort\n" + longLine);
+
+    io::StreamSplitter splitter(stream, "\n", 16);
+    mem::BufferView<const sys::byte> substring;
+    TEST_ASSERT(splitter.getNext(substring));
+    TEST_ASSERT_EQ(std::string(substring.data, substring.size), longLine);
+    TEST_ASSERT(splitter.getNext(substring));
+    TEST_ASSERT_EQ(std::string(substring.data, substring.size), "short");
+    TEST_ASSERT(splitter.getNext(substring));
+    TEST_ASSERT_EQ(std::string(substring.data, substring.size), longLine);
+    TEST_ASSERT(!splitter.getNext(substring));
+    TEST_ASSERT_EQ(splitter.getNumBytesProcessed(), 2 * longLine.size() + 7);
+}
+
 int main(int, char**)
 {
     TEST_CHECK(testStreamSplitterEmpty);
     TEST_CHECK(testStreamSplitter);
     TEST_CHECK(testStreamSplitterInputValidation);
+    TEST_CHECK(testStreamSplitterViewEmpty);
+    TEST_CHECK(testStreamSplitterViewLongLine);
 }
@@ -93,6 +93,76 @@ TEST_CASE(testByteStream)
     TEST_ASSERT_EQ(std::string(buf), "test");
 }
 
+TEST_CASE(testSegmentedByteStream)
+{
+    // Small segments so everything spans several of them
+    io::SegmentedByteStream stream(7);
+    stream.writeln("test");
+    stream.writeln("test");
+
+    TEST_ASSERT_EQ(stream.available(), 0);
+    stream.seek(0, io::Seekable::START);
+    TEST_ASSERT_EQ(stream.available(), 10);
+
+    stream.seek(10, io::Seekable::START);
+    stream.write("0123456789");
+    TEST_ASSERT_EQ(stream.tell(), 20);
+    TEST_ASSERT_EQ(stream.available(), 0);
+
+    stream.seek(22, io::Seekable::CURRENT);
+    TEST_ASSERT_EQ(stream.tell(), -1);
+    stream.reset();
+    TEST_ASSERT_EQ(stream.tell(), 0);
+
+    stream.seek(2, io::Seekable::END);
+    TEST_ASSERT_EQ(stream.tell(), 18);
+    TEST_ASSERT_EQ(stream.getSize(), 20);
+
+    stream.write("abcdef");
+    TEST_ASSERT_EQ(stream.getSize(), 24);
+
+    stream.seek(7, io::Seekable::START);
+    sys::byte buf[255];
+    TEST_ASSERT_EQ(stream.read(buf, 16), 16);
+    TEST_ASSERT_EQ(std::string(buf, 16), "st\n01234567abcde");
+    TEST_ASSERT_EQ(stream.read(buf, 16), 1);
+
+    stream.clear();
+    TEST_ASSERT_EQ(stream.available(), 0);
+    stream.write("test");
+    stream.seek(0, io::Seekable::START);
+    TEST_ASSERT_EQ(stream.available(), 4);
+    stream.read(buf, 4);
+    TEST_ASSERT_EQ(std::string(buf, 4), "test");
+}
+
+TEST_CASE(testSegmentedByteStreamSlice)
+{
+    io::SegmentedByteStream stream(4);
+    stream.write("0123456789");
+    const sys::byte* const firstSegment = stream.getSegments()[0].data;
+
+    // Appending never moves existing bytes
+    stream.write("abcdefghij");
+    TEST_ASSERT(stream.getSegments()[0].data == firstSegment);
+
+    std::vector<mem::BufferView<const sys::byte> > views = stream.slice(2, 6);
+    TEST_ASSERT_EQ(views.size(), 2);
+    TEST_ASSERT_EQ(std::string(views[0].data, views[0].size), "23");
+    TEST_ASSERT_EQ(std::string(views[1].data, views[1].size), "4567");
+
+    views = stream.slice(3, 6);
+    TEST_ASSERT_EQ(views.size(), 3);
+    TEST_ASSERT_EQ(stream.slice(20, 0).size(), 0);
+    TEST_EXCEPTION(stream.slice(15, 6));
+
+    io::ByteStream sink;
+    stream.writeTo(sink);
+    TEST_ASSERT_EQ(sink.getSize(), 20);
+    TEST_ASSERT_EQ(std::string(reinterpret_cast<char*>(sink.get()), 20),
+                   "0123456789abcdefghij");
+}
+
 TEST_CASE(testProxyOutputStream)
 {
     io::StringStream stream;
@@ -112,6 +182,69 @@ TEST_CASE(testCountingOutputStream)
     TEST_ASSERT_EQ(counter.getCount(), 5);
 }
 
+TEST_CASE(testInstrumentedOutputStream)
+{
+    io::ByteStream stream;
+    io::InstrumentedOutputStream out(&stream);
+    out.write("test1");
+    out.write(std::string(1000, 'x'));
+
+    std::vector<mem::BufferView<const sys::byte> > buffers;
+    buffers.push_back(mem::BufferView<const sys::byte>(
+            reinterpret_cast<const sys::byte*>("ab"), 2));
+    buffers.push_back(mem::BufferView<const sys::byte>(
+            reinterpret_cast<const sys::byte*>("cde"), 3));
+    out.write(buffers);
+    out.flush();
+
+    const io::StreamStatistics stats = out.getStatistics();
+    TEST_ASSERT_EQ(stream.getSize(), 1010);
+    TEST_ASSERT_EQ(stats.numCalls, 4);
+    TEST_ASSERT_EQ(stats.numBytes, 1010);
+
+    // 0 bytes (flush), [4, 8) bytes twice, [512, 1024) bytes
+    TEST_ASSERT_EQ(stats.sizeHistogram[0], 1);
+    TEST_ASSERT_EQ(stats.sizeHistogram[3], 2);
+    TEST_ASSERT_EQ(stats.sizeHistogram[10], 1);
+
+    sys::Uint64_T latencyCalls = 0;
+    sys::Uint64_T recentBytes = 0;
+    for (size_t ii = 0; ii < io::StreamStatistics::NUM_BUCKETS; ++ii)
+    {
+        latencyCalls += stats.latencyHistogram[ii];
+    }
+    for (size_t ii = 0; ii < io::StreamStatistics::NUM_SECONDS; ++ii)
+    {
+        recentBytes += stats.bytesPerSecond[ii];
+    }
+    TEST_ASSERT_EQ(latencyCalls, 4);
+    TEST_ASSERT_EQ(recentBytes, 1010);
+    TEST_ASSERT(stats.blockedSeconds <= stats.elapsedSeconds);
+    TEST_ASSERT(stats.getLatencyPercentile(50) <= stats.maxLatencySeconds);
+
+    out.resetStatistics();
+    TEST_ASSERT_EQ(out.getStatistics().numCalls, 0);
+    TEST_ASSERT_EQ(out.getStatistics().numBytes, 0);
+}
+
+TEST_CASE(testInstrumentedInputStream)
+{
+    io::StringStream stream;
+    stream.write("0123456789");
+    io::InstrumentedInputStream in(&stream);
+
+    sys::byte buf[8];
+    TEST_ASSERT_EQ(in.read(buf, 4), 4);
+    TEST_ASSERT_EQ(in.read(buf, 8), 6);
+    TEST_ASSERT_EQ(in.read(buf, 8), -1);
+
+    const io::StreamStatistics stats = in.getStatistics();
+    TEST_ASSERT_EQ(stats.numCalls, 3);
+    TEST_ASSERT_EQ(stats.numBytes, 10);
+    TEST_ASSERT_EQ(stats.sizeHistogram[0], 1);
+    TEST_ASSERT_EQ(stats.sizeHistogram[3], 2);
+}
+
 TEST_CASE(testBufferViewStream)
 {
     {
@@ -296,15 +429,360 @@ TEST_CASE(testRotateReset)
     cleanupFiles( outFile);
 }
 
+TEST_CASE(testVectoredFileStreams)
+{
+    const std::string outFile = "test_vectored.bin";
+    const std::string header = "HEADER";
+    std::vector<sys::byte> payload(100000);
+    for (size_t ii = 0; ii < payload.size(); ++ii)
+    {
+        payload[ii] = static_cast<sys::byte>(ii % 251);
+    }
+
+    {
+        std::vector<mem::BufferView<const sys::byte> > buffers;
+        buffers.push_back(mem::BufferView<const sys::byte>(
+                header.c_str(), header.size()));
+        buffers.push_back(mem::BufferView<const sys::byte>());
+        buffers.push_back(mem::BufferView<const sys::byte>(
+                &payload[0], payload.size()));
+
+        io::FileOutputStream out(outFile);
+        out.write(buffers);
+        out.close();
+    }
+
+    io::FileInputStream in(outFile);
+    TEST_ASSERT_EQ(in.available(),
+                   static_cast<sys::Off_T>(header.size() + payload.size()));
+
+    std::vector<sys::byte> headerIn(header.size());
+    std::vector<sys::byte> payloadIn(payload.size() + 10);
+    std::vector<mem::BufferView<sys::byte> > buffers;
+    buffers.push_back(mem::BufferView<sys::byte>(&headerIn[0],
+                                                 headerIn.size()));
+    buffers.push_back(mem::BufferView<sys::byte>(&payloadIn[0],
+                                                 payloadIn.size()));
+
+    // Short read: the last buffer is only partly filled
+    TEST_ASSERT_EQ(in.read(buffers),
+                   static_cast<sys::SSize_T>(header.size() + payload.size()));
+    TEST_ASSERT_EQ(std::string(headerIn.begin(), headerIn.end()), header);
+    TEST_ASSERT(std::equal(payload.begin(), payload.end(), payloadIn.begin()));
+    TEST_ASSERT_EQ(in.read(buffers), io::InputStream::IS_EOF);
+    in.close();
+
+    sys::OS().remove(outFile);
+}
+
+TEST_CASE(testVectoredByteStream)
+{
+    // ByteStream uses the default (looping) implementations
+    io::ByteStream stream;
+    std::vector<mem::BufferView<const sys::byte> > outBuffers;
+    outBuffers.push_back(mem::BufferView<const sys::byte>("abc", 3));
+    outBuffers.push_back(mem::BufferView<const sys::byte>("defg", 4));
+    stream.write(outBuffers);
+    TEST_ASSERT_EQ(stream.getSize(), 7);
+    stream.seek(0, io::Seekable::START);
+
+    sys::byte first[2];
+    sys::byte second[5];
+    std::vector<mem::BufferView<sys::byte> > inBuffers;
+    inBuffers.push_back(mem::BufferView<sys::byte>(first, 2));
+    inBuffers.push_back(mem::BufferView<sys::byte>(second, 5));
+    TEST_ASSERT_EQ(stream.read(inBuffers, true), 7);
+    TEST_ASSERT_EQ(std::string(first, 2), "ab");
+    TEST_ASSERT_EQ(std::string(second, 5), "cdefg");
+
+    stream.seek(0, io::Seekable::START);
+    sys::byte big[8];
+    inBuffers.push_back(mem::BufferView<sys::byte>(big, 8));
+    try
+    {
+        stream.read(inBuffers, true);
+        TEST_FAIL("Short read should throw when verifying");
+    }
+    catch(except::IOException&)
+    {
+    }
+
+    io::ByteStream sink;
+    io::CountingOutputStream counter(&sink);
+    counter.write(outBuffers);
+    TEST_ASSERT_EQ(counter.getCount(), 7);
+    TEST_ASSERT_EQ(sink.getSize(), 7);
+}
+
+TEST_CASE(testAsyncRotate)
+{
+    std::string outFile = "test_async_rotate.txt";
+    cleanupFiles( outFile);
+
+    sys::OS os;
+    {
+        io::AsyncRotatingFileOutputStream out(outFile, 10, 2);
+        out.write("0123456789");
+        out.write("abc");
+        out.flush();
+        TEST_ASSERT(os.isFile(outFile + ".1"));
+        TEST_ASSERT_EQ(os.getSize(outFile), 3);
+        out.write("def");
+        out.close();
+        TEST_ASSERT_EQ(os.getSize(outFile), 6);
+
+        try
+        {
+            out.write("0");
+            TEST_FAIL("Stream is closed; should throw.");
+        }
+        catch(except::Exception&)
+        {
+        }
+    }
+
+    cleanupFiles( outFile);
+}
+
+namespace
+{
+// Remembers what was written to it and whether it was closed
+class RecordingStream : public io::OutputStream
+{
+public:
+    RecordingStream() :
+        closed(false)
+    {
+    }
+
+    using io::OutputStream::write;
+
+    virtual void write(const void* buffer, size_t len)
+    {
+        data.append(static_cast<const char*>(buffer), len);
+    }
+
+    virtual void close()
+    {
+        closed = true;
+    }
+
+    std::string data;
+    bool closed;
+};
+
+// Writes numRecords records of recordSize copies of c
+class RecordWriter : public sys::Runnable
+{
+public:
+    RecordWriter(io::OutputStream& out, char c, size_t recordSize,
+                 size_t numRecords) :
+        mOut(out),
+        mRecord(recordSize, c),
+        mNumRecords(numRecords)
+    {
+    }
+
+    virtual void run()
+    {
+        for (size_t ii = 0; ii < mNumRecords; ++ii)
+        {
+            mOut.write(mRecord);
+        }
+    }
+
+private:
+    io::OutputStream& mOut;
+    const std::string mRecord;
+    const size_t mNumRecords;
+};
+
+// Writes numRecords records of copies of c, each as a vectored write of
+// pieces of 3, 2 and 5 bytes
+class GatherWriter : public sys::Runnable
+{
+public:
+    GatherWriter(io::OutputStream& out, char c, size_t numRecords) :
+        mOut(out),
+        mRecord(RECORD_SIZE, c),
+        mNumRecords(numRecords)
+    {
+    }
+
+    static const size_t RECORD_SIZE = 10;
+
+    virtual void run()
+    {
+        std::vector<mem::BufferView<const sys::byte> > buffers(3);
+        buffers[0] = mem::BufferView<const sys::byte>(&mRecord[0], 3);
+        buffers[1] = mem::BufferView<const sys::byte>(&mRecord[3], 2);
+        buffers[2] = mem::BufferView<const sys::byte>(&mRecord[5], 5);
+        for (size_t ii = 0; ii < mNumRecords; ++ii)
+        {
+            mOut.write(buffers);
+        }
+    }
+
+private:
+    io::OutputStream& mOut;
+    const std::string mRecord;
+    const size_t mNumRecords;
+};
+
+// Every run of c in data is a whole number of records
+bool recordsAreWhole(const std::string& data, char c, size_t recordSize)
+{
+    size_t run = 0;
+    for (size_t ii = 0; ii <= data.size(); ++ii)
+    {
+        if (ii < data.size() && data[ii] == c)
+        {
+            ++run;
+        }
+        else
+        {
+            if (run % recordSize != 0)
+            {
+                return false;
+            }
+            run = 0;
+        }
+    }
+    return true;
+}
+}
+
+TEST_CASE(testAsyncUnownedProxy)
+{
+    // The caller still has the proxy, so closing mustn't close it
+    RecordingStream sink;
+    {
+        io::AsyncOutputStream out(&sink, false, 16);
+        out.write("record");
+        out.close();
+    }
+    TEST_ASSERT_EQ(sink.data, "record");
+    TEST_ASSERT(!sink.closed);
+
+    RecordingStream* const owned = new RecordingStream;
+    io::AsyncOutputStream out(owned, true, 16);
+    out.write("record");
+    out.close();
+    TEST_ASSERT(owned->closed);
+}
+
+TEST_CASE(testAsyncSplitRecords)
+{
+    // Records bigger than the buffer still don't interleave with another
+    // thread's
+    RecordingStream sink;
+    {
+        io::AsyncOutputStream out(&sink, false, 16);
+        sys::Thread thread(new RecordWriter(out, 'a', 40, 50));
+        thread.start();
+        RecordWriter(out, 'b', 3, 200).run();
+        thread.join();
+        out.close();
+    }
+    TEST_ASSERT_EQ(sink.data.size(), static_cast<size_t>(40 * 50 + 3 * 200));
+    TEST_ASSERT(recordsAreWhole(sink.data, 'a', 40));
+    TEST_ASSERT(recordsAreWhole(sink.data, 'b', 3));
+}
+
+TEST_CASE(testAsyncGatherRecords)
+{
+    // A vectored write is one record, whether or not it fits the buffer
+    const size_t capacities[] = { 64, 16, 8 };
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        RecordingStream sink;
+        {
+            io::AsyncOutputStream out(&sink, false, capacities[ii]);
+            sys::Thread thread(new GatherWriter(out, 'a', 100));
+            thread.start();
+            RecordWriter(out, 'b', 3, 200).run();
+            thread.join();
+            out.close();
+        }
+        TEST_ASSERT_EQ(sink.data.size(),
+                       GatherWriter::RECORD_SIZE * 100 + 3 * 200);
+        TEST_ASSERT(recordsAreWhole(sink.data, 'a',
+                                    GatherWriter::RECORD_SIZE));
+        TEST_ASSERT(recordsAreWhole(sink.data, 'b', 3));
+    }
+
+    // Under DROP, the whole vector is dropped as one record
+    RecordingStream sink;
+    io::AsyncOutputStream out(&sink, false, 8, io::AsyncOutputStream::DROP);
+    GatherWriter(out, 'a', 1).run();
+    out.close();
+    TEST_ASSERT_EQ(out.getNumRecordsDropped(), 1);
+    TEST_ASSERT_EQ(out.getNumBytesDropped(), 10);
+    TEST_ASSERT(sink.data.empty());
+}
+
+TEST_CASE(testAsyncDrop)
+{
+    io::ByteStream sink;
+    {
+        io::AsyncOutputStream out(&sink, false, 16,
+                                  io::AsyncOutputStream::DROP,
+                                  io::AsyncOutputStream::SYNC_ALWAYS);
+        out.write("this record is larger than the buffer");
+        out.write("fits");
+        out.flush();
+        TEST_ASSERT_EQ(out.getNumRecordsDropped(), 1);
+        TEST_ASSERT_EQ(out.getNumBytesDropped(), 37);
+    }
+    sink.seek(0, io::Seekable::START);
+    sys::byte buf[4];
+    TEST_ASSERT_EQ(sink.getSize(), 4);
+    sink.read(buf, 4);
+    TEST_ASSERT_EQ(std::string(buf, 4), "fits");
+}
+
+TEST_CASE(testAsyncBlock)
+{
+    // Records larger than the buffer are split but not lost
+    io::ByteStream sink;
+    std::string expected;
+    {
+        io::AsyncOutputStream out(&sink, false, 7);
+        for (size_t ii = 0; ii < 100; ++ii)
+        {
+            const std::string record = str::toString(ii) + "-0123456789,";
+            out.write(record);
+            expected += record;
+        }
+    }
+    TEST_ASSERT_EQ(sink.getSize(), expected.size());
+    sink.seek(0, io::Seekable::START);
+    std::vector<sys::byte> buf(expected.size());
+    sink.read(&buf[0], buf.size());
+    TEST_ASSERT_EQ(std::string(buf.begin(), buf.end()), expected);
+}
+
 int main(int, char**)
 {
     TEST_CHECK(testStringStream);
     TEST_CHECK(testByteStream);
+    TEST_CHECK(testSegmentedByteStream);
+    TEST_CHECK(testSegmentedByteStreamSlice);
     TEST_CHECK(testProxyOutputStream);
     TEST_CHECK(testCountingOutputStream);
+    TEST_CHECK(testInstrumentedOutputStream);
+    TEST_CHECK(testInstrumentedInputStream);
     TEST_CHECK(testBufferViewStream);
     TEST_CHECK(testBufferViewIntStream);
     TEST_CHECK(testRotate);
     TEST_CHECK(testNeverRotate);
     TEST_CHECK(testRotateReset);
+    TEST_CHECK(testVectoredFileStreams);
+    TEST_CHECK(testVectoredByteStream);
+    TEST_CHECK(testAsyncRotate);
+    TEST_CHECK(testAsyncDrop);
+    TEST_CHECK(testAsyncBlock);
+    TEST_CHECK(testAsyncUnownedProxy);
+    TEST_CHECK(testAsyncSplitRecords);
+    TEST_CHECK(testAsyncGatherRecords);
 }
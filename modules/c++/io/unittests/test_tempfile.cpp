@@ -20,14 +20,27 @@
  *
  */
 
+#include <sys/stat.h>
 #include <fstream>
 
 #include <sys/OS.h>
+#include <io/ReadUtils.h>
 #include <io/TempFile.h>
+#include <mem/BufferView.h>
 #include "TestCase.h"
 
 namespace
 {
+// Whether a pathname still refers to the file 'info' describes.  The
+// /proc/self/fd path of a memfd may be reused for another file as soon as
+// the memfd is closed, so existence alone doesn't say.
+bool isSameFile(const std::string& pathname, const struct stat& info)
+{
+    struct stat current;
+    return ::stat(pathname.c_str(), &current) == 0 &&
+            current.st_dev == info.st_dev && current.st_ino == info.st_ino;
+}
+
 TEST_CASE(testTempFileCreation)
 {
     const sys::OS os;
@@ -50,12 +63,95 @@ TEST_CASE(testFileDestroyed)
     TEST_ASSERT(!os.exists(pathname));
 }
 
+
+TEST_CASE(testMemoryTempFile)
+{
+    std::string pathname;
+    struct stat info;
+    {
+        io::TempFile tempFile(".", io::TempFile::MEMORY);
+        pathname = tempFile.pathname();
+        TEST_ASSERT_EQ(::stat(pathname.c_str(), &info), 0);
+
+        tempFile.write("Test ", 5);
+        tempFile.write("text", 4);
+        TEST_ASSERT_EQ(tempFile.size(), 9);
+        TEST_ASSERT_EQ(io::readFileContents(pathname), "Test text");
+    }
+    TEST_ASSERT(!isSameFile(pathname, info));
+}
+
+TEST_CASE(testMemoryTempFileSpill)
+{
+    const sys::OS os;
+    std::string pathname;
+    {
+        io::TempFile tempFile(".", io::TempFile::MEMORY, 8);
+        tempFile.write("12345678", 8);
+        const bool wasInMemory = tempFile.isInMemory();
+
+        tempFile.write("9", 1);
+        TEST_ASSERT(!tempFile.isInMemory());
+        if (wasInMemory)
+        {
+            // Spilled to a new file in the requested directory
+            TEST_ASSERT_EQ(sys::Path::splitPath(
+                    tempFile.pathname()).first, ".");
+        }
+
+        tempFile.write("0", 1);
+        pathname = tempFile.pathname();
+        TEST_ASSERT_EQ(io::readFileContents(pathname), "1234567890");
+    }
+    TEST_ASSERT(!os.exists(pathname));
+}
+
+TEST_CASE(testMemoryTempFileStreamSpill)
+{
+    // Writes through the stream, vectored ones included, spill too
+    io::TempFile tempFile(".", io::TempFile::MEMORY, 8);
+    io::OutputStream& stream = tempFile.getOutputStream();
+    stream.write("1234");
+    std::vector<mem::BufferView<const sys::byte> > buffers(2);
+    buffers[0] = mem::BufferView<const sys::byte>("5678", 4);
+    buffers[1] = mem::BufferView<const sys::byte>("90", 2);
+    stream.write(buffers);
+    TEST_ASSERT(!tempFile.isInMemory());
+    TEST_ASSERT_EQ(io::readFileContents(tempFile.pathname()), "1234567890");
+}
+
+TEST_CASE(testMemoryTempFileCheckSpill)
+{
+    // Writes through pathname() aren't seen until checkSpill()
+    io::TempFile tempFile(".", io::TempFile::MEMORY, 8);
+    {
+        std::ofstream out(tempFile.pathname().c_str());
+        out << "1234567";
+    }
+    tempFile.checkSpill();
+    const bool wasInMemory = tempFile.isInMemory();
+    {
+        std::ofstream out(tempFile.pathname().c_str(), std::ios::app);
+        out << "890";
+    }
+    tempFile.checkSpill();
+    TEST_ASSERT(!tempFile.isInMemory());
+    if (wasInMemory)
+    {
+        TEST_ASSERT_EQ(sys::Path::splitPath(tempFile.pathname()).first, ".");
+    }
+    TEST_ASSERT_EQ(io::readFileContents(tempFile.pathname()), "1234567890");
+}
 }
 
 int main(int, char**)
 {
     TEST_CHECK(testTempFileCreation);
     TEST_CHECK(testFileDestroyed);
+    TEST_CHECK(testMemoryTempFile);
+    TEST_CHECK(testMemoryTempFileSpill);
+    TEST_CHECK(testMemoryTempFileStreamSpill);
+    TEST_CHECK(testMemoryTempFileCheckSpill);
     return 0;
 }
 
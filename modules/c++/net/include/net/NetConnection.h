@@ -139,6 +139,14 @@ public:
      */
     virtual void write(const void* buffer, size_t len);
 
+    /*!
+     *  Write the buffers to the socket with a single gather send.
+     *  \param buffers The buffers to write to the stream
+     *  \throw IOException
+     */
+    virtual void write(
+            const std::vector<mem::BufferView<const sys::byte> >& buffers);
+
     using io::BidirectionalStream::read;
     using io::BidirectionalStream::write;
 
@@ -152,6 +160,15 @@ protected:
      */
     virtual sys::SSize_T readImpl(void* buffer, size_t len);
 
+    /*!
+     *  Read into a list of buffers with a single scatter recv
+     *  \param buffers Buffers to read into
+     *  \throw IOException
+     *  \return  The number of bytes read, or -1 if eof
+     */
+    virtual sys::SSize_T readImpl(
+            const std::vector<mem::BufferView<sys::byte> >& buffers);
+
     //! The socket
     std::shared_ptr<net::Socket> mSocket;
 };
@@ -26,6 +26,8 @@
 #include <sys/SystemException.h>
 #include <except/Exception.h>
 #include <str/Manip.h>
+#include <mem/BufferView.h>
+#include <vector>
 
 #include "net/Sockets.h"
 #include "net/SocketAddress.h"
@@ -197,6 +199,16 @@ public:
      */
     size_t recv(void* b, size_t len, int flags = 0);
 
+    /*!
+     *  Scatter read: a single recv filling the buffers in order
+     *  (recvmsg on Unix).  Like recv, this may return fewer bytes than
+     *  the buffers can hold.
+     *  \param buffers The byte buffers to recv into
+     *  \param flags (optional) Additional flags (not common)
+     */
+    size_t recv(const std::vector<mem::BufferView<sys::byte> >& buffers,
+                int flags = 0);
+
     /*!
      *  Same as recv, except from a specified socket address.  Only
      *  really makes sense for UDP sockets.  The address recv'd from
@@ -223,6 +235,15 @@ public:
               size_t len,
               int flags = 0);
 
+    /*!
+     *  Gather send: send the buffers, in order, with as few system
+     *  calls as possible (sendmsg on Unix)
+     *  \param buffers The byte buffers to send
+     *  \param flags The flags (usually not specified)
+     */
+    void send(const std::vector<mem::BufferView<const sys::byte> >& buffers,
+              int flags = 0);
+
     /*!
      *  Same as send, except to a specified socket address.  Only
      *  really makes sense for UDP sockets.  The address sent from
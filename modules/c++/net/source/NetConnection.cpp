@@ -31,3 +31,15 @@ void net::NetConnection::write(const void* buffer, size_t len)
 {
     mSocket->send(buffer, len);
 }
+
+sys::SSize_T net::NetConnection::readImpl(
+        const std::vector<mem::BufferView<sys::byte> >& buffers)
+{
+    return mSocket->recv(buffers);
+}
+
+void net::NetConnection::write(
+        const std::vector<mem::BufferView<const sys::byte> >& buffers)
+{
+    mSocket->send(buffers);
+}
@@ -20,8 +20,20 @@
  *
  */
 
+#include <algorithm>
+#include <string.h>
+
 #include "net/Socket.h"
 
+#if !(defined(WIN32) || defined(_WIN32))
+#include <sys/uio.h>
+#include <limits.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+#endif
+
 net::Socket::Socket(int proto)
 {
     mNative = ::socket(AF_INET, proto, 0);
@@ -124,6 +136,58 @@ size_t net::Socket::recv(void* b, size_t len, int flags)
     return numBytes;
 }
 
+size_t net::Socket::recv(
+        const std::vector<mem::BufferView<sys::byte> >& buffers, int flags)
+{
+#if defined(WIN32) || defined(_WIN32)
+    // Windows would need WSARecv; a single recv into the first
+    // non-empty buffer keeps the partial-read semantics of recv()
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        if (buffers[ii].size > 0)
+            return recv(buffers[ii].data, buffers[ii].size, flags);
+    }
+    return -1;
+#else
+    std::vector<struct iovec> iov;
+    iov.reserve(buffers.size());
+    size_t len = 0;
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        if (buffers[ii].size > 0)
+        {
+            struct iovec vec;
+            vec.iov_base = buffers[ii].data;
+            vec.iov_len = buffers[ii].size;
+            iov.push_back(vec);
+            len += vec.iov_len;
+        }
+    }
+    if (iov.empty())
+        return -1;
+
+    struct msghdr msg;
+    ::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov[0];
+    msg.msg_iovlen = std::min<size_t>(iov.size(), IOV_MAX);
+
+    const sys::SSize_T numBytes = ::recvmsg(mNative, &msg, flags);
+    if (numBytes == -1 && NATIVE_SOCKET_GETLASTERROR()
+            != NATIVE_SOCKET_ERROR(WOULDBLOCK))
+    {
+        sys::Err err;
+        std::ostringstream oss;
+        oss << "When receiving " << len << " bytes: " << err.toString();
+        throw sys::SocketException(Ctxt(oss.str()));
+    }
+    else if (numBytes == 0)
+    {
+        return -1;
+    }
+    return numBytes;
+#endif
+}
+
 size_t net::Socket::recvFrom(net::SocketAddress& address,
                              void* b,
                              size_t len,
@@ -174,6 +238,68 @@ void net::Socket::send(const void* b, size_t len, int flags)
     }
 }
 
+void net::Socket::send(
+        const std::vector<mem::BufferView<const sys::byte> >& buffers,
+        int flags)
+{
+#if defined(WIN32) || defined(_WIN32)
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        send(buffers[ii].data, buffers[ii].size, flags);
+    }
+#else
+    std::vector<struct iovec> iov;
+    iov.reserve(buffers.size());
+    for (size_t ii = 0; ii < buffers.size(); ++ii)
+    {
+        if (buffers[ii].size > 0)
+        {
+            struct iovec vec;
+            vec.iov_base = const_cast<sys::byte*>(buffers[ii].data);
+            vec.iov_len = buffers[ii].size;
+            iov.push_back(vec);
+        }
+    }
+
+    // sendmsg() on a stream socket may send less than requested, so keep
+    // advancing through the iovec array until everything has gone out
+    size_t next = 0;
+    while (next < iov.size())
+    {
+        struct msghdr msg;
+        ::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov[next];
+        msg.msg_iovlen = std::min<size_t>(iov.size() - next, IOV_MAX);
+
+        const sys::SSize_T numBytes = ::sendmsg(mNative, &msg, flags);
+        if (numBytes == -1)
+        {
+            if (NATIVE_SOCKET_GETLASTERROR() == EINTR)
+                continue;
+
+            sys::Err err;
+            std::ostringstream oss;
+            oss << "Tried sending " << buffers.size() << " buffers: "
+                << err.toString();
+            throw sys::SocketException(Ctxt(oss.str()));
+        }
+
+        size_t remaining = static_cast<size_t>(numBytes);
+        while (next < iov.size() && remaining >= iov[next].iov_len)
+        {
+            remaining -= iov[next].iov_len;
+            ++next;
+        }
+        if (remaining > 0)
+        {
+            iov[next].iov_base =
+                    static_cast<sys::byte*>(iov[next].iov_base) + remaining;
+            iov[next].iov_len -= remaining;
+        }
+    }
+#endif
+}
+
 void net::Socket::sendTo(const SocketAddress& address,
                          const void* b,
                          size_t len,
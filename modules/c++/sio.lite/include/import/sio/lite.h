@@ -24,11 +24,17 @@
 
 #include "sio/lite/ReadUtils.h"
 #include "sio/lite/ElementType.h"
+#include "sio/lite/Convert.h"
+#include "sio/lite/BlockIndex.h"
 #include "sio/lite/InvalidHeaderException.h"
 #include "sio/lite/UnsupportedDataTypeException.h"
 #include "sio/lite/FileHeader.h"
 #include "sio/lite/FileReader.h"
 #include "sio/lite/FileWriter.h"
+#include "sio/lite/ImageView.h"
+#include "sio/lite/MMapReader.h"
+#include "sio/lite/RowWriter.h"
+#include "sio/lite/TileIndex.h"
 #include "sio/lite/UserDataDictionary.h"
 
 #endif
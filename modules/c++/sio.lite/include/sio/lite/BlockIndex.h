@@ -0,0 +1,200 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIO_LITE_BLOCK_INDEX_H__
+#define __SIO_LITE_BLOCK_INDEX_H__
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <import/sys.h>
+#include "sio/lite/FileHeader.h"
+
+namespace sio
+{
+namespace lite
+{
+/*!
+ *  \class BlockIndex
+ *  \brief Describes an SIO whose image data is stored compressed
+ *
+ *  A compressed SIO has an ordinary header: nl, ne, es and et describe
+ *  the image as usual.  The band-sequential image data is cut into
+ *  blocks of blockSize bytes, the last block being whatever is left, and
+ *  each block is compressed on its own.  The compressed blocks follow the
+ *  header one after another.  The USER_DATA_KEY user data field records
+ *  the blocking along with the offset of every compressed block from the
+ *  start of the image data, so that any block can be read and
+ *  decompressed by itself.
+ *
+ *  Elements are compressed in the byte order of the rest of the file, and
+ *  a block is always a whole number of elements, so a decompressed block
+ *  is swapped like uncompressed image data would be.
+ *
+ *  The field holds 64-bit integers in the byte order of the rest of the
+ *  file: the compression, blockSize, the size of the uncompressed image
+ *  data, then the block offsets followed by the size of the compressed
+ *  image data.
+ */
+class BlockIndex
+{
+public:
+    //! The user data field that marks a compressed SIO
+    static const char* const USER_DATA_KEY;
+
+    //! How each block is compressed
+    enum Compression
+    {
+        //! A zlib stream (RFC 1950) per block
+        ZLIB = 1
+    };
+
+    enum
+    {
+        //! Big enough to compress well, small enough that reading a small
+        //! window doesn't decompress much more than it needs
+        DEFAULT_BLOCK_SIZE = 1024 * 1024,
+
+        //! zlib's default compression level
+        DEFAULT_LEVEL = -1
+    };
+
+    /*!
+     *  Cut dataSize bytes of image data into blocks.  The blocks have no
+     *  compressed sizes until setCompressedSizes() is called.
+     *
+     *  \throws except::Exception if blockSize is 0
+     */
+    BlockIndex(sys::Uint64_T dataSize,
+               size_t blockSize = DEFAULT_BLOCK_SIZE,
+               Compression compression = ZLIB);
+
+    /*!
+     *  Read the index out of a header
+     *
+     *  \return NULL if the header isn't for a compressed SIO
+     *  \throws sio::lite::InvalidHeaderException if the field is malformed
+     */
+    static std::unique_ptr<BlockIndex> fromHeader(const FileHeader& header);
+
+    //! Record the index in a header's user data, in native byte order
+    void addTo(FileHeader& header) const;
+
+    //! \return Whether this build of sio.lite can compress and decompress
+    static bool isSupported();
+
+    Compression getCompression() const
+    {
+        return mCompression;
+    }
+
+    size_t getBlockSize() const
+    {
+        return mBlockSize;
+    }
+
+    //! \return The size of the image data before compression
+    sys::Uint64_T getDataSize() const
+    {
+        return mDataSize;
+    }
+
+    //! \return The size of the image data as it is stored
+    sys::Uint64_T getCompressedDataSize() const
+    {
+        return mOffsets.back();
+    }
+
+    size_t getNumBlocks() const
+    {
+        return mOffsets.size() - 1;
+    }
+
+    //! \return The block holding a byte of the uncompressed image data
+    size_t getBlock(sys::Uint64_T offset) const
+    {
+        return static_cast<size_t>(offset / mBlockSize);
+    }
+
+    //! \return The size of a block before compression, less for the last
+    size_t getBlockDataSize(size_t block) const
+    {
+        return static_cast<size_t>(std::min<sys::Uint64_T>(
+                mBlockSize, mDataSize - static_cast<sys::Uint64_T>(block) *
+                                        mBlockSize));
+    }
+
+    /*!
+     *  \return Where a compressed block starts, in bytes from the start of
+     *          the image data
+     *  \throws except::Exception if there is no such block
+     */
+    sys::Off_T getOffset(size_t block) const;
+
+    //! \throws except::Exception if there is no such block
+    size_t getCompressedSize(size_t block) const;
+
+    /*!
+     *  Lay out the compressed blocks one after another
+     *
+     *  \throws except::Exception if there isn't a size for every block
+     */
+    void setCompressedSizes(const std::vector<size_t>& sizes);
+
+    /*!
+     *  Compress one block
+     *
+     *  \param data The block's getBlockDataSize() bytes
+     *  \param block The block to compress
+     *  \param compressed Output, resized to the compressed size
+     *  \param level 1 (fastest) to 9 (smallest), or DEFAULT_LEVEL
+     *
+     *  \throws except::Exception if compression fails or isn't supported
+     */
+    void compressBlock(const void* data,
+                       size_t block,
+                       std::vector<sys::byte>& compressed,
+                       int level = DEFAULT_LEVEL) const;
+
+    /*!
+     *  Decompress one block
+     *
+     *  \param compressed The block's getCompressedSize() bytes
+     *  \param block The block to decompress
+     *  \param data Output, getBlockDataSize() bytes
+     *
+     *  \throws except::Exception if the block is corrupt or decompression
+     *          isn't supported
+     */
+    void decompressBlock(const void* compressed,
+                         size_t block,
+                         void* data) const;
+
+private:
+    Compression mCompression;
+    size_t mBlockSize;
+    sys::Uint64_T mDataSize;
+    std::vector<sys::Uint64_T> mOffsets;
+};
+}
+}
+
+#endif
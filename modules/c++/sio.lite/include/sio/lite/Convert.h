@@ -0,0 +1,285 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIO_LITE_CONVERT_H__
+#define __SIO_LITE_CONVERT_H__
+
+#include <string.h>
+#include <algorithm>
+#include <complex>
+#include <sstream>
+#include <type_traits>
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <mt/BalancedRunnable1D.h>
+#include "sio/lite/FileHeader.h"
+#include "sio/lite/UnsupportedDataTypeException.h"
+
+namespace sio
+{
+namespace lite
+{
+/*!
+ *  \function swapBytes
+ *  \brief Byte swaps values in place.
+ *
+ *  Like sys::byteSwap(), but 2, 4 and 8-byte values are swapped 16 bytes
+ *  at a time with SSSE3 byte shuffles where the CPU has them.
+ *
+ *  \param buffer The values to swap
+ *  \param elemSize The size of each value
+ *  \param numElems The number of values
+ */
+void swapBytes(void* buffer, size_t elemSize, size_t numElems);
+
+namespace detail
+{
+//! The scalar type of T and how many of them make up a T
+template <typename T>
+struct Components
+{
+    typedef T Type;
+    static const size_t COUNT = 1;
+};
+
+template <typename T>
+struct Components<std::complex<T> >
+{
+    typedef T Type;
+    static const size_t COUNT = 2;
+};
+
+// Values are copied out of the input this many at a time, so they are
+// still in cache when they are converted after being swapped
+const size_t CONVERT_BLOCK_SIZE = 4096;
+
+// Each thread takes this many values at a time
+const size_t CONVERT_CHUNK_SIZE = 1024 * 1024;
+
+template <typename InputT, typename OutputT>
+void convertValues(const sys::byte* input, size_t numValues,
+                   OutputT* output, bool byteSwap)
+{
+    if (std::is_same<InputT, OutputT>::value)
+    {
+        memcpy(output, input, numValues * sizeof(InputT));
+        if (byteSwap)
+        {
+            swapBytes(output, sizeof(InputT), numValues);
+        }
+        return;
+    }
+
+    InputT values[CONVERT_BLOCK_SIZE];
+    for (size_t offset = 0; offset < numValues; offset += CONVERT_BLOCK_SIZE)
+    {
+        const size_t count =
+                std::min(CONVERT_BLOCK_SIZE, numValues - offset);
+        memcpy(values, input + offset * sizeof(InputT),
+               count * sizeof(InputT));
+        if (byteSwap)
+        {
+            swapBytes(values, sizeof(InputT), count);
+        }
+        OutputT* const out = output + offset;
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            out[ii] = static_cast<OutputT>(values[ii]);
+        }
+    }
+}
+
+//! Converts the ii'th chunk of values, for use with mt::runBalanced1D()
+template <typename InputT, typename OutputT>
+class ConvertOp
+{
+public:
+    ConvertOp(const sys::byte* input, size_t numValues, OutputT* output,
+              bool byteSwap) :
+        mInput(input),
+        mNumValues(numValues),
+        mOutput(output),
+        mByteSwap(byteSwap)
+    {
+    }
+
+    void operator()(size_t ii) const
+    {
+        const size_t offset = ii * CONVERT_CHUNK_SIZE;
+        convertValues<InputT, OutputT>(
+                mInput + offset * sizeof(InputT),
+                std::min(CONVERT_CHUNK_SIZE, mNumValues - offset),
+                mOutput + offset, mByteSwap);
+    }
+
+private:
+    const sys::byte* const mInput;
+    const size_t mNumValues;
+    OutputT* const mOutput;
+    const bool mByteSwap;
+};
+
+template <typename InputT, typename OutputT>
+void convert(const void* input, size_t numValues, OutputT* output,
+             bool byteSwap, size_t numThreads)
+{
+    const size_t numChunks =
+            (numValues + CONVERT_CHUNK_SIZE - 1) / CONVERT_CHUNK_SIZE;
+    if (numThreads == 0)
+    {
+        numThreads = sys::OS().getNumCPUs();
+    }
+    mt::runBalanced1D(numChunks, std::min(numThreads, numChunks),
+                      ConvertOp<InputT, OutputT>(
+                              static_cast<const sys::byte*>(input),
+                              numValues, output, byteSwap));
+}
+
+//! Dispatches on the type and size of the values in the file
+template <typename OutputT>
+bool convert(bool isSigned, bool isFloat, size_t valueSize,
+             const void* input, size_t numValues, OutputT* output,
+             bool byteSwap, size_t numThreads)
+{
+    if (isFloat)
+    {
+        switch (valueSize)
+        {
+        case 4:
+            convert<float>(input, numValues, output, byteSwap, numThreads);
+            return true;
+        case 8:
+            convert<double>(input, numValues, output, byteSwap, numThreads);
+            return true;
+        }
+    }
+    else if (isSigned)
+    {
+        switch (valueSize)
+        {
+        case 1:
+            convert<sys::Int8_T>(input, numValues, output, byteSwap,
+                                 numThreads);
+            return true;
+        case 2:
+            convert<sys::Int16_T>(input, numValues, output, byteSwap,
+                                  numThreads);
+            return true;
+        case 4:
+            convert<sys::Int32_T>(input, numValues, output, byteSwap,
+                                  numThreads);
+            return true;
+        case 8:
+            convert<sys::Int64_T>(input, numValues, output, byteSwap,
+                                  numThreads);
+            return true;
+        }
+    }
+    else
+    {
+        switch (valueSize)
+        {
+        case 1:
+            convert<sys::Uint8_T>(input, numValues, output, byteSwap,
+                                  numThreads);
+            return true;
+        case 2:
+            convert<sys::Uint16_T>(input, numValues, output, byteSwap,
+                                   numThreads);
+            return true;
+        case 4:
+            convert<sys::Uint32_T>(input, numValues, output, byteSwap,
+                                   numThreads);
+            return true;
+        case 8:
+            convert<sys::Uint64_T>(input, numValues, output, byteSwap,
+                                   numThreads);
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+/*!
+ *  \function convertElements
+ *  \brief Converts SIO elements, as they are in the file, to OutputT.
+ *
+ *  Each block of elements is byte swapped, if the file's byte order
+ *  differs from this machine's, and converted as static_cast would while
+ *  it is still in cache, so the data is only passed over once.  Large
+ *  payloads are split across threads.
+ *
+ *  Real elements convert to real types, and complex elements to complex
+ *  types: e.g. a complex signed SIO of 4-byte elements may be read as
+ *  std::complex<float>.
+ *
+ *  \param header The header of the SIO the elements came from
+ *  \param input The elements, which need not be aligned
+ *  \param numElements The number of elements
+ *  \param output Where to put the converted elements
+ *  \param numThreads Number of threads to use.  If 0, uses the number of
+ *         available CPUs.
+ *
+ *  \throws sio::lite::UnsupportedDataTypeException if the elements can't
+ *          be converted to OutputT
+ */
+template <typename OutputT>
+void convertElements(const FileHeader& header,
+                     const void* input,
+                     size_t numElements,
+                     OutputT* output,
+                     size_t numThreads = 0)
+{
+    typedef typename detail::Components<OutputT>::Type OutputValueT;
+    const size_t numComponents = detail::Components<OutputT>::COUNT;
+
+    const int type = header.getElementType();
+    const bool isComplex = type == FileHeader::COMPLEX_UNSIGNED ||
+            type == FileHeader::COMPLEX_SIGNED ||
+            type == FileHeader::COMPLEX_FLOAT;
+    const bool isKnown = isComplex || type == FileHeader::UNSIGNED ||
+            type == FileHeader::SIGNED || type == FileHeader::FLOAT;
+    const size_t valueSize = static_cast<size_t>(header.getElementSize()) /
+            (isComplex ? 2 : 1);
+
+    if (!isKnown || isComplex != (numComponents == 2) ||
+        !detail::convert(type == FileHeader::SIGNED ||
+                                 type == FileHeader::COMPLEX_SIGNED,
+                         type == FileHeader::FLOAT ||
+                                 type == FileHeader::COMPLEX_FLOAT,
+                         valueSize, input, numElements * numComponents,
+                         reinterpret_cast<OutputValueT*>(output),
+                         header.isDifferentByteOrdering(), numThreads))
+    {
+        std::ostringstream ostr;
+        ostr << "Can't convert " << header.getElementSize() << "-byte "
+             << header.getElementTypeAsString() << " elements to a "
+             << sizeof(OutputT) << "-byte "
+             << (numComponents == 2 ? "complex" : "real") << " type";
+        throw UnsupportedDataTypeException(Ctxt(ostr.str()));
+    }
+}
+}
+}
+
+#endif
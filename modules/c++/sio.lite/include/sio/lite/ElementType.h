@@ -23,6 +23,7 @@
 #ifndef __SIO_LITE_ELEMENT_TYPE_H__
 #define __SIO_LITE_ELEMENT_TYPE_H__
 
+#include <complex>
 #include <sys/Conf.h>
 #include <sio/lite/FileHeader.h>
 
@@ -75,6 +76,51 @@ struct ElementType<std::complex<double> >
 {
     static const size_t Type = sio::lite::FileHeader::COMPLEX_FLOAT;
 };
+template <>
+struct ElementType<std::complex<sys::Int8_T> >
+{
+    static const size_t Type = sio::lite::FileHeader::COMPLEX_SIGNED;
+};
+template <>
+struct ElementType<std::complex<sys::Int16_T> >
+{
+    static const size_t Type = sio::lite::FileHeader::COMPLEX_SIGNED;
+};
+template <>
+struct ElementType<std::complex<sys::Int32_T> >
+{
+    static const size_t Type = sio::lite::FileHeader::COMPLEX_SIGNED;
+};
+template <>
+struct ElementType<std::complex<sys::Uint8_T> >
+{
+    static const size_t Type = sio::lite::FileHeader::COMPLEX_UNSIGNED;
+};
+template <>
+struct ElementType<std::complex<sys::Uint16_T> >
+{
+    static const size_t Type = sio::lite::FileHeader::COMPLEX_UNSIGNED;
+};
+template <>
+struct ElementType<std::complex<sys::Uint32_T> >
+{
+    static const size_t Type = sio::lite::FileHeader::COMPLEX_UNSIGNED;
+};
+
+/*!
+ *  \function isElementType
+ *  \brief Checks whether an SIO holds elements of type T.
+ *
+ *  \param header The header of the SIO
+ *  \return True if both the element size and type match T
+ */
+template <typename T>
+bool isElementType(const sio::lite::FileHeader& header)
+{
+    return static_cast<size_t>(header.getElementSize()) == sizeof(T) &&
+           static_cast<size_t>(header.getElementType()) ==
+                   ElementType<T>::Type;
+}
 }
 }
 
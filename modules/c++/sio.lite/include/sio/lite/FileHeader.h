@@ -23,7 +23,9 @@
 #define __SIO_LITE_FILE_HEADER_H__
 
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <import/except.h>
 #include <import/sys.h>
@@ -69,10 +71,11 @@ public:
     FileHeader(int numLines, int numElements, int elementSize,
                int elementType, int ver = 1)
             : nl(numLines), ne(numElements), es(elementSize), et(elementType),
-            version(ver), nullTerminatedIds(true) {}
+            version(ver), nullTerminatedIds(true),
+            differentByteOrdering(false) {}
 
     FileHeader() : nl(0), ne(0), es(0), et(0), version(1),
-                 nullTerminatedIds(true){}
+                 nullTerminatedIds(true), differentByteOrdering(false){}
 
     //! Destructor.
     virtual ~FileHeader() {}
@@ -121,6 +124,13 @@ public:
      */
     std::string getElementTypeAsString() const;
 
+    /**
+     *  Byte swapping works on each component of a complex element and
+     *  leaves the bytes of N-byte elements alone.
+     *  @return The size of the values to byte swap in each element
+     */
+    size_t getSwapSize() const;
+
     /**
      *  This produces the file version.  Valid SIO versions appear
      *  to be
@@ -176,13 +186,65 @@ public:
      *  @return An array of user data for a given key
      */
     std::vector<sys::byte>& getUserData(const std::string& key);
+    const std::vector<sys::byte>& getUserData(const std::string& key) const;
+
+    /**
+     *  Get the size of the user data for a given user data ID, without
+     *  reading it if it was deferred
+     *  @return The number of bytes of user data
+     */
+    size_t getUserDataSize(const std::string& key) const;
 
     /**
-     *  Get back the whole hash table
+     *  Get back the whole hash table.  This reads any deferred fields.
      *  @return The hash table
      */
-    const sio::lite::UserDataDictionary& getUserDataSection() const{ return userData; }
-    sio::lite::UserDataDictionary& getUserDataSection() { return userData; }
+    const sio::lite::UserDataDictionary& getUserDataSection() const
+    {
+        loadUserData();
+        return userData;
+    }
+    sio::lite::UserDataDictionary& getUserDataSection()
+    {
+        loadUserData();
+        return userData;
+    }
+
+    /**
+     *  Where the user data fields that a StreamReader defers are read
+     *  from once they're asked for
+     */
+    class UserDataSource
+    {
+    public:
+        virtual ~UserDataSource() {}
+
+        /**
+         *  Read user data
+         *  @param offset Where the data is, in bytes from the start of
+         *         the file
+         *  @param buffer Output, size bytes
+         *  @param size The number of bytes to read
+         */
+        virtual void read(sys::Off_T offset, void* buffer, size_t size) = 0;
+    };
+
+    /**
+     *  Add a user data field whose value is left in the file until it is
+     *  asked for.  Looking fields up and getLength() don't read it.
+     *  @param field The ID of the field
+     *  @param offset Where the value is, in bytes from the start of the
+     *         file
+     *  @param size The size of the value in bytes
+     *  @param source Reads the value
+     */
+    void addDeferredUserData(const std::string& field,
+                             sys::Off_T offset,
+                             size_t size,
+                             const std::shared_ptr<UserDataSource>& source);
+
+    //! Read every deferred user data field
+    void loadUserData() const;
 
 
     //! Add a std::string user data field
@@ -190,6 +252,9 @@ public:
     //! Add a std::vector<sys::byte> user data field
     void addUserData(const std::string& field,
                      const std::vector<sys::byte>& data);
+    //! Add a std::vector<sys::byte> user data field without copying it
+    void addUserData(const std::string& field,
+                     std::vector<sys::byte>&& data);
     //! Add an int user data field
     void addUserData(const std::string& field, int data);
 
@@ -218,11 +283,25 @@ protected:
 
     /** A map representing user data and its corresponding ID keys */
     bool nullTerminatedIds;
-    sio::lite::UserDataDictionary userData;
+    mutable sio::lite::UserDataDictionary userData;
 
     /** Is our input file byte ordering different from our system's */
     bool differentByteOrdering;
 
+    /** A user data field that hasn't been read yet */
+    struct DeferredUserData
+    {
+        sys::Off_T offset;
+        size_t size;
+        std::shared_ptr<UserDataSource> source;
+    };
+
+    /** The fields in userData whose values haven't been read yet */
+    mutable std::unordered_map<std::string, DeferredUserData> deferredUserData;
+
+    /** Read one deferred user data field, if it is deferred */
+    void loadUserData(const std::string& key) const;
+
     /** Write the version2 user data */
     void writeUserData(io::OutputStream& os);
 };
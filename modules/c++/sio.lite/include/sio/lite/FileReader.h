@@ -22,6 +22,8 @@
 #ifndef __SIO_LITE_FILE_READER_H__
 #define __SIO_LITE_FILE_READER_H__
 
+#include <memory>
+#include <vector>
 #include <import/sys.h>
 #include <io/Seekable.h>
 #include <io/FileInputStream.h>
@@ -94,15 +96,23 @@ public:
     {
     }
 
-    FileReader(const std::string& file) :
-        StreamReader(new io::FileInputStream(file), true)
+    /*!
+     *  Open a file by pathname.  Besides the stream, this keeps a
+     *  handle of its own that readWindow() reads through by offset, so
+     *  windows may be read from several threads at once.
+     */
+    FileReader(const std::string& file,
+               UserDataPolicy policy = READ_USER_DATA) :
+        StreamReader(new io::FileInputStream(file), true, policy),
+        mFile(new sys::File(file))
     {
     }
 
 
     /**  Construct from stream  */
-    FileReader(io::FileInputStream* is, bool adopt = false) : 
-        StreamReader(is, adopt)
+    FileReader(io::FileInputStream* is, bool adopt = false,
+               UserDataPolicy policy = READ_USER_DATA) : 
+        StreamReader(is, adopt, policy)
     {
     }
 
@@ -137,8 +147,100 @@ public:
     sys::Off_T tell();
 
 
+    /*!
+     *  \return The number of bands: from the tile index of a tiled SIO,
+     *          and otherwise the size of the image data over the size of
+     *          one band
+     */
+    size_t getNumBands();
+
+    /*!
+     *  Read a rectangular window of one band into 'buffer', one row after
+     *  another with no padding.  Bands are laid out band-sequentially, so
+     *  band b starts b * nl * ne elements into the image data.  For N-byte
+     *  types every element holds all of its bands; pass band 0.
+     *
+     *  Full-width windows are one read.  Narrower windows read several
+     *  rows at a time, gaps included, as long as the gap between rows is
+     *  small, and otherwise read row by row.  In a tiled SIO, the rows of
+     *  the window that fall in each tile are one read.  In a compressed
+     *  SIO, each block that the window touches is read and decompressed
+     *  once.
+     *
+     *  If this reader was opened by pathname, the reads go by offset and
+     *  leave the stream alone, so concurrent calls are safe.  Otherwise
+     *  they go through the stream, which is left after the window's last
+     *  row.
+     *
+     *  \param buffer Output, numRows * numCols * es bytes
+     *  \param rowStart First line of the window
+     *  \param colStart First element of the window
+     *  \param numRows Number of lines to read
+     *  \param numCols Number of elements to read from each line
+     *  \param band The band to read from
+     *  \param byteSwap If true, swap the data to the native byte order
+     *
+     *  \throws except::Exception if the window is outside the image or
+     *          there is no such band
+     */
+    void readWindow(void* buffer,
+                    size_t rowStart,
+                    size_t colStart,
+                    size_t numRows,
+                    size_t numCols,
+                    size_t band = 0,
+                    bool byteSwap = true);
+
+    /*!
+     *  Read one tile of a tiled SIO, in any order.  This goes by offset
+     *  in the same way as readWindow().
+     *
+     *  \throws except::Exception if the SIO isn't tiled or there is no
+     *           such tile
+     */
+    virtual void readTile(void* buffer,
+                          size_t tileRow,
+                          size_t tileCol,
+                          size_t band = 0,
+                          bool byteSwap = true);
+
+    /*!
+     *  Read and decompress one block of a compressed SIO, in any order.
+     *  This goes by offset in the same way as readWindow().
+     *
+     *  \throws except::Exception if the SIO isn't compressed, there is no
+     *           such block, or it can't be decompressed
+     */
+    virtual void readBlock(void* buffer, size_t block, bool byteSwap = true);
+
     void killStream();
 protected:
+    //! readWindow() of a tiled SIO, without the byte swap
+    void readTiledWindow(sys::byte* buffer,
+                         size_t rowStart,
+                         size_t colStart,
+                         size_t numRows,
+                         size_t numCols,
+                         size_t band);
+
+    //! readWindow() of a compressed SIO, without the byte swap
+    void readCompressedWindow(sys::byte* buffer,
+                              size_t rowStart,
+                              size_t colStart,
+                              size_t numRows,
+                              size_t numCols,
+                              size_t band);
+
+    //! Read a block and decompress it into 'buffer', reading the
+    //! compressed block into 'compressed'
+    void readCompressedBlock(size_t block,
+                             std::vector<sys::byte>& compressed,
+                             void* buffer);
+
+    //! Read 'size' bytes 'offset' bytes past the header
+    void readAt(sys::Off_T offset, void* buffer, size_t size);
+
+    std::unique_ptr<sys::File> mFile;
 };
 }
 }
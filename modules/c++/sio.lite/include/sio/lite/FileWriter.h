@@ -28,6 +28,7 @@
 #include <import/io.h>
 #include "sio/lite/InvalidHeaderException.h"
 #include "sio/lite/FileHeader.h"
+#include "sio/lite/BlockIndex.h"
 
 
 namespace sio
@@ -94,6 +95,35 @@ public:
     void write(int numLines, int numElements, int elementSize,
                int elementType, const void* data, int numBands = 1);
 
+    /*!
+     * Writes a tiled SIO (see TileIndex) given the FileHeader and a buffer
+     * of raw data in band-sequential format.  The tile index is added to
+     * the header's user data.
+     */
+    void writeTiled(FileHeader* header, const void* data,
+                    size_t tileRows, size_t tileCols, int numBands = 1);
+
+    /*!
+     * Writes a compressed SIO (see BlockIndex) given the FileHeader and a
+     * buffer of raw data in band-sequential format.  The blocks are
+     * compressed on numThreads threads (0 for one per CPU) and held in
+     * memory until they are all done, since the block index has to go out
+     * in the header ahead of them.  The block index is added to the
+     * header's user data.
+     *
+     * \param blockSize Bytes of image data per block, rounded down to a
+     *        whole number of elements
+     * \param level 1 (fastest) to 9 (smallest), or
+     *        BlockIndex::DEFAULT_LEVEL
+     *
+     * \throws except::Exception if sio.lite was built without zlib
+     */
+    void writeCompressed(FileHeader* header, const void* data,
+                         int numBands = 1,
+                         size_t blockSize = BlockIndex::DEFAULT_BLOCK_SIZE,
+                         int level = BlockIndex::DEFAULT_LEVEL,
+                         size_t numThreads = 0);
+
 protected:
     std::string mFileName;
     std::unique_ptr<io::OutputStream> mStream;
@@ -104,34 +134,17 @@ protected:
 enum { AUTO = -1 };
 
 /*!
- *  Utility routine to write an image of type T into an SIO file format.  Supported
- *  types are complex<float>, float, double, byte unsigned and N-byte unsigned.
- *
- *  Sizes are deduced from the template type automatically (complex<float> = 8,
- *  double = 8, float = 4, and byte = 1, unless the es option is given, which
- *  should typically only be done for N-byte images (like RGB images).
- *
- *  Types are deduced from the template arguments as well, via the size operator
- *  (not explicitly).  This can be a good thing, but in the case of complex<float>
- *  vs. double for example, the element type is treated as COMPLEX_FLOAT.  This is
- *  clearly not the intent for a double, so an option element type can be given
- *  explicitly.
- *
- *  If this function fails to validate the input, it may throw an exception.
- *  If it does not, the SIO file is presumed to be correct.
+ *  Utility routine to make the header for an image of type T, guessing
+ *  the element size and type the way writeSIO() does (see below).
  *
- *  \param image Data to write (this really doesnt have to be an image at all)
  *  \param rows The number of rows in the data (nl in sio-speak)
  *  \param cols The number of cols in the data (ne in sio-speak)
  *  \param et The element type, which defaults to AUTO, in which this is guessed
  *  \param es The element size (in bytes), which defaults to AUTO, in which case
  *            it is guessed
- *
- *
  */
-template<typename T> void writeSIO(const T* image, size_t rows, size_t cols,
-                                   const std::string& imageFile,
-                                   int et = AUTO, int es = AUTO)
+template<typename T> FileHeader makeFileHeader(size_t rows, size_t cols,
+                                               int et = AUTO, int es = AUTO)
 {
 
     if (es == AUTO)
@@ -163,13 +176,44 @@ template<typename T> void writeSIO(const T* image, size_t rows, size_t cols,
         }
     }
 
-    io::FileOutputStream imageStream(imageFile);
+    return FileHeader(rows, cols, es, et);
+}
 
-    FileHeader fhdr(rows, cols, es, et);
-    fhdr.to(1, imageStream);
+/*!
+ *  Utility routine to write an image of type T into an SIO file format.  Supported
+ *  types are complex<float>, float, double, byte unsigned and N-byte unsigned.
+ *
+ *  Sizes are deduced from the template type automatically (complex<float> = 8,
+ *  double = 8, float = 4, and byte = 1, unless the es option is given, which
+ *  should typically only be done for N-byte images (like RGB images).
+ *
+ *  Types are deduced from the template arguments as well, via the size operator
+ *  (not explicitly).  This can be a good thing, but in the case of complex<float>
+ *  vs. double for example, the element type is treated as COMPLEX_FLOAT.  This is
+ *  clearly not the intent for a double, so an option element type can be given
+ *  explicitly.
+ *
+ *  If this function fails to validate the input, it may throw an exception.
+ *  If it does not, the SIO file is presumed to be correct.
+ *
+ *  \param image Data to write (this really doesnt have to be an image at all)
+ *  \param rows The number of rows in the data (nl in sio-speak)
+ *  \param cols The number of cols in the data (ne in sio-speak)
+ *  \param et The element type, which defaults to AUTO, in which this is guessed
+ *  \param es The element size (in bytes), which defaults to AUTO, in which case
+ *            it is guessed
+ *
+ *
+ */
+template<typename T> void writeSIO(const T* image, size_t rows, size_t cols,
+                                   const std::string& imageFile,
+                                   int et = AUTO, int es = AUTO)
+{
+    io::FileOutputStream imageStream(imageFile);
 
-    imageStream.write(reinterpret_cast<const sys::byte*>(image),
-                      rows * cols * es);
+    FileHeader fhdr = makeFileHeader<T>(rows, cols, et, es);
+    FileWriter writer(&imageStream, false);
+    writer.write(&fhdr, image);
 
     imageStream.close();
 }
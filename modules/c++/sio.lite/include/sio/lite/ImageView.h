@@ -0,0 +1,136 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIO_LITE_IMAGE_VIEW_H__
+#define __SIO_LITE_IMAGE_VIEW_H__
+
+#include <stddef.h>
+#include <sstream>
+#include <except/Exception.h>
+
+namespace sio
+{
+namespace lite
+{
+/*!
+ *  \class ImageView
+ *  \brief A read-only 2D view of elements owned by someone else
+ *
+ *  Rows are rowStride elements apart, so a view may cover a window of a
+ *  larger image without copying it.
+ */
+template <typename T>
+class ImageView
+{
+public:
+    ImageView() :
+        mData(NULL),
+        mNumRows(0),
+        mNumCols(0),
+        mRowStride(0)
+    {
+    }
+
+    ImageView(const T* data, size_t numRows, size_t numCols,
+              size_t rowStride) :
+        mData(data),
+        mNumRows(numRows),
+        mNumCols(numCols),
+        mRowStride(rowStride)
+    {
+    }
+
+    ImageView(const T* data, size_t numRows, size_t numCols) :
+        mData(data),
+        mNumRows(numRows),
+        mNumCols(numCols),
+        mRowStride(numCols)
+    {
+    }
+
+    const T* data() const
+    {
+        return mData;
+    }
+
+    size_t getNumRows() const
+    {
+        return mNumRows;
+    }
+
+    size_t getNumCols() const
+    {
+        return mNumCols;
+    }
+
+    //! The distance from one row to the next, in elements
+    size_t getRowStride() const
+    {
+        return mRowStride;
+    }
+
+    //! Whether the rows follow one another with no gaps
+    bool isContiguous() const
+    {
+        return mRowStride == mNumCols || mNumRows <= 1;
+    }
+
+    const T* row(size_t row) const
+    {
+        return mData + row * mRowStride;
+    }
+
+    const T& operator()(size_t row, size_t col) const
+    {
+        return mData[row * mRowStride + col];
+    }
+
+    /*!
+     *  A view of part of this one, sharing its elements
+     *
+     *  \throws except::Exception if the window is outside this view
+     */
+    ImageView window(size_t rowStart, size_t colStart,
+                     size_t numRows, size_t numCols) const
+    {
+        if (rowStart + numRows > mNumRows || colStart + numCols > mNumCols)
+        {
+            std::ostringstream ostr;
+            ostr << "Window of " << numRows << " x " << numCols << " at ("
+                 << rowStart << ", " << colStart << ") is outside the "
+                 << mNumRows << " x " << mNumCols << " view";
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+        return ImageView(row(rowStart) + colStart, numRows, numCols,
+                         mRowStride);
+    }
+
+private:
+    const T* mData;
+    size_t mNumRows;
+    size_t mNumCols;
+    size_t mRowStride;
+};
+}
+}
+
+#endif
@@ -0,0 +1,162 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIO_LITE_MMAP_READER_H__
+#define __SIO_LITE_MMAP_READER_H__
+
+#include <string>
+#include <vector>
+#include <import/except.h>
+#include <import/sys.h>
+#include <io/MMapInputStream.h>
+#include "sio/lite/FileHeader.h"
+#include "sio/lite/ElementType.h"
+#include "sio/lite/Convert.h"
+#include "sio/lite/ImageView.h"
+
+namespace sio
+{
+namespace lite
+{
+/*!
+ *  \class MMapReader
+ *  \brief Reads an SIO by memory mapping it
+ *
+ *  The header is parsed and checked against the file size when the file
+ *  is opened; the pixels aren't touched until they are looked at.  When
+ *  the file is in native byte order, getBand() returns a view straight
+ *  into the mapping.  Otherwise the band is swapped into a copy the
+ *  first time it is asked for, and later calls return that copy.  The
+ *  same happens if the header leaves the data misaligned for T.
+ *
+ *  Views are valid for the life of the reader.  The first getBand() of a
+ *  band that needs a copy must not race with other calls for that band.
+ *
+    \code
+
+    sio::lite::MMapReader reader("/path/to/file.sio");
+    sio::lite::ImageView<float> image = reader.getBand<float>();
+    float first = image(0, 0);
+
+    \endcode
+ */
+class MMapReader
+{
+public:
+    /*!
+     *  Map a file and parse its header
+     *
+     *  \throws sio::lite::InvalidHeaderException if the file is too small
+     *          for what its header describes
+     *  \throws except::Exception if the file is compressed (BlockIndex)
+     */
+    explicit MMapReader(const std::string& pathname);
+
+    const FileHeader& getHeader() const
+    {
+        return mHeader;
+    }
+
+    /*!
+     *  The number of whole bands in the file.  Bands follow one another,
+     *  nl * ne elements each.
+     */
+    size_t getNumBands() const
+    {
+        return mNumBands;
+    }
+
+    /*!
+     *  Get one band in native byte order
+     *
+     *  \param band The band to view
+     *  \throws except::Exception if the file doesn't hold T elements, as
+     *          readSIO() checks, or there is no such band
+     */
+    template <typename T>
+    ImageView<T> getBand(size_t band = 0)
+    {
+        if (!isElementType<T>(mHeader))
+        {
+            throw except::Exception(Ctxt("Unexpected format"));
+        }
+        return ImageView<T>(
+                reinterpret_cast<const T*>(getBandData(band, alignof(T))),
+                mHeader.getNumLines(), mHeader.getNumElements());
+    }
+
+    /*!
+     *  Convert one band to OutputT straight out of the mapping, swapping
+     *  it if need be.  Nothing is cached.  See convertElements().
+     *
+     *  \param output Where to put the band's nl * ne elements
+     *  \param band The band to convert
+     *  \param numThreads Number of threads to use.  If 0, uses the number
+     *         of available CPUs.
+     */
+    template <typename OutputT>
+    void readBand(OutputT* output, size_t band = 0,
+                  size_t numThreads = 0) const
+    {
+        convertElements(mHeader, getRawBand(band),
+                        static_cast<size_t>(mHeader.getNumLines()) *
+                                static_cast<size_t>(mHeader.getNumElements()),
+                        output, numThreads);
+    }
+
+    /*!
+     *  Whether getBand() hands out views of the mapping itself, rather
+     *  than of swapped or realigned copies
+     */
+    template <typename T>
+    bool isZeroCopy() const
+    {
+        return isZeroCopy(alignof(T));
+    }
+
+    //! Unmap the file.  Views into the mapping are no longer valid.
+    void close();
+
+private:
+    MMapReader(const MMapReader&);
+    MMapReader& operator=(const MMapReader&);
+
+    bool isZeroCopy(size_t alignment) const;
+
+    //! The band as it is in the file
+    const sys::byte* getRawBand(size_t band) const;
+
+    const sys::byte* getBandData(size_t band, size_t alignment);
+
+    io::MMapInputStream mStream;
+    FileHeader mHeader;
+    size_t mHeaderLength;
+    size_t mBandSize;
+    size_t mNumBands;
+
+    // Swapped or realigned copies, filled in as they are asked for
+    std::vector<std::vector<sys::byte> > mCopies;
+};
+}
+}
+
+#endif
@@ -31,6 +31,7 @@
 #include <sio/lite/FileReader.h>
 #include <sio/lite/FileHeader.h>
 #include <sio/lite/ElementType.h>
+#include <sio/lite/MMapReader.h>
 
 namespace sio
 {
@@ -54,8 +55,7 @@ void readSIO(const std::string& pathname,
     dims.row = header->getNumLines();
     dims.col = header->getNumElements();
 
-    if (header->getElementSize() != sizeof(InputT) ||
-        header->getElementType() != sio::lite::ElementType<InputT>::Type)
+    if (!sio::lite::isElementType<InputT>(*header))
     {
         throw except::Exception(Ctxt("Unexpected format"));
     }
@@ -65,6 +65,33 @@ void readSIO(const std::string& pathname,
     reader.read(image.get(), numPixels * sizeof(InputT), true);
 }
 
+/*
+ *  \function readAndConvertSIO
+ *  \brief Opens an SIO and converts its data to OutputT as it is read.
+ *
+ *  Unlike readSIO(), the file's elements need not be OutputTs; they are
+ *  converted, and byte swapped if need be, by convertElements().
+ *
+ *  \param pathname The location of the sio.
+ *  \param dims Output for the size of the sio.
+ *  \param image Output for the data.
+ *  \param numThreads Number of threads to use.  If 0, uses the number of
+ *         available CPUs.
+ */
+template <typename OutputT>
+void readAndConvertSIO(const std::string& pathname,
+                       types::RowCol<size_t>& dims,
+                       mem::ScopedArray<OutputT>& image,
+                       size_t numThreads = 0)
+{
+    const sio::lite::MMapReader reader(pathname);
+    dims.row = reader.getHeader().getNumLines();
+    dims.col = reader.getHeader().getNumElements();
+
+    image.reset(new OutputT[dims.row * dims.col]);
+    reader.readBand(image.get(), 0, numThreads);
+}
+
 /*
  *  \function readSIOVerifyDimensions
  *  \brief Opens an sio and ensures it is the same size as a passed in dims.
@@ -0,0 +1,157 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIO_LITE_ROW_WRITER_H__
+#define __SIO_LITE_ROW_WRITER_H__
+
+#include <memory>
+#include <string>
+#include <import/except.h>
+#include <import/sys.h>
+#include <io/AsyncOutputStream.h>
+#include <io/FileOutputStream.h>
+#include "sio/lite/FileHeader.h"
+
+namespace sio
+{
+namespace lite
+{
+/*!
+ *  \class RowWriter
+ *  \brief Writes an SIO a block of rows at a time, as they are produced
+ *
+ *  Rows are copied into a bounded buffer and written by a background
+ *  thread, so producing the next rows overlaps writing the last ones and
+ *  the image never has to be in memory all at once.  The number of lines
+ *  is counted as rows arrive and written into the header by close().
+ *
+ *  User data may be added to getHeader() at any time before close().  If
+ *  the header then no longer fits the space it had at the start, close()
+ *  has to move every row to make room; reserve space up front to avoid
+ *  that.  Reserved space that isn't used is filled with a padding user
+ *  data field, so readers see an ordinary header.  The field takes some
+ *  bytes of its own, so if less than that is left over, the rows move
+ *  too.
+ *
+    \code
+
+    sio::lite::RowWriter writer("out.sio",
+                                sio::lite::makeFileHeader<float>(0, cols));
+    while (produceRows(block, numRows))
+    {
+        writer.writeRows(&block[0], numRows);
+    }
+    writer.close();
+
+    \endcode
+ */
+class RowWriter
+{
+public:
+    //! The user data field that pads the header out to its reserved size
+    static const char* const PADDING_KEY;
+
+    /*!
+     *  Create the file and write a provisional header
+     *
+     *  \param pathname The file to write
+     *  \param header The header to start from.  Its number of lines is
+     *         ignored.
+     *  \param reservedUserDataSize Bytes to set aside in the header for
+     *         user data added after this
+     *  \param bufferSize The most bytes of rows waiting to be written
+     */
+    RowWriter(const std::string& pathname,
+              const FileHeader& header,
+              size_t reservedUserDataSize = 0,
+              size_t bufferSize = 4 * 1024 * 1024);
+
+    //! Closes the file if close() wasn't called, ignoring errors
+    ~RowWriter();
+
+    //! The header that close() will write
+    FileHeader& getHeader()
+    {
+        return mHeader;
+    }
+
+    //! \return The number of rows written so far
+    size_t getNumRows() const
+    {
+        return mNumRows;
+    }
+
+    /*!
+     *  Append rows.  They are copied, so the caller may reuse the buffer
+     *  as soon as this returns.  Blocks while the buffer is full.
+     *
+     *  \param rows numRows * ne * es bytes
+     *  \param numRows The number of rows
+     */
+    void writeRows(const void* rows, size_t numRows);
+
+    /*!
+     *  Append rows of T, as writeSIO() would write them
+     *
+     *  \throws except::Exception if T isn't the size of an element
+     */
+    template <typename T>
+    void writeRows(const T* rows, size_t numRows)
+    {
+        if (sizeof(T) != static_cast<size_t>(mHeader.getElementSize()))
+        {
+            throw except::Exception(Ctxt(FmtX(
+                    "Writing %d-byte values to an SIO of %d-byte elements",
+                    static_cast<int>(sizeof(T)),
+                    mHeader.getElementSize())));
+        }
+        writeRows(static_cast<const void*>(rows), numRows);
+    }
+
+    /*!
+     *  Wait for every row to be written, write the final header and close
+     *  the file
+     */
+    void close();
+
+private:
+    RowWriter(const RowWriter&);
+    RowWriter& operator=(const RowWriter&);
+
+    //! The header as it will be written, padded if there is room
+    FileHeader getFinalHeader(bool& fits) const;
+
+    //! Move the rows so that they start at newOffset instead
+    void moveRows(sys::File& file, sys::Off_T newOffset) const;
+
+    const std::string mPathname;
+    FileHeader mHeader;
+    const size_t mRowSize;
+    size_t mNumRows;
+    long mHeaderLength;
+    std::unique_ptr<io::FileOutputStream> mFile;
+    std::unique_ptr<io::AsyncOutputStream> mAsync;
+};
+}
+}
+
+#endif
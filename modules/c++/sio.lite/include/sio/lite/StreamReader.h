@@ -22,8 +22,11 @@
 #ifndef __SIO_LITE_STREAM_READER_H__
 #define __SIO_LITE_STREAM_READER_H__
 
+#include <memory>
 #include <io/InputStream.h>
 #include "sio/lite/FileHeader.h"
+#include "sio/lite/TileIndex.h"
+#include "sio/lite/BlockIndex.h"
 
 namespace sio
 {
@@ -90,9 +93,39 @@ namespace lite
 class StreamReader : public io::InputStream
 {
 public:
+    /**
+     *  How the user data in the header is read.  Files with many or
+     *  large user data fields open faster when the fields are deferred
+     *  or skipped.
+     */
+    enum UserDataPolicy
+    {
+        /** Read every field along with the rest of the header */
+        READ_USER_DATA,
+
+        /**
+         *  Note where each field is and read it when it is asked for
+         *  (see FileHeader::addDeferredUserData()).  Fields are read
+         *  through this reader's stream, so read any that are needed
+         *  before the reader goes away.  Small fields that come in
+         *  with the rest of the header are kept rather than deferred,
+         *  and streams that aren't Seekable are read as with
+         *  READ_USER_DATA.
+         */
+        DEFER_USER_DATA,
+
+        /**
+         *  Leave every field out of the header except sio.lite's own
+         *  (TileIndex and BlockIndex), for when only the dimensions
+         *  matter
+         */
+        SKIP_USER_DATA
+    };
+
     /** Constructor */
     StreamReader() : 
-        inputStream(NULL), header(NULL), headerLength(0), own(false) {}
+        inputStream(NULL), header(NULL), headerLength(0), own(false),
+        userDataPolicy(READ_USER_DATA), dataPosition(0) {}
 
     /** Destructor */
     virtual ~StreamReader()
@@ -106,8 +139,10 @@ public:
      *  which is probably not what you want unless you are passing
      *  an address.  This is for legacy compatibility.
      */
-    StreamReader(io::InputStream* is, bool adopt = false) : 
-        inputStream(is), header(NULL), headerLength(0), own(adopt)
+    StreamReader(io::InputStream* is, bool adopt = false,
+                 UserDataPolicy policy = READ_USER_DATA) : 
+        inputStream(is), header(NULL), headerLength(0), own(adopt),
+        userDataPolicy(policy), dataPosition(0)
     {
         // No longer calling setInputStream directly -- its virtual now
         parseHeader(true);
@@ -145,6 +180,56 @@ public:
         return inputStream->available();
     }
 
+    /*!
+     *  \return The layout of a tiled SIO, or NULL if its image data is
+     *          band-sequential
+     */
+    const TileIndex* getTileIndex() const { return tileIndex.get(); }
+
+    /*!
+     *  Read one tile of a tiled SIO.  A stream can't go back, so tiles
+     *  have to be read in the order they are stored (by band, tile row
+     *  and tile column, as TileIndex lays them out), although any may be
+     *  skipped.  Don't read the image data any other way in between.
+     *
+     *  \param buffer Output, TileIndex::getTileSize() bytes
+     *  \param tileRow The row of the tile in the grid of tiles
+     *  \param tileCol The column of the tile in the grid of tiles
+     *  \param band The band to read from
+     *  \param byteSwap If true, swap the data to the native byte order
+     *
+     *  \throws except::Exception if the SIO isn't tiled, there is no such
+     *           tile, or the stream is already past it
+     */
+    virtual void readTile(void* buffer,
+                          size_t tileRow,
+                          size_t tileCol,
+                          size_t band = 0,
+                          bool byteSwap = true);
+
+    /*!
+     *  \return The blocking of a compressed SIO, or NULL if its image
+     *          data is stored as it is.  read() returns the compressed
+     *          blocks of a compressed SIO as they are stored; use
+     *          readBlock() to get at the image.
+     */
+    const BlockIndex* getBlockIndex() const { return blockIndex.get(); }
+
+    /*!
+     *  Read and decompress one block of a compressed SIO.  As with
+     *  readTile(), blocks have to be read from a stream in the order they
+     *  are stored, although any may be skipped.
+     *
+     *  \param buffer Output, BlockIndex::getBlockDataSize() bytes
+     *  \param block The block to read
+     *  \param byteSwap If true, swap the data to the native byte order
+     *
+     *  \throws except::Exception if the SIO isn't compressed, there is no
+     *           such block, the stream is already past it, or it can't be
+     *           decompressed
+     */
+    virtual void readBlock(void* buffer, size_t block, bool byteSwap = true);
+
 protected:
     /**
      *  Implements the necessary function to make this
@@ -187,8 +272,9 @@ protected:
      *  It is only guaranteed to work on type 2, although
      *  it will probably successfully work on 3 as well.
      *
+     *  @return The length of the user data section in bytes
      */
-    void readType2Header();
+    long readType2Header();
 
     /**
      *  In C++, we have to check our system endian-ness
@@ -236,11 +322,42 @@ protected:
      */
     void parseHeader(bool calledFromConstructor = false);
 
+    //! \throws except::Exception if the SIO isn't tiled
+    const TileIndex& getTiles() const;
+
+    //! \throws except::Exception if the SIO isn't compressed
+    const BlockIndex& getBlocks() const;
+
+    /*!
+     *  Read forward through the image data to 'offset' bytes past the
+     *  header, for readTile() and readBlock()
+     *
+     *  \throws except::Exception if the stream is already past it
+     */
+    void skipTo(sys::Off_T offset);
+
+    //! Swap image data to the native byte order if it isn't already
+    void swapToNative(void* buffer, size_t size) const;
+
 
     io::InputStream* inputStream;
     FileHeader*  header;
     long headerLength;
     bool own;
+    UserDataPolicy userDataPolicy;
+
+    //! Reads deferred user data through inputStream
+    class UserDataStream;
+    std::shared_ptr<UserDataStream> userDataStream;
+
+    //! Set for a tiled SIO
+    std::unique_ptr<TileIndex> tileIndex;
+
+    //! Set for a compressed SIO
+    std::unique_ptr<BlockIndex> blockIndex;
+
+    //! How far readTile() and readBlock() have read into the image data
+    sys::Off_T dataPosition;
 };
 
 
@@ -0,0 +1,166 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIO_LITE_TILE_INDEX_H__
+#define __SIO_LITE_TILE_INDEX_H__
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <import/sys.h>
+#include "sio/lite/FileHeader.h"
+
+namespace sio
+{
+namespace lite
+{
+/*!
+ *  \class TileIndex
+ *  \brief Describes an SIO whose image data is stored a tile at a time
+ *
+ *  A tiled SIO has an ordinary header: nl, ne, es and et describe the
+ *  image as usual, and its image data is the same size as it would be
+ *  band-sequentially.  Only the order of the bytes differs.  Each band is
+ *  cut into tileRows x tileCols tiles, the tiles on the right and bottom
+ *  edges being cropped to the image, and each tile is stored row by row.
+ *  The USER_DATA_KEY user data field records the tiling along with the
+ *  offset of every tile from the start of the image data, so that any
+ *  tile can be read with one request.
+ *
+ *  The field holds 64-bit integers in the byte order of the rest of the
+ *  file: numRows, numCols, elementSize, tileRows, tileCols, numBands,
+ *  then the tile offsets by band, tile row and tile column.
+ */
+class TileIndex
+{
+public:
+    //! The user data field that marks a tiled SIO
+    static const char* const USER_DATA_KEY;
+
+    /*!
+     *  Lay out the tiles of an image one after another, by band, tile row
+     *  and tile column
+     *
+     *  \throws except::Exception if a tile dimension is 0
+     */
+    TileIndex(size_t numRows,
+              size_t numCols,
+              size_t elementSize,
+              size_t tileRows,
+              size_t tileCols,
+              size_t numBands = 1);
+
+    /*!
+     *  Read the index out of a header
+     *
+     *  \return NULL if the header isn't for a tiled SIO
+     *  \throws sio::lite::InvalidHeaderException if the field is
+     *          malformed, describes a different image than the header or
+     *          has tiles outside the image data
+     */
+    static std::unique_ptr<TileIndex> fromHeader(const FileHeader& header);
+
+    //! Record the index in a header's user data, in native byte order
+    void addTo(FileHeader& header) const;
+
+    size_t getNumRows() const
+    {
+        return mNumRows;
+    }
+
+    size_t getNumCols() const
+    {
+        return mNumCols;
+    }
+
+    size_t getElementSize() const
+    {
+        return mElementSize;
+    }
+
+    size_t getTileRows() const
+    {
+        return mTileRows;
+    }
+
+    size_t getTileCols() const
+    {
+        return mTileCols;
+    }
+
+    size_t getNumBands() const
+    {
+        return mNumBands;
+    }
+
+    //! \return The number of rows of tiles
+    size_t getNumTilesDown() const
+    {
+        return (mNumRows + mTileRows - 1) / mTileRows;
+    }
+
+    //! \return The number of columns of tiles
+    size_t getNumTilesAcross() const
+    {
+        return (mNumCols + mTileCols - 1) / mTileCols;
+    }
+
+    //! \return The rows in the tiles of a tile row, less at the bottom edge
+    size_t getTileNumRows(size_t tileRow) const
+    {
+        return std::min(mTileRows, mNumRows - tileRow * mTileRows);
+    }
+
+    //! \return The columns in the tiles of a tile column, less at the
+    //!         right edge
+    size_t getTileNumCols(size_t tileCol) const
+    {
+        return std::min(mTileCols, mNumCols - tileCol * mTileCols);
+    }
+
+    //! \return The size of a tile in bytes
+    size_t getTileSize(size_t tileRow, size_t tileCol) const
+    {
+        return getTileNumRows(tileRow) * getTileNumCols(tileCol) *
+                mElementSize;
+    }
+
+    /*!
+     *  \return Where a tile starts, in bytes from the start of the image
+     *          data
+     *  \throws except::Exception if there is no such tile
+     */
+    sys::Off_T getOffset(size_t tileRow, size_t tileCol,
+                         size_t band = 0) const;
+
+private:
+    size_t mNumRows;
+    size_t mNumCols;
+    size_t mElementSize;
+    size_t mTileRows;
+    size_t mTileCols;
+    size_t mNumBands;
+    std::vector<sys::Uint64_T> mOffsets;
+};
+}
+}
+
+#endif
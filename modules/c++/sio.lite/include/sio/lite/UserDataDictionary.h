@@ -24,8 +24,9 @@
 
 #include <import/except.h>
 #include <import/sys.h>
-#include <map>
 #include <list>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <string>
 
@@ -38,7 +39,8 @@ namespace lite
  * \class OrderedDictionary
  * 
  * An OrderedDictionary keeps track of the order that items are added to
- * the dictionary, allowing you to iterate in order.
+ * the dictionary, allowing you to iterate in order.  Values are stored
+ * once, in order, and looked up by hashing their key.
  * 
  * This class probably belongs in a utility library.
  * 
@@ -46,15 +48,32 @@ namespace lite
 template < typename Key_T, typename Value_T >
 class OrderedDictionary
 {
+public:
+    typedef typename std::list<std::pair<Key_T, Value_T> >::iterator Iterator;
+    typedef typename std::list<std::pair<Key_T, Value_T> >::const_iterator ConstIterator;
+
 protected:
     std::list< std::pair<Key_T, Value_T> > mList;
-    std::map < Key_T, Value_T > mMap;
+    std::unordered_map < Key_T, Iterator > mMap;
 
 public:
-    typedef typename std::list<std::pair<Key_T, Value_T> >::iterator Iterator;
-    typedef typename std::list<std::pair<Key_T, Value_T> >::const_iterator ConstIterator;
-    
     OrderedDictionary(){}
+
+    OrderedDictionary(const OrderedDictionary& other) : mList(other.mList)
+    {
+        index();
+    }
+
+    OrderedDictionary& operator=(const OrderedDictionary& other)
+    {
+        if (this != &other)
+        {
+            mList = other.mList;
+            index();
+        }
+        return *this;
+    }
+
     virtual ~OrderedDictionary(){}
 
     Iterator begin() { return mList.begin(); }
@@ -65,10 +84,20 @@ public:
 
     virtual Value_T& operator[] (const Key_T& key)
     {
-        typename std::map < Key_T, Value_T >::iterator it = mMap.find(key);
+        typename std::unordered_map < Key_T, Iterator >::iterator it =
+            mMap.find(key);
         if (it == mMap.end())
             throw except::NoSuchKeyException();
-        return it->second;
+        return it->second->second;
+    }
+
+    virtual const Value_T& operator[] (const Key_T& key) const
+    {
+        typename std::unordered_map < Key_T, Iterator >::const_iterator it =
+            mMap.find(key);
+        if (it == mMap.end())
+            throw except::NoSuchKeyException();
+        return it->second->second;
     }
 
     virtual bool exists(const Key_T& key) const
@@ -80,24 +109,37 @@ public:
     
     virtual void add(Key_T key, const Value_T& value)
     {
-        if (exists(key))
+        Value_T copy(value);
+        add(key, std::move(copy));
+    }
+
+    //! Add a value without copying it
+    void add(Key_T key, Value_T&& value)
+    {
+        remove(key);
+        mList.push_back(std::pair<Key_T, Value_T>(key, std::move(value)));
+        mMap[key] = --mList.end();
+    }
+
+    virtual void remove(const Key_T& key)
+    {
+        typename std::unordered_map < Key_T, Iterator >::iterator it =
+            mMap.find(key);
+        if (it != mMap.end())
         {
-            remove(key);
+            mList.erase(it->second);
+            mMap.erase(it);
         }
-        mMap[key] = value;
-        mList.push_back(std::pair<Key_T, Value_T>(key, value));
     }
 
-    virtual void remove(const Key_T& key)
+private:
+    //! Point the map at the entries of mList
+    void index()
     {
-        mMap.erase(key);
+        mMap.clear();
         for (Iterator it = begin(); it != end(); ++it)
         {
-            if (it->first == key)
-            {
-                mList.erase(it);
-                break;
-            }
+            mMap[it->first] = it;
         }
     }
 };
@@ -0,0 +1,237 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <sstream>
+#include "sio/lite/sio_lite_config.h"
+#include "sio/lite/BlockIndex.h"
+
+#ifdef SIO_LITE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+// compression, blockSize and dataSize
+const size_t NUM_FIELDS = 3;
+
+size_t getNumBlocks(sys::Uint64_T dataSize, size_t blockSize)
+{
+    return static_cast<size_t>((dataSize + blockSize - 1) / blockSize);
+}
+
+#ifndef SIO_LITE_HAVE_ZLIB
+void throwUnsupported()
+{
+    throw except::Exception(Ctxt(
+            "sio.lite was built without zlib, so it can't compress or "
+            "decompress image data"));
+}
+#endif
+}
+
+const char* const sio::lite::BlockIndex::USER_DATA_KEY = "sio.lite.blocks";
+
+sio::lite::BlockIndex::BlockIndex(sys::Uint64_T dataSize,
+                                  size_t blockSize,
+                                  Compression compression) :
+    mCompression(compression),
+    mBlockSize(blockSize),
+    mDataSize(dataSize)
+{
+    if (blockSize == 0)
+    {
+        throw except::Exception(Ctxt("Blocks must have a size"));
+    }
+    mOffsets.resize(::getNumBlocks(dataSize, blockSize) + 1, 0);
+}
+
+std::unique_ptr<sio::lite::BlockIndex>
+sio::lite::BlockIndex::fromHeader(const FileHeader& header)
+{
+    if (!header.userDataFieldExists(USER_DATA_KEY))
+    {
+        return std::unique_ptr<BlockIndex>();
+    }
+
+    const std::vector<sys::byte>& field =
+            header.getUserData(USER_DATA_KEY);
+    if (field.size() % sizeof(sys::Uint64_T) != 0 ||
+        field.size() < (NUM_FIELDS + 1) * sizeof(sys::Uint64_T))
+    {
+        throw InvalidHeaderException(Ctxt("Malformed block index"));
+    }
+
+    std::vector<sys::Uint64_T> values(field.size() / sizeof(sys::Uint64_T));
+    memcpy(&values[0], &field[0], field.size());
+    if (header.isDifferentByteOrdering())
+    {
+        sys::byteSwap(&values[0], sizeof(sys::Uint64_T), values.size());
+    }
+
+    if (values[0] != ZLIB)
+    {
+        std::ostringstream ostr;
+        ostr << "Unknown compression " << values[0] << " in block index";
+        throw InvalidHeaderException(Ctxt(ostr.str()));
+    }
+    const size_t blockSize = static_cast<size_t>(values[1]);
+    if (blockSize == 0)
+    {
+        throw InvalidHeaderException(Ctxt(
+                "Block index has blocks without a size"));
+    }
+
+    const sys::Uint64_T dataSize = values[2];
+    const size_t numBlocks = ::getNumBlocks(dataSize, blockSize);
+    if (values.size() - NUM_FIELDS != numBlocks + 1)
+    {
+        std::ostringstream ostr;
+        ostr << "Block index has " << values.size() - NUM_FIELDS - 1
+             << " offsets for " << numBlocks << " blocks";
+        throw InvalidHeaderException(Ctxt(ostr.str()));
+    }
+    if (!std::is_sorted(values.begin() + NUM_FIELDS, values.end()))
+    {
+        throw InvalidHeaderException(Ctxt(
+                "Block index has blocks out of order"));
+    }
+
+    std::unique_ptr<BlockIndex> index(new BlockIndex(
+            dataSize, blockSize, static_cast<Compression>(values[0])));
+    index->mOffsets.assign(values.begin() + NUM_FIELDS, values.end());
+    return index;
+}
+
+void sio::lite::BlockIndex::addTo(FileHeader& header) const
+{
+    std::vector<sys::Uint64_T> values;
+    values.reserve(NUM_FIELDS + mOffsets.size());
+    values.push_back(mCompression);
+    values.push_back(mBlockSize);
+    values.push_back(mDataSize);
+    values.insert(values.end(), mOffsets.begin(), mOffsets.end());
+
+    const sys::byte* const bytes =
+            reinterpret_cast<const sys::byte*>(&values[0]);
+    header.addUserData(USER_DATA_KEY, std::vector<sys::byte>(
+            bytes, bytes + values.size() * sizeof(sys::Uint64_T)));
+}
+
+bool sio::lite::BlockIndex::isSupported()
+{
+#ifdef SIO_LITE_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+sys::Off_T sio::lite::BlockIndex::getOffset(size_t block) const
+{
+    if (block >= getNumBlocks())
+    {
+        std::ostringstream ostr;
+        ostr << "No block " << block << " of " << getNumBlocks();
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    return static_cast<sys::Off_T>(mOffsets[block]);
+}
+
+size_t sio::lite::BlockIndex::getCompressedSize(size_t block) const
+{
+    return static_cast<size_t>(mOffsets[block + 1] - getOffset(block));
+}
+
+void sio::lite::BlockIndex::setCompressedSizes(
+        const std::vector<size_t>& sizes)
+{
+    if (sizes.size() != getNumBlocks())
+    {
+        std::ostringstream ostr;
+        ostr << sizes.size() << " compressed sizes given for "
+             << getNumBlocks() << " blocks";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    for (size_t ii = 0; ii < sizes.size(); ++ii)
+    {
+        mOffsets[ii + 1] = mOffsets[ii] + sizes[ii];
+    }
+}
+
+#ifdef SIO_LITE_HAVE_ZLIB
+void sio::lite::BlockIndex::compressBlock(const void* data,
+                                          size_t block,
+                                          std::vector<sys::byte>& compressed,
+                                          int level) const
+{
+    const size_t size = getBlockDataSize(block);
+    uLongf compressedSize = compressBound(static_cast<uLong>(size));
+    compressed.resize(compressedSize);
+    const int rv = compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                             &compressedSize,
+                             static_cast<const Bytef*>(data),
+                             static_cast<uLong>(size), level);
+    if (rv != Z_OK)
+    {
+        std::ostringstream ostr;
+        ostr << "Failed to compress block " << block << ": zlib error "
+             << rv;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    compressed.resize(compressedSize);
+}
+
+void sio::lite::BlockIndex::decompressBlock(const void* compressed,
+                                            size_t block,
+                                            void* data) const
+{
+    const size_t size = getBlockDataSize(block);
+    uLongf dataSize = static_cast<uLongf>(size);
+    const int rv = uncompress(static_cast<Bytef*>(data), &dataSize,
+                              static_cast<const Bytef*>(compressed),
+                              static_cast<uLong>(getCompressedSize(block)));
+    if (rv != Z_OK || dataSize != size)
+    {
+        std::ostringstream ostr;
+        ostr << "Block " << block << " of the image data is corrupt";
+        if (rv != Z_OK)
+        {
+            ostr << ": zlib error " << rv;
+        }
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+#else
+void sio::lite::BlockIndex::compressBlock(const void*,
+                                          size_t,
+                                          std::vector<sys::byte>&,
+                                          int) const
+{
+    throwUnsupported();
+}
+
+void sio::lite::BlockIndex::decompressBlock(const void*, size_t, void*) const
+{
+    throwUnsupported();
+}
+#endif
@@ -0,0 +1,173 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <algorithm>
+#include "sio/lite/Convert.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+        (defined(__GNUC__) || defined(__clang__))
+#define SIO_LITE_SSSE3 1
+#define SIO_LITE_SSSE3_TARGET __attribute__((target("ssse3")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SIO_LITE_SSSE3 1
+#define SIO_LITE_SSSE3_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+// Compilers turn these into a single byte swap instruction
+inline sys::Uint16_T swapValue(sys::Uint16_T value)
+{
+    return static_cast<sys::Uint16_T>((value >> 8) | (value << 8));
+}
+
+inline sys::Uint32_T swapValue(sys::Uint32_T value)
+{
+    return (value >> 24) | ((value >> 8) & 0x0000ff00) |
+            ((value << 8) & 0x00ff0000) | (value << 24);
+}
+
+inline sys::Uint64_T swapValue(sys::Uint64_T value)
+{
+    return (static_cast<sys::Uint64_T>(
+                    swapValue(static_cast<sys::Uint32_T>(value))) << 32) |
+            swapValue(static_cast<sys::Uint32_T>(value >> 32));
+}
+
+template <typename T>
+void swapScalar(sys::byte* data, size_t numElems)
+{
+    for (size_t ii = 0; ii < numElems; ++ii, data += sizeof(T))
+    {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        value = swapValue(value);
+        memcpy(data, &value, sizeof(T));
+    }
+}
+
+#ifdef SIO_LITE_SSSE3
+bool hasSSSE3()
+{
+    // CPUID leaf 1, ECX bit 9
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+#endif
+    return (ecx & (1 << 9)) != 0;
+}
+
+/*
+ *  Swaps whole 16-byte vectors of elemSize-byte values with PSHUFB.
+ *  Returns the number of bytes swapped, which leaves fewer than 16.
+ */
+SIO_LITE_SSSE3_TARGET
+size_t swapSSSE3(sys::byte* data, size_t elemSize, size_t numBytes)
+{
+    __m128i mask;
+    switch (elemSize)
+    {
+    case 2:
+        mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                             9, 8, 11, 10, 13, 12, 15, 14);
+        break;
+    case 4:
+        mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                             11, 10, 9, 8, 15, 14, 13, 12);
+        break;
+    default:
+        mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                             15, 14, 13, 12, 11, 10, 9, 8);
+        break;
+    }
+
+    size_t offset = 0;
+    for (; offset + 64 <= numBytes; offset += 64)
+    {
+        __m128i* const ptr = reinterpret_cast<__m128i*>(data + offset);
+        const __m128i one = _mm_loadu_si128(ptr);
+        const __m128i two = _mm_loadu_si128(ptr + 1);
+        const __m128i three = _mm_loadu_si128(ptr + 2);
+        const __m128i four = _mm_loadu_si128(ptr + 3);
+        _mm_storeu_si128(ptr, _mm_shuffle_epi8(one, mask));
+        _mm_storeu_si128(ptr + 1, _mm_shuffle_epi8(two, mask));
+        _mm_storeu_si128(ptr + 2, _mm_shuffle_epi8(three, mask));
+        _mm_storeu_si128(ptr + 3, _mm_shuffle_epi8(four, mask));
+    }
+    for (; offset + 16 <= numBytes; offset += 16)
+    {
+        __m128i* const ptr = reinterpret_cast<__m128i*>(data + offset);
+        _mm_storeu_si128(ptr, _mm_shuffle_epi8(_mm_loadu_si128(ptr), mask));
+    }
+    return offset;
+}
+#endif
+}
+
+void sio::lite::swapBytes(void* buffer, size_t elemSize, size_t numElems)
+{
+    sys::byte* data = static_cast<sys::byte*>(buffer);
+    if (elemSize != 2 && elemSize != 4 && elemSize != 8)
+    {
+        if (elemSize > 1)
+        {
+            sys::byteSwap(data, static_cast<unsigned short>(elemSize),
+                          numElems);
+        }
+        return;
+    }
+
+#ifdef SIO_LITE_SSSE3
+    static const bool ssse3 = hasSSSE3();
+    if (ssse3)
+    {
+        const size_t numBytes = swapSSSE3(data, elemSize,
+                                          numElems * elemSize);
+        data += numBytes;
+        numElems -= numBytes / elemSize;
+    }
+#endif
+
+    switch (elemSize)
+    {
+    case 2:
+        swapScalar<sys::Uint16_T>(data, numElems);
+        break;
+    case 4:
+        swapScalar<sys::Uint32_T>(data, numElems);
+        break;
+    default:
+        swapScalar<sys::Uint64_T>(data, numElems);
+        break;
+    }
+}
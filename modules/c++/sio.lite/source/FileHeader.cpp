@@ -61,6 +61,22 @@ std::string sio::lite::FileHeader::getElementTypeAsString() const
     return type;
 }
 
+size_t sio::lite::FileHeader::getSwapSize() const
+{
+    switch ( et )
+    {
+        case COMPLEX_UNSIGNED:
+        case COMPLEX_SIGNED:
+        case COMPLEX_FLOAT:
+            return es / 2;
+        case N_BYTE_UNSIGNED:
+        case N_BYTE_SIGNED:
+            return 1;
+        default:
+            return es;
+    }
+}
+
 long sio::lite::FileHeader::getLength() const
 {
     long length = SIO_HEADER_LENGTH;
@@ -75,7 +91,7 @@ long sio::lite::FileHeader::getLength() const
         if (idsAreNullTerminated())
             length += 1; //1 (null-byte)
         length += 4; //data size
-        length += it->second.size(); //num bytes of data
+        length += getUserDataSize(it->first); //num bytes of data
     }
     return length;
 }
@@ -98,9 +114,63 @@ std::vector<sys::byte>& sio::lite::FileHeader::getUserData(const std::string& ke
 {
     if (!userData.exists(key))
         throw except::NoSuchKeyException(key);
+    loadUserData(key);
     return userData[key];
 }
 
+const std::vector<sys::byte>&
+sio::lite::FileHeader::getUserData(const std::string& key) const
+{
+    if (!userData.exists(key))
+        throw except::NoSuchKeyException(key);
+    loadUserData(key);
+    return userData[key];
+}
+
+size_t sio::lite::FileHeader::getUserDataSize(const std::string& key) const
+{
+    std::unordered_map<std::string, DeferredUserData>::const_iterator it =
+        deferredUserData.find(key);
+    if (it != deferredUserData.end())
+        return it->second.size;
+    if (!userData.exists(key))
+        throw except::NoSuchKeyException(key);
+    return userData[key].size();
+}
+
+void sio::lite::FileHeader::addDeferredUserData(
+    const std::string& field,
+    sys::Off_T offset,
+    size_t size,
+    const std::shared_ptr<UserDataSource>& source)
+{
+    userData.add(field, std::vector<sys::byte>());
+    DeferredUserData& deferred = deferredUserData[field];
+    deferred.offset = offset;
+    deferred.size = size;
+    deferred.source = source;
+}
+
+void sio::lite::FileHeader::loadUserData(const std::string& key) const
+{
+    std::unordered_map<std::string, DeferredUserData>::iterator it =
+        deferredUserData.find(key);
+    if (it == deferredUserData.end())
+        return;
+
+    std::vector<sys::byte>& value = userData[key];
+    value.resize(it->second.size);
+    if (!value.empty())
+        it->second.source->read(it->second.offset, &value[0], value.size());
+    deferredUserData.erase(it);
+}
+
+void sio::lite::FileHeader::loadUserData() const
+{
+    while (!deferredUserData.empty())
+        loadUserData(deferredUserData.begin()->first);
+}
+
 
 void sio::lite::FileHeader::to(size_t numBands, io::OutputStream& os)
 {
@@ -158,6 +228,7 @@ void sio::lite::FileHeader::to(size_t numBands, io::OutputStream& os)
 
 void sio::lite::FileHeader::writeUserData(io::OutputStream& os)
 {
+    loadUserData();
     int numFields = userData.size();
     os.write((const sys::byte*)&numFields, 4);
 
@@ -175,18 +246,15 @@ void sio::lite::FileHeader::writeUserData(io::OutputStream& os)
         os.write((const sys::byte*)&udSize, 4);
 
         //Do we need to check for endian-ness and possibly byteswap???
-        for (std::vector<sys::byte>::iterator iter = uData.begin();
-                iter != uData.end(); ++iter)
-        {
-            sys::byte x = *iter;
-            os.write(&x, 1);
-        }
+        if (!uData.empty())
+            os.write(&uData[0], uData.size());
     }
 }
 
 void sio::lite::FileHeader::addUserData(const std::string& field,
                                         const std::string& data)
 {
+    deferredUserData.erase(field);
     const sys::byte* const begin =
         reinterpret_cast<const sys::byte*>(data.c_str());
 
@@ -198,11 +266,20 @@ void sio::lite::FileHeader::addUserData(const std::string& field,
 void sio::lite::FileHeader::addUserData(const std::string& field,
                                         const std::vector<sys::byte>& data)
 {
+    deferredUserData.erase(field);
     userData.add(field, data);
 }
 
+void sio::lite::FileHeader::addUserData(const std::string& field,
+                                        std::vector<sys::byte>&& data)
+{
+    deferredUserData.erase(field);
+    userData.add(field, std::move(data));
+}
+
 void sio::lite::FileHeader::addUserData(const std::string& field, int data)
 {
+    deferredUserData.erase(field);
     std::vector<sys::byte> vec;
     char* cData = (char*)&data;
     for (int i = 0, size = sizeof(int); i < size; ++i)
@@ -19,8 +19,23 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "sio/lite/Convert.h"
 #include "sio/lite/FileReader.h"
 
+namespace
+{
+// Rows of a window narrower than the image are read several at a time when
+// the bytes between them are no more than this, since reading the gap is
+// cheaper than another request
+const size_t MAX_COALESCED_GAP = 64 * 1024;
+
+// Bounds the buffer that coalesced rows are read into
+const size_t MAX_STAGING_SIZE = 4 * 1024 * 1024;
+}
+
 sys::Off_T sio::lite::FileReader::seek( sys::Off_T offset, Whence whence )
 {
     if (whence == START)
@@ -45,3 +60,289 @@ void sio::lite::FileReader::killStream()
     }
 }
 
+
+void sio::lite::FileReader::readAt(sys::Off_T offset, void* buffer,
+                                   size_t size)
+{
+    if (mFile.get())
+    {
+        mFile->readAt(buffer, size, headerLength + offset);
+    }
+    else
+    {
+        seek(offset, START);
+        read(buffer, size, true);
+    }
+}
+
+size_t sio::lite::FileReader::getNumBands()
+{
+    if (tileIndex.get())
+    {
+        return tileIndex->getNumBands();
+    }
+
+    const sys::Uint64_T bandSize =
+            static_cast<sys::Uint64_T>(header->getNumLines()) *
+            static_cast<sys::Uint64_T>(header->getNumElements()) *
+            static_cast<sys::Uint64_T>(header->getElementSize());
+    if (bandSize == 0)
+    {
+        return 1;
+    }
+
+    sys::Uint64_T dataSize = 0;
+    if (blockIndex.get())
+    {
+        dataSize = blockIndex->getDataSize();
+    }
+    else if (mFile.get())
+    {
+        const sys::Off_T length = mFile->length();
+        dataSize = (length > headerLength) ?
+                static_cast<sys::Uint64_T>(length - headerLength) : 0;
+    }
+    else
+    {
+        dataSize = static_cast<sys::Uint64_T>(tell() + available());
+    }
+    return static_cast<size_t>(dataSize / bandSize);
+}
+
+void sio::lite::FileReader::readWindow(void* buffer,
+                                       size_t rowStart,
+                                       size_t colStart,
+                                       size_t numRows,
+                                       size_t numCols,
+                                       size_t band,
+                                       bool byteSwap)
+{
+    const bool tiled = tileIndex.get() != NULL;
+    const size_t nl = tiled ? tileIndex->getNumRows() :
+            static_cast<size_t>(header->getNumLines());
+    const size_t ne = tiled ? tileIndex->getNumCols() :
+            static_cast<size_t>(header->getNumElements());
+    const size_t es = static_cast<size_t>(header->getElementSize());
+
+    if (rowStart + numRows > nl || colStart + numCols > ne)
+    {
+        std::ostringstream ostr;
+        ostr << "Window of " << numRows << " x " << numCols << " at ("
+             << rowStart << ", " << colStart << ") is outside the "
+             << nl << " x " << ne << " image";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    const size_t numBands = getNumBands();
+    if (band >= numBands)
+    {
+        std::ostringstream ostr;
+        ostr << "Band " << band << " requested from an SIO with "
+             << numBands << " bands";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    if (numRows == 0 || numCols == 0)
+    {
+        return;
+    }
+
+    sys::byte* const out = static_cast<sys::byte*>(buffer);
+    if (blockIndex.get())
+    {
+        readCompressedWindow(out, rowStart, colStart, numRows, numCols,
+                             band);
+        if (byteSwap)
+        {
+            swapToNative(out, numRows * numCols * es);
+        }
+        return;
+    }
+    if (tiled)
+    {
+        readTiledWindow(out, rowStart, colStart, numRows, numCols, band);
+        if (byteSwap)
+        {
+            swapToNative(out, numRows * numCols * es);
+        }
+        return;
+    }
+
+    const size_t rowSize = ne * es;
+    const size_t windowRowSize = numCols * es;
+    const sys::Off_T offset =
+            (static_cast<sys::Off_T>(band) * nl + rowStart) * rowSize +
+            static_cast<sys::Off_T>(colStart) * es;
+
+    if (numCols == ne)
+    {
+        readAt(offset, out, numRows * rowSize);
+    }
+    else if (rowSize - windowRowSize <= MAX_COALESCED_GAP)
+    {
+        const size_t rowsPerRead = std::min(
+                numRows, std::max<size_t>(MAX_STAGING_SIZE / rowSize, 1));
+        std::vector<sys::byte> staging(
+                (rowsPerRead - 1) * rowSize + windowRowSize);
+
+        for (size_t row = 0; row < numRows; row += rowsPerRead)
+        {
+            const size_t rows = std::min(rowsPerRead, numRows - row);
+            readAt(offset + static_cast<sys::Off_T>(row) * rowSize,
+                   &staging[0], (rows - 1) * rowSize + windowRowSize);
+            for (size_t ii = 0; ii < rows; ++ii)
+            {
+                memcpy(out + (row + ii) * windowRowSize,
+                       &staging[ii * rowSize], windowRowSize);
+            }
+        }
+    }
+    else
+    {
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            readAt(offset + static_cast<sys::Off_T>(row) * rowSize,
+                   out + row * windowRowSize, windowRowSize);
+        }
+    }
+
+    if (byteSwap)
+    {
+        swapToNative(out, numRows * windowRowSize);
+    }
+}
+
+void sio::lite::FileReader::readTiledWindow(sys::byte* buffer,
+                                            size_t rowStart,
+                                            size_t colStart,
+                                            size_t numRows,
+                                            size_t numCols,
+                                            size_t band)
+{
+    const TileIndex& tiles = *tileIndex;
+    const size_t es = tiles.getElementSize();
+    const size_t windowRowSize = numCols * es;
+    std::vector<sys::byte> staging;
+
+    const size_t firstTileRow = rowStart / tiles.getTileRows();
+    const size_t lastTileRow = (rowStart + numRows - 1) / tiles.getTileRows();
+    const size_t firstTileCol = colStart / tiles.getTileCols();
+    const size_t lastTileCol = (colStart + numCols - 1) / tiles.getTileCols();
+    for (size_t tileRow = firstTileRow; tileRow <= lastTileRow; ++tileRow)
+    {
+        // The rows of this tile row that are in the window, in image
+        // coordinates
+        const size_t tileTop = tileRow * tiles.getTileRows();
+        const size_t top = std::max(rowStart, tileTop);
+        const size_t bottom = std::min(rowStart + numRows,
+                                       tileTop + tiles.getTileRows());
+
+        for (size_t tileCol = firstTileCol; tileCol <= lastTileCol;
+             ++tileCol)
+        {
+            const size_t tileLeft = tileCol * tiles.getTileCols();
+            const size_t left = std::max(colStart, tileLeft);
+            const size_t right = std::min(colStart + numCols,
+                                          tileLeft + tiles.getTileCols());
+            const size_t tileRowSize = tiles.getTileNumCols(tileCol) * es;
+            const size_t copySize = (right - left) * es;
+
+            // Read every row of the tile that the window needs, whole
+            staging.resize((bottom - top) * tileRowSize);
+            readAt(tiles.getOffset(tileRow, tileCol, band) +
+                           static_cast<sys::Off_T>(top - tileTop) *
+                                   tileRowSize,
+                   &staging[0], staging.size());
+
+            for (size_t row = top; row < bottom; ++row)
+            {
+                memcpy(buffer + (row - rowStart) * windowRowSize +
+                               (left - colStart) * es,
+                       &staging[(row - top) * tileRowSize +
+                                (left - tileLeft) * es],
+                       copySize);
+            }
+        }
+    }
+}
+
+void sio::lite::FileReader::readTile(void* buffer,
+                                     size_t tileRow,
+                                     size_t tileCol,
+                                     size_t band,
+                                     bool byteSwap)
+{
+    const TileIndex& tiles = getTiles();
+    const size_t size = tiles.getTileSize(tileRow, tileCol);
+    readAt(tiles.getOffset(tileRow, tileCol, band), buffer, size);
+    if (byteSwap)
+    {
+        swapToNative(buffer, size);
+    }
+}
+
+void sio::lite::FileReader::readCompressedWindow(sys::byte* buffer,
+                                                 size_t rowStart,
+                                                 size_t colStart,
+                                                 size_t numRows,
+                                                 size_t numCols,
+                                                 size_t band)
+{
+    const BlockIndex& blocks = *blockIndex;
+    const sys::Uint64_T nl = static_cast<sys::Uint64_T>(header->getNumLines());
+    const sys::Uint64_T ne =
+            static_cast<sys::Uint64_T>(header->getNumElements());
+    const size_t es = static_cast<size_t>(header->getElementSize());
+    const size_t windowRowSize = numCols * es;
+
+    // Rows go forward through the image data, so only the block being
+    // copied from needs to be kept
+    std::vector<sys::byte> compressed;
+    std::vector<sys::byte> data(blocks.getBlockSize());
+    size_t current = blocks.getNumBlocks();
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        sys::Uint64_T offset = ((band * nl + rowStart + row) * ne +
+                                colStart) * es;
+        sys::byte* out = buffer + row * windowRowSize;
+        size_t remaining = windowRowSize;
+        while (remaining > 0)
+        {
+            const size_t block = blocks.getBlock(offset);
+            if (block != current)
+            {
+                readCompressedBlock(block, compressed, &data[0]);
+                current = block;
+            }
+
+            const size_t start = static_cast<size_t>(
+                    offset - static_cast<sys::Uint64_T>(block) *
+                                     blocks.getBlockSize());
+            const size_t numBytes = std::min(
+                    remaining, blocks.getBlockDataSize(block) - start);
+            memcpy(out, &data[start], numBytes);
+            out += numBytes;
+            offset += numBytes;
+            remaining -= numBytes;
+        }
+    }
+}
+
+void sio::lite::FileReader::readCompressedBlock(
+        size_t block, std::vector<sys::byte>& compressed, void* buffer)
+{
+    const BlockIndex& blocks = getBlocks();
+    compressed.resize(blocks.getCompressedSize(block));
+    readAt(blocks.getOffset(block), compressed.data(), compressed.size());
+    blocks.decompressBlock(compressed.data(), block, buffer);
+}
+
+void sio::lite::FileReader::readBlock(void* buffer,
+                                      size_t block,
+                                      bool byteSwap)
+{
+    std::vector<sys::byte> compressed;
+    readCompressedBlock(block, compressed, buffer);
+    if (byteSwap)
+    {
+        swapToNative(buffer, getBlocks().getBlockDataSize(block));
+    }
+}
@@ -19,7 +19,41 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <string.h>
+#include <mt/BalancedRunnable1D.h>
 #include "sio/lite/FileWriter.h"
+#include "sio/lite/TileIndex.h"
+
+namespace
+{
+//! Compresses the ii'th block, for use with mt::runBalanced1D()
+class CompressOp
+{
+public:
+    CompressOp(const sio::lite::BlockIndex& blocks,
+               const sys::byte* data,
+               int level,
+               std::vector<std::vector<sys::byte> >& compressed) :
+        mBlocks(blocks),
+        mData(data),
+        mLevel(level),
+        mCompressed(compressed)
+    {
+    }
+
+    void operator()(size_t ii) const
+    {
+        mBlocks.compressBlock(mData + ii * mBlocks.getBlockSize(), ii,
+                              mCompressed[ii], mLevel);
+    }
+
+private:
+    const sio::lite::BlockIndex& mBlocks;
+    const sys::byte* const mData;
+    const int mLevel;
+    std::vector<std::vector<sys::byte> >& mCompressed;
+};
+}
 
 void sio::lite::FileWriter::write(sio::lite::FileHeader* header, std::vector<io::InputStream*> bandStreams)
 {
@@ -43,12 +77,22 @@ void sio::lite::FileWriter::write(sio::lite::FileHeader* header,
                                   const void* data,
                                   int numBands)
 {
-    header->to(numBands, *mStream); //write header
-    mStream->write(static_cast<const sys::byte*>(data),
-                   static_cast<size_t>(header->getNumLines()) *
-                            static_cast<size_t>(header->getNumElements()) *
-                            static_cast<size_t>(header->getElementSize()) *
-                            static_cast<size_t>(numBands));
+    //serialize the header up front so it goes out with the bands in a
+    //single gather write
+    io::ByteStream headerStream;
+    header->to(numBands, headerStream);
+
+    std::vector<mem::BufferView<const sys::byte> > buffers(2);
+    buffers[0] = mem::BufferView<const sys::byte>(
+            reinterpret_cast<const sys::byte*>(headerStream.get()),
+            headerStream.getSize());
+    buffers[1] = mem::BufferView<const sys::byte>(
+            static_cast<const sys::byte*>(data),
+            static_cast<size_t>(header->getNumLines()) *
+                    static_cast<size_t>(header->getNumElements()) *
+                    static_cast<size_t>(header->getElementSize()) *
+                    static_cast<size_t>(numBands));
+    mStream->write(buffers);
 }
 
 void sio::lite::FileWriter::write(int numLines, int numElements, int elementSize,
@@ -58,3 +102,104 @@ void sio::lite::FileWriter::write(int numLines, int numElements, int elementSize
     write(&hdr, data, numBands);
 }
 
+
+void sio::lite::FileWriter::writeTiled(sio::lite::FileHeader* header,
+                                       const void* data,
+                                       size_t tileRows,
+                                       size_t tileCols,
+                                       int numBands)
+{
+    const size_t nl = static_cast<size_t>(header->getNumLines());
+    const size_t ne = static_cast<size_t>(header->getNumElements());
+    const size_t es = static_cast<size_t>(header->getElementSize());
+    const sio::lite::TileIndex tiles(nl, ne, es, tileRows, tileCols,
+                                     static_cast<size_t>(numBands));
+    tiles.addTo(*header);
+    header->to(numBands, *mStream);
+
+    //gather a whole row of tiles at a time, so each goes out in one write
+    const sys::byte* const image = static_cast<const sys::byte*>(data);
+    const size_t rowSize = ne * es;
+    std::vector<sys::byte> tileRowData(tileRows * rowSize);
+    for (size_t band = 0; band < tiles.getNumBands(); ++band)
+    {
+        for (size_t tileRow = 0; tileRow < tiles.getNumTilesDown(); ++tileRow)
+        {
+            const size_t rows = tiles.getTileNumRows(tileRow);
+            const sys::byte* const strip =
+                    image + (band * nl + tileRow * tileRows) * rowSize;
+            sys::byte* out = &tileRowData[0];
+            for (size_t tileCol = 0; tileCol < tiles.getNumTilesAcross();
+                 ++tileCol)
+            {
+                const size_t tileRowSize = tiles.getTileNumCols(tileCol) * es;
+                for (size_t row = 0; row < rows; ++row)
+                {
+                    memcpy(out, strip + row * rowSize + tileCol * tileCols * es,
+                           tileRowSize);
+                    out += tileRowSize;
+                }
+            }
+            mStream->write(&tileRowData[0], rows * rowSize);
+        }
+    }
+}
+
+void sio::lite::FileWriter::writeCompressed(sio::lite::FileHeader* header,
+                                            const void* data,
+                                            int numBands,
+                                            size_t blockSize,
+                                            int level,
+                                            size_t numThreads)
+{
+    if (!sio::lite::BlockIndex::isSupported())
+    {
+        throw except::Exception(Ctxt(
+                "sio.lite was built without zlib, so it can't write a "
+                "compressed SIO"));
+    }
+
+    const size_t es = static_cast<size_t>(header->getElementSize());
+    const sys::Uint64_T dataSize =
+            static_cast<sys::Uint64_T>(header->getNumLines()) *
+            static_cast<sys::Uint64_T>(header->getNumElements()) * es *
+            static_cast<sys::Uint64_T>(numBands);
+    sio::lite::BlockIndex blocks(
+            dataSize, std::max(blockSize / es, static_cast<size_t>(1)) * es);
+
+    const size_t numBlocks = blocks.getNumBlocks();
+    std::vector<std::vector<sys::byte> > compressed(numBlocks);
+    if (numThreads == 0)
+    {
+        numThreads = sys::OS().getNumCPUs();
+    }
+    if (numBlocks > 0)
+    {
+        mt::runBalanced1D(numBlocks, std::min(numThreads, numBlocks),
+                          CompressOp(blocks,
+                                     static_cast<const sys::byte*>(data),
+                                     level, compressed));
+    }
+
+    std::vector<size_t> sizes(numBlocks);
+    for (size_t ii = 0; ii < numBlocks; ++ii)
+    {
+        sizes[ii] = compressed[ii].size();
+    }
+    blocks.setCompressedSizes(sizes);
+    blocks.addTo(*header);
+
+    io::ByteStream headerStream;
+    header->to(numBands, headerStream);
+    std::vector<mem::BufferView<const sys::byte> > buffers;
+    buffers.reserve(numBlocks + 1);
+    buffers.push_back(mem::BufferView<const sys::byte>(
+            reinterpret_cast<const sys::byte*>(headerStream.get()),
+            headerStream.getSize()));
+    for (size_t ii = 0; ii < numBlocks; ++ii)
+    {
+        buffers.push_back(mem::BufferView<const sys::byte>(
+                &compressed[ii][0], compressed[ii].size()));
+    }
+    mStream->write(buffers);
+}
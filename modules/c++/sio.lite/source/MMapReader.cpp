@@ -0,0 +1,125 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <sstream>
+#include "sio/lite/StreamReader.h"
+#include "sio/lite/MMapReader.h"
+#include "sio/lite/TileIndex.h"
+#include "sio/lite/BlockIndex.h"
+
+sio::lite::MMapReader::MMapReader(const std::string& pathname) :
+    mStream(pathname),
+    mHeaderLength(0),
+    mBandSize(0),
+    mNumBands(0)
+{
+    {
+        StreamReader reader(&mStream);
+        mHeader = *reader.getHeader();
+    }
+
+    if (mHeader.userDataFieldExists(BlockIndex::USER_DATA_KEY))
+    {
+        throw except::Exception(Ctxt(
+                "The image data of compressed SIO " + pathname + " can't "
+                "be mapped; read it with FileReader::readWindow()"));
+    }
+
+    if (mHeader.getNumLines() < 0 || mHeader.getNumElements() < 0 ||
+        mHeader.getElementSize() <= 0)
+    {
+        throw sio::lite::InvalidHeaderException(
+                Ctxt("Invalid image size in " + pathname));
+    }
+
+    mHeaderLength = static_cast<size_t>(mHeader.getLength());
+    mBandSize = static_cast<size_t>(mHeader.getNumLines()) *
+            static_cast<size_t>(mHeader.getNumElements()) *
+            static_cast<size_t>(mHeader.getElementSize());
+    if (mStream.getSize() < mHeaderLength + mBandSize)
+    {
+        std::ostringstream ostr;
+        ostr << pathname << " holds " << mStream.getSize()
+             << " bytes, but its header describes "
+             << mHeaderLength + mBandSize;
+        throw sio::lite::InvalidHeaderException(Ctxt(ostr.str()));
+    }
+
+    mNumBands = (mBandSize == 0) ?
+            1 : (mStream.getSize() - mHeaderLength) / mBandSize;
+    mCopies.resize(mNumBands);
+}
+
+void sio::lite::MMapReader::close()
+{
+    mStream.close();
+    mCopies.clear();
+    mNumBands = 0;
+}
+
+bool sio::lite::MMapReader::isZeroCopy(size_t alignment) const
+{
+    return (!mHeader.isDifferentByteOrdering() ||
+            mHeader.getSwapSize() <= 1) &&
+            mHeaderLength % alignment == 0;
+}
+
+const sys::byte* sio::lite::MMapReader::getRawBand(size_t band) const
+{
+    if (band >= mNumBands)
+    {
+        std::ostringstream ostr;
+        ostr << "Band " << band << " requested from an SIO with "
+             << mNumBands << " bands";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    if (mHeader.userDataFieldExists(TileIndex::USER_DATA_KEY))
+    {
+        throw except::Exception(Ctxt(
+                "The image data of a tiled SIO isn't band-sequential; read "
+                "it with FileReader::readWindow()"));
+    }
+    return mStream.get() + mHeaderLength + band * mBandSize;
+}
+
+const sys::byte* sio::lite::MMapReader::getBandData(size_t band,
+                                                    size_t alignment)
+{
+    const sys::byte* const data = getRawBand(band);
+    if (isZeroCopy(alignment) || mBandSize == 0)
+    {
+        return data;
+    }
+
+    std::vector<sys::byte>& copy = mCopies[band];
+    if (copy.empty())
+    {
+        copy.resize(mBandSize);
+        memcpy(&copy[0], data, mBandSize);
+        if (mHeader.isDifferentByteOrdering())
+        {
+            const size_t swapSize = mHeader.getSwapSize();
+            swapBytes(&copy[0], swapSize, mBandSize / swapSize);
+        }
+    }
+    return &copy[0];
+}
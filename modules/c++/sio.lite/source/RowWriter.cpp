@@ -0,0 +1,186 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <vector>
+#include <io/ByteStream.h>
+#include <io/ProxyStreams.h>
+#include "sio/lite/RowWriter.h"
+
+namespace
+{
+// Passes writes through to the file, but leaves flushing and closing it to
+// the RowWriter, which still has the header to write once the background
+// thread is done
+class DetachedOutputStream : public io::ProxyOutputStream
+{
+public:
+    explicit DetachedOutputStream(io::OutputStream* proxy) :
+        io::ProxyOutputStream(proxy)
+    {
+    }
+
+    virtual void flush()
+    {
+    }
+
+    virtual void close()
+    {
+    }
+};
+
+// How much of the file moveRows() moves at a time
+const size_t MOVE_BLOCK_SIZE = 4 * 1024 * 1024;
+}
+
+const char* const sio::lite::RowWriter::PADDING_KEY = "sio.lite.padding";
+
+sio::lite::RowWriter::RowWriter(const std::string& pathname,
+                                const FileHeader& header,
+                                size_t reservedUserDataSize,
+                                size_t bufferSize) :
+    mPathname(pathname),
+    mHeader(header),
+    mRowSize(static_cast<size_t>(header.getNumElements()) *
+             static_cast<size_t>(header.getElementSize())),
+    mNumRows(0),
+    mHeaderLength(0),
+    mFile(new io::FileOutputStream(pathname))
+{
+    mHeader.setNumLines(0);
+
+    FileHeader provisional(mHeader);
+    if (reservedUserDataSize > 0)
+    {
+        provisional.addUserData(
+                PADDING_KEY, std::vector<sys::byte>(reservedUserDataSize));
+    }
+    provisional.to(1, *mFile);
+    mHeaderLength = provisional.getLength();
+
+    mAsync.reset(new io::AsyncOutputStream(
+            new DetachedOutputStream(mFile.get()), true, bufferSize));
+}
+
+sio::lite::RowWriter::~RowWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void sio::lite::RowWriter::writeRows(const void* rows, size_t numRows)
+{
+    if (!mAsync.get())
+    {
+        throw except::Exception(Ctxt("Writing rows to a closed RowWriter"));
+    }
+    mAsync->write(rows, numRows * mRowSize);
+    mNumRows += numRows;
+}
+
+void sio::lite::RowWriter::close()
+{
+    if (!mAsync.get())
+    {
+        return;
+    }
+
+    // Once the background thread has stopped, the file is ours again
+    std::unique_ptr<io::AsyncOutputStream> async(mAsync.release());
+    async->close();
+
+    bool fits = false;
+    FileHeader header = getFinalHeader(fits);
+    io::ByteStream headerStream;
+    header.to(1, headerStream);
+    const sys::byte* const headerBytes =
+            reinterpret_cast<const sys::byte*>(headerStream.get());
+    const size_t headerSize = static_cast<size_t>(headerStream.getSize());
+
+    if (fits)
+    {
+        mFile->seek(0, io::Seekable::START);
+        mFile->write(headerBytes, headerSize);
+        mFile->close();
+        return;
+    }
+
+    mFile->close();
+    sys::File file(mPathname, sys::File::READ_AND_WRITE,
+                   sys::File::EXISTING);
+    moveRows(file, header.getLength());
+    file.seekTo(0, sys::File::FROM_START);
+    file.writeFrom(headerBytes, headerSize);
+    file.close();
+}
+
+sio::lite::FileHeader sio::lite::RowWriter::getFinalHeader(bool& fits) const
+{
+    FileHeader header(mHeader);
+    header.setNumLines(static_cast<int>(mNumRows));
+    if (header.getLength() == mHeaderLength)
+    {
+        fits = true;
+        return header;
+    }
+
+    // Fill what's left of the reserved space with padding
+    FileHeader padded(header);
+    padded.addUserData(PADDING_KEY, std::vector<sys::byte>());
+    const long minimumLength = padded.getLength();
+    if (minimumLength <= mHeaderLength)
+    {
+        padded.addUserData(PADDING_KEY, std::vector<sys::byte>(
+                static_cast<size_t>(mHeaderLength - minimumLength)));
+        fits = true;
+        return padded;
+    }
+
+    // Otherwise the rows have to move to make room.  If the header shrank,
+    // but not by enough to pad, it still needs the padding field so that
+    // it's longer than before, since rows only move later in the file.
+    fits = false;
+    return header.getLength() < mHeaderLength ? padded : header;
+}
+
+void sio::lite::RowWriter::moveRows(sys::File& file,
+                                    sys::Off_T newOffset) const
+{
+    // The rows only ever move later in the file, so move the last ones
+    // first
+    sys::Off_T remaining = static_cast<sys::Off_T>(mNumRows) * mRowSize;
+    std::vector<sys::byte> buffer(static_cast<size_t>(
+            std::min<sys::Off_T>(remaining, MOVE_BLOCK_SIZE)));
+    while (remaining > 0)
+    {
+        const size_t numBytes = static_cast<size_t>(
+                std::min<sys::Off_T>(remaining, buffer.size()));
+        remaining -= numBytes;
+        file.readAt(&buffer[0], numBytes, mHeaderLength + remaining);
+        file.seekTo(newOffset + remaining, sys::File::FROM_START);
+        file.writeFrom(&buffer[0], numBytes);
+    }
+}
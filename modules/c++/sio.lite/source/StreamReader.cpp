@@ -19,8 +19,171 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "sio/lite/Convert.h"
 #include "sio/lite/StreamReader.h"
 
+namespace
+{
+// magic + nl + ne + et + es
+const long SIO_HEADER_LENGTH = 20;
+
+// Skipped user data and tiles are read in pieces of this size
+const size_t SKIP_BUFFER_SIZE = 64 * 1024;
+
+// User data is parsed out of a buffer filled this much at a time
+const size_t HEADER_BUFFER_SIZE = 64 * 1024;
+
+// Reads user data a block at a time, so that a header with many fields
+// isn't several reads per field.  Reading ahead is only done on Seekable
+// streams, which finish() can put back at the end of the header.
+class HeaderBuffer
+{
+public:
+    HeaderBuffer(io::InputStream* stream, io::Seekable* seekable) :
+        mStream(stream),
+        mSeekable(seekable),
+        mBuffer(seekable ? HEADER_BUFFER_SIZE : 0),
+        mPosition(0),
+        mSize(0),
+        mStreamPosition(seekable ? seekable->tell() : 0)
+    {
+    }
+
+    void read(void* buffer, size_t size)
+    {
+        sys::byte* out = static_cast<sys::byte*>(buffer);
+        const size_t buffered = std::min(size, mSize - mPosition);
+        if (buffered > 0)
+        {
+            memcpy(out, &mBuffer[mPosition], buffered);
+            mPosition += buffered;
+            out += buffered;
+            size -= buffered;
+        }
+        if (size == 0)
+            return;
+
+        if (size >= mBuffer.size())
+        {
+            mStream->read(out, size, true);
+            mStreamPosition += static_cast<sys::Off_T>(size);
+            return;
+        }
+
+        const sys::SSize_T numRead = mStream->read(&mBuffer[0],
+                                                   mBuffer.size());
+        mSize = numRead > 0 ? static_cast<size_t>(numRead) : 0;
+        mPosition = 0;
+        mStreamPosition += static_cast<sys::Off_T>(mSize);
+        if (mSize < size)
+            throw sio::lite::InvalidHeaderException(
+                Ctxt("The user data runs past the end of the stream"));
+        memcpy(out, &mBuffer[0], size);
+        mPosition = size;
+    }
+
+    //! Whether the next 'size' bytes are already in memory
+    bool isBuffered(size_t size) const
+    {
+        return size <= mSize - mPosition;
+    }
+
+    int readInt(bool byteSwap)
+    {
+        int value;
+        read(&value, sizeof(value));
+        return byteSwap ? sys::byteSwap(value) : value;
+    }
+
+    void skip(size_t size)
+    {
+        const size_t buffered = std::min(size, mSize - mPosition);
+        mPosition += buffered;
+        size -= buffered;
+        if (size == 0)
+            return;
+
+        if (mSeekable)
+        {
+            mSeekable->seek(static_cast<sys::Off_T>(size),
+                            io::Seekable::CURRENT);
+            mStreamPosition += static_cast<sys::Off_T>(size);
+            return;
+        }
+
+        std::vector<sys::byte> skipped(std::min(size, SKIP_BUFFER_SIZE));
+        while (size > 0)
+        {
+            const size_t numBytes = std::min(size, skipped.size());
+            mStream->read(&skipped[0], numBytes, true);
+            size -= numBytes;
+        }
+    }
+
+    //! Where the next byte parsed is in a Seekable stream
+    sys::Off_T tell() const
+    {
+        return mStreamPosition - static_cast<sys::Off_T>(mSize - mPosition);
+    }
+
+    //! Put the stream back just past what was parsed
+    void finish()
+    {
+        if (mPosition < mSize)
+            mSeekable->seek(-static_cast<sys::Off_T>(mSize - mPosition),
+                            io::Seekable::CURRENT);
+        mPosition = mSize = 0;
+    }
+
+private:
+    io::InputStream* const mStream;
+    io::Seekable* const mSeekable;
+    std::vector<sys::byte> mBuffer;
+    size_t mPosition;
+    size_t mSize;
+
+    // Where a Seekable stream is, so tell() doesn't have to ask it
+    sys::Off_T mStreamPosition;
+};
+}
+
+class sio::lite::StreamReader::UserDataStream :
+    public sio::lite::FileHeader::UserDataSource
+{
+public:
+    UserDataStream(io::InputStream* stream, io::Seekable* seekable) :
+        mStream(stream), mSeekable(seekable)
+    {
+    }
+
+    //! Stop reading from the stream, which is about to go away
+    void detach()
+    {
+        mStream = NULL;
+        mSeekable = NULL;
+    }
+
+    virtual void read(sys::Off_T offset, void* buffer, size_t size)
+    {
+        if (!mStream)
+            throw except::Exception(Ctxt(
+                "User data can't be read after its reader is gone"));
+
+        // Leave the stream where the reader had it
+        const sys::Off_T position = mSeekable->tell();
+        mSeekable->seek(offset, io::Seekable::START);
+        mStream->read(buffer, size, true);
+        mSeekable->seek(position, io::Seekable::START);
+    }
+
+private:
+    io::InputStream* mStream;
+    io::Seekable* mSeekable;
+};
+
 
 union _IntBuffer
 {
@@ -95,8 +258,17 @@ void sio::lite::StreamReader::killHeader()
     if (header)
         delete header;
     header = NULL;
+    // Copies of the header can't read deferred user data any more
+    if (userDataStream.get())
+    {
+        userDataStream->detach();
+        userDataStream.reset();
+    }
     // Reset length so we always have a correct value
     headerLength = 0;
+    tileIndex.reset();
+    blockIndex.reset();
+    dataPosition = 0;
 }
 
 void sio::lite::StreamReader::killStream()
@@ -118,15 +290,31 @@ void sio::lite::StreamReader::parseHeader(bool calledFromConstructor)
     header->setElementType( getNextInteger() );
     header->setElementSize( getNextInteger() );
 
-    if (header->getVersion() >= 2)
-        readType2Header();
+    // Cache this for seek speed.  This counts what was read, since
+    // skipped user data isn't in the header.
+    long length = SIO_HEADER_LENGTH;
+    try
+    {
+        if (header->getVersion() >= 2)
+            length += readType2Header();
 
-    if (header->getVersion() > 2)
-        dbg_printf("Warning: header version is [%d]\n",
-                   header->getVersion() );
+        if (header->getVersion() > 2)
+            dbg_printf("Warning: header version is [%d]\n",
+                       header->getVersion() );
 
-    // Cache this for seek speed
-    headerLength = header->getLength();
+        tileIndex = TileIndex::fromHeader(*header);
+        blockIndex = BlockIndex::fromHeader(*header);
+        headerLength = length;
+    }
+    catch (...)
+    {
+        if (calledFromConstructor)
+        {
+            killHeader();
+            killStream();
+        }
+        throw;
+    }
 }
 
 void sio::lite::StreamReader::setInputStream(io::InputStream* is, bool adopt)
@@ -137,32 +325,150 @@ void sio::lite::StreamReader::setInputStream(io::InputStream* is, bool adopt)
     parseHeader();
 }
 
-void sio::lite::StreamReader::readType2Header()
+long sio::lite::StreamReader::readType2Header()
 {
     int numUDEntries = getNextInteger();
+    long length = 4;
 
+    // Deferring and skipping fields both need to seek past them
+    io::Seekable* const seekable = dynamic_cast<io::Seekable*>(inputStream);
+    UserDataPolicy policy = userDataPolicy;
+    if (policy == DEFER_USER_DATA && !seekable)
+        policy = READ_USER_DATA;
+    if (policy == DEFER_USER_DATA)
+        userDataStream.reset(new UserDataStream(inputStream, seekable));
+
+    HeaderBuffer buffer(inputStream, seekable);
+    const bool byteSwap = header->isDifferentByteOrdering();
+    std::vector<sys::byte> idBytes;
     for (int i = 0; i < numUDEntries; i++)
     {
         // Read the id size
-        int idSize = getNextInteger();
-
-        sys::byte *tmpBytes = new sys::byte[idSize];
-        inputStream->read(tmpBytes, idSize);
-        std::string id((const char*)tmpBytes);
-        header->setNullTerminationFlag(tmpBytes[idSize-1] == 0x00);
-        delete [] tmpBytes;
-
-        int udSize = getNextInteger();
-        // This is what we are storing in the hash table
-        std::vector<sys::byte> udEntry;
-        udEntry.reserve(udSize);
-        for (int i = 0; i < udSize; i++)
+        int idSize = buffer.readInt(byteSwap);
+        if (idSize <= 0)
+            throw sio::lite::InvalidHeaderException(
+                Ctxt("Invalid user data id size"));
+
+        idBytes.resize(idSize);
+        buffer.read(&idBytes[0], idSize);
+        std::string id(idBytes.begin(),
+                       std::find(idBytes.begin(), idBytes.end(), 0x00));
+        header->setNullTerminationFlag(idBytes.back() == 0x00);
+
+        int udSize = buffer.readInt(byteSwap);
+        if (udSize < 0)
+            throw sio::lite::InvalidHeaderException(
+                Ctxt("Invalid size for user data field " + id));
+        length += 8 + idSize + udSize;
+
+        // Deferring a field that has already been read gains nothing
+        if (policy == READ_USER_DATA || id == TileIndex::USER_DATA_KEY ||
+            id == BlockIndex::USER_DATA_KEY ||
+            (policy == DEFER_USER_DATA && buffer.isBuffered(udSize)))
+        {
+            // This is what we are storing in the hash table
+            std::vector<sys::byte> udEntry(udSize);
+            if (udSize > 0)
+                buffer.read(&udEntry[0], udSize);
+            header->addUserData(id, std::move(udEntry));
+        }
+        else
         {
-            sys::byte x;
-            inputStream->read(&x, 1);
-            udEntry.push_back(x);
+            if (policy == DEFER_USER_DATA)
+                header->addDeferredUserData(id, buffer.tell(), udSize,
+                                            userDataStream);
+            buffer.skip(udSize);
         }
-        header->getUserDataSection().add(id, udEntry);
     }
+    buffer.finish();
+    return length;
+}
+
+
+const sio::lite::TileIndex& sio::lite::StreamReader::getTiles() const
+{
+    if (!tileIndex.get())
+    {
+        throw except::Exception(Ctxt("The SIO isn't tiled"));
+    }
+    return *tileIndex;
+}
+
+const sio::lite::BlockIndex& sio::lite::StreamReader::getBlocks() const
+{
+    if (!blockIndex.get())
+    {
+        throw except::Exception(Ctxt("The SIO isn't compressed"));
+    }
+    return *blockIndex;
 }
 
+void sio::lite::StreamReader::swapToNative(void* buffer, size_t size) const
+{
+    if (header->isDifferentByteOrdering())
+    {
+        const size_t swapSize = header->getSwapSize();
+        swapBytes(buffer, swapSize, size / swapSize);
+    }
+}
+
+void sio::lite::StreamReader::skipTo(sys::Off_T offset)
+{
+    if (offset < dataPosition)
+    {
+        throw except::Exception(Ctxt(
+                "Tiles and blocks must be read from a stream in the order "
+                "they are stored"));
+    }
+
+    if (offset > dataPosition)
+    {
+        std::vector<sys::byte> skipped(static_cast<size_t>(
+                std::min<sys::Off_T>(offset - dataPosition,
+                                     SKIP_BUFFER_SIZE)));
+        while (dataPosition < offset)
+        {
+            const size_t numBytes = static_cast<size_t>(
+                    std::min<sys::Off_T>(offset - dataPosition,
+                                         skipped.size()));
+            read(&skipped[0], numBytes, true);
+            dataPosition += numBytes;
+        }
+    }
+}
+
+void sio::lite::StreamReader::readTile(void* buffer,
+                                       size_t tileRow,
+                                       size_t tileCol,
+                                       size_t band,
+                                       bool byteSwap)
+{
+    const TileIndex& tiles = getTiles();
+    const size_t size = tiles.getTileSize(tileRow, tileCol);
+    skipTo(tiles.getOffset(tileRow, tileCol, band));
+
+    read(buffer, size, true);
+    dataPosition += size;
+    if (byteSwap)
+    {
+        swapToNative(buffer, size);
+    }
+}
+
+void sio::lite::StreamReader::readBlock(void* buffer,
+                                        size_t block,
+                                        bool byteSwap)
+{
+    const BlockIndex& blocks = getBlocks();
+    skipTo(blocks.getOffset(block));
+
+    std::vector<sys::byte> compressed(blocks.getCompressedSize(block));
+    read(compressed.data(), compressed.size(), true);
+    dataPosition += compressed.size();
+
+    blocks.decompressBlock(compressed.data(), block, buffer);
+    if (byteSwap)
+    {
+        swapToNative(buffer, blocks.getBlockDataSize(block));
+    }
+}
@@ -0,0 +1,203 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <sstream>
+#include "sio/lite/TileIndex.h"
+
+namespace
+{
+// numRows, numCols, elementSize, tileRows, tileCols and numBands
+const size_t NUM_FIELDS = 6;
+}
+
+const char* const sio::lite::TileIndex::USER_DATA_KEY = "sio.lite.tiles";
+
+sio::lite::TileIndex::TileIndex(size_t numRows,
+                                size_t numCols,
+                                size_t elementSize,
+                                size_t tileRows,
+                                size_t tileCols,
+                                size_t numBands) :
+    mNumRows(numRows),
+    mNumCols(numCols),
+    mElementSize(elementSize),
+    mTileRows(tileRows),
+    mTileCols(tileCols),
+    mNumBands(numBands)
+{
+    if (tileRows == 0 || tileCols == 0)
+    {
+        throw except::Exception(Ctxt("Tiles must have rows and columns"));
+    }
+
+    mOffsets.reserve(getNumTilesDown() * getNumTilesAcross() * numBands);
+    sys::Uint64_T offset = 0;
+    for (size_t band = 0; band < numBands; ++band)
+    {
+        for (size_t tileRow = 0; tileRow < getNumTilesDown(); ++tileRow)
+        {
+            for (size_t tileCol = 0; tileCol < getNumTilesAcross();
+                 ++tileCol)
+            {
+                mOffsets.push_back(offset);
+                offset += getTileSize(tileRow, tileCol);
+            }
+        }
+    }
+}
+
+std::unique_ptr<sio::lite::TileIndex>
+sio::lite::TileIndex::fromHeader(const FileHeader& header)
+{
+    if (!header.userDataFieldExists(USER_DATA_KEY))
+    {
+        return std::unique_ptr<TileIndex>();
+    }
+
+    const std::vector<sys::byte>& field =
+            header.getUserData(USER_DATA_KEY);
+    if (field.size() % sizeof(sys::Uint64_T) != 0 ||
+        field.size() < NUM_FIELDS * sizeof(sys::Uint64_T))
+    {
+        throw InvalidHeaderException(Ctxt("Malformed tile index"));
+    }
+
+    std::vector<sys::Uint64_T> values(field.size() / sizeof(sys::Uint64_T));
+    memcpy(&values[0], &field[0], field.size());
+    if (header.isDifferentByteOrdering())
+    {
+        sys::byteSwap(&values[0], sizeof(sys::Uint64_T), values.size());
+    }
+
+    // The index must describe the image the header does, since readers
+    // size their buffers from the header
+    if (header.getNumLines() < 0 || header.getNumElements() < 0 ||
+        header.getElementSize() < 0 ||
+        values[0] != static_cast<sys::Uint64_T>(header.getNumLines()) ||
+        values[1] != static_cast<sys::Uint64_T>(header.getNumElements()) ||
+        values[2] != static_cast<sys::Uint64_T>(header.getElementSize()))
+    {
+        std::ostringstream ostr;
+        ostr << "Tile index is for a " << values[0] << " x " << values[1]
+             << " image of " << values[2] << "-byte elements, but the "
+             << "header has " << header.getNumLines() << " x "
+             << header.getNumElements() << " of "
+             << header.getElementSize() << "-byte elements";
+        throw InvalidHeaderException(Ctxt(ostr.str()));
+    }
+
+    const size_t numRows = static_cast<size_t>(values[0]);
+    const size_t numCols = static_cast<size_t>(values[1]);
+    const size_t elementSize = static_cast<size_t>(values[2]);
+    const size_t tileRows = static_cast<size_t>(values[3]);
+    const size_t tileCols = static_cast<size_t>(values[4]);
+    const sys::Uint64_T numBands = values[5];
+    if (tileRows == 0 || tileCols == 0)
+    {
+        throw InvalidHeaderException(Ctxt(
+                "Tile index has tiles without rows or columns"));
+    }
+
+    // Every band of a non-empty image has a tile, which bounds the band
+    // count before it's multiplied by anything
+    const size_t numOffsets = values.size() - NUM_FIELDS;
+    const size_t tilesPerBand = (numRows + tileRows - 1) / tileRows *
+            ((numCols + tileCols - 1) / tileCols);
+    if ((tilesPerBand > 0 && numBands > numOffsets) ||
+        tilesPerBand * numBands != numOffsets)
+    {
+        std::ostringstream ostr;
+        ostr << "Tile index has " << numOffsets << " offsets for "
+             << numBands << " bands of " << tilesPerBand << " tiles";
+        throw InvalidHeaderException(Ctxt(ostr.str()));
+    }
+
+    std::unique_ptr<TileIndex> index(new TileIndex(
+            numRows, numCols, elementSize, tileRows, tileCols,
+            static_cast<size_t>(numBands)));
+    index->mOffsets.assign(values.begin() + NUM_FIELDS, values.end());
+
+    // Tiles have to lie within the image data, which is the same size as
+    // it would be untiled
+    const sys::Uint64_T dataSize = static_cast<sys::Uint64_T>(numRows) *
+            numCols * elementSize * numBands;
+    for (size_t band = 0, ii = 0; band < index->mNumBands; ++band)
+    {
+        for (size_t tileRow = 0; tileRow < index->getNumTilesDown();
+             ++tileRow)
+        {
+            for (size_t tileCol = 0; tileCol < index->getNumTilesAcross();
+                 ++tileCol, ++ii)
+            {
+                const sys::Uint64_T offset = index->mOffsets[ii];
+                const sys::Uint64_T size =
+                        index->getTileSize(tileRow, tileCol);
+                if (offset > dataSize || size > dataSize - offset)
+                {
+                    std::ostringstream ostr;
+                    ostr << "Tile (" << tileRow << ", " << tileCol
+                         << ") of band " << band << " runs past the "
+                         << dataSize << " bytes of image data";
+                    throw InvalidHeaderException(Ctxt(ostr.str()));
+                }
+            }
+        }
+    }
+    return index;
+}
+
+void sio::lite::TileIndex::addTo(FileHeader& header) const
+{
+    std::vector<sys::Uint64_T> values;
+    values.reserve(NUM_FIELDS + mOffsets.size());
+    values.push_back(mNumRows);
+    values.push_back(mNumCols);
+    values.push_back(mElementSize);
+    values.push_back(mTileRows);
+    values.push_back(mTileCols);
+    values.push_back(mNumBands);
+    values.insert(values.end(), mOffsets.begin(), mOffsets.end());
+
+    const sys::byte* const bytes =
+            reinterpret_cast<const sys::byte*>(&values[0]);
+    header.addUserData(USER_DATA_KEY, std::vector<sys::byte>(
+            bytes, bytes + values.size() * sizeof(sys::Uint64_T)));
+}
+
+sys::Off_T sio::lite::TileIndex::getOffset(size_t tileRow,
+                                           size_t tileCol,
+                                           size_t band) const
+{
+    if (tileRow >= getNumTilesDown() || tileCol >= getNumTilesAcross() ||
+        band >= mNumBands)
+    {
+        std::ostringstream ostr;
+        ostr << "No tile (" << tileRow << ", " << tileCol << ") in band "
+             << band << " of a " << getNumTilesDown() << " x "
+             << getNumTilesAcross() << " grid of tiles with " << mNumBands
+             << " bands";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    return static_cast<sys::Off_T>(mOffsets[
+            (band * getNumTilesDown() + tileRow) * getNumTilesAcross() +
+            tileCol]);
+}
@@ -0,0 +1,292 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/sio/lite.h>
+#include "PageCache.h"
+
+// Benchmarks writing and reading SIOs whose image data is compressed a
+// block at a time (see sio::lite::BlockIndex) against the same images
+// stored as they are, for a sparse mask, a smooth magnitude image and, as
+// the worst case, noise.  Reads are of the whole image and of random
+// chips, with the file in the page cache and, on Linux, after evicting it.
+namespace
+{
+const size_t CHIP_SIZE = 256;
+
+struct Image
+{
+    std::string name;
+    size_t rows;
+    size_t cols;
+    size_t elementSize;
+    int elementType;
+    std::vector<sys::byte> data;
+};
+
+//! Mostly zero, with a few hundred filled rectangles
+Image makeMask(size_t rows, size_t cols)
+{
+    Image image = { "mask", rows, cols, 1, sio::lite::FileHeader::UNSIGNED,
+                    std::vector<sys::byte>(rows * cols, 0) };
+    srand(1234);
+    for (size_t ii = 0; ii < 300; ++ii)
+    {
+        const size_t height = 1 + rand() % 64;
+        const size_t width = 1 + rand() % 64;
+        const size_t top = rand() % (rows - std::min(rows, height) + 1);
+        const size_t left = rand() % (cols - std::min(cols, width) + 1);
+        for (size_t row = top; row < std::min(rows, top + height); ++row)
+        {
+            std::fill_n(&image.data[row * cols + left],
+                        std::min(width, cols - left), 1);
+        }
+    }
+    return image;
+}
+
+//! Slowly varying float magnitudes, quantized the way detected imagery is
+Image makeMagnitude(size_t rows, size_t cols)
+{
+    Image image = { "magnitude", rows, cols, sizeof(float),
+                    sio::lite::FileHeader::FLOAT,
+                    std::vector<sys::byte>(rows * cols * sizeof(float)) };
+    float* const values = reinterpret_cast<float*>(&image.data[0]);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            const float value = 100.0f +
+                    50.0f * static_cast<float>(sin(row / 200.0)) *
+                    static_cast<float>(cos(col / 300.0));
+            values[row * cols + col] = floorf(value * 16.0f) / 16.0f;
+        }
+    }
+    return image;
+}
+
+//! Uniform random floats, which won't compress
+Image makeNoise(size_t rows, size_t cols)
+{
+    Image image = { "noise", rows, cols, sizeof(float),
+                    sio::lite::FileHeader::FLOAT,
+                    std::vector<sys::byte>(rows * cols * sizeof(float)) };
+    float* const values = reinterpret_cast<float*>(&image.data[0]);
+    srand(1234);
+    for (size_t ii = 0; ii < rows * cols; ++ii)
+    {
+        values[ii] = static_cast<float>(rand()) / RAND_MAX;
+    }
+    return image;
+}
+
+// Returns the elapsed time in ms.  numThreads of 0 stores the image as
+// it is.
+double BM_Write(const Image& image, const std::string& pathname,
+                size_t numThreads)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileHeader header(static_cast<int>(image.rows),
+                                 static_cast<int>(image.cols),
+                                 static_cast<int>(image.elementSize),
+                                 image.elementType);
+    sio::lite::FileWriter writer(pathname);
+    if (numThreads == 0)
+    {
+        writer.write(&header, &image.data[0]);
+    }
+    else
+    {
+        writer.writeCompressed(&header, &image.data[0], 1,
+                               sio::lite::BlockIndex::DEFAULT_BLOCK_SIZE,
+                               sio::lite::BlockIndex::DEFAULT_LEVEL,
+                               numThreads);
+    }
+    return sw.stop();
+}
+
+// Returns the elapsed time in ms
+double BM_ReadImage(const Image& image, const std::string& pathname)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileReader reader(pathname);
+    std::vector<sys::byte> read(image.data.size());
+    reader.readWindow(&read[0], 0, 0, image.rows, image.cols);
+    const double elapsed = sw.stop();
+    if (read != image.data)
+    {
+        throw except::Exception(Ctxt(pathname + " has the wrong data"));
+    }
+    return elapsed;
+}
+
+// Returns the elapsed time in ms
+double BM_ReadChips(const Image& image, const std::string& pathname,
+                    size_t numChips)
+{
+    const size_t chipRows = std::min(CHIP_SIZE, image.rows);
+    const size_t chipCols = std::min(CHIP_SIZE, image.cols);
+    const size_t chipRowSize = chipCols * image.elementSize;
+    srand(1234);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileReader reader(pathname);
+    std::vector<sys::byte> chip(chipRows * chipRowSize);
+    for (size_t ii = 0; ii < numChips; ++ii)
+    {
+        const size_t top = rand() % (image.rows - chipRows + 1);
+        const size_t left = rand() % (image.cols - chipCols + 1);
+        reader.readWindow(&chip[0], top, left, chipRows, chipCols, 0, false);
+        if (!std::equal(chip.begin(), chip.begin() + chipRowSize,
+                        image.data.begin() +
+                                (top * image.cols + left) *
+                                        image.elementSize))
+        {
+            throw except::Exception(Ctxt(pathname + " has the wrong data"));
+        }
+    }
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, double sizeMB,
+                 const std::string& pathname)
+{
+    std::cout << std::setw(36) << std::left << name << " "
+              << std::setw(10) << std::right << std::fixed
+              << std::setprecision(1) << elapsedMS << " "
+              << std::setw(10) << std::right << std::fixed
+              << std::setprecision(1) << sizeMB / (elapsedMS / 1000.0) << " "
+              << std::setw(10) << std::right << std::fixed
+              << std::setprecision(2)
+              << sys::OS().getSize(pathname) / (1024.0 * 1024.0)
+              << std::endl;
+}
+
+void runBenchmark(const Image& image, const std::string& workDir,
+                  size_t numThreads, size_t numChips)
+{
+    const std::string raw =
+            sys::Path::joinPaths(workDir, "compressed_benchmark_raw.sio");
+    const std::string compressed =
+            sys::Path::joinPaths(workDir, "compressed_benchmark.sio");
+    const double imageMB = image.data.size() / (1024.0 * 1024.0);
+    const double chipsMB = numChips * std::min(CHIP_SIZE, image.rows) *
+            std::min(CHIP_SIZE, image.cols) * image.elementSize /
+            (1024.0 * 1024.0);
+
+    printResult(image.name + " write", BM_Write(image, raw, 0), imageMB,
+                raw);
+    printResult(image.name + " write (compressed, 1 thread)",
+                BM_Write(image, compressed, 1), imageMB, compressed);
+    if (numThreads != 1)
+    {
+        printResult(image.name + " write (compressed, " +
+                            str::toString(numThreads) + " threads)",
+                    BM_Write(image, compressed, numThreads), imageMB,
+                    compressed);
+    }
+
+    const std::string pathnames[] = { raw, compressed };
+    const std::string layouts[] = { "", " (compressed)" };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        printResult(image.name + " read" + layouts[ii],
+                    BM_ReadImage(image, pathnames[ii]), imageMB,
+                    pathnames[ii]);
+        if (evictFromPageCache(pathnames[ii]))
+        {
+            printResult(image.name + " read" + layouts[ii] + ", cold",
+                        BM_ReadImage(image, pathnames[ii]), imageMB,
+                        pathnames[ii]);
+        }
+        printResult(image.name + " chips" + layouts[ii],
+                    BM_ReadChips(image, pathnames[ii], numChips), chipsMB,
+                    pathnames[ii]);
+    }
+
+    sys::OS().remove(raw);
+    sys::OS().remove(compressed);
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [rows] [cols] [numThreads] [numChips]"
+                      << std::endl;
+            return 1;
+        }
+        if (!sio::lite::BlockIndex::isSupported())
+        {
+            std::cerr << "sio.lite was built without zlib" << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t rows = (argc > 2) ? str::toType<size_t>(argv[2]) : 4096;
+        const size_t cols = (argc > 3) ? str::toType<size_t>(argv[3]) : 4096;
+        const size_t numThreads = (argc > 4) ?
+                str::toType<size_t>(argv[4]) : sys::OS().getNumCPUs();
+        const size_t numChips =
+                (argc > 5) ? str::toType<size_t>(argv[5]) : 100;
+
+        std::cout << std::setw(36) << std::left << "Benchmark" << " "
+                  << std::setw(10) << std::right << "ms" << " "
+                  << std::setw(10) << std::right << "MB/s" << " "
+                  << std::setw(10) << std::right << "file MB" << std::endl;
+        std::cout << std::string(69, '-') << std::endl;
+
+        runBenchmark(makeMask(rows, cols), workDir, numThreads, numChips);
+        runBenchmark(makeMagnitude(rows, cols), workDir, numThreads,
+                     numChips);
+        runBenchmark(makeNoise(rows, cols), workDir, numThreads, numChips);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/sio/lite.h>
+
+// Benchmarks byte swapping and converting SIO payloads of 2, 4 and 8-byte
+// and complex elements: sys::byteSwap() followed by a conversion loop,
+// against sio::lite::convertElements() on one or more threads
+namespace
+{
+template <typename InputT, typename OutputT>
+double BM_SwapThenConvert(const std::vector<sys::byte>& payload,
+                          std::vector<OutputT>& output,
+                          size_t swapSize)
+{
+    const size_t numValues = payload.size() / sizeof(InputT);
+    std::vector<InputT> values(numValues);
+    output.resize(numValues);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    memcpy(&values[0], &payload[0], payload.size());
+    sys::byteSwap(&values[0], static_cast<unsigned short>(swapSize),
+                  payload.size() / swapSize);
+    for (size_t ii = 0; ii < numValues; ++ii)
+    {
+        output[ii] = static_cast<OutputT>(values[ii]);
+    }
+    return sw.stop();
+}
+
+template <typename OutputT>
+double BM_ConvertElements(const sio::lite::FileHeader& header,
+                          const std::vector<sys::byte>& payload,
+                          std::vector<OutputT>& output,
+                          size_t numThreads)
+{
+    const size_t numElements = payload.size() / header.getElementSize();
+    output.resize(numElements);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::convertElements(header, &payload[0], numElements,
+                               &output[0], numThreads);
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, double totalMB)
+{
+    std::cout << std::setw(40) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+
+/*
+ *  InputT is what the file holds (for complex elements, one component
+ *  of it) and OutputT is what it is converted to
+ */
+template <typename InputT, typename OutputT>
+void runBenchmarks(const std::string& label,
+                   int elementType,
+                   size_t elementSize,
+                   size_t payloadMB,
+                   size_t maxThreads)
+{
+    std::vector<sys::byte> payload(payloadMB * 1024 * 1024);
+    for (size_t ii = 0; ii < payload.size(); ++ii)
+    {
+        payload[ii] = static_cast<sys::byte>(ii * 31 + 7);
+    }
+
+    sio::lite::FileHeader header(1, 1, static_cast<int>(elementSize),
+                                 elementType);
+    header.setIsDifferentByteOrdering(true);
+
+    std::vector<typename sio::lite::detail::Components<OutputT>::Type>
+            baseline;
+    printResult(label + " byteSwap + cast",
+                BM_SwapThenConvert<InputT>(payload, baseline,
+                                           sizeof(InputT)),
+                static_cast<double>(payloadMB));
+
+    std::vector<OutputT> output;
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        printResult(label + " convert (" + str::toString(numThreads) +
+                            " thr)",
+                    BM_ConvertElements(header, payload, output, numThreads),
+                    static_cast<double>(payloadMB));
+    }
+
+    if (memcmp(&baseline[0], &output[0],
+               baseline.size() * sizeof(baseline[0])) != 0)
+    {
+        throw except::Exception(Ctxt(label + " results differ"));
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t payloadMB =
+                (argc > 1) ? str::toType<size_t>(argv[1]) : 256;
+        const size_t maxThreads = (argc > 2) ?
+                str::toType<size_t>(argv[2]) : sys::OS().getNumCPUs();
+
+        std::cout << std::setw(40) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(66, '-') << std::endl;
+
+        runBenchmarks<sys::Int16_T, sys::Int16_T>(
+                "int16", sio::lite::FileHeader::SIGNED, 2,
+                payloadMB, maxThreads);
+        runBenchmarks<sys::Int16_T, float>(
+                "int16 -> float", sio::lite::FileHeader::SIGNED, 2,
+                payloadMB, maxThreads);
+        runBenchmarks<float, float>(
+                "float", sio::lite::FileHeader::FLOAT, 4,
+                payloadMB, maxThreads);
+        runBenchmarks<sys::Uint32_T, double>(
+                "uint32 -> double", sio::lite::FileHeader::UNSIGNED, 4,
+                payloadMB, maxThreads);
+        runBenchmarks<double, double>(
+                "double", sio::lite::FileHeader::FLOAT, 8,
+                payloadMB, maxThreads);
+        runBenchmarks<sys::Int16_T, std::complex<float> >(
+                "complex<int16> -> complex<float>",
+                sio::lite::FileHeader::COMPLEX_SIGNED, 4,
+                payloadMB, maxThreads);
+        runBenchmarks<float, std::complex<float> >(
+                "complex<float>", sio::lite::FileHeader::COMPLEX_FLOAT, 8,
+                payloadMB, maxThreads);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,502 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/sio/lite.h>
+#include <io/ByteStream.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include "PageCache.h"
+
+// Measures SIO throughput through FileWriter, RowWriter, FileReader and
+// StreamReader for an image of a given size, element type and number of
+// bands, stored in native and in swapped byte order: whole-image writes,
+// streaming writes, full and streaming reads, and random windows.  Reads
+// run with the file in the page cache and, on Linux, after evicting it.
+// Each case is timed several times and the results are printed as JSON,
+// so runs can be compared from one build to the next.
+namespace
+{
+// Streaming writes and reads go this many bytes at a time
+const size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+struct ElementType
+{
+    const char* name;
+    int elementSize;
+    int elementType;
+};
+
+const ElementType ELEMENT_TYPES[] = {
+    { "ubyte", 1, sio::lite::FileHeader::UNSIGNED },
+    { "int16", 2, sio::lite::FileHeader::SIGNED },
+    { "uint16", 2, sio::lite::FileHeader::UNSIGNED },
+    { "int32", 4, sio::lite::FileHeader::SIGNED },
+    { "float", 4, sio::lite::FileHeader::FLOAT },
+    { "double", 8, sio::lite::FileHeader::FLOAT },
+    { "cfloat", 8, sio::lite::FileHeader::COMPLEX_FLOAT },
+    { "cdouble", 16, sio::lite::FileHeader::COMPLEX_FLOAT }
+};
+
+const ElementType& findElementType(const std::string& name)
+{
+    for (size_t ii = 0;
+         ii < sizeof(ELEMENT_TYPES) / sizeof(ELEMENT_TYPES[0]); ++ii)
+    {
+        if (name == ELEMENT_TYPES[ii].name)
+        {
+            return ELEMENT_TYPES[ii];
+        }
+    }
+    throw except::Exception(Ctxt("Unknown element type " + name));
+}
+
+struct Config
+{
+    std::string workDir;
+    size_t rows;
+    size_t cols;
+    ElementType type;
+    size_t numBands;
+    std::vector<bool> byteOrders;
+    size_t repeats;
+    size_t windowSize;
+    size_t numWindows;
+};
+
+//! One file and the image it holds, in native byte order
+struct Setup
+{
+    const Config* config;
+    std::string pathname;
+    bool swapped;
+    const std::vector<sys::byte>* image;
+};
+
+struct Result
+{
+    std::string name;
+    std::string byteOrder;
+    std::string cache;
+    double megabytes;
+    std::vector<double> seconds;
+};
+
+typedef double (*Benchmark)(const Setup& setup);
+
+sio::lite::FileHeader makeHeader(const Config& config)
+{
+    return sio::lite::FileHeader(static_cast<int>(config.rows),
+                                 static_cast<int>(config.cols),
+                                 config.type.elementSize,
+                                 config.type.elementType);
+}
+
+size_t getBandSize(const Config& config)
+{
+    return config.rows * config.cols * config.type.elementSize;
+}
+
+size_t getWindowSize(const Config& config)
+{
+    return std::min(config.windowSize, config.rows) *
+            std::min(config.windowSize, config.cols) *
+            config.type.elementSize;
+}
+
+std::vector<sys::byte> makeImage(const Config& config)
+{
+    std::vector<sys::byte> image(getBandSize(config) * config.numBands);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::byte>(ii % 251);
+    }
+    return image;
+}
+
+//! Write the image as another machine would have, header and all
+void writeSwapped(const Setup& setup)
+{
+    const Config& config = *setup.config;
+    sio::lite::FileHeader header = makeHeader(config);
+    io::ByteStream headerStream;
+    header.to(config.numBands, headerStream);
+
+    // Without user data, the header is all 4-byte integers
+    std::vector<sys::byte> headerBytes(
+            reinterpret_cast<const sys::byte*>(headerStream.get()),
+            reinterpret_cast<const sys::byte*>(headerStream.get()) +
+                    headerStream.getSize());
+    sys::byteSwap(&headerBytes[0], 4, headerBytes.size() / 4);
+
+    std::vector<sys::byte> data(*setup.image);
+    const size_t swapSize = header.getSwapSize();
+    if (swapSize > 1)
+    {
+        sys::byteSwap(&data[0], static_cast<unsigned short>(swapSize),
+                      data.size() / swapSize);
+    }
+
+    io::FileOutputStream out(setup.pathname);
+    out.write(&headerBytes[0], headerBytes.size());
+    out.write(&data[0], data.size());
+    out.close();
+}
+
+void checkData(const sys::byte* data, const std::vector<sys::byte>& image,
+               size_t offset, size_t size, const std::string& pathname)
+{
+    if (memcmp(data, &image[offset], size) != 0)
+    {
+        throw except::Exception(Ctxt(pathname + " has the wrong data"));
+    }
+}
+
+// Returns the elapsed time in seconds
+double BM_Write(const Setup& setup)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileHeader header = makeHeader(*setup.config);
+    {
+        sio::lite::FileWriter writer(setup.pathname);
+        writer.write(&header, &(*setup.image)[0],
+                     static_cast<int>(setup.config->numBands));
+    }
+    return sw.stop() / 1000.0;
+}
+
+// Returns the elapsed time in seconds
+double BM_StreamingWrite(const Setup& setup)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileHeader header = makeHeader(*setup.config);
+    io::FileOutputStream out(setup.pathname);
+    header.to(setup.config->numBands, out);
+    const std::vector<sys::byte>& image = *setup.image;
+    for (size_t offset = 0; offset < image.size(); offset += CHUNK_SIZE)
+    {
+        out.write(&image[offset], std::min(CHUNK_SIZE,
+                                           image.size() - offset));
+    }
+    out.close();
+    return sw.stop() / 1000.0;
+}
+
+// Returns the elapsed time in seconds.  RowWriter writes one band.
+double BM_RowWriter(const Setup& setup)
+{
+    const Config& config = *setup.config;
+    const size_t rowSize = config.cols * config.type.elementSize;
+    const size_t rowsPerWrite = std::max<size_t>(CHUNK_SIZE / rowSize, 1);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::RowWriter writer(setup.pathname, makeHeader(config));
+    for (size_t row = 0; row < config.rows; row += rowsPerWrite)
+    {
+        writer.writeRows(
+                static_cast<const void*>(&(*setup.image)[row * rowSize]),
+                std::min(rowsPerWrite, config.rows - row));
+    }
+    writer.close();
+    return sw.stop() / 1000.0;
+}
+
+// Returns the elapsed time in seconds
+double BM_FullRead(const Setup& setup)
+{
+    const Config& config = *setup.config;
+    const size_t bandSize = getBandSize(config);
+    std::vector<sys::byte> band(bandSize);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileReader reader(setup.pathname);
+    for (size_t ii = 0; ii < config.numBands; ++ii)
+    {
+        reader.readWindow(&band[0], 0, 0, config.rows, config.cols, ii);
+        checkData(&band[0], *setup.image, ii * bandSize, bandSize,
+                  setup.pathname);
+    }
+    return sw.stop() / 1000.0;
+}
+
+// Returns the elapsed time in seconds
+double BM_StreamingRead(const Setup& setup)
+{
+    const std::vector<sys::byte>& image = *setup.image;
+    std::vector<sys::byte> chunk(CHUNK_SIZE);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    io::FileInputStream stream(setup.pathname);
+    sio::lite::StreamReader reader(&stream);
+    const sio::lite::FileHeader& header = *reader.getHeader();
+    const size_t swapSize = header.getSwapSize();
+    for (size_t offset = 0; offset < image.size(); offset += CHUNK_SIZE)
+    {
+        const size_t size = std::min(CHUNK_SIZE, image.size() - offset);
+        reader.read(&chunk[0], size, true);
+        if (header.isDifferentByteOrdering() && swapSize > 1)
+        {
+            sys::byteSwap(&chunk[0], static_cast<unsigned short>(swapSize),
+                          size / swapSize);
+        }
+        checkData(&chunk[0], image, offset, size, setup.pathname);
+    }
+    return sw.stop() / 1000.0;
+}
+
+// Returns the elapsed time in seconds
+double BM_WindowRead(const Setup& setup)
+{
+    const Config& config = *setup.config;
+    const size_t numRows = std::min(config.windowSize, config.rows);
+    const size_t numCols = std::min(config.windowSize, config.cols);
+    const size_t es = config.type.elementSize;
+    std::vector<sys::byte> window(numRows * numCols * es);
+    srand(1234);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileReader reader(setup.pathname);
+    for (size_t ii = 0; ii < config.numWindows; ++ii)
+    {
+        const size_t band = rand() % config.numBands;
+        const size_t row = rand() % (config.rows - numRows + 1);
+        const size_t col = rand() % (config.cols - numCols + 1);
+        reader.readWindow(&window[0], row, col, numRows, numCols, band);
+        for (size_t jj = 0; jj < numRows; ++jj)
+        {
+            checkData(&window[jj * numCols * es], *setup.image,
+                      ((band * config.rows + row + jj) * config.cols + col) *
+                              es,
+                      numCols * es, setup.pathname);
+        }
+    }
+    return sw.stop() / 1000.0;
+}
+
+Result runWrite(const std::string& name, Benchmark benchmark,
+                const Setup& setup)
+{
+    const Config& config = *setup.config;
+    Result result = { name, "native", "", 0, std::vector<double>() };
+    result.megabytes = setup.image->size() / (1024.0 * 1024.0);
+    for (size_t ii = 0; ii < config.repeats; ++ii)
+    {
+        result.seconds.push_back(benchmark(setup));
+    }
+    return result;
+}
+
+void runRead(const std::string& name, Benchmark benchmark,
+             const Setup& setup, double megabytes,
+             std::vector<Result>& results)
+{
+    const Config& config = *setup.config;
+    const std::string byteOrder = setup.swapped ? "swapped" : "native";
+
+    // Once untimed, so that the warm runs find the file in the page cache
+    benchmark(setup);
+    Result warm = { name, byteOrder, "warm", megabytes,
+                    std::vector<double>() };
+    for (size_t ii = 0; ii < config.repeats; ++ii)
+    {
+        warm.seconds.push_back(benchmark(setup));
+    }
+    results.push_back(warm);
+
+    Result cold = { name, byteOrder, "cold", megabytes,
+                    std::vector<double>() };
+    for (size_t ii = 0;
+         ii < config.repeats && evictFromPageCache(setup.pathname);
+         ++ii)
+    {
+        cold.seconds.push_back(benchmark(setup));
+    }
+    if (!cold.seconds.empty())
+    {
+        results.push_back(cold);
+    }
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    return values.size() % 2 == 1 ? values[middle] :
+            (values[middle - 1] + values[middle]) / 2;
+}
+
+void printJSON(const Config& config, const std::vector<Result>& results)
+{
+    std::cout << std::fixed << "{\n"
+              << "  \"benchmark\": \"sio.lite\",\n"
+              << "  \"config\": {\n"
+              << "    \"rows\": " << config.rows << ",\n"
+              << "    \"cols\": " << config.cols << ",\n"
+              << "    \"elementType\": \"" << config.type.name << "\",\n"
+              << "    \"elementSize\": " << config.type.elementSize << ",\n"
+              << "    \"numBands\": " << config.numBands << ",\n"
+              << "    \"repeats\": " << config.repeats << ",\n"
+              << "    \"windowSize\": " << config.windowSize << ",\n"
+              << "    \"numWindows\": " << config.numWindows << "\n"
+              << "  },\n"
+              << "  \"results\": [";
+    for (size_t ii = 0; ii < results.size(); ++ii)
+    {
+        const Result& result = results[ii];
+        const double medianSeconds = median(result.seconds);
+        std::cout << (ii == 0 ? "\n" : ",\n")
+                  << "    {\"name\": \"" << result.name << "\", "
+                  << "\"byteOrder\": \"" << result.byteOrder << "\", "
+                  << "\"cache\": ";
+        if (result.cache.empty())
+        {
+            std::cout << "null";
+        }
+        else
+        {
+            std::cout << "\"" << result.cache << "\"";
+        }
+        std::cout << std::setprecision(3)
+                  << ", \"megabytes\": " << result.megabytes
+                  << std::setprecision(6)
+                  << ", \"medianSeconds\": " << medianSeconds
+                  << ", \"bestSeconds\": "
+                  << *std::min_element(result.seconds.begin(),
+                                       result.seconds.end())
+                  << std::setprecision(1)
+                  << ", \"medianMBps\": " << result.megabytes / medianSeconds
+                  << "}";
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [rows] [cols] [elementType] [numBands]"
+                      << " [native|swapped|both] [repeats]" << std::endl
+                      << "Element types are ubyte, int16, uint16, int32,"
+                      << " float, double, cfloat and cdouble" << std::endl;
+            return 1;
+        }
+
+        Config config;
+        config.workDir = argv[1];
+        config.rows = (argc > 2) ? str::toType<size_t>(argv[2]) : 4096;
+        config.cols = (argc > 3) ? str::toType<size_t>(argv[3]) : 4096;
+        config.type = findElementType((argc > 4) ? argv[4] : "float");
+        config.numBands = (argc > 5) ? str::toType<size_t>(argv[5]) : 1;
+        const std::string byteOrder = (argc > 6) ? argv[6] : "both";
+        config.repeats = (argc > 7) ? str::toType<size_t>(argv[7]) : 3;
+        config.windowSize = 256;
+        config.numWindows = 100;
+        if (byteOrder != "swapped")
+        {
+            config.byteOrders.push_back(false);
+        }
+        if (byteOrder != "native")
+        {
+            config.byteOrders.push_back(true);
+        }
+        if (config.rows == 0 || config.cols == 0 || config.numBands == 0 ||
+            config.repeats == 0 || (byteOrder != "native" &&
+                                    byteOrder != "swapped" &&
+                                    byteOrder != "both"))
+        {
+            throw except::Exception(Ctxt("Invalid arguments"));
+        }
+
+        const std::vector<sys::byte> image = makeImage(config);
+        const double imageMB = image.size() / (1024.0 * 1024.0);
+        const double windowsMB = config.numWindows * getWindowSize(config) /
+                (1024.0 * 1024.0);
+        const Setup setup = {
+            &config, sys::Path::joinPaths(config.workDir, "io_benchmark.sio"),
+            false, &image
+        };
+
+        std::vector<Result> results;
+        results.push_back(runWrite("write", BM_Write, setup));
+        results.push_back(runWrite("streaming write", BM_StreamingWrite,
+                                   setup));
+        if (config.numBands == 1)
+        {
+            results.push_back(runWrite("RowWriter", BM_RowWriter, setup));
+        }
+
+        for (size_t ii = 0; ii < config.byteOrders.size(); ++ii)
+        {
+            Setup readSetup = setup;
+            readSetup.swapped = config.byteOrders[ii];
+            if (readSetup.swapped)
+            {
+                writeSwapped(readSetup);
+            }
+            else
+            {
+                BM_Write(readSetup);
+            }
+
+            runRead("full read", BM_FullRead, readSetup, imageMB, results);
+            runRead("streaming read", BM_StreamingRead, readSetup, imageMB,
+                    results);
+            runRead("window read", BM_WindowRead, readSetup, windowsMB,
+                    results);
+        }
+
+        sys::OS().remove(setup.pathname);
+        printJSON(config, results);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
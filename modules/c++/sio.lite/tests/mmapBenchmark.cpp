@@ -0,0 +1,209 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/mem.h>
+#include <import/types.h>
+#include <import/sio/lite.h>
+#include "PageCache.h"
+
+// Benchmarks how long it takes to open an SIO and get at its first pixel,
+// and then to look at every pixel, through readSIO() and through
+// MMapReader.  Each case runs with the file in the page cache and, on
+// Linux, after evicting it.
+namespace
+{
+void writeImage(const std::string& pathname, size_t rows, size_t cols,
+                bool swapped)
+{
+    std::vector<float> image(rows * cols);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<float>(ii % 1000);
+    }
+
+    sio::lite::FileHeader header(rows, cols, sizeof(float),
+                                 sio::lite::FileHeader::FLOAT);
+    io::ByteStream headerStream;
+    header.to(1, headerStream);
+    std::vector<sys::byte> headerBytes(
+            reinterpret_cast<const sys::byte*>(headerStream.get()),
+            reinterpret_cast<const sys::byte*>(headerStream.get()) +
+                    headerStream.getSize());
+    if (swapped)
+    {
+        sys::byteSwap(&headerBytes[0], 4, headerBytes.size() / 4);
+        sys::byteSwap(&image[0], sizeof(float), image.size());
+    }
+
+    io::FileOutputStream out(pathname);
+    out.write(&headerBytes[0], headerBytes.size());
+    out.write(&image[0], image.size() * sizeof(float));
+    out.close();
+}
+
+double sum(const float* data, size_t rows, size_t cols, size_t stride)
+{
+    double total = 0;
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const float* const rowData = data + row * stride;
+        for (size_t col = 0; col < cols; ++col)
+        {
+            total += rowData[col];
+        }
+    }
+    return total;
+}
+
+double elapsedMS(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+struct Result
+{
+    Result() :
+        firstPixelMS(0),
+        allPixelsMS(0),
+        total(0)
+    {
+    }
+
+    double firstPixelMS;
+    double allPixelsMS;
+    double total;
+};
+
+Result BM_ReadSIO(const std::string& pathname)
+{
+    Result result;
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    types::RowCol<size_t> dims;
+    mem::ScopedArray<float> image;
+    sio::lite::readSIO(pathname, dims, image);
+    sio::lite::FileReader reader(pathname);
+    if (reader.getHeader()->isDifferentByteOrdering())
+    {
+        sys::byteSwap(image.get(), sizeof(float), dims.area());
+    }
+    result.total = image[0];
+    result.firstPixelMS = elapsedMS(start);
+    result.total += sum(image.get(), dims.row, dims.col, dims.col);
+    result.allPixelsMS = elapsedMS(start);
+    return result;
+}
+
+Result BM_MMapReader(const std::string& pathname)
+{
+    Result result;
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+    sio::lite::MMapReader reader(pathname);
+    const sio::lite::ImageView<float> image = reader.getBand<float>();
+    result.total = image(0, 0);
+    result.firstPixelMS = elapsedMS(start);
+    result.total += sum(image.data(), image.getNumRows(),
+                        image.getNumCols(), image.getRowStride());
+    result.allPixelsMS = elapsedMS(start);
+    return result;
+}
+
+void printResult(const std::string& name, const Result& result)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(14) << std::right << std::fixed
+              << std::setprecision(3) << result.firstPixelMS << " "
+              << std::setw(14) << std::right << std::fixed
+              << std::setprecision(1) << result.allPixelsMS << std::endl;
+}
+
+void runBenchmarks(const std::string& label, const std::string& pathname)
+{
+    printResult(label + " readSIO", BM_ReadSIO(pathname));
+    printResult(label + " MMapReader", BM_MMapReader(pathname));
+    if (evictFromPageCache(pathname))
+    {
+        printResult(label + " readSIO (cold)", BM_ReadSIO(pathname));
+        evictFromPageCache(pathname);
+        printResult(label + " MMapReader (cold)", BM_MMapReader(pathname));
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [rows] [cols]" << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t rows = (argc > 2) ? str::toType<size_t>(argv[2]) : 8192;
+        const size_t cols = (argc > 3) ? str::toType<size_t>(argv[3]) : 8192;
+
+        const std::string nativeFile =
+                sys::Path::joinPaths(workDir, "mmap_native.sio");
+        const std::string swappedFile =
+                sys::Path::joinPaths(workDir, "mmap_swapped.sio");
+        writeImage(nativeFile, rows, cols, false);
+        writeImage(swappedFile, rows, cols, true);
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(14) << std::right << "1st pixel (ms)" << " "
+                  << std::setw(14) << std::right << "All (ms)" << std::endl;
+        std::cout << std::string(58, '-') << std::endl;
+
+        runBenchmarks("native", nativeFile);
+        runBenchmarks("swapped", swappedFile);
+
+        sys::OS().remove(nativeFile);
+        sys::OS().remove(swappedFile);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,214 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/io.h>
+#include <import/sio/lite.h>
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+// Writes a float SIO whose rows are computed a block at a time, three ways:
+// computing the whole image and then calling writeSIO(), writing each block
+// through a FileOutputStream as it is computed, and handing each block to a
+// RowWriter.  Reports time and peak resident memory; each run happens in
+// its own child process so the peak memory of one doesn't hide the other's.
+namespace
+{
+const char* const SIO_FILE = "rowWriterBenchmark.sio";
+const size_t BLOCK_ROWS = 16;
+
+//! Stands in for whatever work produces the rows
+void produceRows(float* rows, size_t firstRow, size_t numRows, size_t cols)
+{
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            rows[row * cols + col] = std::sqrt(
+                    static_cast<float>((firstRow + row) * cols + col));
+        }
+    }
+}
+
+double BM_WriteSIO(size_t rows, size_t cols)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    std::vector<float> image(rows * cols);
+    for (size_t row = 0; row < rows; row += BLOCK_ROWS)
+    {
+        produceRows(&image[row * cols], row,
+                    std::min(BLOCK_ROWS, rows - row), cols);
+    }
+    sio::lite::writeSIO(&image[0], rows, cols, SIO_FILE);
+    return sw.stop();
+}
+
+double BM_SyncRows(size_t rows, size_t cols)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileHeader header =
+            sio::lite::makeFileHeader<float>(rows, cols);
+    io::FileOutputStream out(SIO_FILE);
+    header.to(1, out);
+    std::vector<float> block(BLOCK_ROWS * cols);
+    for (size_t row = 0; row < rows; row += BLOCK_ROWS)
+    {
+        const size_t numRows = std::min(BLOCK_ROWS, rows - row);
+        produceRows(&block[0], row, numRows, cols);
+        out.write(&block[0], numRows * cols * sizeof(float));
+    }
+    out.close();
+    return sw.stop();
+}
+
+double BM_RowWriter(size_t rows, size_t cols)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::RowWriter writer(SIO_FILE,
+                                sio::lite::makeFileHeader<float>(0, cols));
+    std::vector<float> block(BLOCK_ROWS * cols);
+    for (size_t row = 0; row < rows; row += BLOCK_ROWS)
+    {
+        const size_t numRows = std::min(BLOCK_ROWS, rows - row);
+        produceRows(&block[0], row, numRows, cols);
+        writer.writeRows(&block[0], numRows);
+    }
+    writer.close();
+    return sw.stop();
+}
+
+double peakMemoryMB()
+{
+#if defined(WIN32) || defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+void printResult(const std::string& name, double elapsedMS, size_t totalMB)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0) << " "
+              << std::setw(14) << std::right << std::fixed
+              << std::setprecision(1) << peakMemoryMB() << std::endl;
+}
+
+void runBenchmark(int which, size_t rows, size_t cols)
+{
+    const size_t totalMB = rows * cols * sizeof(float) / (1024 * 1024);
+    switch (which)
+    {
+    case 0:
+        printResult("writeSIO", BM_WriteSIO(rows, cols), totalMB);
+        break;
+    case 1:
+        printResult("FileOutputStream rows", BM_SyncRows(rows, cols),
+                    totalMB);
+        break;
+    default:
+        printResult("RowWriter", BM_RowWriter(rows, cols), totalMB);
+        break;
+    }
+    sys::OS().remove(SIO_FILE);
+}
+
+void runInChild(int which, size_t rows, size_t cols)
+{
+#if defined(WIN32) || defined(_WIN32)
+    runBenchmark(which, rows, cols);
+#else
+    std::cout.flush();
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        try
+        {
+            runBenchmark(which, rows, cols);
+        }
+        catch (const except::Exception& ex)
+        {
+            std::cerr << ex.toString() << std::endl;
+        }
+        std::cout.flush();
+        ::_exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+#endif
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t totalMB = (argc > 1) ? str::toType<size_t>(argv[1]) : 512;
+        const size_t cols = 4096;
+        const size_t rows = totalMB * 1024 * 1024 / (cols * sizeof(float));
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << " "
+                  << std::setw(14) << std::right << "Peak RSS (MB)"
+                  << std::endl;
+        std::cout << std::string(69, '-') << std::endl;
+
+        for (int which = 0; which < 3; ++which)
+        {
+            runInChild(which, rows, cols);
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
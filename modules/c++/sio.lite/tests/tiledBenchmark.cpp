@@ -0,0 +1,241 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/sio/lite.h>
+#include "PageCache.h"
+
+// Benchmarks random chips and column and row strips of a large image read
+// with FileReader::readWindow(), from a band-sequential SIO and from a
+// tiled one.  Each case runs with the file in the page cache and, on
+// Linux, after evicting it.
+namespace
+{
+struct Window
+{
+    size_t row;
+    size_t col;
+    size_t numRows;
+    size_t numCols;
+};
+
+//! Pixel (row, col) holds row * cols + col, so any window can be checked
+void writeImage(const std::string& pathname, size_t rows, size_t cols,
+                size_t tileSize)
+{
+    std::vector<sys::Uint32_T> image(rows * cols);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::Uint32_T>(ii);
+    }
+
+    sio::lite::FileHeader header(static_cast<int>(rows),
+                                 static_cast<int>(cols),
+                                 sizeof(sys::Uint32_T),
+                                 sio::lite::FileHeader::UNSIGNED);
+    sio::lite::FileWriter writer(pathname);
+    if (tileSize == 0)
+    {
+        writer.write(&header, &image[0]);
+    }
+    else
+    {
+        writer.writeTiled(&header, &image[0], tileSize, tileSize);
+    }
+}
+
+void checkWindow(const std::vector<sys::Uint32_T>& chip,
+                 const Window& window,
+                 size_t cols)
+{
+    for (size_t row = 0; row < window.numRows; ++row)
+    {
+        for (size_t col = 0; col < window.numCols; ++col)
+        {
+            const size_t expected =
+                    (window.row + row) * cols + window.col + col;
+            if (chip[row * window.numCols + col] != expected)
+            {
+                throw except::Exception(Ctxt(
+                        "Window at (" + str::toString(window.row) + ", " +
+                        str::toString(window.col) + ") has the wrong data"));
+            }
+        }
+    }
+}
+
+//! Windows at random, or at random multiples of 'align' if it isn't 0
+std::vector<Window> makeWindows(size_t numWindows, size_t numRows,
+                                size_t numCols, size_t rows, size_t cols,
+                                size_t align = 0)
+{
+    srand(1234);
+    std::vector<Window> windows(numWindows);
+    for (size_t ii = 0; ii < numWindows; ++ii)
+    {
+        windows[ii].row = rand() % (rows - numRows + 1);
+        windows[ii].col = rand() % (cols - numCols + 1);
+        if (align != 0)
+        {
+            windows[ii].row -= windows[ii].row % align;
+            windows[ii].col -= windows[ii].col % align;
+        }
+        windows[ii].numRows = numRows;
+        windows[ii].numCols = numCols;
+    }
+    return windows;
+}
+
+// Returns the elapsed time in ms
+double BM_ReadWindow(const std::string& pathname,
+                     const std::vector<Window>& windows)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileReader reader(pathname);
+    const size_t cols = reader.getTileIndex() ?
+            reader.getTileIndex()->getNumCols() :
+            reader.getHeader()->getNumElements();
+    std::vector<sys::Uint32_T> chip;
+    for (size_t ii = 0; ii < windows.size(); ++ii)
+    {
+        const Window& window = windows[ii];
+        chip.resize(window.numRows * window.numCols);
+        reader.readWindow(&chip[0], window.row, window.col,
+                          window.numRows, window.numCols);
+        checkWindow(chip, window, cols);
+    }
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS,
+                 const std::vector<Window>& windows)
+{
+    double totalMB = 0;
+    for (size_t ii = 0; ii < windows.size(); ++ii)
+    {
+        totalMB += windows[ii].numRows * windows[ii].numCols *
+                sizeof(sys::Uint32_T) / (1024.0 * 1024.0);
+    }
+    std::cout << std::setw(36) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(3) << elapsedMS / windows.size() << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+
+void runBenchmark(const std::string& name,
+                  const std::string& classic,
+                  const std::string& tiled,
+                  const std::vector<Window>& windows)
+{
+    const std::string pathnames[] = { classic, tiled };
+    const std::string layouts[] = { "", " (tiled)" };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        printResult(name + layouts[ii],
+                    BM_ReadWindow(pathnames[ii], windows), windows);
+        if (evictFromPageCache(pathnames[ii]))
+        {
+            printResult(name + layouts[ii] + ", cold",
+                        BM_ReadWindow(pathnames[ii], windows), windows);
+        }
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [rows] [cols] [tileSize] [numChips]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t rows = (argc > 2) ? str::toType<size_t>(argv[2]) : 8192;
+        const size_t cols = (argc > 3) ? str::toType<size_t>(argv[3]) : 8192;
+        const size_t tileSize =
+                (argc > 4) ? str::toType<size_t>(argv[4]) : 256;
+        const size_t numChips =
+                (argc > 5) ? str::toType<size_t>(argv[5]) : 200;
+
+        const std::string classic =
+                sys::Path::joinPaths(workDir, "tiled_benchmark.sio");
+        const std::string tiled =
+                sys::Path::joinPaths(workDir, "tiled_benchmark_tiles.sio");
+        writeImage(classic, rows, cols, 0);
+        writeImage(tiled, rows, cols, tileSize);
+
+        const size_t chipSize = std::min(tileSize, std::min(rows, cols));
+        const std::vector<Window> tiles = makeWindows(
+                numChips, chipSize, chipSize, rows, cols, tileSize);
+        const std::vector<Window> chips = makeWindows(
+                numChips, chipSize, chipSize, rows, cols);
+        const std::vector<Window> colStrips = makeWindows(
+                std::max<size_t>(numChips / 10, 1), rows,
+                std::min<size_t>(cols, 64), rows, cols);
+        const std::vector<Window> rowStrips = makeWindows(
+                numChips, std::min<size_t>(rows, 64), cols, rows, cols);
+
+        std::cout << std::setw(36) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "ms/window" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(62, '-') << std::endl;
+
+        const std::string chipName =
+                str::toString(chipSize) + "x" + str::toString(chipSize);
+        runBenchmark(chipName + " tile", classic, tiled, tiles);
+        runBenchmark(chipName + " chip", classic, tiled, chips);
+        runBenchmark("64-col strip", classic, tiled, colStrips);
+        runBenchmark("64-row strip", classic, tiled, rowStrips);
+
+        sys::OS().remove(classic);
+        sys::OS().remove(tiled);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/sio/lite.h>
+
+// Benchmarks opening SIOs with many small user data fields and with a few
+// large ones, reading the user data, deferring it or skipping it, and
+// looking every field up by name
+namespace
+{
+std::string fieldName(size_t ii)
+{
+    return "field" + str::toString(ii);
+}
+
+void writeImage(const std::string& pathname, size_t numFields,
+                size_t fieldSize)
+{
+    const std::vector<float> image(64 * 64);
+    sio::lite::FileHeader header(64, 64, sizeof(float),
+                                 sio::lite::FileHeader::FLOAT);
+    for (size_t ii = 0; ii < numFields; ++ii)
+    {
+        header.addUserData(fieldName(ii),
+                           std::vector<sys::byte>(fieldSize, 'x'));
+    }
+    sio::lite::FileWriter writer(pathname);
+    writer.write(&header, &image[0]);
+}
+
+// Returns the elapsed time in ms per open
+double BM_Open(const std::string& pathname,
+               sio::lite::StreamReader::UserDataPolicy policy,
+               size_t numOpens)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t ii = 0; ii < numOpens; ++ii)
+    {
+        sio::lite::FileReader reader(pathname, policy);
+        if (reader.getHeader()->getNumLines() != 64)
+        {
+            throw except::Exception(Ctxt("Wrong header"));
+        }
+    }
+    return sw.stop() / numOpens;
+}
+
+// Returns the elapsed time in ms to look every field up
+double BM_Lookup(const std::string& pathname,
+                 sio::lite::StreamReader::UserDataPolicy policy,
+                 size_t numFields)
+{
+    sio::lite::FileReader reader(pathname, policy);
+    const sio::lite::FileHeader& header = *reader.getHeader();
+    std::vector<std::string> names(numFields);
+    for (size_t ii = 0; ii < numFields; ++ii)
+    {
+        names[ii] = fieldName(ii);
+    }
+
+    size_t total = 0;
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t ii = 0; ii < numFields; ++ii)
+    {
+        total += header.getUserData(names[ii]).size();
+    }
+    const double elapsed = sw.stop();
+    if (total == 0)
+    {
+        throw except::Exception(Ctxt("No user data"));
+    }
+    return elapsed;
+}
+
+void printResult(const std::string& name, double elapsedMS)
+{
+    std::cout << std::setw(40) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(3) << elapsedMS << std::endl;
+}
+
+void runBenchmarks(const std::string& label, const std::string& pathname,
+                   size_t numFields, size_t fieldSize, size_t numOpens)
+{
+    writeImage(pathname, numFields, fieldSize);
+    printResult(label + ", open",
+                BM_Open(pathname, sio::lite::StreamReader::READ_USER_DATA,
+                        numOpens));
+    printResult(label + ", open deferred",
+                BM_Open(pathname, sio::lite::StreamReader::DEFER_USER_DATA,
+                        numOpens));
+    printResult(label + ", open skipped",
+                BM_Open(pathname, sio::lite::StreamReader::SKIP_USER_DATA,
+                        numOpens));
+    printResult(label + ", look up all",
+                BM_Lookup(pathname, sio::lite::StreamReader::READ_USER_DATA,
+                          numFields));
+    printResult(label + ", look up all deferred",
+                BM_Lookup(pathname, sio::lite::StreamReader::DEFER_USER_DATA,
+                          numFields));
+    sys::OS().remove(pathname);
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const std::string workDir = (argc > 1) ? argv[1] : ".";
+        const size_t numOpens = (argc > 2) ? str::toType<size_t>(argv[2]) : 10;
+        const std::string pathname =
+                sys::Path::joinPaths(workDir, "user_data_benchmark.sio");
+
+        std::cout << std::setw(40) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << std::endl;
+        std::cout << std::string(53, '-') << std::endl;
+
+        runBenchmarks("10000 x 64B fields", pathname, 10000, 64, numOpens);
+        runBenchmarks("8 x 16MB fields", pathname, 8, 16 * 1024 * 1024,
+                      numOpens);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
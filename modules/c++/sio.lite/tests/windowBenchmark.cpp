@@ -0,0 +1,323 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/sio/lite.h>
+
+// Benchmarks FileReader::readWindow() for chips and strips of a large image,
+// against reading the whole image and cropping the chip out of it
+namespace
+{
+struct Window
+{
+    size_t row;
+    size_t col;
+    size_t numRows;
+    size_t numCols;
+};
+
+//! Pixel (row, col) holds row * cols + col, so any window can be checked
+void writeImage(const std::string& pathname, size_t rows, size_t cols)
+{
+    std::vector<sys::Uint32_T> image(rows * cols);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::Uint32_T>(ii);
+    }
+    sio::lite::writeSIO(&image[0], rows, cols, pathname,
+                        sio::lite::FileHeader::UNSIGNED);
+}
+
+void checkWindow(const std::vector<sys::Uint32_T>& chip,
+                 const Window& window,
+                 size_t cols)
+{
+    for (size_t row = 0; row < window.numRows; ++row)
+    {
+        for (size_t col = 0; col < window.numCols; ++col)
+        {
+            const size_t expected =
+                    (window.row + row) * cols + window.col + col;
+            if (chip[row * window.numCols + col] != expected)
+            {
+                throw except::Exception(Ctxt(
+                        "Window at (" + str::toString(window.row) + ", " +
+                        str::toString(window.col) + ") has the wrong data"));
+            }
+        }
+    }
+}
+
+std::vector<Window> makeWindows(size_t numWindows, size_t numRows,
+                                size_t numCols, size_t rows, size_t cols)
+{
+    srand(1234);
+    std::vector<Window> windows(numWindows);
+    for (size_t ii = 0; ii < numWindows; ++ii)
+    {
+        windows[ii].row = rand() % (rows - numRows + 1);
+        windows[ii].col = rand() % (cols - numCols + 1);
+        windows[ii].numRows = numRows;
+        windows[ii].numCols = numCols;
+    }
+    return windows;
+}
+
+// Returns the elapsed time in ms
+double BM_FullRead(const std::string& pathname,
+                   const std::vector<Window>& windows)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t ii = 0; ii < windows.size(); ++ii)
+    {
+        const Window& window = windows[ii];
+        sio::lite::FileReader reader(pathname);
+        const size_t cols = reader.getHeader()->getNumElements();
+        std::vector<sys::Uint32_T> image(
+                static_cast<size_t>(reader.getHeader()->getNumLines()) *
+                cols);
+        reader.read(&image[0], image.size() * sizeof(sys::Uint32_T), true);
+
+        std::vector<sys::Uint32_T> chip(window.numRows * window.numCols);
+        for (size_t row = 0; row < window.numRows; ++row)
+        {
+            std::copy(&image[(window.row + row) * cols + window.col],
+                      &image[(window.row + row) * cols + window.col] +
+                              window.numCols,
+                      &chip[row * window.numCols]);
+        }
+        checkWindow(chip, window, cols);
+    }
+    return sw.stop();
+}
+
+double BM_ReadWindow(const std::string& pathname,
+                     const std::vector<Window>& windows,
+                     bool byPathname)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    io::FileInputStream stream(pathname);
+    std::unique_ptr<sio::lite::FileReader> reader(byPathname ?
+            new sio::lite::FileReader(pathname) :
+            new sio::lite::FileReader(&stream));
+    const size_t cols = reader->getHeader()->getNumElements();
+    std::vector<sys::Uint32_T> chip;
+    for (size_t ii = 0; ii < windows.size(); ++ii)
+    {
+        const Window& window = windows[ii];
+        chip.resize(window.numRows * window.numCols);
+        reader->readWindow(&chip[0], window.row, window.col,
+                           window.numRows, window.numCols);
+        checkWindow(chip, window, cols);
+    }
+    return sw.stop();
+}
+
+class ReadWindows : public sys::Runnable
+{
+public:
+    ReadWindows(sio::lite::FileReader& reader,
+                const std::vector<Window>& windows,
+                size_t start,
+                size_t stride,
+                bool& failed) :
+        mReader(reader),
+        mWindows(windows),
+        mStart(start),
+        mStride(stride),
+        mFailed(failed)
+    {
+    }
+
+    virtual void run()
+    {
+        try
+        {
+            const size_t cols = mReader.getHeader()->getNumElements();
+            std::vector<sys::Uint32_T> chip;
+            for (size_t ii = mStart; ii < mWindows.size(); ii += mStride)
+            {
+                const Window& window = mWindows[ii];
+                chip.resize(window.numRows * window.numCols);
+                mReader.readWindow(&chip[0], window.row, window.col,
+                                   window.numRows, window.numCols);
+                checkWindow(chip, window, cols);
+            }
+        }
+        catch (...)
+        {
+            mFailed = true;
+        }
+    }
+
+private:
+    sio::lite::FileReader& mReader;
+    const std::vector<Window>& mWindows;
+    const size_t mStart;
+    const size_t mStride;
+    bool& mFailed;
+};
+
+double BM_ConcurrentReadWindow(const std::string& pathname,
+                               const std::vector<Window>& windows,
+                               size_t numThreads)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    sio::lite::FileReader reader(pathname);
+    bool anyFailed = false;
+    std::vector<sys::Thread*> threads(numThreads);
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        threads[ii] = new sys::Thread(new ReadWindows(
+                reader, windows, ii, numThreads, anyFailed));
+        threads[ii]->start();
+    }
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        threads[ii]->join();
+        delete threads[ii];
+    }
+    if (anyFailed)
+    {
+        throw except::Exception(Ctxt("A concurrent window read failed"));
+    }
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS,
+                 const std::vector<Window>& windows)
+{
+    double totalMB = 0;
+    for (size_t ii = 0; ii < windows.size(); ++ii)
+    {
+        totalMB += windows[ii].numRows * windows[ii].numCols *
+                sizeof(sys::Uint32_T) / (1024.0 * 1024.0);
+    }
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(3) << elapsedMS / windows.size() << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [rows] [cols] [numChips] [maxThreads]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t rows = (argc > 2) ? str::toType<size_t>(argv[2]) : 8192;
+        const size_t cols = (argc > 3) ? str::toType<size_t>(argv[3]) : 8192;
+        const size_t numChips =
+                (argc > 4) ? str::toType<size_t>(argv[4]) : 200;
+        const size_t maxThreads = (argc > 5) ?
+                str::toType<size_t>(argv[5]) : sys::OS().getNumCPUs();
+
+        const std::string pathname =
+                sys::Path::joinPaths(workDir, "window_benchmark.sio");
+        writeImage(pathname, rows, cols);
+
+        const std::vector<Window> smallChips =
+                makeWindows(numChips, std::min<size_t>(rows, 256),
+                            std::min<size_t>(cols, 256), rows, cols);
+        const std::vector<Window> largeChips =
+                makeWindows(numChips, std::min<size_t>(rows, 1024),
+                            std::min<size_t>(cols, 1024), rows, cols);
+        const std::vector<Window> wideChips =
+                makeWindows(numChips, std::min<size_t>(rows, 256),
+                            cols - std::min<size_t>(cols, 16), rows, cols);
+        const std::vector<Window> rowStrips =
+                makeWindows(numChips, std::min<size_t>(rows, 64), cols,
+                            rows, cols);
+        const std::vector<Window> colStrips =
+                makeWindows(std::max<size_t>(numChips / 10, 1), rows,
+                            std::min<size_t>(cols, 64), rows, cols);
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "ms/window" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(54, '-') << std::endl;
+
+        const std::vector<Window> fullReadChips(
+                smallChips.begin(),
+                smallChips.begin() + std::min<size_t>(numChips, 5));
+        printResult("256x256 full read + crop",
+                    BM_FullRead(pathname, fullReadChips), fullReadChips);
+        printResult("256x256 window (stream)",
+                    BM_ReadWindow(pathname, smallChips, false), smallChips);
+        printResult("256x256 window",
+                    BM_ReadWindow(pathname, smallChips, true), smallChips);
+        printResult("1024x1024 window",
+                    BM_ReadWindow(pathname, largeChips, true), largeChips);
+        printResult("256 rows, cols-16 window",
+                    BM_ReadWindow(pathname, wideChips, true), wideChips);
+        printResult("64-row strip",
+                    BM_ReadWindow(pathname, rowStrips, true), rowStrips);
+        printResult("64-col strip",
+                    BM_ReadWindow(pathname, colStrips, true), colStrips);
+        for (size_t numThreads = 2; numThreads <= maxThreads;
+             numThreads *= 2)
+        {
+            printResult("256x256 window (" + str::toString(numThreads) +
+                                " thr)",
+                        BM_ConcurrentReadWindow(pathname, smallChips,
+                                                numThreads),
+                        smallChips);
+        }
+
+        sys::OS().remove(pathname);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
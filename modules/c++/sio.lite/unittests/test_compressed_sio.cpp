@@ -0,0 +1,264 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <io/FileInputStream.h>
+#include <sio/lite/BlockIndex.h>
+#include <sio/lite/FileHeader.h>
+#include <sio/lite/FileReader.h>
+#include <sio/lite/FileWriter.h>
+#include <sio/lite/InvalidHeaderException.h>
+#include <sio/lite/MMapReader.h>
+#include <sio/lite/StreamReader.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const SIO_FILE = "test_compressed_sio.sio";
+
+// Blocks that don't divide the rows or the image, so windows straddle
+// blocks and the last block is short
+const size_t ROWS = 50;
+const size_t COLS = 37;
+const size_t NUM_BANDS = 2;
+const size_t BLOCK_SIZE = 1000;
+
+//! Pixel (row, col) of band b holds (b * rows + row) * cols + col
+std::vector<sys::Uint32_T> makeImage()
+{
+    std::vector<sys::Uint32_T> image(ROWS * COLS * NUM_BANDS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::Uint32_T>(ii);
+    }
+    return image;
+}
+
+void writeCompressedImage(size_t numThreads = 2)
+{
+    const std::vector<sys::Uint32_T> image = makeImage();
+    sio::lite::FileHeader header(ROWS, COLS, sizeof(sys::Uint32_T),
+                                 sio::lite::FileHeader::UNSIGNED);
+    header.addUserData("name", "block test");
+    sio::lite::FileWriter writer(SIO_FILE);
+    writer.writeCompressed(&header, &image[0], static_cast<int>(NUM_BANDS),
+                           BLOCK_SIZE, sio::lite::BlockIndex::DEFAULT_LEVEL,
+                           numThreads);
+}
+
+bool windowMatches(const std::vector<sys::Uint32_T>& window,
+                   size_t rowStart, size_t colStart,
+                   size_t numRows, size_t numCols, size_t band = 0)
+{
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        for (size_t col = 0; col < numCols; ++col)
+        {
+            const size_t expected =
+                    (band * ROWS + rowStart + row) * COLS + colStart + col;
+            if (window[row * numCols + col] != expected)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testLayout)
+{
+    sio::lite::BlockIndex blocks(2500, 1000);
+    TEST_ASSERT_EQ(blocks.getNumBlocks(), 3);
+    TEST_ASSERT_EQ(blocks.getBlockDataSize(0), 1000);
+    TEST_ASSERT_EQ(blocks.getBlockDataSize(2), 500);
+    TEST_ASSERT_EQ(blocks.getBlock(1999), 1);
+
+    std::vector<size_t> sizes;
+    sizes.push_back(10);
+    sizes.push_back(20);
+    TEST_EXCEPTION(blocks.setCompressedSizes(sizes));
+    sizes.push_back(5);
+    blocks.setCompressedSizes(sizes);
+    TEST_ASSERT_EQ(blocks.getOffset(2), 30);
+    TEST_ASSERT_EQ(blocks.getCompressedSize(1), 20);
+    TEST_ASSERT_EQ(blocks.getCompressedDataSize(), 35);
+    TEST_EXCEPTION(blocks.getOffset(3));
+
+    sio::lite::FileHeader header(10, 10, 1, sio::lite::FileHeader::UNSIGNED);
+    TEST_ASSERT(sio::lite::BlockIndex::fromHeader(header).get() == NULL);
+    blocks.addTo(header);
+    std::unique_ptr<sio::lite::BlockIndex> read =
+            sio::lite::BlockIndex::fromHeader(header);
+    TEST_ASSERT(read.get() != NULL);
+    TEST_ASSERT_EQ(read->getDataSize(), 2500);
+    TEST_ASSERT_EQ(read->getBlockSize(), 1000);
+    TEST_ASSERT_EQ(read->getOffset(1), 10);
+    TEST_ASSERT_EQ(read->getCompressedDataSize(), 35);
+
+    // One offset short
+    std::vector<sys::byte>& field =
+            header.getUserData(sio::lite::BlockIndex::USER_DATA_KEY);
+    field.resize(field.size() - sizeof(sys::Uint64_T));
+    TEST_EXCEPTION(sio::lite::BlockIndex::fromHeader(header));
+}
+
+TEST_CASE(testReadWindow)
+{
+    if (!sio::lite::BlockIndex::isSupported())
+    {
+        const std::vector<sys::Uint32_T> image = makeImage();
+        sio::lite::FileHeader header(ROWS, COLS, sizeof(sys::Uint32_T),
+                                     sio::lite::FileHeader::UNSIGNED);
+        sio::lite::FileWriter writer(SIO_FILE);
+        TEST_EXCEPTION(writer.writeCompressed(&header, &image[0]));
+        sys::OS().remove(SIO_FILE);
+        return;
+    }
+
+    writeCompressedImage();
+    sio::lite::FileReader reader(SIO_FILE);
+    const sio::lite::BlockIndex* const blocks = reader.getBlockIndex();
+    TEST_ASSERT(blocks != NULL);
+    TEST_ASSERT_EQ(blocks->getNumBlocks(), 15);
+    TEST_ASSERT_EQ(blocks->getDataSize(),
+                   ROWS * COLS * NUM_BANDS * sizeof(sys::Uint32_T));
+    TEST_ASSERT(reader.getHeader()->getUserData("name").size() > 0);
+
+    std::vector<sys::Uint32_T> window(ROWS * COLS);
+    reader.readWindow(&window[0], 0, 0, ROWS, COLS, 1);
+    TEST_ASSERT(windowMatches(window, 0, 0, ROWS, COLS, 1));
+
+    reader.readWindow(&window[0], 5, 30, 20, 7);
+    TEST_ASSERT(windowMatches(window, 5, 30, 20, 7));
+
+    TEST_EXCEPTION(reader.readWindow(&window[0], 45, 0, 6, 1));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testReadBlock)
+{
+    if (!sio::lite::BlockIndex::isSupported())
+    {
+        return;
+    }
+
+    writeCompressedImage(1);
+    const std::vector<sys::Uint32_T> image = makeImage();
+    sio::lite::FileReader reader(SIO_FILE);
+    const sio::lite::BlockIndex& blocks = *reader.getBlockIndex();
+
+    // In any order, including the short one at the end
+    std::vector<sys::Uint32_T> block(BLOCK_SIZE / sizeof(sys::Uint32_T));
+    reader.readBlock(&block[0], 14);
+    TEST_ASSERT_EQ(blocks.getBlockDataSize(14), 800);
+    TEST_ASSERT_EQ(block[0], 14 * 250);
+    TEST_ASSERT_EQ(block[199], image.back());
+    reader.readBlock(&block[0], 3);
+    TEST_ASSERT_EQ(block[0], 3 * 250);
+    TEST_EXCEPTION(reader.readBlock(&block[0], 15));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testStreamReadBlock)
+{
+    if (!sio::lite::BlockIndex::isSupported())
+    {
+        return;
+    }
+
+    writeCompressedImage();
+    {
+        io::FileInputStream stream(SIO_FILE);
+        sio::lite::StreamReader reader(&stream);
+        std::vector<sys::Uint32_T> block(BLOCK_SIZE / sizeof(sys::Uint32_T));
+        reader.readBlock(&block[0], 1);
+        TEST_ASSERT_EQ(block[0], 250);
+
+        // Skipping ahead is fine, going back isn't
+        reader.readBlock(&block[0], 4);
+        TEST_ASSERT_EQ(block[249], 5 * 250 - 1);
+        TEST_EXCEPTION(reader.readBlock(&block[0], 2));
+    }
+
+    // The index comes along when the rest of the user data doesn't
+    sio::lite::FileReader reader(SIO_FILE,
+                                 sio::lite::StreamReader::SKIP_USER_DATA);
+    TEST_ASSERT(!reader.getHeader()->userDataFieldExists("name"));
+    TEST_ASSERT(reader.getBlockIndex() != NULL);
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testSparseImage)
+{
+    if (!sio::lite::BlockIndex::isSupported())
+    {
+        return;
+    }
+
+    // A mask that is mostly empty
+    const size_t rows = 512;
+    const size_t cols = 512;
+    std::vector<sys::ubyte> mask(rows * cols, 0);
+    for (size_t row = 100; row < 150; ++row)
+    {
+        for (size_t col = 200; col < 260; ++col)
+        {
+            mask[row * cols + col] = 1;
+        }
+    }
+
+    sio::lite::FileHeader header(rows, cols, 1,
+                                 sio::lite::FileHeader::UNSIGNED);
+    {
+        sio::lite::FileWriter writer(SIO_FILE);
+        writer.writeCompressed(&header, &mask[0], 1, 64 * 1024);
+    }
+    TEST_ASSERT(sys::OS().getSize(SIO_FILE) <
+                static_cast<sys::Off_T>(rows * cols / 20));
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::ubyte> read(rows * cols);
+    reader.readWindow(&read[0], 0, 0, rows, cols);
+    TEST_ASSERT(read == mask);
+
+    // There's nothing to map
+    TEST_EXCEPTION(sio::lite::MMapReader(SIO_FILE));
+
+    sys::OS().remove(SIO_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testLayout);
+    TEST_CHECK(testReadWindow);
+    TEST_CHECK(testReadBlock);
+    TEST_CHECK(testStreamReadBlock);
+    TEST_CHECK(testSparseImage);
+    return 0;
+}
@@ -0,0 +1,237 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <mem/ScopedArray.h>
+#include <types/RowCol.h>
+#include <sio/lite/Convert.h>
+#include <sio/lite/FileHeader.h>
+#include <sio/lite/FileWriter.h>
+#include <sio/lite/MMapReader.h>
+#include <sio/lite/ReadUtils.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const SIO_FILE = "test_convert.sio";
+
+sio::lite::FileHeader makeHeader(int elementType, int elementSize,
+                                 bool swapped)
+{
+    sio::lite::FileHeader header(1, 1, elementSize, elementType);
+    header.setIsDifferentByteOrdering(swapped);
+    return header;
+}
+
+template <typename T>
+std::vector<T> swapped(std::vector<T> values, size_t swapSize = sizeof(T))
+{
+    sys::byteSwap(&values[0], static_cast<unsigned short>(swapSize),
+                  values.size() * sizeof(T) / swapSize);
+    return values;
+}
+
+TEST_CASE(testSwapBytes)
+{
+    // Odd lengths exercise both the vector loop and the scalar tail
+    const size_t sizes[] = { 2, 4, 8, 3 };
+    for (size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ++ii)
+    {
+        std::vector<sys::byte> buffer(sizes[ii] * 37);
+        for (size_t jj = 0; jj < buffer.size(); ++jj)
+        {
+            buffer[jj] = static_cast<sys::byte>(jj * 7 + 1);
+        }
+        std::vector<sys::byte> expected(buffer);
+        sys::byteSwap(&expected[0], static_cast<unsigned short>(sizes[ii]),
+                      37);
+
+        sio::lite::swapBytes(&buffer[0], sizes[ii], 37);
+        TEST_ASSERT(buffer == expected);
+    }
+}
+
+TEST_CASE(testConvertReal)
+{
+    std::vector<sys::Int16_T> values;
+    for (int ii = -500; ii < 500; ++ii)
+    {
+        values.push_back(static_cast<sys::Int16_T>(ii * 37));
+    }
+
+    std::vector<float> output(values.size());
+    sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::SIGNED, 2, false),
+            &values[0], values.size(), &output[0]);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(output[ii], static_cast<float>(values[ii]));
+    }
+
+    const std::vector<sys::Int16_T> swappedValues = swapped(values);
+    std::vector<double> swappedOutput(values.size());
+    sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::SIGNED, 2, true),
+            &swappedValues[0], values.size(), &swappedOutput[0], 2);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(swappedOutput[ii], static_cast<double>(values[ii]));
+    }
+}
+
+TEST_CASE(testConvertSameType)
+{
+    std::vector<float> values(1000);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = static_cast<float>(ii) * 0.5f;
+    }
+    const std::vector<float> swappedValues = swapped(values);
+
+    std::vector<float> output(values.size());
+    sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::FLOAT, 4, true),
+            &swappedValues[0], values.size(), &output[0]);
+    TEST_ASSERT(output == values);
+}
+
+TEST_CASE(testConvertComplex)
+{
+    std::vector<std::complex<sys::Int16_T> > values;
+    for (int ii = 0; ii < 300; ++ii)
+    {
+        values.push_back(std::complex<sys::Int16_T>(
+                static_cast<sys::Int16_T>(ii - 150),
+                static_cast<sys::Int16_T>(2 * ii)));
+    }
+    const std::vector<std::complex<sys::Int16_T> > swappedValues =
+            swapped(values, 2);
+
+    std::vector<std::complex<float> > output(values.size());
+    sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::COMPLEX_SIGNED, 4, true),
+            &swappedValues[0], values.size(), &output[0]);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(output[ii].real(),
+                       static_cast<float>(values[ii].real()));
+        TEST_ASSERT_EQ(output[ii].imag(),
+                       static_cast<float>(values[ii].imag()));
+    }
+}
+
+TEST_CASE(testConvertManyChunks)
+{
+    // More than one chunk, unaligned, on several threads
+    const size_t numValues = 3 * 1024 * 1024 + 123;
+    std::vector<sys::byte> input(numValues * 4 + 1);
+    std::vector<sys::Uint32_T> values(numValues);
+    for (size_t ii = 0; ii < numValues; ++ii)
+    {
+        values[ii] = static_cast<sys::Uint32_T>(ii * 2654435761u);
+    }
+    const std::vector<sys::Uint32_T> swappedValues = swapped(values);
+    memcpy(&input[1], &swappedValues[0], numValues * 4);
+
+    std::vector<double> output(numValues);
+    sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::UNSIGNED, 4, true),
+            &input[1], numValues, &output[0], 3);
+    bool matches = true;
+    for (size_t ii = 0; ii < numValues; ++ii)
+    {
+        matches = matches && output[ii] == static_cast<double>(values[ii]);
+    }
+    TEST_ASSERT(matches);
+}
+
+TEST_CASE(testUnsupportedConversions)
+{
+    std::vector<sys::byte> input(64);
+    std::vector<float> real(4);
+    std::vector<std::complex<float> > complex(4);
+
+    TEST_EXCEPTION(sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::COMPLEX_FLOAT, 8, false),
+            &input[0], 4, &real[0]));
+    TEST_EXCEPTION(sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::FLOAT, 4, false),
+            &input[0], 4, &complex[0]));
+    TEST_EXCEPTION(sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::N_BYTE_UNSIGNED, 3, false),
+            &input[0], 4, &real[0]));
+    TEST_EXCEPTION(sio::lite::convertElements(
+            makeHeader(sio::lite::FileHeader::FLOAT, 2, false),
+            &input[0], 4, &real[0]));
+}
+
+TEST_CASE(testReadAndConvertSIO)
+{
+    const size_t rows = 40;
+    const size_t cols = 30;
+    std::vector<std::complex<sys::Int16_T> > image(rows * cols);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = std::complex<sys::Int16_T>(
+                static_cast<sys::Int16_T>(ii),
+                static_cast<sys::Int16_T>(-static_cast<int>(ii)));
+    }
+    sio::lite::writeSIO(&image[0], rows, cols, SIO_FILE,
+                        sio::lite::FileHeader::COMPLEX_SIGNED);
+
+    types::RowCol<size_t> dims;
+    mem::ScopedArray<std::complex<float> > output;
+    sio::lite::readAndConvertSIO(SIO_FILE, dims, output);
+    TEST_ASSERT_EQ(dims.row, rows);
+    TEST_ASSERT_EQ(dims.col, cols);
+    TEST_ASSERT_EQ(output[0], std::complex<float>(0, 0));
+    TEST_ASSERT_EQ(output[rows * cols - 1],
+                   std::complex<float>(rows * cols - 1.0f,
+                                       1.0f - rows * cols));
+
+    // The types match, so the mapping can be viewed directly too
+    sio::lite::MMapReader reader(SIO_FILE);
+    TEST_ASSERT_EQ(reader.getBand<std::complex<sys::Int16_T> >()(1, 2),
+                   image[cols + 2]);
+    reader.close();
+
+    sys::OS().remove(SIO_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testSwapBytes);
+    TEST_CHECK(testConvertReal);
+    TEST_CHECK(testConvertSameType);
+    TEST_CHECK(testConvertComplex);
+    TEST_CHECK(testConvertManyChunks);
+    TEST_CHECK(testUnsupportedConversions);
+    TEST_CHECK(testReadAndConvertSIO);
+    return 0;
+}
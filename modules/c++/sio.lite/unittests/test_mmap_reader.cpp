@@ -0,0 +1,211 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <io/ByteStream.h>
+#include <io/FileOutputStream.h>
+#include <sio/lite/FileHeader.h>
+#include <sio/lite/FileWriter.h>
+#include <sio/lite/InvalidHeaderException.h>
+#include <sio/lite/MMapReader.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const SIO_FILE = "test_mmap_reader.sio";
+
+std::vector<float> makeImage(size_t rows, size_t cols, size_t numBands = 1)
+{
+    std::vector<float> image(rows * cols * numBands);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<float>(ii) + 0.25f;
+    }
+    return image;
+}
+
+void writeImage(const std::vector<float>& image, size_t rows, size_t cols,
+                size_t numBands = 1, const std::string& userData = "")
+{
+    sio::lite::FileHeader header(rows, cols, sizeof(float),
+                                 sio::lite::FileHeader::FLOAT);
+    if (!userData.empty())
+    {
+        header.addUserData("name", userData);
+    }
+    sio::lite::FileWriter writer(SIO_FILE);
+    writer.write(&header, &image[0], static_cast<int>(numBands));
+}
+
+//! Writes an SIO in the opposite byte order from this machine's
+void writeSwappedImage(const std::vector<float>& image,
+                       size_t rows, size_t cols)
+{
+    sio::lite::FileHeader header(rows, cols, sizeof(float),
+                                 sio::lite::FileHeader::FLOAT);
+    io::ByteStream headerStream;
+    header.to(1, headerStream);
+    std::vector<sys::byte> bytes(
+            reinterpret_cast<const sys::byte*>(headerStream.get()),
+            reinterpret_cast<const sys::byte*>(headerStream.get()) +
+                    headerStream.getSize());
+    sys::byteSwap(&bytes[0], 4, bytes.size() / 4);
+
+    std::vector<float> swapped(image);
+    sys::byteSwap(&swapped[0], sizeof(float), swapped.size());
+
+    io::FileOutputStream out(SIO_FILE);
+    out.write(&bytes[0], bytes.size());
+    out.write(&swapped[0], swapped.size() * sizeof(float));
+    out.close();
+}
+
+TEST_CASE(testNativeView)
+{
+    const size_t rows = 30;
+    const size_t cols = 20;
+    const std::vector<float> image = makeImage(rows, cols);
+    writeImage(image, rows, cols);
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    TEST_ASSERT_EQ(reader.getNumBands(), static_cast<size_t>(1));
+    TEST_ASSERT(reader.isZeroCopy<float>());
+
+    const sio::lite::ImageView<float> view = reader.getBand<float>();
+    TEST_ASSERT_EQ(view.getNumRows(), rows);
+    TEST_ASSERT_EQ(view.getNumCols(), cols);
+    TEST_ASSERT(view.isContiguous());
+    TEST_ASSERT(std::equal(image.begin(), image.end(), view.data()));
+
+    const sio::lite::ImageView<float> window = view.window(5, 7, 3, 4);
+    TEST_ASSERT(!window.isContiguous());
+    TEST_ASSERT_EQ(window.getRowStride(), cols);
+    TEST_ASSERT_EQ(window(0, 0), image[5 * cols + 7]);
+    TEST_ASSERT_EQ(window(2, 3), image[7 * cols + 10]);
+    TEST_EXCEPTION(view.window(28, 0, 3, 1));
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testBands)
+{
+    const size_t rows = 10;
+    const size_t cols = 12;
+    const std::vector<float> image = makeImage(rows, cols, 2);
+    writeImage(image, rows, cols, 2);
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    TEST_ASSERT_EQ(reader.getNumBands(), static_cast<size_t>(2));
+    const sio::lite::ImageView<float> band = reader.getBand<float>(1);
+    TEST_ASSERT_EQ(band(0, 0), image[rows * cols]);
+    TEST_ASSERT_EQ(band(rows - 1, cols - 1), image.back());
+    TEST_EXCEPTION(reader.getBand<float>(2));
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testSwappedCopy)
+{
+    const size_t rows = 9;
+    const size_t cols = 11;
+    const std::vector<float> image = makeImage(rows, cols);
+    writeSwappedImage(image, rows, cols);
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    TEST_ASSERT(reader.getHeader().isDifferentByteOrdering());
+    TEST_ASSERT(!reader.isZeroCopy<float>());
+
+    const sio::lite::ImageView<float> view = reader.getBand<float>();
+    TEST_ASSERT(std::equal(image.begin(), image.end(), view.data()));
+
+    // The copy is only made once
+    TEST_ASSERT_EQ(reader.getBand<float>().data(), view.data());
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testMisalignedData)
+{
+    // Two bytes of user data leave the pixels off a float boundary
+    const size_t rows = 4;
+    const size_t cols = 5;
+    const std::vector<float> image = makeImage(rows, cols);
+    writeImage(image, rows, cols, 1, "ab");
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    TEST_ASSERT(!reader.isZeroCopy<float>());
+    TEST_ASSERT(reader.isZeroCopy<sys::byte>());
+    const sio::lite::ImageView<float> view = reader.getBand<float>();
+    TEST_ASSERT(std::equal(image.begin(), image.end(), view.data()));
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testWrongType)
+{
+    writeImage(makeImage(2, 2), 2, 2);
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    TEST_EXCEPTION(reader.getBand<sys::Int32_T>());
+    TEST_EXCEPTION(reader.getBand<double>());
+    TEST_EXCEPTION(reader.getBand<std::complex<float> >());
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testTruncatedFile)
+{
+    // The header promises 16 lines but only 8 follow it
+    const std::vector<float> image = makeImage(8, 8);
+    sio::lite::FileHeader header(16, 8, sizeof(float),
+                                 sio::lite::FileHeader::FLOAT);
+    io::FileOutputStream out(SIO_FILE);
+    header.to(1, out);
+    out.write(&image[0], image.size() * sizeof(float));
+    out.close();
+
+    TEST_EXCEPTION(sio::lite::MMapReader(std::string(SIO_FILE)));
+    sys::OS().remove(SIO_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testNativeView);
+    TEST_CHECK(testBands);
+    TEST_CHECK(testSwappedCopy);
+    TEST_CHECK(testMisalignedData);
+    TEST_CHECK(testWrongType);
+    TEST_CHECK(testTruncatedFile);
+    return 0;
+}
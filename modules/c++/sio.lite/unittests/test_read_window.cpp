@@ -0,0 +1,268 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <io/ByteStream.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include <sio/lite/FileHeader.h>
+#include <sio/lite/FileReader.h>
+#include <sio/lite/FileWriter.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const SIO_FILE = "test_read_window.sio";
+
+//! Pixel (row, col) of band b holds (b * rows + row) * cols + col
+std::vector<sys::Uint32_T> makeImage(size_t rows, size_t cols,
+                                     size_t numBands = 1)
+{
+    std::vector<sys::Uint32_T> image(rows * cols * numBands);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::Uint32_T>(ii);
+    }
+    return image;
+}
+
+void writeImage(const std::vector<sys::Uint32_T>& image,
+                size_t rows, size_t cols, size_t numBands = 1)
+{
+    sio::lite::FileHeader header(rows, cols, sizeof(sys::Uint32_T),
+                                 sio::lite::FileHeader::UNSIGNED);
+    header.addUserData("name", "window test");
+    sio::lite::FileWriter writer(SIO_FILE);
+    writer.write(&header, &image[0], static_cast<int>(numBands));
+}
+
+//! Writes an SIO in the opposite byte order from this machine's
+template <typename T>
+void writeSwappedImage(const std::vector<T>& image,
+                       size_t rows, size_t cols, int elementType,
+                       size_t swapSize)
+{
+    sio::lite::FileHeader header(rows, cols, sizeof(T), elementType);
+    io::ByteStream headerStream;
+    header.to(1, headerStream);
+    std::vector<sys::byte> bytes(
+            reinterpret_cast<const sys::byte*>(headerStream.get()),
+            reinterpret_cast<const sys::byte*>(headerStream.get()) +
+                    headerStream.getSize());
+    sys::byteSwap(&bytes[0], 4, bytes.size() / 4);
+
+    std::vector<T> swapped(image);
+    sys::byteSwap(&swapped[0], static_cast<unsigned short>(swapSize),
+                  swapped.size() * sizeof(T) / swapSize);
+
+    io::FileOutputStream out(SIO_FILE);
+    out.write(&bytes[0], bytes.size());
+    out.write(&swapped[0], swapped.size() * sizeof(T));
+    out.close();
+}
+
+bool windowMatches(const std::vector<sys::Uint32_T>& window,
+                   size_t cols, size_t rowStart, size_t colStart,
+                   size_t numRows, size_t numCols, size_t bandRows = 0,
+                   size_t band = 0)
+{
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        for (size_t col = 0; col < numCols; ++col)
+        {
+            const size_t expected =
+                    (band * bandRows + rowStart + row) * cols +
+                    colStart + col;
+            if (window[row * numCols + col] != expected)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testFullWidthWindow)
+{
+    const size_t rows = 50;
+    const size_t cols = 40;
+    writeImage(makeImage(rows, cols), rows, cols);
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::Uint32_T> window(10 * cols);
+    reader.readWindow(&window[0], 7, 0, 10, cols);
+    TEST_ASSERT(windowMatches(window, cols, 7, 0, 10, cols));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testCoalescedWindow)
+{
+    const size_t rows = 50;
+    const size_t cols = 40;
+    writeImage(makeImage(rows, cols), rows, cols);
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::Uint32_T> window(20 * 13);
+    reader.readWindow(&window[0], 30, 27, 20, 13);
+    TEST_ASSERT(windowMatches(window, cols, 30, 27, 20, 13));
+
+    // The same window through a reader that only has the stream
+    io::FileInputStream stream(SIO_FILE);
+    sio::lite::FileReader streamReader(&stream);
+    std::vector<sys::Uint32_T> streamWindow(window.size());
+    streamReader.readWindow(&streamWindow[0], 30, 27, 20, 13);
+    TEST_ASSERT(streamWindow == window);
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testRowByRowWindow)
+{
+    // Rows about 160 KB apart, more than the 64 KiB gap that is read
+    // through, so each is read on its own
+    const size_t rows = 8;
+    const size_t cols = 40000;
+    writeImage(makeImage(rows, cols), rows, cols);
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::Uint32_T> window(5 * 3);
+    reader.readWindow(&window[0], 2, 39997, 5, 3);
+    TEST_ASSERT(windowMatches(window, cols, 2, 39997, 5, 3));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testBandWindow)
+{
+    const size_t rows = 20;
+    const size_t cols = 30;
+    const size_t numBands = 2;
+    writeImage(makeImage(rows, cols, numBands), rows, cols, numBands);
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::Uint32_T> window(4 * 5);
+    reader.readWindow(&window[0], 3, 6, 4, 5, 1);
+    TEST_ASSERT(windowMatches(window, cols, 3, 6, 4, 5, rows, 1));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testSwappedWindow)
+{
+    const size_t rows = 10;
+    const size_t cols = 12;
+    const std::vector<sys::Uint32_T> image = makeImage(rows, cols);
+    writeSwappedImage(image, rows, cols, sio::lite::FileHeader::UNSIGNED,
+                      sizeof(sys::Uint32_T));
+
+    sio::lite::FileReader reader(SIO_FILE);
+    TEST_ASSERT(reader.getHeader()->isDifferentByteOrdering());
+    TEST_ASSERT_EQ(reader.getHeader()->getNumLines(), 10);
+
+    std::vector<sys::Uint32_T> window(3 * 4);
+    reader.readWindow(&window[0], 2, 5, 3, 4);
+    TEST_ASSERT(windowMatches(window, cols, 2, 5, 3, 4));
+
+    // Left alone when asked
+    reader.readWindow(&window[0], 2, 5, 3, 4, 0, false);
+    TEST_ASSERT_EQ(window[0], sys::byteSwap<sys::Uint32_T>(2 * cols + 5));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testSwappedComplexWindow)
+{
+    const size_t rows = 6;
+    const size_t cols = 7;
+    std::vector<std::complex<float> > image(rows * cols);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = std::complex<float>(static_cast<float>(ii), -1.5f);
+    }
+    writeSwappedImage(image, rows, cols,
+                      sio::lite::FileHeader::COMPLEX_FLOAT, sizeof(float));
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<std::complex<float> > window(2 * 3);
+    reader.readWindow(&window[0], 4, 1, 2, 3);
+    TEST_ASSERT_EQ(window[0], image[4 * cols + 1]);
+    TEST_ASSERT_EQ(window[5], image[5 * cols + 3]);
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testWindowOutsideImage)
+{
+    const size_t rows = 10;
+    const size_t cols = 10;
+    writeImage(makeImage(rows, cols), rows, cols);
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::Uint32_T> window(100);
+    TEST_EXCEPTION(reader.readWindow(&window[0], 5, 0, 6, 1));
+    TEST_EXCEPTION(reader.readWindow(&window[0], 0, 9, 1, 2));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testWindowOutsideBands)
+{
+    const size_t rows = 10;
+    const size_t cols = 10;
+    const size_t numBands = 2;
+    writeImage(makeImage(rows, cols, numBands), rows, cols, numBands);
+
+    sio::lite::FileReader reader(SIO_FILE);
+    TEST_ASSERT_EQ(reader.getNumBands(), numBands);
+    std::vector<sys::Uint32_T> window(4);
+    reader.readWindow(&window[0], 8, 8, 2, 2, 1);
+    TEST_ASSERT(windowMatches(window, cols, 8, 8, 2, 2, rows, 1));
+    TEST_EXCEPTION(reader.readWindow(&window[0], 0, 0, 2, 2, 2));
+
+    // The same through a reader that only has the stream
+    io::FileInputStream stream(SIO_FILE);
+    sio::lite::FileReader streamReader(&stream);
+    TEST_ASSERT_EQ(streamReader.getNumBands(), numBands);
+    TEST_EXCEPTION(streamReader.readWindow(&window[0], 0, 0, 2, 2, 2));
+
+    sys::OS().remove(SIO_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testFullWidthWindow);
+    TEST_CHECK(testCoalescedWindow);
+    TEST_CHECK(testRowByRowWindow);
+    TEST_CHECK(testBandWindow);
+    TEST_CHECK(testSwappedWindow);
+    TEST_CHECK(testSwappedComplexWindow);
+    TEST_CHECK(testWindowOutsideImage);
+    TEST_CHECK(testWindowOutsideBands);
+    return 0;
+}
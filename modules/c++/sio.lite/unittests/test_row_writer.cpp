@@ -0,0 +1,247 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <sio/lite/FileHeader.h>
+#include <sio/lite/FileReader.h>
+#include <sio/lite/FileWriter.h>
+#include <sio/lite/MMapReader.h>
+#include <sio/lite/RowWriter.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const SIO_FILE = "test_row_writer.sio";
+
+//! Writes rows [0, numRows) of a float image in blocks of blockRows
+void writeRows(sio::lite::RowWriter& writer, size_t numRows, size_t cols,
+               size_t blockRows)
+{
+    std::vector<float> block(blockRows * cols);
+    for (size_t row = 0; row < numRows; row += blockRows)
+    {
+        const size_t rowsInBlock = std::min(blockRows, numRows - row);
+        for (size_t ii = 0; ii < rowsInBlock * cols; ++ii)
+        {
+            block[ii] = static_cast<float>(row * cols + ii);
+        }
+        writer.writeRows(&block[0], rowsInBlock);
+    }
+}
+
+bool imageMatches(const sio::lite::ImageView<float>& view)
+{
+    for (size_t row = 0; row < view.getNumRows(); ++row)
+    {
+        for (size_t col = 0; col < view.getNumCols(); ++col)
+        {
+            if (view(row, col) !=
+                static_cast<float>(row * view.getNumCols() + col))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testRoundTrip)
+{
+    const size_t rows = 37;
+    const size_t cols = 29;
+    {
+        sio::lite::RowWriter writer(
+                SIO_FILE, sio::lite::makeFileHeader<float>(0, cols),
+                0, 1024);
+        writeRows(writer, rows, cols, 4);
+        TEST_ASSERT_EQ(writer.getNumRows(), rows);
+        writer.close();
+    }
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    TEST_ASSERT_EQ(reader.getHeader().getNumLines(),
+                   static_cast<int>(rows));
+    TEST_ASSERT_EQ(reader.getHeader().getNumElements(),
+                   static_cast<int>(cols));
+    TEST_ASSERT_EQ(reader.getHeader().getVersion(), 1);
+    TEST_ASSERT(imageMatches(reader.getBand<float>()));
+    TEST_ASSERT_EQ(sys::OS().getSize(SIO_FILE),
+                   static_cast<sys::Off_T>(
+                           reader.getHeader().getLength() +
+                           rows * cols * sizeof(float)));
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testCloseInDestructor)
+{
+    const size_t rows = 5;
+    const size_t cols = 3;
+    {
+        sio::lite::RowWriter writer(
+                SIO_FILE, sio::lite::makeFileHeader<float>(0, cols));
+        writeRows(writer, rows, cols, 1);
+    }
+
+    {
+        sio::lite::FileReader reader(SIO_FILE);
+        TEST_ASSERT_EQ(reader.getHeader()->getNumLines(),
+                       static_cast<int>(rows));
+        std::vector<float> image(rows * cols);
+        reader.read(&image[0], image.size() * sizeof(float));
+        TEST_ASSERT_EQ(image.back(), static_cast<float>(rows * cols - 1));
+    }
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testWrongType)
+{
+    sio::lite::RowWriter writer(
+            SIO_FILE, sio::lite::makeFileHeader<float>(0, 4));
+    const std::vector<double> rows(4);
+    TEST_EXCEPTION(writer.writeRows(&rows[0], 1));
+    writer.close();
+    TEST_EXCEPTION(writer.writeRows(static_cast<const void*>(&rows[0]), 1));
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testReservedUserData)
+{
+    const size_t rows = 11;
+    const size_t cols = 13;
+    {
+        sio::lite::RowWriter writer(
+                SIO_FILE, sio::lite::makeFileHeader<float>(0, cols), 64);
+        writeRows(writer, rows, cols, 3);
+        writer.getHeader().addUserData("rows", static_cast<int>(rows));
+        writer.close();
+    }
+
+    // Whatever wasn't used is padding, so the rows didn't move
+    sio::lite::FileHeader provisional =
+            sio::lite::makeFileHeader<float>(0, cols);
+    provisional.addUserData(sio::lite::RowWriter::PADDING_KEY,
+                            std::vector<sys::byte>(64));
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    sio::lite::FileHeader header(reader.getHeader());
+    TEST_ASSERT_EQ(header.getLength(), provisional.getLength());
+    TEST_ASSERT_EQ(header.getNumLines(), static_cast<int>(rows));
+    TEST_ASSERT(header.userDataFieldExists("rows"));
+    TEST_ASSERT(header.userDataFieldExists(
+            sio::lite::RowWriter::PADDING_KEY));
+    TEST_ASSERT(imageMatches(reader.getBand<float>()));
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testTooLittleSlackToPad)
+{
+    // User data that leaves the reserved space with fewer bytes than a
+    // padding field needs, so the header grows into the rows instead
+    const size_t rows = 6;
+    const size_t cols = 7;
+    sio::lite::FileHeader provisional =
+            sio::lite::makeFileHeader<float>(0, cols);
+    provisional.addUserData(sio::lite::RowWriter::PADDING_KEY,
+                            std::vector<sys::byte>(64));
+    sio::lite::FileHeader unpadded =
+            sio::lite::makeFileHeader<float>(0, cols);
+    unpadded.addUserData("extra", std::vector<sys::byte>());
+
+    for (long slack = 1; slack <= 24; ++slack)
+    {
+        const size_t extraSize = static_cast<size_t>(
+                provisional.getLength() - slack - unpadded.getLength());
+        {
+            sio::lite::RowWriter writer(
+                    SIO_FILE, sio::lite::makeFileHeader<float>(0, cols), 64);
+            writeRows(writer, rows, cols, 2);
+            writer.getHeader().addUserData(
+                    "extra", std::vector<sys::byte>(extraSize, 'x'));
+            TEST_ASSERT_EQ(writer.getHeader().getLength(),
+                           provisional.getLength() - slack);
+            writer.close();
+        }
+
+        sio::lite::MMapReader reader(SIO_FILE);
+        sio::lite::FileHeader header(reader.getHeader());
+        TEST_ASSERT(header.getLength() > provisional.getLength());
+        TEST_ASSERT_EQ(header.getNumLines(), static_cast<int>(rows));
+        TEST_ASSERT_EQ(header.getUserData("extra").size(), extraSize);
+        TEST_ASSERT(imageMatches(reader.getBand<float>()));
+        TEST_ASSERT_EQ(sys::OS().getSize(SIO_FILE),
+                       static_cast<sys::Off_T>(
+                               header.getLength() +
+                               rows * cols * sizeof(float)));
+        reader.close();
+    }
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testGrownUserData)
+{
+    // More user data than was reserved, and more rows than are moved at
+    // once
+    const size_t rows = 1100;
+    const size_t cols = 1024;
+    {
+        sio::lite::RowWriter writer(
+                SIO_FILE, sio::lite::makeFileHeader<float>(0, cols), 8);
+        writeRows(writer, rows, cols, 100);
+        writer.getHeader().addUserData("description",
+                                       std::string(1000, 'x'));
+        writer.close();
+    }
+
+    sio::lite::MMapReader reader(SIO_FILE);
+    sio::lite::FileHeader header(reader.getHeader());
+    TEST_ASSERT_EQ(header.getNumLines(), static_cast<int>(rows));
+    TEST_ASSERT_EQ(header.getUserData("description").size(),
+                   static_cast<size_t>(1000));
+    TEST_ASSERT(!header.userDataFieldExists(
+            sio::lite::RowWriter::PADDING_KEY));
+    TEST_ASSERT(imageMatches(reader.getBand<float>()));
+
+    reader.close();
+    sys::OS().remove(SIO_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testRoundTrip);
+    TEST_CHECK(testCloseInDestructor);
+    TEST_CHECK(testWrongType);
+    TEST_CHECK(testReservedUserData);
+    TEST_CHECK(testTooLittleSlackToPad);
+    TEST_CHECK(testGrownUserData);
+    return 0;
+}
@@ -0,0 +1,286 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <io/FileInputStream.h>
+#include <sio/lite/FileHeader.h>
+#include <sio/lite/FileReader.h>
+#include <sio/lite/FileWriter.h>
+#include <sio/lite/InvalidHeaderException.h>
+#include <sio/lite/MMapReader.h>
+#include <sio/lite/StreamReader.h>
+#include <sio/lite/TileIndex.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const SIO_FILE = "test_tiled_sio.sio";
+
+// Tiles that don't divide the image, so the edge tiles are cropped
+const size_t ROWS = 50;
+const size_t COLS = 37;
+const size_t TILE_ROWS = 16;
+const size_t TILE_COLS = 8;
+const size_t NUM_BANDS = 2;
+
+//! Pixel (row, col) of band b holds (b * rows + row) * cols + col
+std::vector<sys::Uint32_T> makeImage()
+{
+    std::vector<sys::Uint32_T> image(ROWS * COLS * NUM_BANDS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<sys::Uint32_T>(ii);
+    }
+    return image;
+}
+
+void writeTiledImage()
+{
+    const std::vector<sys::Uint32_T> image = makeImage();
+    sio::lite::FileHeader header(ROWS, COLS, sizeof(sys::Uint32_T),
+                                 sio::lite::FileHeader::UNSIGNED);
+    header.addUserData("name", "tile test");
+    sio::lite::FileWriter writer(SIO_FILE);
+    writer.writeTiled(&header, &image[0], TILE_ROWS, TILE_COLS,
+                      static_cast<int>(NUM_BANDS));
+}
+
+//! A header with a tile index, one of whose 64-bit values is replaced
+sio::lite::FileHeader corruptHeader(size_t field, sys::Uint64_T value)
+{
+    sio::lite::FileHeader header(ROWS, COLS, sizeof(sys::Uint32_T),
+                                 sio::lite::FileHeader::UNSIGNED);
+    sio::lite::TileIndex(ROWS, COLS, sizeof(sys::Uint32_T), TILE_ROWS,
+                         TILE_COLS, NUM_BANDS).addTo(header);
+    std::vector<sys::byte>& index =
+            header.getUserData(sio::lite::TileIndex::USER_DATA_KEY);
+    memcpy(&index[field * sizeof(value)], &value, sizeof(value));
+    return header;
+}
+
+bool windowMatches(const std::vector<sys::Uint32_T>& window,
+                   size_t rowStart, size_t colStart,
+                   size_t numRows, size_t numCols, size_t band = 0)
+{
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        for (size_t col = 0; col < numCols; ++col)
+        {
+            const size_t expected =
+                    (band * ROWS + rowStart + row) * COLS + colStart + col;
+            if (window[row * numCols + col] != expected)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testLayout)
+{
+    const sio::lite::TileIndex tiles(ROWS, COLS, 4, TILE_ROWS, TILE_COLS,
+                                     NUM_BANDS);
+    TEST_ASSERT_EQ(tiles.getNumTilesDown(), static_cast<size_t>(4));
+    TEST_ASSERT_EQ(tiles.getNumTilesAcross(), static_cast<size_t>(5));
+    TEST_ASSERT_EQ(tiles.getTileNumRows(3), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(tiles.getTileNumCols(4), static_cast<size_t>(5));
+    TEST_ASSERT_EQ(tiles.getTileSize(3, 4), static_cast<size_t>(2 * 5 * 4));
+    TEST_ASSERT_EQ(tiles.getOffset(0, 1),
+                   static_cast<sys::Off_T>(16 * 8 * 4));
+    TEST_ASSERT_EQ(tiles.getOffset(0, 0, 1),
+                   static_cast<sys::Off_T>(ROWS * COLS * 4));
+    TEST_EXCEPTION(tiles.getOffset(4, 0));
+    TEST_EXCEPTION(tiles.getOffset(0, 0, 2));
+    TEST_EXCEPTION(sio::lite::TileIndex(ROWS, COLS, 4, 0, TILE_COLS));
+
+    // Round trip through a header
+    sio::lite::FileHeader header(ROWS, COLS, 4,
+                                 sio::lite::FileHeader::UNSIGNED);
+    TEST_ASSERT(!sio::lite::TileIndex::fromHeader(header).get());
+    tiles.addTo(header);
+    std::unique_ptr<sio::lite::TileIndex> parsed =
+            sio::lite::TileIndex::fromHeader(header);
+    TEST_ASSERT(parsed.get() != NULL);
+    TEST_ASSERT_EQ(parsed->getNumBands(), NUM_BANDS);
+    TEST_ASSERT_EQ(parsed->getOffset(3, 4, 1), tiles.getOffset(3, 4, 1));
+
+    header.getUserData(sio::lite::TileIndex::USER_DATA_KEY).resize(8 * 7);
+    TEST_EXCEPTION(sio::lite::TileIndex::fromHeader(header));
+}
+
+TEST_CASE(testLegacyHeader)
+{
+    writeTiledImage();
+
+    // Anything that reads SIO headers sees the image it expects
+    sio::lite::FileReader reader(SIO_FILE);
+    const sio::lite::FileHeader* header = reader.getHeader();
+    TEST_ASSERT_EQ(header->getNumLines(), static_cast<int>(ROWS));
+    TEST_ASSERT_EQ(header->getNumElements(), static_cast<int>(COLS));
+    TEST_ASSERT_EQ(sys::OS().getSize(SIO_FILE),
+                   static_cast<sys::Off_T>(header->getLength() +
+                                           ROWS * COLS * NUM_BANDS * 4));
+    TEST_ASSERT(reader.getTileIndex() != NULL);
+
+    // but the data isn't band-sequential
+    sio::lite::MMapReader mmapReader(SIO_FILE);
+    TEST_EXCEPTION(mmapReader.getBand<sys::Uint32_T>());
+    mmapReader.close();
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testReadTile)
+{
+    writeTiledImage();
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::Uint32_T> tile(TILE_ROWS * TILE_COLS);
+
+    // An edge tile, then one before it
+    reader.readTile(&tile[0], 3, 4, 1);
+    TEST_ASSERT(windowMatches(tile, 48, 32, 2, 5, 1));
+    reader.readTile(&tile[0], 1, 2);
+    TEST_ASSERT(windowMatches(tile, 16, 16, TILE_ROWS, TILE_COLS));
+    TEST_EXCEPTION(reader.readTile(&tile[0], 4, 0));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testReadWindow)
+{
+    writeTiledImage();
+
+    sio::lite::FileReader reader(SIO_FILE);
+    std::vector<sys::Uint32_T> window(ROWS * COLS);
+
+    // Inside one tile
+    reader.readWindow(&window[0], 17, 9, 3, 4);
+    TEST_ASSERT(windowMatches(window, 17, 9, 3, 4));
+
+    // Across tiles and into the edge tiles of the second band
+    reader.readWindow(&window[0], 10, 5, 40, 32, 1);
+    TEST_ASSERT(windowMatches(window, 10, 5, 40, 32, 1));
+
+    // A column strip and the whole image
+    reader.readWindow(&window[0], 0, 20, ROWS, 1);
+    TEST_ASSERT(windowMatches(window, 0, 20, ROWS, 1));
+    reader.readWindow(&window[0], 0, 0, ROWS, COLS);
+    TEST_ASSERT(windowMatches(window, 0, 0, ROWS, COLS));
+
+    TEST_EXCEPTION(reader.readWindow(&window[0], 0, 30, 1, 8));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testStreamReadTile)
+{
+    writeTiledImage();
+
+    std::vector<sys::Uint32_T> tile(TILE_ROWS * TILE_COLS);
+    {
+        io::FileInputStream stream(SIO_FILE);
+        sio::lite::StreamReader reader(&stream);
+        reader.readTile(&tile[0], 0, 1);
+        TEST_ASSERT(windowMatches(tile, 0, 8, TILE_ROWS, TILE_COLS));
+
+        // Skipping ahead is fine, going back isn't
+        reader.readTile(&tile[0], 2, 3, 1);
+        TEST_ASSERT(windowMatches(tile, 32, 24, TILE_ROWS, TILE_COLS, 1));
+        TEST_EXCEPTION(reader.readTile(&tile[0], 1, 0, 1));
+        stream.close();
+    }
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testCorruptIndex)
+{
+    // Untouched, the index is fine
+    TEST_ASSERT(sio::lite::TileIndex::fromHeader(corruptHeader(2, 4)).get() !=
+                NULL);
+
+    // Dimensions or an element size that differ from the header's, which
+    // readers size buffers from
+    TEST_EXCEPTION(sio::lite::TileIndex::fromHeader(corruptHeader(0, 60)));
+    TEST_EXCEPTION(sio::lite::TileIndex::fromHeader(corruptHeader(1, 40)));
+    TEST_EXCEPTION(sio::lite::TileIndex::fromHeader(corruptHeader(2, 8)));
+
+    // A band count that overflows into the right number of tiles
+    TEST_EXCEPTION(sio::lite::TileIndex::fromHeader(
+            corruptHeader(5, (static_cast<sys::Uint64_T>(1) << 63) + 2)));
+
+    // Tiles past the end of the image data, by a little and by enough to
+    // wrap
+    const size_t lastOffset = 6 + 4 * 5 * NUM_BANDS - 1;
+    TEST_EXCEPTION(sio::lite::TileIndex::fromHeader(
+            corruptHeader(lastOffset, ROWS * COLS * 4 * NUM_BANDS - 39)));
+    TEST_EXCEPTION(sio::lite::TileIndex::fromHeader(
+            corruptHeader(lastOffset, static_cast<sys::Uint64_T>(-8))));
+
+    // Readers refuse the file
+    sio::lite::FileHeader header = corruptHeader(1, 40);
+    const std::vector<sys::Uint32_T> image = makeImage();
+    {
+        sio::lite::FileWriter writer(SIO_FILE);
+        writer.write(&header, &image[0], static_cast<int>(NUM_BANDS));
+    }
+    TEST_EXCEPTION(sio::lite::FileReader(SIO_FILE));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testClassicLayout)
+{
+    const std::vector<sys::Uint32_T> image = makeImage();
+    sio::lite::FileHeader header(ROWS, COLS, sizeof(sys::Uint32_T),
+                                 sio::lite::FileHeader::UNSIGNED);
+    {
+        sio::lite::FileWriter writer(SIO_FILE);
+        writer.write(&header, &image[0]);
+    }
+
+    sio::lite::FileReader reader(SIO_FILE);
+    TEST_ASSERT(reader.getTileIndex() == NULL);
+    std::vector<sys::Uint32_T> tile(TILE_ROWS * TILE_COLS);
+    TEST_EXCEPTION(reader.readTile(&tile[0], 0, 0));
+
+    sys::OS().remove(SIO_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testLayout);
+    TEST_CHECK(testLegacyHeader);
+    TEST_CHECK(testReadTile);
+    TEST_CHECK(testReadWindow);
+    TEST_CHECK(testStreamReadTile);
+    TEST_CHECK(testCorruptIndex);
+    TEST_CHECK(testClassicLayout);
+    return 0;
+}
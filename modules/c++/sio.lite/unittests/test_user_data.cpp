@@ -0,0 +1,237 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <io/FileInputStream.h>
+#include <io/ProxyStreams.h>
+#include <sio/lite/FileHeader.h>
+#include <sio/lite/FileReader.h>
+#include <sio/lite/FileWriter.h>
+#include <sio/lite/StreamReader.h>
+#include <sio/lite/UserDataDictionary.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const SIO_FILE = "test_user_data.sio";
+const size_t ROWS = 4;
+const size_t COLS = 5;
+
+std::string toString(const std::vector<sys::byte>& value)
+{
+    return std::string(value.begin(), value.end());
+}
+
+//! An image whose pixels are their index, with three user data fields
+void writeImage()
+{
+    std::vector<float> image(ROWS * COLS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<float>(ii);
+    }
+
+    sio::lite::FileHeader header(ROWS, COLS, sizeof(float),
+                                 sio::lite::FileHeader::FLOAT);
+    header.addUserData("name", "user data test");
+    header.addUserData("blob", std::string(100000, 'b'));
+    header.addUserData("empty", std::string());
+    header.addUserData("notes", std::string(70000, 'n'));
+    sio::lite::FileWriter writer(SIO_FILE);
+    writer.write(&header, &image[0]);
+}
+
+TEST_CASE(testDictionary)
+{
+    sio::lite::UserDataDictionary dictionary;
+    dictionary.add("a", std::vector<sys::byte>(1, 'a'));
+    dictionary.add("b", std::vector<sys::byte>(2, 'b'));
+    dictionary.add("c", std::vector<sys::byte>(3, 'c'));
+
+    // Replacing a value moves it to the end
+    dictionary.add("a", std::vector<sys::byte>(4, 'a'));
+    TEST_ASSERT_EQ(dictionary.size(), static_cast<size_t>(3));
+    TEST_ASSERT_EQ(dictionary.begin()->first, std::string("b"));
+    TEST_ASSERT_EQ(dictionary["a"].size(), static_cast<size_t>(4));
+
+    // Changes through lookups show up when iterating
+    dictionary["b"].push_back('x');
+    TEST_ASSERT_EQ(dictionary.begin()->second.size(), static_cast<size_t>(3));
+
+    // Copies have their own values
+    sio::lite::UserDataDictionary copy(dictionary);
+    dictionary.remove("c");
+    dictionary["b"].clear();
+    TEST_ASSERT(!dictionary.exists("c"));
+    TEST_ASSERT(copy.exists("c"));
+    TEST_ASSERT_EQ(copy["b"].size(), static_cast<size_t>(3));
+    TEST_EXCEPTION(dictionary["c"]);
+
+    copy = dictionary;
+    TEST_ASSERT_EQ(copy.size(), static_cast<size_t>(2));
+    TEST_ASSERT(copy["b"].empty());
+}
+
+TEST_CASE(testReadUserData)
+{
+    writeImage();
+
+    sio::lite::FileReader reader(SIO_FILE);
+    sio::lite::FileHeader* header = reader.getHeader();
+    TEST_ASSERT_EQ(header->getNumUserDataFields(), static_cast<size_t>(4));
+    TEST_ASSERT_EQ(toString(header->getUserData("name")),
+                   std::string("user data test"));
+    TEST_ASSERT_EQ(header->getUserDataSize("blob"),
+                   static_cast<size_t>(100000));
+    TEST_ASSERT(header->getUserData("empty").empty());
+    TEST_EXCEPTION(header->getUserDataSize("missing"));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testDeferredUserData)
+{
+    writeImage();
+
+    std::unique_ptr<sio::lite::FileHeader> copy;
+    {
+        sio::lite::FileReader reader(
+                SIO_FILE, sio::lite::StreamReader::DEFER_USER_DATA);
+        sio::lite::FileHeader* header = reader.getHeader();
+        TEST_ASSERT_EQ(header->getNumUserDataFields(),
+                       static_cast<size_t>(4));
+        TEST_ASSERT(header->userDataFieldExists("blob"));
+        TEST_ASSERT_EQ(header->getUserDataSize("blob"),
+                       static_cast<size_t>(100000));
+        TEST_ASSERT_EQ(reader.getHeader()->getLength(),
+                       static_cast<long>(sys::OS().getSize(SIO_FILE) -
+                                         ROWS * COLS * sizeof(float)));
+
+        // Reading a field leaves the stream at the image data
+        std::vector<float> pixels(2);
+        reader.read(&pixels[0], sizeof(float), true);
+        TEST_ASSERT_EQ(toString(header->getUserData("name")),
+                       std::string("user data test"));
+        reader.read(&pixels[1], sizeof(float), true);
+        TEST_ASSERT_EQ(pixels[0], 0.0f);
+        TEST_ASSERT_EQ(pixels[1], 1.0f);
+
+        const std::vector<sys::byte>& blob = header->getUserData("blob");
+        TEST_ASSERT_EQ(blob.size(), static_cast<size_t>(100000));
+        TEST_ASSERT_EQ(blob.back(), static_cast<sys::byte>('b'));
+
+        copy.reset(new sio::lite::FileHeader(*header));
+    }
+
+    // The reader is gone, but what was read stays
+    TEST_ASSERT_EQ(toString(copy->getUserData("name")),
+                   std::string("user data test"));
+    TEST_ASSERT(copy->getUserData("empty").empty());
+    TEST_EXCEPTION(copy->getUserData("notes"));
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testSkippedUserData)
+{
+    writeImage();
+
+    sio::lite::FileReader reader(SIO_FILE,
+                                 sio::lite::StreamReader::SKIP_USER_DATA);
+    TEST_ASSERT_EQ(reader.getHeader()->getNumUserDataFields(),
+                   static_cast<size_t>(0));
+    TEST_ASSERT_EQ(reader.getHeader()->getNumLines(),
+                   static_cast<int>(ROWS));
+
+    // The image data is still found
+    std::vector<float> window(2);
+    reader.readWindow(&window[0], 3, 3, 1, 2);
+    TEST_ASSERT_EQ(window[1], static_cast<float>(3 * COLS + 4));
+    reader.seek(4, io::Seekable::START);
+    reader.read(&window[0], sizeof(float), true);
+    TEST_ASSERT_EQ(window[0], 1.0f);
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testSkippedUserDataKeepsTiles)
+{
+    std::vector<float> image(ROWS * COLS, 1.0f);
+    sio::lite::FileHeader header(ROWS, COLS, sizeof(float),
+                                 sio::lite::FileHeader::FLOAT);
+    header.addUserData("name", "tiled");
+    {
+        sio::lite::FileWriter writer(SIO_FILE);
+        writer.writeTiled(&header, &image[0], 2, 2);
+    }
+
+    sio::lite::FileReader reader(SIO_FILE,
+                                 sio::lite::StreamReader::SKIP_USER_DATA);
+    TEST_ASSERT_EQ(reader.getHeader()->getNumUserDataFields(),
+                   static_cast<size_t>(1));
+    TEST_ASSERT(reader.getTileIndex() != NULL);
+
+    sys::OS().remove(SIO_FILE);
+}
+
+TEST_CASE(testUnseekableStream)
+{
+    writeImage();
+
+    // Fields can't be deferred without seeking, nor skipped by seeking
+    const sio::lite::StreamReader::UserDataPolicy policies[] = {
+        sio::lite::StreamReader::DEFER_USER_DATA,
+        sio::lite::StreamReader::SKIP_USER_DATA
+    };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        io::FileInputStream file(SIO_FILE);
+        io::ProxyInputStream stream(&file);
+        sio::lite::StreamReader reader(&stream, false, policies[ii]);
+        const size_t expectedFields = (ii == 0) ? 4 : 0;
+        TEST_ASSERT_EQ(reader.getHeader()->getNumUserDataFields(),
+                       expectedFields);
+
+        std::vector<float> pixels(ROWS * COLS);
+        reader.read(&pixels[0], pixels.size() * sizeof(float), true);
+        TEST_ASSERT_EQ(pixels.back(), static_cast<float>(ROWS * COLS - 1));
+        file.close();
+    }
+
+    sys::OS().remove(SIO_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testDictionary);
+    TEST_CHECK(testReadUserData);
+    TEST_CHECK(testDeferredUserData);
+    TEST_CHECK(testSkippedUserData);
+    TEST_CHECK(testSkippedUserDataKeepsTiles);
+    TEST_CHECK(testUnseekableStream);
+    return 0;
+}
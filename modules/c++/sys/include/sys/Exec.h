@@ -92,10 +92,16 @@ public:
     *  Kicks off child process and connects a pipe to the std::cout
     *
     *  \param cmd           - command line string to run
+    *  \param spawn         - launch the child with posix_spawn() instead
+    *                          of fork() and exec(), which stays cheap when
+    *                          this process is large.  pthread_atfork()
+    *                          handlers don't run, and this end of the pipe
+    *                          is made close-on-exec.  Ignored on Windows.
     */
-    ExecPipe(const std::string& cmd) : 
+    ExecPipe(const std::string& cmd, bool spawn = false) : 
         Exec(cmd),
-        mOutStream(nullptr)
+        mOutStream(nullptr),
+        mSpawn(spawn)
     {
     }
 
@@ -146,11 +152,19 @@ protected:
 #endif
 
     FILE* mOutStream;
+    bool mSpawn;
 
     //! popen with user access to process id
     FILE* openPipe(const std::string& command,
                    const std::string& type);
 
+#ifndef _WIN32
+    //! openPipe() through posix_spawn()
+    FILE* spawnPipe(const std::string& command,
+                    const std::string& type,
+                    int pIO[2]);
+#endif
+
     //! forcefully kill the process and call closePipe
     int killProcess();
 
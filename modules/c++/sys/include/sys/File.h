@@ -180,6 +180,22 @@ public:
      */
     void readInto(void* buffer, size_t size);
 
+    /*!
+     *  Read 'size' bytes starting at 'offset' from the start of the file.
+     *  Unlike readInto(), this doesn't read from the file position, and
+     *  it leaves the position where it was, so several threads may call
+     *  readAt() on the same File at once.  On Windows the position is
+     *  moved while reading and put back afterwards, so don't mix it with
+     *  readInto() or seekTo() on other threads.
+     *  Blocks.
+     *  If the file ends before 'size' bytes are read, an exception occurs.
+     *
+     *  \param buffer The buffer to put to
+     *  \param size The number of bytes
+     *  \param offset Where in the file to start reading
+     */
+    void readAt(void* buffer, size_t size, sys::Off_T offset);
+
     /*!
      *  Write from a buffer 'size' bytes into the 
      *  file.
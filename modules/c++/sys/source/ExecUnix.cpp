@@ -23,6 +23,10 @@
 
 #if !(defined(WIN32) || defined(_WIN32))
 
+#include <errno.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
 #include <sys/wait.h>
 #include <str/Manip.h>
 #include <sys/Exec.h>
@@ -33,9 +37,68 @@ static const size_t READ_PIPE = 0;
 static const size_t WRITE_PIPE = 1;
 }
 
+extern char** environ;
+
 namespace sys
 {
 
+FILE* ExecPipe::spawnPipe(const std::string& command,
+                          const std::string& type,
+                          int pIO[2])
+{
+    //! the child only needs its own end of the pipe --
+    //  keep ours from leaking into it (or into any other child)
+    const bool readFromChild = (type == "r");
+    const int parentEnd = readFromChild ? pIO[READ_PIPE] : pIO[WRITE_PIPE];
+    const int childEnd = readFromChild ? pIO[WRITE_PIPE] : pIO[READ_PIPE];
+    fcntl(parentEnd, F_SETFD, FD_CLOEXEC);
+
+    //! connect the pipes we create to stdin or stdout --
+    //  for reading, both stdout and stderr go to the outpipe
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (readFromChild)
+    {
+        posix_spawn_file_actions_adddup2(&actions, childEnd, STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, childEnd, STDERR_FILENO);
+    }
+    else
+    {
+        posix_spawn_file_actions_adddup2(&actions, childEnd, STDIN_FILENO);
+    }
+    if (childEnd != STDIN_FILENO && childEnd != STDOUT_FILENO &&
+        childEnd != STDERR_FILENO)
+    {
+        posix_spawn_file_actions_addclose(&actions, childEnd);
+    }
+
+    //! spawn a subprocess for running our command --
+    //  here we use the user-defined pid, which is one major
+    //  differences between this and the normal popen().
+    //  posix_spawn() doesn't copy the parent's page tables the way
+    //  fork() does, so launching stays cheap in large processes.
+    char* const argv[] = {const_cast<char*>("sh"),
+                          const_cast<char*>("-c"),
+                          const_cast<char*>(command.c_str()),
+                          static_cast<char*>(NULL)};
+    const int spawnErr = posix_spawn(&mProcess, "/bin/sh", &actions, NULL,
+                                     argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawnErr != 0)
+    {
+        // there was an error while spawning
+        close(pIO[READ_PIPE]);
+        close(pIO[WRITE_PIPE]);
+        errno = spawnErr;
+        return NULL;
+    }
+
+    //! this is executed on the parent process --
+    //  the child has its own copy of its end, so close ours
+    close(childEnd);
+    return fdopen(parentEnd, type.c_str());
+}
+
 FILE* ExecPipe::openPipe(const std::string& command,
                          const std::string& type)
 {
@@ -48,6 +111,11 @@ FILE* ExecPipe::openPipe(const std::string& command,
         return NULL;
     }
 
+    if (mSpawn)
+    {
+        return spawnPipe(command, type, pIO);
+    }
+
     //! fork a subprocess for running our command --
     //  here we use the user-defined pid, which is one major
     //  differences between this and the normal popen()
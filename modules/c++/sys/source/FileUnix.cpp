@@ -92,6 +92,33 @@ void sys::File::readInto(void* buffer, Size_T size)
     throw sys::SystemException(Ctxt("Unknown read state"));
 }
 
+void sys::File::readAt(void* buffer, Size_T size, sys::Off_T offset)
+{
+    Size_T totalBytesRead = 0;
+    sys::byte* bufferPtr = static_cast<sys::byte*>(buffer);
+
+    while (totalBytesRead < size)
+    {
+        const SSize_T bytesRead = ::pread(mHandle,
+                                          bufferPtr + totalBytesRead,
+                                          size - totalBytesRead,
+                                          offset + totalBytesRead);
+        if (bytesRead == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            throw sys::SystemException(Ctxt("While reading from file"));
+        }
+        if (bytesRead == 0)
+        {
+            throw sys::SystemException(Ctxt("Unexpected end of file"));
+        }
+        totalBytesRead += bytesRead;
+    }
+}
+
 void sys::File::writeFrom(const void* buffer, size_t size)
 {
     size_t bytesActuallyWritten = 0;
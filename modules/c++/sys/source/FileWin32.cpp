@@ -26,6 +26,33 @@
 #include <cmath>
 #include "sys/File.h"
 
+namespace
+{
+// ReadFile() with an OVERLAPPED offset still moves the file pointer of a
+// synchronous handle, so readAt() puts it back where it found it
+class FilePointerRestorer
+{
+public:
+    FilePointerRestorer(HANDLE handle) :
+        mHandle(handle)
+    {
+        LARGE_INTEGER zero;
+        zero.QuadPart = 0;
+        if (!SetFilePointerEx(mHandle, zero, &mPosition, FILE_CURRENT))
+            throw sys::SystemException(Ctxt("SetFilePointer failed"));
+    }
+
+    ~FilePointerRestorer()
+    {
+        SetFilePointerEx(mHandle, mPosition, NULL, FILE_BEGIN);
+    }
+
+private:
+    const HANDLE mHandle;
+    LARGE_INTEGER mPosition;
+};
+}
+
 void sys::File::create(const std::string& str,
                        int accessFlags,
                        int creationFlags)
@@ -91,6 +118,45 @@ void sys::File::readInto(void* buffer, size_t size)
     }
 }
 
+void sys::File::readAt(void* buffer, size_t size, sys::Off_T offset)
+{
+    static const size_t MAX_READ_SIZE = std::numeric_limits<DWORD>::max();
+    size_t bytesRead = 0;
+
+    sys::byte* bufferPtr = static_cast<sys::byte*>(buffer);
+    const FilePointerRestorer restorer(mHandle);
+
+    while (bytesRead < size)
+    {
+        const DWORD bytesToRead = static_cast<DWORD>(
+                std::min(MAX_READ_SIZE, size - bytesRead));
+
+        // An OVERLAPPED offset on a synchronous handle reads from that
+        // offset, whatever other threads have done to the file pointer
+        const sys::Uint64_T position =
+                static_cast<sys::Uint64_T>(offset) + bytesRead;
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+        DWORD bytesThisRead = 0;
+        if (!ReadFile(mHandle,
+                      bufferPtr + bytesRead,
+                      bytesToRead,
+                      &bytesThisRead,
+                      &overlapped))
+        {
+            throw sys::SystemException(Ctxt("Error reading from file"));
+        }
+        else if (bytesThisRead == 0)
+        {
+            throw sys::SystemException(Ctxt("Unexpected end of file"));
+        }
+
+        bytesRead += bytesThisRead;
+    }
+}
+
 void sys::File::writeFrom(const void* buffer, size_t size)
 {
     static const size_t MAX_WRITE_SIZE = std::numeric_limits<DWORD>::max();
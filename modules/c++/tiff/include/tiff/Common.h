@@ -143,7 +143,24 @@ public:
             DEFLATE,
             JBIG_BW,
             JBIG_COLOR,
-            PACK_BITS = 32773
+            PACK_BITS = 32773,
+            ADOBE_DEFLATE = 32946
+        };
+    };
+
+    /*
+     * Predictor
+     * http://www.awaresystems.be/imaging/tiff/tifftags/predictor.html
+     */
+
+    class PredictorType
+    {
+    public:
+        enum
+        {
+            NONE = 1,
+            HORIZONTAL_DIFFERENCING,
+            FLOATING_POINT
         };
     };
 
@@ -0,0 +1,117 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef __TIFF_DECODER_H__
+#define __TIFF_DECODER_H__
+
+#include <stddef.h>
+
+namespace tiff
+{
+
+/**
+ *********************************************************************
+ * @class Decoder
+ * @brief Decompresses TIFF strips and tiles.
+ *
+ * Handles LZW, Deflate and PackBits compression, and undoes the
+ * horizontal differencing predictor.  Deflate needs zlib; without it
+ * isSupported() is false for Deflate and decoding it throws.
+ *********************************************************************/
+class Decoder
+{
+public:
+    /**
+     *****************************************************************
+     * Returns whether strips or tiles compressed this way can be
+     * decoded.
+     *
+     * @param compression
+     *   a tiff::Const::CompressionType
+     *****************************************************************/
+    static bool isSupported(unsigned short compression);
+
+    /**
+     *****************************************************************
+     * Decompresses one strip or tile.
+     *
+     * @param compression
+     *   a tiff::Const::CompressionType
+     * @param input
+     *   the strip or tile as it is in the file
+     * @param inputSize
+     *   the size of input in bytes
+     * @param output
+     *   the buffer to decompress into
+     * @param outputSize
+     *   the size of the strip or tile once decompressed.  It is an
+     *   error for the data to decompress to fewer bytes.
+     *****************************************************************/
+    static void decode(unsigned short compression,
+            const unsigned char *input, size_t inputSize,
+            unsigned char *output, size_t outputSize);
+
+    //! Decompresses LZW data, as described in section 13 of TIFF 6.0
+    static void decodeLZW(const unsigned char *input, size_t inputSize,
+            unsigned char *output, size_t outputSize);
+
+    //! Decompresses zlib-wrapped Deflate data
+    static void decodeDeflate(const unsigned char *input, size_t inputSize,
+            unsigned char *output, size_t outputSize);
+
+    //! Decompresses PackBits data, as described in section 9 of TIFF 6.0
+    static void decodePackBits(const unsigned char *input, size_t inputSize,
+            unsigned char *output, size_t outputSize);
+
+    /**
+     *****************************************************************
+     * Undoes a predictor in place.  For horizontal differencing,
+     * samples must already be in this machine's byte order.  The
+     * floating point predictor takes the rows as they were
+     * decompressed and leaves them in this machine's byte order.
+     *
+     * @param predictor
+     *   a tiff::Const::PredictorType
+     * @param data
+     *   the decompressed rows
+     * @param numRows
+     *   the number of rows
+     * @param rowSize
+     *   the size of a row in bytes
+     * @param sampleSize
+     *   the size of a sample in bytes, 1, 2, 4 or 8
+     * @param samplesPerPixel
+     *   the number of samples in each pixel
+     *****************************************************************/
+    static void undoPredictor(unsigned short predictor, unsigned char *data,
+            size_t numRows, size_t rowSize, size_t sampleSize,
+            size_t samplesPerPixel);
+
+private:
+    Decoder()
+    {
+    }
+};
+
+}
+#endif // __TIFF_DECODER_H__
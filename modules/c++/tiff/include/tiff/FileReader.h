@@ -23,9 +23,11 @@
 #ifndef __TIFF_FILE_READER_H__
 #define __TIFF_FILE_READER_H__
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <import/io.h>
+#include <sys/File.h>
 
 #include "tiff/Header.h"
 #include "tiff/ImageReader.h"
@@ -137,6 +139,9 @@ private:
     //! The input stream to use to read the TIFF file
     io::FileInputStream mInput;
 
+    //! The same file, for the images' positional reads
+    std::unique_ptr<sys::File> mFile;
+
     //! The TIFF file header
     tiff::Header mHeader;
 
@@ -23,7 +23,10 @@
 #ifndef __TIFF_IMAGE_READER_H__
 #define __TIFF_IMAGE_READER_H__
 
+#include <vector>
 #include <import/io.h>
+#include <sys/File.h>
+#include <sys/Mutex.h>
 
 #include "tiff/IFDEntry.h"
 #include "tiff/IFD.h"
@@ -49,11 +52,20 @@ public:
      *
      * @param input
      *   the stream to read the TIFF image from
+     * @param file
+     *   the same file, for positional reads that getImage() and
+     *   getRegion() can make from several threads at once.  Without
+     *   it they take turns seeking and reading input.
      *****************************************************************/
-    ImageReader(io::FileInputStream *input) :
-        mIFD(), mStripByteCounts(NULL), mStripOffsets(NULL), mInput(input),
+    ImageReader(io::FileInputStream *input, sys::File *file = NULL) :
+        mIFD(), mInput(input), mFile(file),
                 mNextOffset(0), mBytePosition(0), mStripIndex(0),
-                mElementSize(0), mReverseBytes(false)
+                mElementSize(0), mSampleSize(0), mReverseBytes(false),
+                mCompression(tiff::Const::CompressionType::NO_COMPRESSION),
+                mPredictor(tiff::Const::PredictorType::NONE),
+                mSeparatePlanes(false), mTiled(false), mWidth(0), mLength(0),
+                mChunkWidth(0), mChunkLength(0), mChunksAcross(0),
+                mChunksDown(0), mDecodedChunkRow(NO_CHUNK_ROW)
     {
     }
 
@@ -83,6 +95,10 @@ public:
      * Gets the specified number of elements from the TIFF image and
      * stores them into the specified buffer.  The buffer must be
      * allocated outside because it is not allocated in this function.
+     * Compressed strips or tiles are decoded a row of them at a time
+     * on this thread, and the last row decoded is kept, so reading
+     * in order decodes each one once.  getImage() and getRegion()
+     * decode on several threads.
      * 
      * @param buffer
      *   the buffer to populate with image data
@@ -91,6 +107,68 @@ public:
      *****************************************************************/
     void getData(unsigned char *buffer, const sys::Uint32_T numElementsToRead);
 
+    /**
+     *****************************************************************
+     * Reads the whole image into the specified buffer in raster
+     * order.  Unlike getData(), this doesn't depend on or move the
+     * current read position.
+     *
+     * @param buffer
+     *   the buffer to populate, ImageWidth * ImageLength elements
+     * @param numThreads
+     *   the number of threads to read strips or tiles with, or 0 for
+     *   one per CPU
+     *****************************************************************/
+    void getImage(unsigned char *buffer, size_t numThreads = 0);
+
+    /**
+     *****************************************************************
+     * Reads a region of the image into the specified buffer in
+     * raster order.  Each strip or tile the region touches is read
+     * with a single request, and strips or tiles are read and
+     * decompressed concurrently.
+     *
+     * @param buffer
+     *   the buffer to populate, numRows * numCols elements
+     * @param rowStart
+     *   the first row of the region
+     * @param colStart
+     *   the first column of the region
+     * @param numRows
+     *   the number of rows in the region
+     * @param numCols
+     *   the number of columns in the region
+     * @param numThreads
+     *   the number of threads to read strips or tiles with, or 0 for
+     *   one per CPU
+     *****************************************************************/
+    void getRegion(unsigned char *buffer, size_t rowStart, size_t colStart,
+            size_t numRows, size_t numCols, size_t numThreads = 0);
+
+    //! Whether the image is stored in tiles rather than strips
+    bool isTiled() const
+    {
+        return mTiled;
+    }
+
+    //! The number of strips or tiles the image is stored in
+    size_t getNumChunks() const
+    {
+        return mChunksAcross * mChunksDown;
+    }
+
+    //! The image's tiff::Const::CompressionType
+    unsigned short getCompression() const
+    {
+        return mCompression;
+    }
+
+    //! The image's tiff::Const::PredictorType
+    unsigned short getPredictor() const
+    {
+        return mPredictor;
+    }
+
     /**
      *****************************************************************
      * Returns a pointer to the IFD for this image.
@@ -128,6 +206,56 @@ public:
     }
 
 private:
+    //! Reads the strips or tiles of one region, for getRegion()
+    class RegionOp;
+
+    //! Reads size bytes at offset in the file
+    void readAt(sys::Uint32_T offset, void *buffer, size_t size);
+
+    /**
+     *****************************************************************
+     * Reads whole rows of a strip or tile, decompressing it if need
+     * be, and leaves them in this machine's byte order.
+     *
+     * @param chunk
+     *   the index of the strip or tile
+     * @param firstRow
+     *   the first row to read, relative to the strip or tile
+     * @param numRows
+     *   the number of rows to read
+     * @param buffer
+     *   the buffer to populate, numRows rows of the strip or tile's
+     *   full width
+     *****************************************************************/
+    void readChunkRows(size_t chunk, size_t firstRow, size_t numRows,
+            unsigned char *buffer);
+
+    /**
+     *****************************************************************
+     * Reads the part of a strip or tile that falls in a region.
+     *
+     * @param chunk
+     *   the index of the strip or tile
+     * @param scratch
+     *   a buffer to stage rows in when the strip or tile is wider
+     *   than its part of the region
+     *****************************************************************/
+    void readChunkRegion(size_t chunk, unsigned char *buffer,
+            size_t rowStart, size_t colStart, size_t numRows, size_t numCols,
+            std::vector<unsigned char>& scratch);
+
+    /**
+     *****************************************************************
+     * Reads the specified number of elements into the specified
+     * buffer from a compressed image, decoding each row of strips or
+     * tiles they fall in unless it was the last one decoded.
+     * @param buffer
+     *   the buffer to populate with image data
+     * @param numElementsToRead
+     *   the number of elements (not bytes) to read from the image
+     *****************************************************************/
+    void getDecodedData(unsigned char *buffer,
+            sys::Uint32_T numElementsToRead);
 
     /**
      *****************************************************************
@@ -156,15 +284,15 @@ private:
     //! Contains the IFD for this image.
     tiff::IFD mIFD;
 
-    //! A pointer to the "StripByteCounts" IFDEntry to make reading faster.
-    tiff::IFDEntry *mStripByteCounts;
-
-    //! A pointer to the "StripOffsets" IFDEntry to make reading faster.
-    tiff::IFDEntry *mStripOffsets;
-
     //! Points to the input file stream.
     io::FileInputStream *mInput;
 
+    //! The same file for positional reads, or NULL.
+    sys::File *mFile;
+
+    //! Serializes reads from mInput when there is no mFile.
+    sys::Mutex mInputMutex;
+
     //! The offset to the next IFD.
     sys::Uint32_T mNextOffset;
 
@@ -176,8 +304,43 @@ private:
     //! The element size of the image.
     unsigned short mElementSize;
 
+    //! The size of one sample of an element, which is what gets swapped.
+    unsigned short mSampleSize;
+
     //! Whether to reverse bytes when reading.
     bool mReverseBytes;
+
+    //! The Compression tag's value.
+    unsigned short mCompression;
+
+    //! The Predictor tag's value.
+    unsigned short mPredictor;
+
+    //! Whether PlanarConfiguration puts each band in its own chunks.
+    bool mSeparatePlanes;
+
+    // The layout of the strips or tiles, worked out once in process().
+    // A strip is a chunk as wide as the image.
+    bool mTiled;
+    size_t mWidth;
+    size_t mLength;
+    size_t mChunkWidth;
+    size_t mChunkLength;
+    size_t mChunksAcross;
+    size_t mChunksDown;
+
+    //! StripOffsets or TileOffsets.
+    std::vector<sys::Uint32_T> mOffsets;
+
+    //! StripByteCounts or TileByteCounts.
+    std::vector<sys::Uint32_T> mByteCounts;
+
+    //! mDecodedChunkRow when nothing has been decoded.
+    static const size_t NO_CHUNK_ROW = static_cast<size_t>(-1);
+
+    //! The row of strips or tiles getData() decoded last, and its rows.
+    size_t mDecodedChunkRow;
+    std::vector<unsigned char> mDecodedRows;
 };
 
 } // End namespace.
@@ -0,0 +1,373 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "tiff/Decoder.h"
+
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include <import/except.h>
+#include <import/sys.h>
+#include "tiff/Common.h"
+#include "tiff/tiff_config.h"
+
+#ifdef TIFF_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+// LZW codes, which start out 9 bits wide and grow to 12
+const unsigned int LZW_CLEAR = 256;
+const unsigned int LZW_END_OF_INFORMATION = 257;
+const unsigned int LZW_FIRST_CODE = 258;
+const unsigned int LZW_MIN_BITS = 9;
+const unsigned int LZW_MAX_BITS = 12;
+const unsigned int LZW_TABLE_SIZE = 1 << LZW_MAX_BITS;
+
+//! A string in the LZW table.  Every string past the single bytes is one
+//! already written to the output plus the byte after it, so it is kept as
+//! a span of the output.
+struct LZWString
+{
+    size_t offset;
+    size_t length;
+};
+
+void throwCorrupt(const char *compression, const std::string& details)
+{
+    throw except::Exception(Ctxt(std::string("Corrupt ") + compression +
+                                 " data: " + details));
+}
+
+void throwShort(const char *compression, size_t decoded, size_t expected)
+{
+    std::ostringstream ostr;
+    ostr << "only " << decoded << " of " << expected << " bytes";
+    throwCorrupt(compression, ostr.str());
+}
+
+template <typename T>
+void undoDifferencing(unsigned char *row, size_t numSamples,
+                      size_t samplesPerPixel)
+{
+    T *samples = reinterpret_cast<T *>(row);
+    for (size_t ii = samplesPerPixel; ii < numSamples; ++ii)
+        samples[ii] = static_cast<T>(samples[ii] + samples[ii -
+                                                            samplesPerPixel]);
+}
+
+// The floating point predictor stores each row as planes of bytes, most
+// significant first, and differences the bytes
+void undoFloatingPoint(unsigned char *row, size_t rowSize, size_t sampleSize,
+                       size_t samplesPerPixel, std::vector<unsigned char>& planes)
+{
+    for (size_t ii = samplesPerPixel; ii < rowSize; ++ii)
+        row[ii] = static_cast<unsigned char>(row[ii] +
+                                             row[ii - samplesPerPixel]);
+
+    planes.assign(row, row + rowSize);
+    const size_t numSamples = rowSize / sampleSize;
+    const bool bigEndian = sys::isBigEndianSystem();
+    for (size_t ii = 0; ii < numSamples; ++ii)
+    {
+        for (size_t byte = 0; byte < sampleSize; ++byte)
+        {
+            const size_t plane = bigEndian ? byte : sampleSize - byte - 1;
+            row[ii * sampleSize + byte] = planes[plane * numSamples + ii];
+        }
+    }
+}
+}
+
+bool tiff::Decoder::isSupported(unsigned short compression)
+{
+    switch (compression)
+    {
+    case tiff::Const::CompressionType::NO_COMPRESSION:
+    case tiff::Const::CompressionType::LZW:
+    case tiff::Const::CompressionType::PACK_BITS:
+        return true;
+    case tiff::Const::CompressionType::DEFLATE:
+    case tiff::Const::CompressionType::ADOBE_DEFLATE:
+#ifdef TIFF_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+void tiff::Decoder::decode(unsigned short compression,
+        const unsigned char *input, size_t inputSize,
+        unsigned char *output, size_t outputSize)
+{
+    switch (compression)
+    {
+    case tiff::Const::CompressionType::NO_COMPRESSION:
+        if (inputSize < outputSize)
+            throwShort("uncompressed", inputSize, outputSize);
+        memcpy(output, input, outputSize);
+        break;
+    case tiff::Const::CompressionType::LZW:
+        decodeLZW(input, inputSize, output, outputSize);
+        break;
+    case tiff::Const::CompressionType::DEFLATE:
+    case tiff::Const::CompressionType::ADOBE_DEFLATE:
+        decodeDeflate(input, inputSize, output, outputSize);
+        break;
+    case tiff::Const::CompressionType::PACK_BITS:
+        decodePackBits(input, inputSize, output, outputSize);
+        break;
+    default:
+        throw except::Exception(Ctxt(FmtX("Unsupported compression type: %d",
+                                          compression)));
+    }
+}
+
+void tiff::Decoder::decodeLZW(const unsigned char *input, size_t inputSize,
+        unsigned char *output, size_t outputSize)
+{
+    // Writers before TIFF 6.0 packed codes least significant bit first.
+    // Like libtiff, tell them apart by how the first Clear code looks.
+    if (inputSize >= 2 && input[0] == 0 && (input[1] & 1))
+        throw except::Exception(Ctxt("Unsupported LZW variant: codes packed "
+                                     "least significant bit first"));
+
+    std::vector<LZWString> table(LZW_TABLE_SIZE);
+    unsigned int next = LZW_FIRST_CODE;
+    unsigned int width = LZW_MIN_BITS;
+    unsigned int previous = LZW_CLEAR;
+    LZWString written = { 0, 0 };
+    sys::Uint32_T bits = 0;
+    unsigned int numBits = 0;
+    size_t in = 0;
+    size_t out = 0;
+    while (out < outputSize)
+    {
+        while (numBits < width && in < inputSize)
+        {
+            bits = (bits << 8) | input[in++];
+            numBits += 8;
+        }
+        if (numBits < width)
+            break;
+        const unsigned int code = (bits >> (numBits - width)) &
+                ((1u << width) - 1);
+        numBits -= width;
+
+        if (code == LZW_END_OF_INFORMATION)
+            break;
+        if (code == LZW_CLEAR)
+        {
+            next = LZW_FIRST_CODE;
+            width = LZW_MIN_BITS;
+            previous = LZW_CLEAR;
+            continue;
+        }
+
+        if (previous == LZW_CLEAR)
+        {
+            // The first code after a Clear is always a single byte
+            if (code > 255)
+                throwCorrupt("LZW", FmtX("code %d follows a Clear code",
+                                         code));
+        }
+        else
+        {
+            if (code > next || (code == next && next == LZW_TABLE_SIZE))
+                throwCorrupt("LZW", FmtX("code %d isn't in the table",
+                                         code));
+
+            // The new string is the previous one plus the first byte of
+            // this one, which is about to be written right after it
+            if (next < LZW_TABLE_SIZE)
+            {
+                table[next].offset = written.offset;
+                table[next].length = written.length + 1;
+                ++next;
+
+                // Writers widen codes one code early
+                if (next == (1u << width) - 1 && width < LZW_MAX_BITS)
+                    ++width;
+            }
+        }
+
+        // Copy the string, dropping whatever doesn't fit.  A string can
+        // overlap itself, when it's the one just added, so copy forwards.
+        written.offset = out;
+        if (code < 256)
+        {
+            written.length = 1;
+            output[out++] = static_cast<unsigned char>(code);
+        }
+        else
+        {
+            written.length = table[code].length;
+            const size_t length = std::min(written.length, outputSize - out);
+            const unsigned char *string = output + table[code].offset;
+            if (table[code].offset + length <= out)
+            {
+                memcpy(output + out, string, length);
+            }
+            else
+            {
+                for (size_t ii = 0; ii < length; ++ii)
+                    output[out + ii] = string[ii];
+            }
+            out += length;
+        }
+        previous = code;
+    }
+
+    if (out < outputSize)
+        throwShort("LZW", out, outputSize);
+}
+
+void tiff::Decoder::decodeDeflate(const unsigned char *input,
+        size_t inputSize, unsigned char *output, size_t outputSize)
+{
+#ifdef TIFF_HAVE_ZLIB
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
+        throw except::Exception(Ctxt("Failed to initialize zlib"));
+
+    stream.next_in = const_cast<Bytef *>(input);
+    stream.avail_in = static_cast<uInt>(inputSize);
+    stream.next_out = output;
+    stream.avail_out = static_cast<uInt>(outputSize);
+    const int rv = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+
+    // Anything left over once the output is full is padding
+    if (rv != Z_STREAM_END && !(rv == Z_BUF_ERROR && stream.avail_out == 0))
+    {
+        if (rv == Z_BUF_ERROR)
+            throwShort("Deflate", outputSize - stream.avail_out, outputSize);
+        throwCorrupt("Deflate", FmtX("zlib error %d", rv));
+    }
+    if (stream.avail_out != 0)
+        throwShort("Deflate", outputSize - stream.avail_out, outputSize);
+#else
+    (void)input;
+    (void)inputSize;
+    (void)output;
+    (void)outputSize;
+    throw except::Exception(Ctxt(
+            "tiff was built without zlib, so it can't decode Deflate"));
+#endif
+}
+
+void tiff::Decoder::decodePackBits(const unsigned char *input,
+        size_t inputSize, unsigned char *output, size_t outputSize)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (out < outputSize && in < inputSize)
+    {
+        const int header = static_cast<signed char>(input[in++]);
+        if (header >= 0)
+        {
+            // The next header + 1 bytes, as they are
+            const size_t count = static_cast<size_t>(header) + 1;
+            if (in + count > inputSize)
+                throwCorrupt("PackBits", "a literal runs past the end");
+            const size_t copied = std::min(count, outputSize - out);
+            memcpy(output + out, input + in, copied);
+            in += count;
+            out += copied;
+        }
+        else if (header != -128)
+        {
+            // The next byte, 1 - header times
+            if (in >= inputSize)
+                throwCorrupt("PackBits", "a run is missing its byte");
+            const size_t count = std::min(static_cast<size_t>(1 - header),
+                                          outputSize - out);
+            memset(output + out, input[in++], count);
+            out += count;
+        }
+    }
+
+    if (out < outputSize)
+        throwShort("PackBits", out, outputSize);
+}
+
+void tiff::Decoder::undoPredictor(unsigned short predictor,
+        unsigned char *data, size_t numRows, size_t rowSize,
+        size_t sampleSize, size_t samplesPerPixel)
+{
+    if (predictor == tiff::Const::PredictorType::NONE)
+        return;
+
+    if (predictor == tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING)
+    {
+        const size_t numSamples = rowSize / sampleSize;
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            unsigned char *rowData = data + row * rowSize;
+            switch (sampleSize)
+            {
+            case 1:
+                undoDifferencing<sys::Uint8_T>(rowData, numSamples,
+                                               samplesPerPixel);
+                break;
+            case 2:
+                undoDifferencing<sys::Uint16_T>(rowData, numSamples,
+                                                samplesPerPixel);
+                break;
+            case 4:
+                undoDifferencing<sys::Uint32_T>(rowData, numSamples,
+                                                samplesPerPixel);
+                break;
+            case 8:
+                undoDifferencing<sys::Uint64_T>(rowData, numSamples,
+                                                samplesPerPixel);
+                break;
+            default:
+            {
+                std::ostringstream ostr;
+                ostr << "Unsupported sample size for the horizontal "
+                     << "predictor: " << sampleSize << " bytes";
+                throw except::Exception(Ctxt(ostr.str()));
+            }
+            }
+        }
+    }
+    else if (predictor == tiff::Const::PredictorType::FLOATING_POINT)
+    {
+        std::vector<unsigned char> planes;
+        for (size_t row = 0; row < numRows; ++row)
+            undoFloatingPoint(data + row * rowSize, rowSize, sampleSize,
+                              samplesPerPixel, planes);
+    }
+    else
+    {
+        throw except::Exception(Ctxt(FmtX("Unsupported predictor: %d",
+                                          predictor)));
+    }
+}
@@ -45,6 +45,7 @@ void tiff::FileReader::openFile(const std::string& fileName)
     mInput.create(fileName.c_str());
     if (!mInput.isOpen())
         throw except::Exception(Ctxt("File was not opened"));
+    mFile.reset(new sys::File(fileName));
 
     // Read TIFF header from input
     mHeader.deserialize(mInput);
@@ -53,7 +54,8 @@ void tiff::FileReader::openFile(const std::string& fileName)
     sys::Uint32_T offset = mHeader.getIFDOffset();
     while (offset != 0)
     {
-        tiff::ImageReader *imageReader = new tiff::ImageReader(&mInput);
+        tiff::ImageReader *imageReader = new tiff::ImageReader(&mInput,
+                                                               mFile.get());
 
         mInput.seek(offset, io::Seekable::START);
         imageReader->process(mReverseBytes);
@@ -68,6 +70,7 @@ void tiff::FileReader::close()
     mHeader = tiff::Header{};
 
     mInput.close();
+    mFile.reset();
 
     std::vector<tiff::ImageReader *>::iterator readIter;
     for (readIter = mImages.begin(); readIter != mImages.end(); ++readIter)
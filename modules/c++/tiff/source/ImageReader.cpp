@@ -22,16 +22,84 @@
 
 #include "tiff/ImageReader.h"
 
+#include <string.h>
+#include <algorithm>
 #include <sstream>
 #include <import/io.h>
 #include <import/except.h>
+#include <mt/BalancedRunnable1D.h>
+#include <mt/CriticalSection.h>
 #include "tiff/Common.h"
+#include "tiff/Decoder.h"
 #include "tiff/GenericType.h"
 #include "tiff/IFDEntry.h"
 
+namespace
+{
+//! Gets one value of a tag that may be a SHORT or a LONG
+sys::Uint32_T getValue(const tiff::IFDEntry& entry, sys::Uint32_T index)
+{
+    if (entry.getType() == tiff::Const::Type::SHORT)
+        return *(tiff::GenericType<unsigned short> *)entry[index];
+    return *(tiff::GenericType<sys::Uint32_T> *)entry[index];
+}
+
+//! Gets every value of a tag that may be a SHORT or a LONG
+std::vector<sys::Uint32_T> getValues(const tiff::IFDEntry *entry)
+{
+    std::vector<sys::Uint32_T> values;
+    if (entry)
+    {
+        values.resize(entry->getCount());
+        for (sys::Uint32_T i = 0; i < entry->getCount(); ++i)
+            values[i] = getValue(*entry, i);
+    }
+    return values;
+}
+}
+
+class tiff::ImageReader::RegionOp
+{
+public:
+    RegionOp(tiff::ImageReader& reader, unsigned char *buffer,
+             size_t rowStart, size_t colStart, size_t numRows,
+             size_t numCols, size_t firstChunkRow, size_t firstChunkCol,
+             size_t chunksAcross) :
+        mReader(reader), mBuffer(buffer), mRowStart(rowStart),
+        mColStart(colStart), mNumRows(numRows), mNumCols(numCols),
+        mFirstChunkRow(firstChunkRow), mFirstChunkCol(firstChunkCol),
+        mChunksAcross(chunksAcross)
+    {
+    }
+
+    // Called with the index of a chunk among those the region touches
+    void operator()(size_t ii) const
+    {
+        const size_t chunkRow = mFirstChunkRow + ii / mChunksAcross;
+        const size_t chunkCol = mFirstChunkCol + ii % mChunksAcross;
+        std::vector<unsigned char> scratch;
+        mReader.readChunkRegion(chunkRow * mReader.mChunksAcross + chunkCol,
+                                mBuffer, mRowStart, mColStart, mNumRows,
+                                mNumCols, scratch);
+    }
+
+private:
+    tiff::ImageReader& mReader;
+    unsigned char * const mBuffer;
+    const size_t mRowStart;
+    const size_t mColStart;
+    const size_t mNumRows;
+    const size_t mNumCols;
+    const size_t mFirstChunkRow;
+    const size_t mFirstChunkCol;
+    const size_t mChunksAcross;
+};
+
 void tiff::ImageReader::process(const bool reverseBytes)
 {
     mReverseBytes = reverseBytes;
+    mDecodedChunkRow = NO_CHUNK_ROW;
+    mDecodedRows.clear();
 
     mIFD.deserialize(*mInput, mReverseBytes);
 
@@ -41,9 +109,53 @@ void tiff::ImageReader::process(const bool reverseBytes)
 
     // Done here to lower the number of calls to it later.
     mElementSize = mIFD.getElementSize();
+    const unsigned short numBands = mIFD.getNumBands();
+    mSampleSize = numBands > 0 ? mElementSize / numBands : mElementSize;
+
+    tiff::IFDEntry *compression = mIFD["Compression"];
+    if (compression)
+        mCompression = static_cast<unsigned short>(getValue(*compression, 0));
 
-    mStripByteCounts = mIFD["StripByteCounts"];
-    mStripOffsets = mIFD["StripOffsets"];
+    tiff::IFDEntry *predictor = mIFD["Predictor"];
+    if (predictor)
+        mPredictor = static_cast<unsigned short>(getValue(*predictor, 0));
+
+    tiff::IFDEntry *planarConfiguration = mIFD["PlanarConfiguration"];
+    mSeparatePlanes = planarConfiguration &&
+            getValue(*planarConfiguration, 0) == 2;
+
+    // Work out the strip or tile layout once, rather than looking tags up
+    // for every read
+    mWidth = mIFD.getImageWidth();
+    mLength = mIFD.getImageLength();
+    tiff::IFDEntry *tileWidth = mIFD["TileWidth"];
+    tiff::IFDEntry *tileLength = mIFD["TileLength"];
+    if (mIFD["StripOffsets"])
+    {
+        mTiled = false;
+        mOffsets = getValues(mIFD["StripOffsets"]);
+        mByteCounts = getValues(mIFD["StripByteCounts"]);
+
+        // Without RowsPerStrip, the whole image is one strip
+        tiff::IFDEntry *rowsPerStrip = mIFD["RowsPerStrip"];
+        mChunkWidth = mWidth;
+        mChunkLength = rowsPerStrip ? getValue(*rowsPerStrip, 0) : mLength;
+        mChunkLength = std::min(mChunkLength, mLength);
+    }
+    else if (mIFD["TileOffsets"] && tileWidth && tileLength)
+    {
+        mTiled = true;
+        mOffsets = getValues(mIFD["TileOffsets"]);
+        mByteCounts = getValues(mIFD["TileByteCounts"]);
+        mChunkWidth = getValue(*tileWidth, 0);
+        mChunkLength = getValue(*tileLength, 0);
+    }
+
+    if (mChunkWidth > 0 && mChunkLength > 0)
+    {
+        mChunksAcross = (mWidth + mChunkWidth - 1) / mChunkWidth;
+        mChunksDown = (mLength + mChunkLength - 1) / mChunkLength;
+    }
 }
 
 void tiff::ImageReader::print(io::OutputStream &output) const
@@ -59,24 +171,241 @@ void tiff::ImageReader::print(io::OutputStream &output) const
 void tiff::ImageReader::getData(unsigned char *buffer,
         const sys::Uint32_T numElementsToRead)
 {
-    //see if it is uncompressed
-    tiff::IFDEntry *compression = mIFD["Compression"];
-    if (compression)
+    // Compressed strips and tiles have to be decoded whole
+    if (mCompression != tiff::Const::CompressionType::NO_COMPRESSION)
     {
-        unsigned short c = *(tiff::GenericType<unsigned short> *)(*compression)[0];
-        if (c != tiff::Const::CompressionType::NO_COMPRESSION)
-            throw except::Exception(Ctxt(FmtX("Unsupported compression type: %d", c)));
+        getDecodedData(buffer, numElementsToRead);
+        return;
     }
-    
-    if (mIFD["StripOffsets"])
-        getStripData(buffer, numElementsToRead);
-    else if (mIFD["TileOffsets"])
+
+    if (mOffsets.empty())
+        throw except::Exception(Ctxt("Unsupported TIFF file format"));
+
+    if (mTiled)
         getTileData(buffer, numElementsToRead);
     else
+        getStripData(buffer, numElementsToRead);
+
+    // Each sample is swapped on its own, not a whole element of them
+    if (mReverseBytes && mSampleSize > 1)
+        sys::byteSwap((sys::byte*)buffer, mSampleSize,
+                      numElementsToRead * (mElementSize / mSampleSize));
+}
+
+void tiff::ImageReader::getImage(unsigned char *buffer, size_t numThreads)
+{
+    getRegion(buffer, 0, 0, mLength, mWidth, numThreads);
+}
+
+void tiff::ImageReader::getRegion(unsigned char *buffer, size_t rowStart,
+        size_t colStart, size_t numRows, size_t numCols, size_t numThreads)
+{
+    if (!tiff::Decoder::isSupported(mCompression))
+        throw except::Exception(Ctxt(FmtX("Unsupported compression type: %d",
+                                          mCompression)));
+
+    if (mOffsets.empty() || mChunksAcross == 0)
         throw except::Exception(Ctxt("Unsupported TIFF file format"));
 
-    if (mReverseBytes)
-        sys::byteSwap((sys::byte*)buffer, mElementSize, numElementsToRead);
+    if (mSeparatePlanes && mIFD.getNumBands() > 1)
+        throw except::Exception(Ctxt(
+                "Unsupported planar configuration: bands in separate planes"));
+
+    if (mOffsets.size() < getNumChunks() ||
+        mByteCounts.size() < getNumChunks())
+    {
+        std::ostringstream ostr;
+        ostr << "Image has " << getNumChunks() << " strips or tiles but "
+             << mOffsets.size() << " offsets and " << mByteCounts.size()
+             << " byte counts";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    if (rowStart + numRows > mLength || colStart + numCols > mWidth)
+    {
+        std::ostringstream ostr;
+        ostr << "Region of " << numRows << " x " << numCols << " at ("
+             << rowStart << ", " << colStart << ") is outside the "
+             << mLength << " x " << mWidth << " image";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    if (numRows == 0 || numCols == 0)
+        return;
+
+    const size_t firstChunkRow = rowStart / mChunkLength;
+    const size_t firstChunkCol = colStart / mChunkWidth;
+    const size_t chunksDown =
+            (rowStart + numRows - 1) / mChunkLength - firstChunkRow + 1;
+    const size_t chunksAcross =
+            (colStart + numCols - 1) / mChunkWidth - firstChunkCol + 1;
+    const size_t numChunks = chunksDown * chunksAcross;
+
+    if (numThreads == 0)
+        numThreads = sys::OS().getNumCPUs();
+
+    mt::runBalanced1D(numChunks, std::min(numThreads, numChunks),
+                      RegionOp(*this, buffer, rowStart, colStart, numRows,
+                               numCols, firstChunkRow, firstChunkCol,
+                               chunksAcross));
+}
+
+void tiff::ImageReader::readAt(sys::Uint32_T offset, void *buffer,
+        size_t size)
+{
+    if (mFile)
+    {
+        mFile->readAt(buffer, size, offset);
+    }
+    else
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mInputMutex);
+        mInput->seek(offset, io::Seekable::START);
+        mInput->read(buffer, size, true);
+    }
+}
+
+void tiff::ImageReader::readChunkRows(size_t chunk, size_t firstRow,
+        size_t numRows, unsigned char *buffer)
+{
+    const size_t rowSize = mChunkWidth * mElementSize;
+    if (mCompression == tiff::Const::CompressionType::NO_COMPRESSION)
+    {
+        if ((firstRow + numRows) * rowSize > mByteCounts[chunk])
+        {
+            std::ostringstream ostr;
+            ostr << "Strip or tile " << chunk << " has " << mByteCounts[chunk]
+                 << " bytes, too few for " << firstRow + numRows
+                 << " rows of " << rowSize << " bytes";
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+
+        readAt(mOffsets[chunk] +
+                       static_cast<sys::Uint32_T>(firstRow * rowSize),
+               buffer, numRows * rowSize);
+        if (mReverseBytes && mSampleSize > 1)
+            sys::byteSwap((sys::byte *)buffer, mSampleSize,
+                          numRows * rowSize / mSampleSize);
+        return;
+    }
+
+    // A compressed strip or tile is decoded whole, straight into buffer
+    // when all of it is wanted.  The last strip can be short.
+    const size_t chunkRows = mTiled ? mChunkLength :
+            std::min(mChunkLength, mLength - (chunk / mChunksAcross) *
+                                             mChunkLength);
+    std::vector<unsigned char> compressed(mByteCounts[chunk]);
+    if (!compressed.empty())
+        readAt(mOffsets[chunk], &compressed[0], compressed.size());
+
+    std::vector<unsigned char> decoded;
+    unsigned char *rows = buffer;
+    if (firstRow != 0 || numRows != chunkRows)
+    {
+        decoded.resize(chunkRows * rowSize);
+        rows = &decoded[0];
+    }
+    tiff::Decoder::decode(mCompression,
+                          compressed.empty() ? NULL : &compressed[0],
+                          compressed.size(), rows, chunkRows * rowSize);
+
+    // The floating point predictor leaves samples in this machine's order,
+    // and horizontal differencing has to be undone in it
+    if (mReverseBytes && mSampleSize > 1 &&
+        mPredictor != tiff::Const::PredictorType::FLOATING_POINT)
+        sys::byteSwap((sys::byte *)rows, mSampleSize,
+                      chunkRows * rowSize / mSampleSize);
+    tiff::Decoder::undoPredictor(mPredictor, rows, chunkRows, rowSize,
+                                 mSampleSize, mElementSize / mSampleSize);
+
+    if (rows != buffer)
+        memcpy(buffer, rows + firstRow * rowSize, numRows * rowSize);
+}
+
+void tiff::ImageReader::readChunkRegion(size_t chunk, unsigned char *buffer,
+        size_t rowStart, size_t colStart, size_t numRows, size_t numCols,
+        std::vector<unsigned char>& scratch)
+{
+    // The part of the region inside this chunk, which can run past the
+    // image's bottom and right edges
+    const size_t chunkRowStart = (chunk / mChunksAcross) * mChunkLength;
+    const size_t chunkColStart = (chunk % mChunksAcross) * mChunkWidth;
+    const size_t rowBegin = std::max(rowStart, chunkRowStart);
+    const size_t rowEnd = std::min(rowStart + numRows,
+                                   chunkRowStart + mChunkLength);
+    const size_t colBegin = std::max(colStart, chunkColStart);
+    const size_t colEnd = std::min(colStart + numCols,
+                                   chunkColStart + mChunkWidth);
+    if (rowBegin >= rowEnd || colBegin >= colEnd)
+        return;
+
+    const size_t rows = rowEnd - rowBegin;
+    const size_t spanSize = (colEnd - colBegin) * mElementSize;
+    const size_t outRowSize = numCols * mElementSize;
+    unsigned char *out = buffer + (rowBegin - rowStart) * outRowSize +
+            (colBegin - colStart) * mElementSize;
+
+    if (spanSize == outRowSize && colEnd - colBegin == mChunkWidth)
+    {
+        // Chunk rows are output rows, as with a full-width region of strips
+        readChunkRows(chunk, rowBegin - chunkRowStart, rows, out);
+    }
+    else
+    {
+        const size_t chunkRowSize = mChunkWidth * mElementSize;
+        scratch.resize(rows * chunkRowSize);
+        readChunkRows(chunk, rowBegin - chunkRowStart, rows, &scratch[0]);
+
+        const unsigned char *in = &scratch[0] +
+                (colBegin - chunkColStart) * mElementSize;
+        for (size_t row = 0; row < rows; ++row)
+        {
+            memcpy(out + row * outRowSize, in + row * chunkRowSize,
+                   spanSize);
+        }
+    }
+}
+
+void tiff::ImageReader::getDecodedData(unsigned char *buffer,
+        sys::Uint32_T numElementsToRead)
+{
+    // Decode a row of strips or tiles at a time, on this thread, and keep
+    // the last one, so that reading a row or less at a time doesn't decode
+    // the same strips or tiles over and over
+    const size_t rowSize = mWidth * mElementSize;
+    size_t position = mBytePosition;
+    size_t size = static_cast<size_t>(numElementsToRead) * mElementSize;
+    if (size == 0)
+        return;
+    if (position + size > mLength * rowSize)
+        throw except::Exception(Ctxt("Read past the end of the image"));
+    if (mChunkLength == 0)
+        throw except::Exception(Ctxt("Unsupported TIFF file format"));
+
+    const size_t chunkRowSize = mChunkLength * rowSize;
+    while (size > 0)
+    {
+        const size_t chunkRow = position / chunkRowSize;
+        if (chunkRow != mDecodedChunkRow)
+        {
+            const size_t firstRow = chunkRow * mChunkLength;
+            const size_t numRows = std::min(mChunkLength,
+                                            mLength - firstRow);
+            mDecodedChunkRow = NO_CHUNK_ROW;
+            mDecodedRows.resize(numRows * rowSize);
+            getRegion(&mDecodedRows[0], firstRow, 0, numRows, mWidth, 1);
+            mDecodedChunkRow = chunkRow;
+        }
+
+        const size_t offset = position - chunkRow * chunkRowSize;
+        const size_t numBytes = std::min(size, mDecodedRows.size() - offset);
+        memcpy(buffer, &mDecodedRows[offset], numBytes);
+        buffer += numBytes;
+        position += numBytes;
+        size -= numBytes;
+    }
+
+    mBytePosition = static_cast<sys::Uint32_T>(position);
 }
 
 void tiff::ImageReader::getStripData(unsigned char *buffer,
@@ -87,7 +416,7 @@ void tiff::ImageReader::getStripData(unsigned char *buffer,
     //figure out how far we are in the current strip
     sys::Uint32_T stripOffset = 0;
     for (size_t i = 0; i < mStripIndex; ++i)
-        stripOffset += *(tiff::GenericType<sys::Uint32_T> *)(*mStripByteCounts)[i];
+        stripOffset += mByteCounts[i];
     sys::Uint32_T stripPosition = mBytePosition - stripOffset;
     
     //how many bytes do we need to read?
@@ -95,16 +424,17 @@ void tiff::ImageReader::getStripData(unsigned char *buffer,
 
     while (numBytesToRead)
     {
-        if (mStripIndex >= mStripOffsets->getCount())
+        if (mStripIndex >= mOffsets.size() ||
+            mStripIndex >= mByteCounts.size())
             throw except::Exception(Ctxt("Invalid strip offset index"));
 
-        sys::Uint32_T stripSize = *(tiff::GenericType<sys::Uint32_T> *)(*mStripByteCounts)[mStripIndex];
+        sys::Uint32_T stripSize = mByteCounts[mStripIndex];
 
         // Calculate what remains to be read in the current strip.
         sys::Uint32_T remainingBytesInStrip = stripSize - stripPosition;
 
         // Seek to the strip offset plus the last read position.
-        sys::Uint32_T seekPos = (*(tiff::GenericType<sys::Uint32_T> *)(*mStripOffsets)[mStripIndex]) + stripPosition;
+        sys::Uint32_T seekPos = mOffsets[mStripIndex] + stripPosition;
 
         
         sys::Uint32_T thisRead = numBytesToRead;
@@ -118,8 +448,7 @@ void tiff::ImageReader::getStripData(unsigned char *buffer,
         }
         
         // Go to the offset, and read.
-        mInput->seek(seekPos, io::Seekable::START);
-        mInput->read((sys::byte *)buffer + bufferOffset, thisRead);
+        readAt(seekPos, buffer + bufferOffset, thisRead);
 
         // Update the tile position in bytes.
         mBytePosition += thisRead;
@@ -136,33 +465,14 @@ void tiff::ImageReader::getStripData(unsigned char *buffer,
 void tiff::ImageReader::getTileData(unsigned char*buffer,
         sys::Uint32_T numElementsToRead)
 {
-    // Get the image width and length.
-    sys::Uint32_T imageElemWidth = mIFD.getImageWidth();
-    sys::Uint32_T imageByteWidth = imageElemWidth * mElementSize;
+    // Get the image width.
+    sys::Uint32_T imageByteWidth = mWidth * mElementSize;
 
-    // Get the tile width.
-    tiff::IFDEntry *tileWidth = mIFD["TileWidth"];
-    sys::Uint32_T tileElemWidth = 0;
-    if (tileWidth->getType() == tiff::Const::Type::LONG)
-        tileElemWidth = *(tiff::GenericType<sys::Uint32_T> *)(*tileWidth)[0];
-    else
-        tileElemWidth = *(tiff::GenericType<unsigned short> *)(*tileWidth)[0];
-    sys::Uint32_T tileByteWidth = tileElemWidth * mElementSize;
-
-    // Get the tile length.
-    tiff::IFDEntry *tileLength = mIFD["TileLength"];
-    sys::Uint32_T tileElemLength = 0;
-    if (tileLength->getType() == tiff::Const::Type::LONG)
-        tileElemLength = *(tiff::GenericType<sys::Uint32_T> *)(*tileLength)[0];
-    else
-        tileElemLength = *(tiff::GenericType<unsigned short> *)(*tileLength)[0];
-
-    // Compute the number of tiles wide the image is.
-    sys::Uint32_T tilesAcross = (imageElemWidth + tileElemWidth - 1)
-            / tileElemWidth;
+    sys::Uint32_T tileByteWidth = mChunkWidth * mElementSize;
 
     // Determine how many bytes were used to pad the right edge.
-    sys::Uint32_T widthPadding = (tileByteWidth * tilesAcross) - imageByteWidth;
+    sys::Uint32_T widthPadding = (tileByteWidth * mChunksAcross) -
+            imageByteWidth;
     sys::Uint32_T bufferOffset = 0;
 
     while (numElementsToRead)
@@ -171,8 +481,8 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
 
         // Compute the row in image, row in tile, and tile row.
         sys::Uint32_T row = mBytePosition / imageByteWidth;
-        sys::Uint32_T tileRow = row / tileElemLength;
-        sys::Uint32_T rowInTile = row % tileElemLength;
+        sys::Uint32_T tileRow = row / mChunkLength;
+        sys::Uint32_T rowInTile = row % mChunkLength;
 
         // Compute the column in image, column in tile, and tile column.
         sys::Uint32_T column = mBytePosition - (row * imageByteWidth);
@@ -180,9 +490,11 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
         sys::Uint32_T colInTile = column % tileByteWidth;
 
         // Compute the 1D tile index from the tile row and tile column.
-        sys::Uint32_T tileIndex = (tileRow * tilesAcross) + tileColumn;
+        sys::Uint32_T tileIndex = (tileRow * mChunksAcross) + tileColumn;
+        if (tileIndex >= mOffsets.size())
+            throw except::Exception(Ctxt("Invalid tile offset index"));
 
-        sys::Uint32_T paddedBytes = ((tileColumn + 1) / tilesAcross)
+        sys::Uint32_T paddedBytes = ((tileColumn + 1) / mChunksAcross)
                 * widthPadding;
 
         sys::Uint32_T remainingBytesThisLine = tileByteWidth - (paddedBytes
@@ -195,15 +507,11 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
             bytesToRead = remainingBytesThisLine;
 
         // Seek to the tile offset plus the last read position.
-        tiff::IFDEntry *tileOffsets = mIFD["TileOffsets"];
-        sys::Uint32_T seekPos = (*(tiff::GenericType<sys::Uint32_T> *)(*tileOffsets)[tileIndex]) + (rowInTile * tileByteWidth)
-                + colInTile;
-
-        // Go to the offset.
-        mInput->seek(seekPos, io::Seekable::START);
+        sys::Uint32_T seekPos = mOffsets[tileIndex] +
+                (rowInTile * tileByteWidth) + colInTile;
 
         // Read the data.
-        mInput->read((sys::byte *)buffer + bufferOffset, bytesToRead);
+        readAt(seekPos, buffer + bufferOffset, bytesToRead);
 
         // Update the strip position in bytes.
         mBytePosition += bytesToRead;
@@ -0,0 +1,158 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/tiff.h>
+
+// Benchmarks reading and decoding whole TIFF images with getImage(), with
+// a growing number of threads.  Give it the same image written several
+// ways (uncompressed, LZW, Deflate, PackBits, with and without a
+// predictor) to compare them.  Each time is the best of a few reads with
+// the file in the page cache.
+namespace
+{
+const size_t NUM_TRIALS = 3;
+
+std::string compressionName(unsigned short compression)
+{
+    switch (compression)
+    {
+    case tiff::Const::CompressionType::NO_COMPRESSION:
+        return "none";
+    case tiff::Const::CompressionType::LZW:
+        return "LZW";
+    case tiff::Const::CompressionType::DEFLATE:
+    case tiff::Const::CompressionType::ADOBE_DEFLATE:
+        return "Deflate";
+    case tiff::Const::CompressionType::PACK_BITS:
+        return "PackBits";
+    default:
+        return str::toString(compression);
+    }
+}
+
+std::string predictorName(unsigned short predictor)
+{
+    switch (predictor)
+    {
+    case tiff::Const::PredictorType::NONE:
+        return "";
+    case tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING:
+        return " + horizontal";
+    case tiff::Const::PredictorType::FLOATING_POINT:
+        return " + floating point";
+    default:
+        return " + predictor " + str::toString(predictor);
+    }
+}
+
+// Returns the best elapsed time in ms
+double BM_GetImage(const std::string& pathname, size_t numThreads)
+{
+    double best = 0;
+    for (size_t trial = 0; trial < NUM_TRIALS; ++trial)
+    {
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        tiff::FileReader reader(pathname);
+        std::vector<unsigned char> image(
+                reader[0]->getIFD()->getImageSize());
+        reader[0]->getImage(&image[0], numThreads);
+        const double elapsed = sw.stop();
+        best = trial == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+void runBenchmark(const std::string& pathname, size_t maxThreads)
+{
+    tiff::FileReader reader(pathname);
+    tiff::ImageReader& image = *reader[0];
+    const double imageMB = image.getIFD()->getImageSize() / (1024.0 * 1024.0);
+    const double fileMB = sys::OS().getSize(pathname) / (1024.0 * 1024.0);
+    std::cout << sys::Path::basename(pathname) << ": "
+              << image.getIFD()->getImageLength() << " x "
+              << image.getIFD()->getImageWidth() << ", "
+              << image.getNumChunks()
+              << (image.isTiled() ? " tiles, " : " strips, ")
+              << compressionName(image.getCompression())
+              << predictorName(image.getPredictor()) << ", "
+              << std::fixed << std::setprecision(1) << imageMB << " MB in "
+              << fileMB << " MB" << std::endl;
+    reader.close();
+
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        const double elapsedMS = BM_GetImage(pathname, numThreads);
+        std::cout << "  " << std::setw(12) << std::left
+                  << str::toString(numThreads) + (numThreads == 1 ?
+                                                   " thread" : " threads")
+                  << std::setw(10) << std::right << std::fixed
+                  << std::setprecision(1) << elapsedMS << " ms "
+                  << std::setw(10) << std::right << std::fixed
+                  << std::setprecision(1) << imageMB / (elapsedMS / 1000.0)
+                  << " MB/s" << std::endl;
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 3)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " maxThreads tiffFile [tiffFile ...]" << std::endl;
+            return 1;
+        }
+
+        const size_t maxThreads = std::max<size_t>(
+                str::toType<size_t>(argv[1]), 1);
+        for (int ii = 2; ii < argc; ++ii)
+        {
+            runBenchmark(argv[ii], maxThreads);
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,278 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <import/tiff.h>
+#include "PageCache.h"
+
+// Benchmarks reading a large float image stored in strips and in tiles:
+// getData() against getImage() with a growing number of threads, with the
+// file in the page cache and, on Linux, after evicting it, and random
+// chips through getRegion().
+namespace
+{
+const size_t CHIP_SIZE = 512;
+
+//! Each pixel holds its own index, so a misplaced strip or tile shows up
+std::vector<float> makeImage(size_t rows, size_t cols)
+{
+    std::vector<float> image(rows * cols);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            image[row * cols + col] = static_cast<float>(row * cols + col);
+        }
+    }
+    return image;
+}
+
+void writeImage(const std::vector<float>& image, size_t rows, size_t cols,
+                tiff::ImageWriter::ImageFormat format,
+                const std::string& pathname)
+{
+    tiff::FileWriter fileWriter(pathname);
+    fileWriter.writeHeader();
+
+    tiff::ImageWriter* imageWriter = fileWriter.addImage();
+    tiff::IFD* ifd = imageWriter->getIFD();
+    ifd->addEntry(tiff::KnownTags::IMAGE_WIDTH,
+                  static_cast<sys::Uint32_T>(cols));
+    ifd->addEntry(tiff::KnownTags::IMAGE_LENGTH,
+                  static_cast<sys::Uint32_T>(rows));
+    ifd->addEntry(tiff::KnownTags::PHOTOMETRIC_INTERPRETATION,
+                  static_cast<unsigned short>(
+                          tiff::Const::PhotoInterpType::BLACK_IS_ZERO));
+    ifd->addEntry(tiff::KnownTags::BITS_PER_SAMPLE,
+                  static_cast<unsigned short>(32));
+    ifd->addEntry(tiff::KnownTags::SAMPLE_FORMAT,
+                  static_cast<unsigned short>(
+                          tiff::Const::SampleFormatType::IEEE_FLOAT));
+
+    // 256 x 256 tiles, and strips of about 64 KB
+    imageWriter->setImageFormat(format);
+    imageWriter->setIdealChunkSize(
+            format == tiff::ImageWriter::TILED ? 256 * 256 * sizeof(float) :
+                                                 64 * 1024);
+    imageWriter->putData(reinterpret_cast<const unsigned char*>(&image[0]),
+                         static_cast<sys::Uint32_T>(image.size()));
+    imageWriter->writeIFD();
+    fileWriter.close();
+}
+
+void check(const std::vector<float>& read, const std::vector<float>& image,
+           const std::string& pathname)
+{
+    if (read != image)
+    {
+        throw except::Exception(Ctxt(pathname + " has the wrong data"));
+    }
+}
+
+// Returns the elapsed time in ms
+double BM_GetData(const std::vector<float>& image,
+                  const std::string& pathname)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    tiff::FileReader reader(pathname);
+    std::vector<float> read(image.size());
+    reader.getData(reinterpret_cast<unsigned char*>(&read[0]),
+                   static_cast<sys::Uint32_T>(read.size()));
+    const double elapsed = sw.stop();
+    check(read, image, pathname);
+    return elapsed;
+}
+
+// Returns the elapsed time in ms
+double BM_GetImage(const std::vector<float>& image,
+                   const std::string& pathname, size_t numThreads)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    tiff::FileReader reader(pathname);
+    std::vector<float> read(image.size());
+    reader[0]->getImage(reinterpret_cast<unsigned char*>(&read[0]),
+                        numThreads);
+    const double elapsed = sw.stop();
+    check(read, image, pathname);
+    return elapsed;
+}
+
+// Returns the elapsed time in ms
+double BM_GetRegions(const std::vector<float>& image, size_t rows,
+                     size_t cols, const std::string& pathname,
+                     size_t numChips, size_t numThreads)
+{
+    const size_t chipRows = std::min(CHIP_SIZE, rows);
+    const size_t chipCols = std::min(CHIP_SIZE, cols);
+    srand(1234);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    tiff::FileReader reader(pathname);
+    std::vector<float> chip(chipRows * chipCols);
+    for (size_t ii = 0; ii < numChips; ++ii)
+    {
+        const size_t top = rand() % (rows - chipRows + 1);
+        const size_t left = rand() % (cols - chipCols + 1);
+        reader[0]->getRegion(reinterpret_cast<unsigned char*>(&chip[0]),
+                             top, left, chipRows, chipCols, numThreads);
+        if (!std::equal(chip.begin(), chip.begin() + chipCols,
+                        image.begin() + top * cols + left))
+        {
+            throw except::Exception(Ctxt(pathname + " has the wrong data"));
+        }
+    }
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, double sizeMB)
+{
+    std::cout << std::setw(40) << std::left << name << " "
+              << std::setw(10) << std::right << std::fixed
+              << std::setprecision(1) << elapsedMS << " "
+              << std::setw(10) << std::right << std::fixed
+              << std::setprecision(1) << sizeMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+
+std::string threads(size_t numThreads)
+{
+    return str::toString(numThreads) +
+            (numThreads == 1 ? " thread" : " threads");
+}
+
+void runBenchmark(const std::vector<float>& image, size_t rows, size_t cols,
+                  tiff::ImageWriter::ImageFormat format,
+                  const std::string& workDir, size_t maxThreads,
+                  size_t numChips)
+{
+    const std::string layout =
+            format == tiff::ImageWriter::TILED ? "tiled" : "stripped";
+    const std::string pathname = sys::Path::joinPaths(
+            workDir, "image_reader_benchmark_" + layout + ".tif");
+    const double imageMB = image.size() * sizeof(float) / (1024.0 * 1024.0);
+    const double chipsMB = numChips * std::min(CHIP_SIZE, rows) *
+            std::min(CHIP_SIZE, cols) * sizeof(float) / (1024.0 * 1024.0);
+
+    writeImage(image, rows, cols, format, pathname);
+    {
+        tiff::FileReader reader(pathname);
+        std::cout << layout << ": " << reader[0]->getNumChunks()
+                  << (format == tiff::ImageWriter::TILED ? " tiles" :
+                                                           " strips")
+                  << std::endl;
+    }
+
+    printResult(layout + " getData", BM_GetData(image, pathname), imageMB);
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        printResult(layout + " getImage, " + threads(numThreads),
+                    BM_GetImage(image, pathname, numThreads), imageMB);
+    }
+
+    if (evictFromPageCache(pathname))
+    {
+        printResult(layout + " getData, cold", BM_GetData(image, pathname),
+                    imageMB);
+        for (size_t numThreads = 1; numThreads <= maxThreads;
+             numThreads *= 2)
+        {
+            evictFromPageCache(pathname);
+            printResult(layout + " getImage, cold, " + threads(numThreads),
+                        BM_GetImage(image, pathname, numThreads), imageMB);
+        }
+    }
+
+    printResult(layout + " getRegion chips, 1 thread",
+                BM_GetRegions(image, rows, cols, pathname, numChips, 1),
+                chipsMB);
+    if (maxThreads > 1)
+    {
+        printResult(layout + " getRegion chips, " + threads(maxThreads),
+                    BM_GetRegions(image, rows, cols, pathname, numChips,
+                                  maxThreads),
+                    chipsMB);
+    }
+
+    sys::OS().remove(pathname);
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [rows] [cols] [maxThreads] [numChips]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t rows = (argc > 2) ? str::toType<size_t>(argv[2]) : 4096;
+        const size_t cols = (argc > 3) ? str::toType<size_t>(argv[3]) : 4096;
+        const size_t maxThreads = (argc > 4) ?
+                str::toType<size_t>(argv[4]) :
+                std::max<size_t>(sys::OS().getNumCPUs(), 4);
+        const size_t numChips =
+                (argc > 5) ? str::toType<size_t>(argv[5]) : 100;
+
+        std::cout << std::setw(40) << std::left << "Benchmark" << " "
+                  << std::setw(10) << std::right << "ms" << " "
+                  << std::setw(10) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(62, '-') << std::endl;
+
+        const std::vector<float> image = makeImage(rows, cols);
+        runBenchmark(image, rows, cols, tiff::ImageWriter::STRIPPED, workDir,
+                     maxThreads, numChips);
+        runBenchmark(image, rows, cols, tiff::ImageWriter::TILED, workDir,
+                     maxThreads, numChips);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <tiff/Common.h>
+#include <tiff/Decoder.h>
+#include "TestCase.h"
+
+// Known answers.  The LZW and predictor data were written by libtiff.
+namespace
+{
+const char TEXT[] = "TOBEORNOTTOBEORTOBEORNOT";
+const size_t TEXT_SIZE = sizeof(TEXT) - 1;
+
+const unsigned char TEXT_LZW[] = {
+    0x80, 0x15, 0x09, 0xe4, 0x22, 0x29, 0x3c, 0xa4, 0x4e, 0x27, 0x95,
+    0x20, 0x50, 0x48, 0x34, 0x2e, 0x0b, 0x07, 0x84, 0xc0, 0x40
+};
+
+const unsigned char TEXT_DEFLATE[] = {
+    0x78, 0xda, 0x0b, 0xf1, 0x77, 0x72, 0xf5, 0x0f, 0xf2, 0xf3, 0x0f,
+    0x09, 0x01, 0x33, 0x42, 0x60, 0x5c, 0x00, 0x5a, 0x97, 0x07, 0x44
+};
+
+// From section 9 of TIFF 6.0
+const unsigned char PACK_BITS[] = {
+    0xFE, 0xAA, 0x02, 0x80, 0x00, 0x2A, 0xFD, 0xAA, 0x03, 0x80, 0x00,
+    0x2A, 0x22, 0xF7, 0xAA
+};
+const unsigned char UNPACKED_BITS[] = {
+    0xAA, 0xAA, 0xAA, 0x80, 0x00, 0x2A, 0xAA, 0xAA, 0xAA, 0xAA, 0x80,
+    0x00, 0x2A, 0x22, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+    0xAA, 0xAA
+};
+
+// 1000, 1010, 990, 65535, 3, 7 as little endian shorts, differenced
+const unsigned char SHORTS_LZW_HORIZONTAL[] = {
+    0x80, 0x3a, 0x00, 0x60, 0xa0, 0x03, 0xb1, 0xfe, 0x21, 0x7e, 0x01,
+    0x00, 0x10, 0xa8, 0x08
+};
+const sys::Uint16_T SHORTS[] = { 1000, 1010, 990, 65535, 3, 7 };
+
+// 1, 1.5, -2.25, 100 through the floating point predictor
+const unsigned char FLOATS_LZW_FLOATING_POINT[] = {
+    0x80, 0x0f, 0xc0, 0x08, 0x14, 0x10, 0xf8, 0x80, 0x50, 0x5c, 0x0e,
+    0x00, 0x10, 0xb8, 0x60, 0x02, 0x02
+};
+const float FLOATS[] = { 1.0f, 1.5f, -2.25f, 100.0f };
+
+TEST_CASE(testLZW)
+{
+    std::vector<unsigned char> text(TEXT_SIZE);
+    tiff::Decoder::decodeLZW(TEXT_LZW, sizeof(TEXT_LZW), &text[0],
+                             text.size());
+    TEST_ASSERT_EQ(std::string(text.begin(), text.end()), TEXT);
+
+    // Fewer bytes than the data holds is fine, more is an error
+    tiff::Decoder::decodeLZW(TEXT_LZW, sizeof(TEXT_LZW), &text[0], 10);
+    TEST_ASSERT_EQ(std::string(text.begin(), text.begin() + 10),
+                   "TOBEORNOTT");
+    text.resize(TEXT_SIZE + 1);
+    TEST_EXCEPTION(tiff::Decoder::decodeLZW(TEXT_LZW, sizeof(TEXT_LZW),
+                                            &text[0], text.size()));
+    TEST_EXCEPTION(tiff::Decoder::decodeLZW(TEXT_LZW, 8, &text[0],
+                                            TEXT_SIZE));
+}
+
+TEST_CASE(testDeflate)
+{
+    std::vector<unsigned char> text(TEXT_SIZE);
+    if (!tiff::Decoder::isSupported(
+            tiff::Const::CompressionType::DEFLATE))
+    {
+        TEST_EXCEPTION(tiff::Decoder::decodeDeflate(
+                TEXT_DEFLATE, sizeof(TEXT_DEFLATE), &text[0], text.size()));
+        return;
+    }
+
+    tiff::Decoder::decode(tiff::Const::CompressionType::ADOBE_DEFLATE,
+                          TEXT_DEFLATE, sizeof(TEXT_DEFLATE), &text[0],
+                          text.size());
+    TEST_ASSERT_EQ(std::string(text.begin(), text.end()), TEXT);
+
+    text.resize(TEXT_SIZE + 1);
+    TEST_EXCEPTION(tiff::Decoder::decodeDeflate(
+            TEXT_DEFLATE, sizeof(TEXT_DEFLATE), &text[0], text.size()));
+    TEST_EXCEPTION(tiff::Decoder::decodeDeflate(
+            TEXT_DEFLATE + 1, sizeof(TEXT_DEFLATE) - 1, &text[0],
+            TEXT_SIZE));
+}
+
+TEST_CASE(testPackBits)
+{
+    std::vector<unsigned char> unpacked(sizeof(UNPACKED_BITS));
+    tiff::Decoder::decode(tiff::Const::CompressionType::PACK_BITS,
+                          PACK_BITS, sizeof(PACK_BITS), &unpacked[0],
+                          unpacked.size());
+    TEST_ASSERT(std::equal(unpacked.begin(), unpacked.end(),
+                           UNPACKED_BITS));
+
+    // A literal that runs past the end, and data that runs out
+    TEST_EXCEPTION(tiff::Decoder::decodePackBits(PACK_BITS + 2, 3,
+                                                 &unpacked[0], 3));
+    TEST_EXCEPTION(tiff::Decoder::decodePackBits(PACK_BITS, 6,
+                                                 &unpacked[0], 7));
+}
+
+TEST_CASE(testHorizontalPredictor)
+{
+    std::vector<sys::Uint16_T> shorts(6);
+    unsigned char* const bytes =
+            reinterpret_cast<unsigned char*>(&shorts[0]);
+    tiff::Decoder::decodeLZW(SHORTS_LZW_HORIZONTAL,
+                             sizeof(SHORTS_LZW_HORIZONTAL), bytes, 12);
+    if (sys::isBigEndianSystem())
+        sys::byteSwap(bytes, 2, 6);
+    tiff::Decoder::undoPredictor(
+            tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING, bytes, 1,
+            12, 2, 1);
+    TEST_ASSERT(std::equal(shorts.begin(), shorts.end(), SHORTS));
+
+    // Two rows of three-sample pixels
+    unsigned char rgb[] = { 10, 20, 30, 1, 2, 3, 255, 0, 1,
+                            5, 5, 5, 0, 0, 0, 1, 1, 1 };
+    tiff::Decoder::undoPredictor(
+            tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING, rgb, 2, 9,
+            1, 3);
+    const unsigned char expected[] = { 10, 20, 30, 11, 22, 33, 10, 22, 34,
+                                       5, 5, 5, 5, 5, 5, 6, 6, 6 };
+    TEST_ASSERT(std::equal(rgb, rgb + sizeof(rgb), expected));
+}
+
+TEST_CASE(testFloatingPointPredictor)
+{
+    // The predictor leaves samples in this machine's byte order
+    std::vector<float> floats(4);
+    unsigned char* const bytes = reinterpret_cast<unsigned char*>(&floats[0]);
+    tiff::Decoder::decodeLZW(FLOATS_LZW_FLOATING_POINT,
+                             sizeof(FLOATS_LZW_FLOATING_POINT), bytes, 16);
+    tiff::Decoder::undoPredictor(tiff::Const::PredictorType::FLOATING_POINT,
+                                 bytes, 1, 16, 4, 1);
+    TEST_ASSERT(std::equal(floats.begin(), floats.end(), FLOATS));
+}
+
+TEST_CASE(testUnsupported)
+{
+    TEST_ASSERT(tiff::Decoder::isSupported(
+            tiff::Const::CompressionType::NO_COMPRESSION));
+    TEST_ASSERT(tiff::Decoder::isSupported(
+            tiff::Const::CompressionType::LZW));
+    TEST_ASSERT(!tiff::Decoder::isSupported(
+            tiff::Const::CompressionType::JPEG));
+
+    unsigned char output[4];
+    TEST_EXCEPTION(tiff::Decoder::decode(tiff::Const::CompressionType::JPEG,
+                                         PACK_BITS, sizeof(PACK_BITS),
+                                         output, sizeof(output)));
+    TEST_EXCEPTION(tiff::Decoder::undoPredictor(4, output, 1, 4, 1, 1));
+    TEST_EXCEPTION(tiff::Decoder::undoPredictor(
+            tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING, output, 1,
+            3, 3, 1));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testLZW);
+    TEST_CHECK(testDeflate);
+    TEST_CHECK(testPackBits);
+    TEST_CHECK(testHorizontalPredictor);
+    TEST_CHECK(testFloatingPointPredictor);
+    TEST_CHECK(testUnsupported);
+    return 0;
+}
@@ -0,0 +1,796 @@
+/* =========================================================================
+ * This file is part of tiff-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * tiff-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/OS.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include <tiff/Common.h>
+#include <tiff/Decoder.h>
+#include <tiff/FileReader.h>
+#include <tiff/Header.h>
+#include <tiff/ImageReader.h>
+#include <tiff/tiff_config.h>
+#include "TestCase.h"
+
+#ifdef TIFF_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+const char* const TIFF_FILE = "test_image_reader.tif";
+
+//! Sample b of pixel (row, col)
+sys::Uint16_T pixel(size_t row, size_t col, size_t b = 0)
+{
+    return static_cast<sys::Uint16_T>(row * 1000 + col * 3 + b);
+}
+
+std::vector<sys::Uint16_T> makeImage(size_t length, size_t width,
+                                     size_t numBands = 1)
+{
+    std::vector<sys::Uint16_T> image(length * width * numBands);
+    for (size_t row = 0; row < length; ++row)
+        for (size_t col = 0; col < width; ++col)
+            for (size_t b = 0; b < numBands; ++b)
+                image[(row * width + col) * numBands + b] = pixel(row, col, b);
+    return image;
+}
+
+//! Appends code, width bits wide, most significant bit first
+void putCode(unsigned int code, unsigned int width, sys::Uint32_T& bits,
+             unsigned int& numBits, std::vector<unsigned char>& output)
+{
+    bits = (bits << width) | code;
+    numBits += width;
+    while (numBits >= 8)
+    {
+        output.push_back(static_cast<unsigned char>(bits >> (numBits - 8)));
+        numBits -= 8;
+    }
+}
+
+//! LZW the way libtiff writes it, widening codes one early and clearing
+//! the table before it fills
+std::vector<unsigned char> encodeLZW(const std::vector<unsigned char>& input)
+{
+    std::vector<unsigned char> output;
+    sys::Uint32_T bits = 0;
+    unsigned int numBits = 0;
+    unsigned int width = 9;
+    unsigned int next = 258;
+    std::map<unsigned int, unsigned int> table;
+    putCode(256, width, bits, numBits, output);
+
+    unsigned int prefix = input[0];
+    for (size_t ii = 1; ii < input.size(); ++ii)
+    {
+        const unsigned int key = (prefix << 8) | input[ii];
+        std::map<unsigned int, unsigned int>::const_iterator found =
+                table.find(key);
+        if (found != table.end())
+        {
+            prefix = found->second;
+            continue;
+        }
+
+        putCode(prefix, width, bits, numBits, output);
+        table[key] = next++;
+        if (next == 4094)
+        {
+            putCode(256, width, bits, numBits, output);
+            table.clear();
+            width = 9;
+            next = 258;
+        }
+        else if (next == (1u << width))
+        {
+            ++width;
+        }
+        prefix = input[ii];
+    }
+
+    // The reader adds a string for the last code too
+    putCode(prefix, width, bits, numBits, output);
+    if (++next == (1u << width))
+        ++width;
+    putCode(257, width, bits, numBits, output);
+    if (numBits > 0)
+        output.push_back(static_cast<unsigned char>(bits << (8 - numBits)));
+    return output;
+}
+
+std::vector<unsigned char> encodePackBits(
+        const std::vector<unsigned char>& input)
+{
+    std::vector<unsigned char> output;
+    size_t ii = 0;
+    while (ii < input.size())
+    {
+        size_t run = 1;
+        while (ii + run < input.size() && run < 128 &&
+               input[ii + run] == input[ii])
+            ++run;
+        if (run > 1)
+        {
+            output.push_back(static_cast<unsigned char>(257 - run));
+            output.push_back(input[ii]);
+            ii += run;
+            continue;
+        }
+
+        // A literal, up to the next repeated byte
+        size_t end = ii + 1;
+        while (end < input.size() && end - ii < 128 &&
+               !(end + 1 < input.size() && input[end + 1] == input[end]))
+            ++end;
+        output.push_back(static_cast<unsigned char>(end - ii - 1));
+        output.insert(output.end(), input.begin() + ii, input.begin() + end);
+        ii = end;
+    }
+    return output;
+}
+
+std::vector<unsigned char> encode(unsigned short compression,
+                                  const std::vector<unsigned char>& input)
+{
+    switch (compression)
+    {
+    case tiff::Const::CompressionType::LZW:
+        return encodeLZW(input);
+    case tiff::Const::CompressionType::PACK_BITS:
+        return encodePackBits(input);
+#ifdef TIFF_HAVE_ZLIB
+    case tiff::Const::CompressionType::DEFLATE:
+    {
+        uLongf size = compressBound(static_cast<uLong>(input.size()));
+        std::vector<unsigned char> output(size);
+        compress(&output[0], &size, &input[0],
+                 static_cast<uLong>(input.size()));
+        output.resize(size);
+        return output;
+    }
+#endif
+    default:
+        // Stored as it is, even when the tag says otherwise
+        return input;
+    }
+}
+
+//! Writes a 16-bit TIFF a value at a time, so that the byte order, tag
+//! types and strip or tile layout are all up to the test
+class TestTIFF
+{
+public:
+    TestTIFF(size_t length, size_t width, size_t numBands = 1) :
+        mLength(length), mWidth(width), mNumBands(numBands),
+        mTiled(false), mChunkLength(length), mChunkWidth(width),
+        mSwapped(false), mShortCounts(false),
+        mCompression(tiff::Const::CompressionType::NO_COMPRESSION),
+        mPredictor(tiff::Const::PredictorType::NONE)
+    {
+    }
+
+    void setCompression(unsigned short compression,
+                        unsigned short predictor =
+                                tiff::Const::PredictorType::NONE)
+    {
+        mCompression = compression;
+        mPredictor = predictor;
+    }
+
+    void setStrips(size_t rowsPerStrip)
+    {
+        mTiled = false;
+        mChunkLength = rowsPerStrip;
+        mChunkWidth = mWidth;
+    }
+
+    void setTiles(size_t tileLength, size_t tileWidth)
+    {
+        mTiled = true;
+        mChunkLength = tileLength;
+        mChunkWidth = tileWidth;
+    }
+
+    //! Write in the opposite byte order from this machine's
+    void setSwapped()
+    {
+        mSwapped = true;
+    }
+
+    //! Store the byte counts as SHORTs rather than LONGs
+    void setShortCounts()
+    {
+        mShortCounts = true;
+    }
+
+    void write(const std::vector<sys::Uint16_T>& image)
+    {
+        // Cut the image up into strips, or tiles padded out to full size
+        const size_t across = (mWidth + mChunkWidth - 1) / mChunkWidth;
+        const size_t down = (mLength + mChunkLength - 1) / mChunkLength;
+        std::vector<std::vector<unsigned char> > chunks;
+        for (size_t ii = 0; ii < across * down; ++ii)
+        {
+            const size_t rowStart = (ii / across) * mChunkLength;
+            const size_t colStart = (ii % across) * mChunkWidth;
+            const size_t rows = mTiled ? mChunkLength :
+                    std::min(mChunkLength, mLength - rowStart);
+            std::vector<sys::Uint16_T> chunk(rows * mChunkWidth * mNumBands);
+            for (size_t row = 0; row < rows; ++row)
+                for (size_t col = 0; col < mChunkWidth; ++col)
+                    if (rowStart + row < mLength && colStart + col < mWidth)
+                        for (size_t b = 0; b < mNumBands; ++b)
+                            chunk[(row * mChunkWidth + col) * mNumBands + b] =
+                                    image[((rowStart + row) * mWidth +
+                                           colStart + col) * mNumBands + b];
+            chunks.push_back(encode(mCompression, predict(chunk, rows)));
+        }
+
+        std::vector<sys::byte> data;
+        std::vector<sys::Uint32_T> offsets;
+        std::vector<sys::Uint32_T> counts;
+        for (size_t ii = 0; ii < chunks.size(); ++ii)
+        {
+            offsets.push_back(static_cast<sys::Uint32_T>(8 + data.size()));
+            counts.push_back(static_cast<sys::Uint32_T>(chunks[ii].size()));
+            data.insert(data.end(), chunks[ii].begin(), chunks[ii].end());
+        }
+        if (data.size() % 2)
+            data.push_back(0);
+
+        mEntries.clear();
+        addEntry(256, tiff::Const::Type::LONG, single(mWidth));
+        addEntry(257, tiff::Const::Type::LONG, single(mLength));
+        addEntry(258, tiff::Const::Type::SHORT,
+                 std::vector<sys::Uint32_T>(mNumBands, 16));
+        addEntry(259, tiff::Const::Type::SHORT, single(mCompression));
+        if (mPredictor != tiff::Const::PredictorType::NONE)
+            addEntry(317, tiff::Const::Type::SHORT, single(mPredictor));
+        addEntry(262, tiff::Const::Type::SHORT, single(mNumBands == 3 ? 2 : 1));
+        addEntry(277, tiff::Const::Type::SHORT, single(mNumBands));
+        const unsigned short countType = mShortCounts ?
+                tiff::Const::Type::SHORT : tiff::Const::Type::LONG;
+        if (mTiled)
+        {
+            addEntry(322, tiff::Const::Type::LONG, single(mChunkWidth));
+            addEntry(323, tiff::Const::Type::LONG, single(mChunkLength));
+            addEntry(324, tiff::Const::Type::LONG, offsets);
+            addEntry(325, countType, counts);
+        }
+        else
+        {
+            addEntry(273, tiff::Const::Type::LONG, offsets);
+            addEntry(278, tiff::Const::Type::LONG, single(mChunkLength));
+            addEntry(279, countType, counts);
+        }
+
+        // Header, then the image data, then the IFD and the values that
+        // don't fit in it
+        std::vector<sys::byte> file(8);
+        const bool bigEndian = sys::isBigEndianSystem() != mSwapped;
+        file[0] = file[1] = bigEndian ? 'M' : 'I';
+        put16(&file[2], 42);
+        const size_t ifdOffset = 8 + data.size();
+        put32(&file[4], static_cast<sys::Uint32_T>(ifdOffset));
+        file.insert(file.end(), data.begin(), data.end());
+
+        std::vector<sys::byte> ifd(2 + mEntries.size() * 12 + 4);
+        std::vector<sys::byte> extra;
+        put16(&ifd[0], static_cast<sys::Uint16_T>(mEntries.size()));
+        size_t pos = 2;
+        for (std::map<unsigned short, Entry>::const_iterator iter =
+                mEntries.begin(); iter != mEntries.end(); ++iter, pos += 12)
+        {
+            const Entry& entry = iter->second;
+            const size_t valueSize =
+                    entry.type == tiff::Const::Type::SHORT ? 2 : 4;
+            put16(&ifd[pos], iter->first);
+            put16(&ifd[pos + 2], entry.type);
+            put32(&ifd[pos + 4],
+                  static_cast<sys::Uint32_T>(entry.values.size()));
+
+            sys::byte* out = &ifd[pos + 8];
+            if (entry.values.size() * valueSize > 4)
+            {
+                put32(out, static_cast<sys::Uint32_T>(
+                        ifdOffset + ifd.size() + extra.size()));
+                extra.resize(extra.size() + entry.values.size() * valueSize);
+                out = &extra[extra.size() - entry.values.size() * valueSize];
+            }
+            for (size_t ii = 0; ii < entry.values.size(); ++ii)
+            {
+                if (valueSize == 2)
+                    put16(out + ii * 2,
+                          static_cast<sys::Uint16_T>(entry.values[ii]));
+                else
+                    put32(out + ii * 4, entry.values[ii]);
+            }
+        }
+        file.insert(file.end(), ifd.begin(), ifd.end());
+        file.insert(file.end(), extra.begin(), extra.end());
+
+        io::FileOutputStream out(TIFF_FILE);
+        out.write(&file[0], file.size());
+        out.close();
+    }
+
+private:
+    struct Entry
+    {
+        unsigned short type;
+        std::vector<sys::Uint32_T> values;
+    };
+
+    //! The bytes of a chunk as they are before compression
+    std::vector<unsigned char> predict(std::vector<sys::Uint16_T> chunk,
+                                       size_t rows) const
+    {
+        const size_t rowSamples = mChunkWidth * mNumBands;
+        std::vector<unsigned char> bytes(chunk.size() * 2);
+        for (size_t row = 0; row < rows; ++row)
+        {
+            sys::Uint16_T* samples = &chunk[row * rowSamples];
+            unsigned char* rowBytes = &bytes[row * rowSamples * 2];
+            if (mPredictor == tiff::Const::PredictorType::FLOATING_POINT)
+            {
+                // Most significant bytes first, whatever the byte order
+                for (size_t ii = 0; ii < rowSamples; ++ii)
+                {
+                    rowBytes[ii] =
+                            static_cast<unsigned char>(samples[ii] >> 8);
+                    rowBytes[rowSamples + ii] =
+                            static_cast<unsigned char>(samples[ii]);
+                }
+                for (size_t ii = rowSamples * 2 - 1; ii >= mNumBands; --ii)
+                    rowBytes[ii] = static_cast<unsigned char>(
+                            rowBytes[ii] - rowBytes[ii - mNumBands]);
+                continue;
+            }
+
+            if (mPredictor ==
+                tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING)
+            {
+                for (size_t ii = rowSamples - 1; ii >= mNumBands; --ii)
+                    samples[ii] = static_cast<sys::Uint16_T>(
+                            samples[ii] - samples[ii - mNumBands]);
+            }
+            for (size_t ii = 0; ii < rowSamples; ++ii)
+                put16(reinterpret_cast<sys::byte*>(rowBytes + ii * 2),
+                      samples[ii]);
+        }
+        return bytes;
+    }
+
+    static std::vector<sys::Uint32_T> single(size_t value)
+    {
+        return std::vector<sys::Uint32_T>(1,
+                                          static_cast<sys::Uint32_T>(value));
+    }
+
+    void addEntry(unsigned short tag, unsigned short type,
+                  const std::vector<sys::Uint32_T>& values)
+    {
+        mEntries[tag].type = type;
+        mEntries[tag].values = values;
+    }
+
+    void put16(sys::byte* out, sys::Uint16_T value) const
+    {
+        if (mSwapped)
+            value = sys::byteSwap(value);
+        memcpy(out, &value, sizeof(value));
+    }
+
+    void put32(sys::byte* out, sys::Uint32_T value) const
+    {
+        if (mSwapped)
+            value = sys::byteSwap(value);
+        memcpy(out, &value, sizeof(value));
+    }
+
+    const size_t mLength;
+    const size_t mWidth;
+    const size_t mNumBands;
+    bool mTiled;
+    size_t mChunkLength;
+    size_t mChunkWidth;
+    bool mSwapped;
+    bool mShortCounts;
+    unsigned short mCompression;
+    unsigned short mPredictor;
+    std::map<unsigned short, Entry> mEntries;
+};
+
+bool regionMatches(const std::vector<sys::Uint16_T>& region,
+                   size_t rowStart, size_t colStart, size_t numRows,
+                   size_t numCols, size_t numBands = 1)
+{
+    for (size_t row = 0; row < numRows; ++row)
+        for (size_t col = 0; col < numCols; ++col)
+            for (size_t b = 0; b < numBands; ++b)
+                if (region[(row * numCols + col) * numBands + b] !=
+                    pixel(rowStart + row, colStart + col, b))
+                    return false;
+    return true;
+}
+
+unsigned char* bytes(std::vector<sys::Uint16_T>& buffer)
+{
+    return reinterpret_cast<unsigned char*>(&buffer[0]);
+}
+
+TEST_CASE(testStrippedImage)
+{
+    // The last strip is short
+    const size_t length = 50;
+    const size_t width = 37;
+    const std::vector<sys::Uint16_T> image = makeImage(length, width);
+    TestTIFF tiff(length, width);
+    tiff.setStrips(8);
+    tiff.write(image);
+
+    tiff::FileReader reader(TIFF_FILE);
+    TEST_ASSERT(!reader[0]->isTiled());
+    TEST_ASSERT_EQ(reader[0]->getNumChunks(), 7);
+
+    std::vector<sys::Uint16_T> buffer(image.size());
+    reader[0]->getImage(bytes(buffer), 1);
+    TEST_ASSERT(buffer == image);
+
+    std::vector<sys::Uint16_T> threaded(image.size());
+    reader[0]->getImage(bytes(threaded), 4);
+    TEST_ASSERT(threaded == image);
+
+    // getData() reads the same pixels
+    std::vector<sys::Uint16_T> data(image.size());
+    reader.getData(bytes(data), static_cast<sys::Uint32_T>(image.size()));
+    TEST_ASSERT(data == image);
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testTiledImage)
+{
+    // Tiles hang over the right and bottom edges
+    const size_t length = 70;
+    const size_t width = 45;
+    const std::vector<sys::Uint16_T> image = makeImage(length, width);
+    TestTIFF tiff(length, width);
+    tiff.setTiles(16, 16);
+    tiff.write(image);
+
+    tiff::FileReader reader(TIFF_FILE);
+    TEST_ASSERT(reader[0]->isTiled());
+    TEST_ASSERT_EQ(reader[0]->getNumChunks(), 15);
+
+    std::vector<sys::Uint16_T> buffer(image.size());
+    reader[0]->getImage(bytes(buffer), 3);
+    TEST_ASSERT(buffer == image);
+
+    std::vector<sys::Uint16_T> data(image.size());
+    reader.getData(bytes(data), static_cast<sys::Uint32_T>(image.size()));
+    TEST_ASSERT(data == image);
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testTiledRegion)
+{
+    const size_t length = 70;
+    const size_t width = 45;
+    TestTIFF tiff(length, width);
+    tiff.setTiles(16, 16);
+    tiff.write(makeImage(length, width));
+
+    tiff::FileReader reader(TIFF_FILE);
+
+    // Across tiles, inside one tile, and against the bottom right corner
+    std::vector<sys::Uint16_T> region(30 * 20);
+    reader[0]->getRegion(bytes(region), 10, 5, 30, 20, 2);
+    TEST_ASSERT(regionMatches(region, 10, 5, 30, 20));
+
+    region.resize(4 * 5);
+    reader[0]->getRegion(bytes(region), 17, 18, 4, 5);
+    TEST_ASSERT(regionMatches(region, 17, 18, 4, 5));
+
+    region.resize(7 * 6);
+    reader[0]->getRegion(bytes(region), 63, 39, 7, 6);
+    TEST_ASSERT(regionMatches(region, 63, 39, 7, 6));
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testStrippedRegion)
+{
+    const size_t length = 50;
+    const size_t width = 37;
+    TestTIFF tiff(length, width);
+    tiff.setStrips(8);
+    tiff.setShortCounts();
+    tiff.write(makeImage(length, width));
+
+    tiff::FileReader reader(TIFF_FILE);
+
+    std::vector<sys::Uint16_T> region(20 * width);
+    reader[0]->getRegion(bytes(region), 30, 0, 20, width);
+    TEST_ASSERT(regionMatches(region, 30, 0, 20, width));
+
+    region.resize(11 * 9);
+    reader[0]->getRegion(bytes(region), 5, 20, 11, 9);
+    TEST_ASSERT(regionMatches(region, 5, 20, 11, 9));
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testSwappedImage)
+{
+    // Samples are swapped one at a time, not three to a pixel
+    const size_t length = 20;
+    const size_t width = 30;
+    const size_t numBands = 3;
+    const std::vector<sys::Uint16_T> image =
+            makeImage(length, width, numBands);
+    TestTIFF tiff(length, width, numBands);
+    tiff.setTiles(16, 16);
+    tiff.setSwapped();
+    tiff.write(image);
+
+    tiff::FileReader reader(TIFF_FILE);
+    std::vector<sys::Uint16_T> buffer(image.size());
+    reader[0]->getImage(bytes(buffer));
+    TEST_ASSERT(buffer == image);
+
+    std::vector<sys::Uint16_T> region(3 * 4 * numBands);
+    reader[0]->getRegion(bytes(region), 14, 13, 3, 4);
+    TEST_ASSERT(regionMatches(region, 14, 13, 3, 4, numBands));
+
+    std::vector<sys::Uint16_T> data(image.size());
+    reader.getData(bytes(data), static_cast<sys::Uint32_T>(length * width));
+    TEST_ASSERT(data == image);
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testStreamOnly)
+{
+    // Without a sys::File, threads take turns with the stream
+    const size_t length = 40;
+    const size_t width = 33;
+    const std::vector<sys::Uint16_T> image = makeImage(length, width);
+    TestTIFF tiff(length, width);
+    tiff.setTiles(16, 16);
+    tiff.write(image);
+
+    io::FileInputStream input(TIFF_FILE);
+    tiff::Header header;
+    header.deserialize(input);
+    input.seek(header.getIFDOffset(), io::Seekable::START);
+    tiff::ImageReader imageReader(&input);
+    imageReader.process(header.isDifferentByteOrdering());
+
+    std::vector<sys::Uint16_T> buffer(image.size());
+    imageReader.getImage(bytes(buffer), 4);
+    TEST_ASSERT(buffer == image);
+
+    input.close();
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testCompressedImages)
+{
+    const unsigned short compressions[] = {
+        tiff::Const::CompressionType::LZW,
+        tiff::Const::CompressionType::PACK_BITS,
+        tiff::Const::CompressionType::DEFLATE
+    };
+    const size_t length = 70;
+    const size_t width = 45;
+    const std::vector<sys::Uint16_T> image = makeImage(length, width);
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        if (!tiff::Decoder::isSupported(compressions[ii]))
+            continue;
+
+        for (size_t tiled = 0; tiled < 2; ++tiled)
+        {
+            TestTIFF tiff(length, width);
+            if (tiled)
+                tiff.setTiles(16, 32);
+            else
+                tiff.setStrips(8);
+            tiff.setCompression(compressions[ii]);
+            tiff.write(image);
+
+            tiff::FileReader reader(TIFF_FILE);
+            std::vector<sys::Uint16_T> buffer(image.size());
+            reader[0]->getImage(bytes(buffer), 3);
+            TEST_ASSERT(buffer == image);
+
+            std::vector<sys::Uint16_T> region(30 * 20);
+            reader[0]->getRegion(bytes(region), 10, 5, 30, 20, 2);
+            TEST_ASSERT(regionMatches(region, 10, 5, 30, 20));
+
+            // getData() decodes what it needs, a piece at a time
+            std::vector<sys::Uint16_T> data(image.size());
+            const sys::Uint32_T first = 1000;
+            reader.getData(bytes(data), first);
+            reader.getData(bytes(data) + first * sizeof(sys::Uint16_T),
+                           static_cast<sys::Uint32_T>(image.size() - first));
+            TEST_ASSERT(data == image);
+
+            // Reading one image row at a time reuses the decoded chunks
+            tiff::FileReader rowReader(TIFF_FILE);
+            std::vector<sys::Uint16_T> rows(image.size());
+            for (size_t row = 0; row < length; ++row)
+            {
+                rowReader.getData(bytes(rows) + row * width *
+                                          sizeof(sys::Uint16_T),
+                                  static_cast<sys::Uint32_T>(width));
+            }
+            TEST_ASSERT(rows == image);
+        }
+    }
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testLargeLZW)
+{
+    // Enough strings that the codes widen to 12 bits and the table clears
+    const size_t length = 300;
+    const size_t width = 500;
+    std::vector<sys::Uint16_T> image(length * width);
+    sys::Uint32_T seed = 1234;
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        seed = seed * 1103515245 + 12345;
+        image[ii] = static_cast<sys::Uint16_T>((seed >> 16) & 0x3ff);
+    }
+    TestTIFF tiff(length, width);
+    tiff.setStrips(100);
+    tiff.setCompression(tiff::Const::CompressionType::LZW);
+    tiff.write(image);
+
+    tiff::FileReader reader(TIFF_FILE);
+    std::vector<sys::Uint16_T> buffer(image.size());
+    reader[0]->getImage(bytes(buffer));
+    TEST_ASSERT(buffer == image);
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testHorizontalPredictor)
+{
+    // Differences are taken between samples in this machine's order, so
+    // the swapped file has to be swapped before they are undone
+    const size_t length = 20;
+    const size_t width = 30;
+    const size_t numBands = 3;
+    const std::vector<sys::Uint16_T> image =
+            makeImage(length, width, numBands);
+    for (size_t swapped = 0; swapped < 2; ++swapped)
+    {
+        TestTIFF tiff(length, width, numBands);
+        tiff.setTiles(16, 16);
+        tiff.setCompression(
+                tiff::Const::CompressionType::LZW,
+                tiff::Const::PredictorType::HORIZONTAL_DIFFERENCING);
+        if (swapped)
+            tiff.setSwapped();
+        tiff.write(image);
+
+        tiff::FileReader reader(TIFF_FILE);
+        std::vector<sys::Uint16_T> buffer(image.size());
+        reader[0]->getImage(bytes(buffer));
+        TEST_ASSERT(buffer == image);
+
+        std::vector<sys::Uint16_T> region(3 * 4 * numBands);
+        reader[0]->getRegion(bytes(region), 14, 13, 3, 4);
+        TEST_ASSERT(regionMatches(region, 14, 13, 3, 4, numBands));
+    }
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testFloatingPointPredictor)
+{
+    const size_t length = 25;
+    const size_t width = 19;
+    const std::vector<sys::Uint16_T> image = makeImage(length, width);
+    for (size_t swapped = 0; swapped < 2; ++swapped)
+    {
+        TestTIFF tiff(length, width);
+        tiff.setStrips(4);
+        tiff.setCompression(tiff::Const::CompressionType::LZW,
+                            tiff::Const::PredictorType::FLOATING_POINT);
+        if (swapped)
+            tiff.setSwapped();
+        tiff.write(image);
+
+        tiff::FileReader reader(TIFF_FILE);
+        std::vector<sys::Uint16_T> buffer(image.size());
+        reader[0]->getImage(bytes(buffer));
+        TEST_ASSERT(buffer == image);
+    }
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testUnsupportedCompression)
+{
+    const size_t length = 10;
+    const size_t width = 10;
+    TestTIFF tiff(length, width);
+    tiff.setCompression(tiff::Const::CompressionType::JPEG);
+    tiff.write(makeImage(length, width));
+
+    tiff::FileReader reader(TIFF_FILE);
+    std::vector<sys::Uint16_T> buffer(length * width);
+    TEST_EXCEPTION(reader[0]->getImage(bytes(buffer)));
+    TEST_EXCEPTION(reader.getData(bytes(buffer),
+                                  static_cast<sys::Uint32_T>(buffer.size())));
+
+    sys::OS().remove(TIFF_FILE);
+}
+
+TEST_CASE(testRegionOutsideImage)
+{
+    const size_t length = 10;
+    const size_t width = 10;
+    TestTIFF tiff(length, width);
+    tiff.setStrips(4);
+    tiff.write(makeImage(length, width));
+
+    tiff::FileReader reader(TIFF_FILE);
+    std::vector<sys::Uint16_T> region(100);
+    TEST_EXCEPTION(reader[0]->getRegion(bytes(region), 5, 0, 6, 1));
+    TEST_EXCEPTION(reader[0]->getRegion(bytes(region), 0, 9, 1, 2));
+
+    sys::OS().remove(TIFF_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testStrippedImage);
+    TEST_CHECK(testTiledImage);
+    TEST_CHECK(testTiledRegion);
+    TEST_CHECK(testStrippedRegion);
+    TEST_CHECK(testSwappedImage);
+    TEST_CHECK(testStreamOnly);
+    TEST_CHECK(testCompressedImages);
+    TEST_CHECK(testLargeLZW);
+    TEST_CHECK(testHorizontalPredictor);
+    TEST_CHECK(testFloatingPointPredictor);
+    TEST_CHECK(testUnsupportedCompression);
+    TEST_CHECK(testRegionOutsideImage);
+    return 0;
+}
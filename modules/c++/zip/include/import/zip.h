@@ -23,6 +23,8 @@
 #ifndef __IMPORT_ZIP_H__
 #define __IMPORT_ZIP_H__
 
+#include "zip/CRC32.h"
+#include "zip/GZipIndex.h"
 #include "zip/GZipInputStream.h"
 #include "zip/GZipOutputStream.h"
 #include "zip/ZipEntry.h"
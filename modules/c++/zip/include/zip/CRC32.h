@@ -0,0 +1,97 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __ZIP_CRC32_H__
+#define __ZIP_CRC32_H__
+
+#include <stddef.h>
+
+#include <sys/Conf.h>
+
+namespace zip
+{
+/*!
+ *  \class CRC32
+ *  \brief The CRC-32 used by zip and gzip (ISO 3309 / ITU-T V.42)
+ *
+ *  Values match zlib's crc32() and crc32_combine(), so the two can be
+ *  mixed.  The default kernel is chosen the first time it's needed: a
+ *  carry-less multiply (PCLMULQDQ) folding kernel on x86 processors that
+ *  have it, and slicing-by-8 tables everywhere else.
+ */
+class CRC32
+{
+public:
+    enum Kernel
+    {
+        //! The fastest kernel this processor supports
+        AUTO,
+
+        //! One table lookup per byte, for reference
+        BYTEWISE,
+
+        //! Eight table lookups per eight bytes
+        SLICING_BY_8,
+
+        //! Folds 64 bytes at a time with PCLMULQDQ
+        CLMUL
+    };
+
+    //! \return Whether this build and processor can run a kernel
+    static bool isSupported(Kernel kernel);
+
+    //! \return The kernel that AUTO resolves to
+    static Kernel getDefaultKernel();
+
+    /*!
+     *  Extend a CRC with more data.  Start from a CRC of 0.
+     *
+     *  \param crc The CRC of the data so far
+     *  \param data The bytes to add
+     *  \param len The number of bytes to add
+     *  \param kernel The kernel to use.  Unsupported kernels throw.
+     *  \return The CRC of the data so far followed by these bytes
+     */
+    static sys::Uint32_T update(sys::Uint32_T crc,
+                                const void* data,
+                                size_t len,
+                                Kernel kernel = AUTO);
+
+    /*!
+     *  Compute the CRC of two blocks laid end to end from their separate
+     *  CRCs, so blocks can be summed in parallel.  This costs O(log len2).
+     *
+     *  \param crc1 The CRC of the first block
+     *  \param crc2 The CRC of the second block
+     *  \param len2 The length of the second block in bytes
+     *  \return The CRC of the first block followed by the second
+     */
+    static sys::Uint32_T combine(sys::Uint32_T crc1,
+                                 sys::Uint32_T crc2,
+                                 sys::Uint64_T len2);
+
+private:
+    CRC32();
+};
+}
+
+#endif
@@ -0,0 +1,136 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __ZIP_GZIP_INDEX_H__
+#define __ZIP_GZIP_INDEX_H__
+
+#include <string>
+#include <vector>
+
+#include "zip/Types.h"
+
+namespace zip
+{
+/*!
+ *  \class GZipIndex
+ *  \brief Access points into a gzip file, for random access
+ *
+ *  Deflate data can only be decoded from the start, unless the decoder is
+ *  handed the 32 KiB of output preceding the point it starts from.  An
+ *  index records that window (and the bit position in the compressed
+ *  data) every 'span' uncompressed bytes, so GZipInputStream::seek() only
+ *  has to decompress from the nearest access point rather than from the
+ *  start of the file.  This is the technique of zlib's zran.c example.
+ *
+ *  Building an index costs one full decompression pass; it can then be
+ *  saved alongside the gzip file and loaded later.  A saved index records
+ *  the size and trailer of the file it was built from, so one that no
+ *  longer matches its file is rejected instead of seeking to the wrong
+ *  places.
+ */
+class GZipIndex
+{
+public:
+    enum
+    {
+        DEFAULT_SPAN = 1024 * 1024,
+        WINDOW_SIZE = 32768
+    };
+
+    //! Where decompression can resume
+    struct AccessPoint
+    {
+        //! Offset in the uncompressed data
+        sys::Uint64_T uncompressedOffset;
+
+        //! Offset of the first byte in the gzip file not yet consumed
+        sys::Uint64_T compressedOffset;
+
+        //! Number of bits of the previous byte that belong to this point
+        int bits;
+
+        //! The WINDOW_SIZE bytes of output preceding this point
+        std::vector<sys::byte> window;
+    };
+
+    GZipIndex();
+
+    /*!
+     *  Build an index by decompressing a gzip file
+     *
+     *  \param gzipPathname The gzip file to index
+     *  \param span Uncompressed bytes between access points.  Smaller
+     *         spans make seeks faster and the index bigger.
+     */
+    void build(const std::string& gzipPathname,
+               size_t span = DEFAULT_SPAN);
+
+    /*!
+     *  Read an index written by save()
+     *
+     *  \param indexPathname The index file
+     *  \param gzipPathname The gzip file the index was built from
+     *
+     *  \throws except::IOException if the index is corrupt, or the gzip
+     *           file's size or trailer (CRC-32 and size of its last member)
+     *           differs from when the index was built
+     */
+    void load(const std::string& indexPathname,
+              const std::string& gzipPathname);
+
+    /*!
+     *  Write the index to a file.  Windows are compressed.
+     *
+     *  \param indexPathname The index file
+     */
+    void save(const std::string& indexPathname) const;
+
+    //! \return The total uncompressed size of the indexed file
+    sys::Uint64_T getUncompressedSize() const
+    {
+        return mUncompressedSize;
+    }
+
+    size_t getNumAccessPoints() const
+    {
+        return mPoints.size();
+    }
+
+    /*!
+     *  \param uncompressedOffset An offset in the uncompressed data
+     *  \return The last access point at or before the offset, or NULL if
+     *          decompression must start from the beginning of the file
+     */
+    const AccessPoint* findAccessPoint(sys::Uint64_T uncompressedOffset) const;
+
+private:
+    size_t mSpan;
+    sys::Uint64_T mUncompressedSize;
+    //! Size of the indexed gzip file
+    sys::Uint64_T mCompressedSize;
+    //! The last 8 bytes of the indexed gzip file
+    sys::Uint64_T mTrailer;
+    std::vector<AccessPoint> mPoints;
+};
+}
+
+#endif
@@ -23,10 +23,15 @@
 #ifndef __ZIP_GZIP_INPUT_STREAM_H__
 #define __ZIP_GZIP_INPUT_STREAM_H__
 
+#include <memory>
+#include <string>
+
 #include "zip/Types.h"
 
 namespace zip
 {
+class GZipIndex;
+
 /*!
  *  \class GZipInputStream
  *  \brief Read from a gzip file
@@ -37,6 +42,10 @@ namespace zip
  *  the user should only call streamTo() if the optional buffer size
  *  argument is given, and in a loop.  On the last run, the buffer
  *  size should will probably smaller than the amount requested.
+ *
+ *  seek() works on any gzip file, but has to decompress everything
+ *  before the target offset (from the start, when seeking backwards).
+ *  Given a GZipIndex, it only decompresses from the nearest access point.
  */
 class GZipInputStream: public io::InputStream
 {
@@ -46,6 +55,27 @@ public:
     //!  Constructor requires initialization
     GZipInputStream(const std::string& file);
 
+    virtual ~GZipInputStream();
+
+    /*!
+     *  Use an index to speed up seek().  The index must outlive the
+     *  stream, or be replaced before it is destroyed.
+     *
+     *  \param index An index built from this file, or NULL for none
+     */
+    void setIndex(const GZipIndex* index);
+
+    /*!
+     *  Move to an offset in the uncompressed data
+     *
+     *  \param offset Offset from the start of the uncompressed data
+     *  \return The new offset
+     */
+    sys::Off_T seek(sys::Off_T offset);
+
+    //! \return The current offset in the uncompressed data
+    sys::Off_T tell();
+
     /*!
      *  Close the gzip stream.  You must call this
      *  afterward (it is not done automatically);
@@ -60,8 +90,15 @@ protected:
      */
     virtual sys::SSize_T readImpl(void* buffer, size_t len);
 
+private:
+    class IndexedReader;
+
+    const std::string mPathname;
+    const GZipIndex* mIndex;
+
+    // Takes over from mFile on the first indexed seek
+    std::unique_ptr<IndexedReader> mIndexedReader;
 };
 }
 
 #endif
-
@@ -23,6 +23,9 @@
 #ifndef __ZIP_GZIP_OUTPUT_STREAM_H__
 #define __ZIP_GZIP_OUTPUT_STREAM_H__
 
+#include <memory>
+#include <vector>
+
 #include "zip/Types.h"
 
 namespace zip
@@ -31,13 +34,37 @@ namespace zip
  *  \class GZipOutputStream
  *  \brief IO wrapper for zlib API
  *
+ *  With more than one thread, the input is split into fixed-size blocks
+ *  that are deflated concurrently (as pigz does).  Each block is primed
+ *  with the last 32 KiB of the block before it, so the ratio stays close
+ *  to that of a single stream, and the blocks are stitched together into
+ *  one ordinary gzip member that any gunzip can read.
  */
 class GZipOutputStream: public io::OutputStream
 {
     gzFile mFile;
 public:
-    //!  Constructor requires initialization
-    GZipOutputStream(const std::string& file);
+    enum
+    {
+        DEFAULT_BLOCK_SIZE = 128 * 1024
+    };
+
+    /*!
+     *  Constructor requires initialization
+     *
+     *  \param file The file to write
+     *  \param level Compression level: 0-9, or Z_DEFAULT_COMPRESSION
+     *  \param numThreads Number of threads to deflate with.  If 1,
+     *         everything goes through a single zlib stream on the calling
+     *         thread.
+     *  \param blockSize Bytes of input per block when using threads
+     */
+    GZipOutputStream(const std::string& file,
+                     int level = Z_DEFAULT_COMPRESSION,
+                     size_t numThreads = 1,
+                     size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    using io::OutputStream::write;
 
     /*!
      *  Write len (or less) bytes into the gzip stream.
@@ -53,6 +80,21 @@ public:
      *  afterward (it is not done automatically).
      */
     virtual void close();
+
+private:
+    //! Deflate the pending blocks and write them out, in order
+    void deflatePending(bool finish);
+
+    const int mLevel;
+    const size_t mNumThreads;
+    const size_t mBlockSize;
+
+    // Only used with more than one thread
+    std::unique_ptr<io::OutputStream> mOutput;
+    std::vector<std::vector<sys::byte> > mPending;
+    std::vector<sys::byte> mDictionary;
+    sys::Uint32_T mCrc;
+    sys::Uint64_T mTotalIn;
 };
 }
 
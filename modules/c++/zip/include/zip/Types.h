@@ -39,7 +39,12 @@ enum
     MAX_EOCD_SEARCH = MAX_COMMENT_LEN + EOCD_LEN,
     ENTRY_SIGNATURE = 0x02014b50,
     ENTRY_LEN = 46,
-    LFH_SIZE = 30
+    LFH_SIZE = 30,
+    ZIP64_EOCD_SIGNATURE = 0x06064b50,
+    ZIP64_EOCD_LEN = 56,
+    ZIP64_LOCATOR_SIGNATURE = 0x07064b50,
+    ZIP64_LOCATOR_LEN = 20,
+    ZIP64_EXTRA_ID = 0x0001
 };
 }
 
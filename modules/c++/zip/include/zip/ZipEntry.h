@@ -36,11 +36,13 @@ namespace zip
  */
 class ZipEntry
 {
+public:
     enum CompressionMethod
     {
         COMP_STORED = 0, COMP_DEFLATED = 8
     };
 
+private:
     sys::ubyte* mCompressedData;
     sys::Size_T mCompressedSize;
     sys::Size_T mUncompressedSize;
@@ -56,6 +58,10 @@ class ZipEntry
     sys::Uint32_T mCRC32;
     sys::Uint16_T mInternalAttrs;
     sys::Uint32_T mExternalAttrs;
+    bool mVerifyCRC;
+
+    //!  Throw if a CRC computed over the uncompressed data doesn't match
+    void checkCRC(sys::Uint32_T crc) const;
 
     static void inflate(sys::ubyte* out, sys::Size_T outLen, sys::ubyte* in,
             sys::Size_T inLen);
@@ -78,7 +84,8 @@ public:
                         compressionMethod),
                 mLastModifiedTime(lastModifiedTime), mLastModifiedDate(
                         lastModifiedDate), mCRC32(crc32), mInternalAttrs(
-                        internalAttrs), mExternalAttrs(externalAttrs)
+                        internalAttrs), mExternalAttrs(externalAttrs),
+                mVerifyCRC(false)
     {
     }
 
@@ -89,6 +96,37 @@ public:
     sys::ubyte* decompress();
     void decompress(sys::ubyte* out, sys::Size_T outLen);
 
+    /*!
+     *  Decompress the entry a chunk at a time, so that entries larger than
+     *  memory can be extracted
+     *
+     *  \param out The stream to write the uncompressed bytes to
+     *  \param chunkSize The number of uncompressed bytes per write
+     */
+    void decompress(io::OutputStream& out, sys::Size_T chunkSize = 1048576);
+
+    /*!
+     *  Check the entry's data against its CRC without keeping the
+     *  uncompressed bytes.  Stored entries are summed straight from the
+     *  archive.
+     *
+     *  \return false if the CRC doesn't match or the data can't be inflated
+     */
+    bool verify();
+
+    /*!
+     *  When set, every decompress() call sums what it produces and throws
+     *  an except::IOException if that doesn't match the entry's CRC
+     */
+    void setVerifyCRC(bool verify)
+    {
+        mVerifyCRC = verify;
+    }
+    bool getVerifyCRC() const
+    {
+        return mVerifyCRC;
+    }
+
     sys::Uint16_T getVersionMadeBy() const
     {
         return mVersionMadeBy;
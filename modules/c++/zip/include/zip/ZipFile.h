@@ -23,6 +23,9 @@
 #ifndef __ZIP_ZIP_FILE_H__
 #define __ZIP_ZIP_FILE_H__
 
+#include <memory>
+
+#include <io/MMapInputStream.h>
 #include "zip/ZipEntry.h"
 
 /*!
@@ -57,15 +60,19 @@ class ZipFile
     //!  Zip (apparently) is little-endian
     bool mSwapBytes;
 
-    //!  Compressed data buffer (yes we eat the whole file)
+    //!  Compressed data buffer.  This is either a heap copy of the whole
+    //!  stream or a read-only mapping of the file (see mMapping)
     sys::ubyte* mCompressed;
     sys::Size_T mCompressedLength;
 
+    //!  Set when the archive was opened by pathname
+    std::unique_ptr<io::MMapInputStream> mMapping;
+
     sys::Uint16_T mDiskNum;
     sys::Uint16_T mDiskWithCentralDir;
 
-    sys::Uint32_T mCentralDirSize;
-    sys::Uint32_T mCentralDirOffset;
+    sys::Uint64_T mCentralDirSize;
+    sys::Uint64_T mCentralDirOffset;
 
     std::string mComment;
 
@@ -75,6 +82,9 @@ class ZipFile
     //!  Read a short (little-endian)
     sys::Uint16_T readShort(sys::ubyte* buf);
 
+    //!  Read a Zip64 long (little-endian)
+    sys::Uint64_T readLong(sys::ubyte* buf);
+
     //!  Read the top-level zip directory
     void readCentralDir();
 
@@ -84,9 +94,16 @@ class ZipFile
     //!  Get information for the central dir
     void readCentralDirValues(sys::ubyte* buf, sys::SSize_T len);
 
+    //!  Replace the central dir values with those of the Zip64 EOCD
+    void readZip64CentralDirValues(sys::ubyte* eocd);
+
     //!  Copy to a string
     //void copyString(const sys::ubyte* buf, sys::SSize_T len);
 
+    //!  Noncopyable
+    ZipFile(const ZipFile&);
+    ZipFile& operator=(const ZipFile&);
+
 public:
 
     //!  Provide iterator access to the ZipEntry objects
@@ -108,6 +125,18 @@ public:
         readCentralDir();
     }
 
+    /*!
+     *  Open an archive on disk without reading it into memory.  The file
+     *  is mapped read-only, the end of central directory record is found
+     *  by looking only at the tail of the file, and only the central
+     *  directory and local headers are touched while opening.  Entry
+     *  payloads are paged in when ZipEntry::decompress() is called, so
+     *  the archive may be much larger than available memory.
+     *
+     *  \param pathname The zip file to open
+     */
+    explicit ZipFile(const std::string& pathname);
+
     /*!
      *  When the ZipFile object goes out of scope, that
      *  means its time to delete all of our entries.
@@ -131,11 +160,11 @@ public:
         return mEntries.end();
     }
 
-    sys::Uint32_T getCentralDirSize() const
+    sys::Uint64_T getCentralDirSize() const
     {
         return mCentralDirSize;
     }
-    sys::Uint32_T getCentralDirOffset() const
+    sys::Uint64_T getCentralDirOffset() const
     {
         return mCentralDirOffset;
     }
@@ -149,6 +178,43 @@ public:
         return mEntries.size();
     }
 
+    /*!
+     *  Decompress every entry concurrently.  Large entries are started
+     *  first so that one of them doesn't finish alone at the end.
+     *
+     *  \param buffers One buffer per entry, in iteration order, each
+     *         holding at least that entry's getUncompressedSize() bytes
+     *  \param numThreads The number of threads to use, or 0 for one per CPU
+     */
+    void decompress(const std::vector<sys::ubyte*>& buffers,
+                    size_t numThreads = 0) const;
+
+    /*!
+     *  Extract every entry below a directory, creating the directories
+     *  named in the archive.  Files are decompressed concurrently and
+     *  streamed to disk, so entries need not fit in memory.  Entries with
+     *  absolute paths or ".." components are rejected.
+     *
+     *  \param directory An existing directory to extract to
+     *  \param numThreads The number of threads to use, or 0 for one per CPU
+     */
+    void extract(const std::string& directory, size_t numThreads = 0) const;
+
+    /*!
+     *  Make every entry's decompress() check its CRC, throwing an
+     *  except::IOException on a mismatch
+     */
+    void setVerifyCRC(bool verify);
+
+    /*!
+     *  Check every entry against its CRC concurrently, without keeping
+     *  any uncompressed data
+     *
+     *  \param numThreads The number of threads to use, or 0 for one per CPU
+     *  \return The names of the entries that failed, in iteration order
+     */
+    std::vector<std::string> verify(size_t numThreads = 0) const;
+
 };
 
 /*!
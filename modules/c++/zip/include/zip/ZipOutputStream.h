@@ -24,6 +24,7 @@
 #define __ZIP_ZIP_OUTPUT_STREAM_H__
 
 #include <string>
+#include <vector>
 #include <zip.h>
 #include <sys/Conf.h>
 #include <io/OutputStream.h>
@@ -38,13 +39,79 @@ namespace zip
 class ZipOutputStream: public io::OutputStream
 {
 public:
+    /*
+     *  Compression settings for setCompression().  Deflate levels 1
+     *  through 9 may also be given directly.
+     */
+    enum Compression
+    {
+        //! Store entries as they are, for data that won't compress
+        STORED = 0,
+
+        //! Deflate at level 1
+        FAST = 1,
+
+        //! Deflate at zlib's default level
+        DEFAULT = Z_DEFAULT_COMPRESSION,
+
+        //! Deflate at level 9
+        BEST = 9,
+
+        //! Try FAST on the first AUTO_SAMPLE_SIZE bytes of each entry.
+        //! Store the entry if that doesn't save at least a tenth,
+        //! otherwise deflate it at DEFAULT.
+        AUTO = -2
+    };
+
+    enum
+    {
+        AUTO_SAMPLE_SIZE = 64 * 1024
+    };
+
+    //! What happened to one entry
+    struct EntryStatistics
+    {
+        EntryStatistics() :
+            method(Z_DEFLATED),
+            level(DEFAULT),
+            uncompressedSize(0),
+            compressedSize(0),
+            elapsedSeconds(0)
+        {
+        }
+
+        std::string pathname;
+
+        //! 0 when stored, Z_DEFLATED when deflated
+        int method;
+
+        //! The deflate level used, or STORED
+        int level;
+
+        sys::Uint64_T uncompressedSize;
+
+        //! Bytes of entry data in the archive.  Unknown (0) for
+        //! encrypted entries.
+        sys::Uint64_T compressedSize;
+
+        //! Time spent inside this class compressing and writing the entry
+        double elapsedSeconds;
+    };
+
     /*
      *  \func Constructor
      *  \brief Sets up the internal structure of the class.
      *
      *  \param pathname The path and filename of the zip.
+     *  \param zip64 Whether entries reserve room for Zip64 sizes in their
+     *         local headers, which entries of 4 GB or more need.  Turn it
+     *         off only for readers that predate Zip64.  Offsets and entry
+     *         counts past the 32-bit limits always get Zip64 records.
      */
-    ZipOutputStream(const std::string& pathname);
+    ZipOutputStream(const std::string& pathname, bool zip64 = true);
+
+    //! Releases the deflate state of an entry that was never closed
+    virtual ~ZipOutputStream();
 
     /*
      *  \func createFileInZip
@@ -58,6 +125,29 @@ public:
                          const std::string& comment = "",
                          const std::string& password = "");
 
+    /*
+     *  \func setCompression
+     *  \brief Sets how entries created from now on are compressed.
+     *
+     *  \compression A Compression value or a deflate level from 1 to 9.
+     *               The default is DEFAULT.
+     */
+    void setCompression(int compression);
+
+    int getCompression() const
+    {
+        return mCompression;
+    }
+
+    /*
+     *  \func getEntryStatistics
+     *  \brief Reports on every entry closed so far, in order.
+     */
+    const std::vector<EntryStatistics>& getEntryStatistics() const
+    {
+        return mStatistics;
+    }
+
     /*
      *  \func closeFileInZip
      *  \brief Closes a file that was opened by createFileInZip. This will
@@ -81,7 +171,43 @@ public:
     virtual void close();
 
 private:
+    //! Create the entry in minizip, now that its compression is known
+    void openFileInZip(int compression);
+
+    //! Decide how to compress an AUTO entry from its first bytes
+    int chooseCompression() const;
+
+    //! CRC and compress bytes of an open entry
+    void writeToEntry(const void* buffer, size_t len);
+
+    //! Deflate and hand the output to minizip
+    void deflateInZip(const void* buffer, size_t len, int flush);
+
+    //! Hand bytes to minizip as they are
+    void writeInZip(const void* buffer, size_t len);
+
     zipFile mZip;
+    const bool mZip64;
+
+    // Unencrypted entries are deflated here rather than in minizip, so
+    // the CRC of the uncompressed data can use zip::CRC32
+    bool mRaw;
+    z_stream mStream;
+    std::vector<sys::byte> mDeflated;
+    sys::Uint32_T mCRC;
+    sys::Uint64_T mUncompressedSize;
+    sys::Uint64_T mCompressedSize;
+
+    int mCompression;
+
+    // An AUTO entry isn't created in minizip until its sample is full
+    bool mDeferred;
+    std::string mComment;
+    std::string mPassword;
+    std::vector<sys::byte> mSample;
+
+    EntryStatistics mEntry;
+    std::vector<EntryStatistics> mStatistics;
 };
 }
 
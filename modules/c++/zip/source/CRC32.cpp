@@ -0,0 +1,360 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <except/Exception.h>
+#include "zip/CRC32.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+        (defined(__GNUC__) || defined(__clang__))
+#define ZIP_CRC32_CLMUL 1
+#define ZIP_CRC32_CLMUL_TARGET __attribute__((target("pclmul,sse4.1")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define ZIP_CRC32_CLMUL 1
+#define ZIP_CRC32_CLMUL_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+// The reflected CRC-32 polynomial
+const sys::Uint32_T POLY = 0xedb88320;
+
+struct SlicingTables
+{
+    SlicingTables()
+    {
+        for (sys::Uint32_T ii = 0; ii < 256; ++ii)
+        {
+            sys::Uint32_T crc = ii;
+            for (size_t bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ POLY : crc >> 1;
+            }
+            table[0][ii] = crc;
+        }
+
+        // table[k][b] is the CRC of b followed by k zero bytes
+        for (size_t kk = 1; kk < 8; ++kk)
+        {
+            for (size_t ii = 0; ii < 256; ++ii)
+            {
+                const sys::Uint32_T prev = table[kk - 1][ii];
+                table[kk][ii] = (prev >> 8) ^ table[0][prev & 0xff];
+            }
+        }
+    }
+
+    sys::Uint32_T table[8][256];
+};
+
+const SlicingTables& getTables()
+{
+    static const SlicingTables tables;
+    return tables;
+}
+
+// Like the other kernels, this works on the CRC register (the bitwise
+// complement of the public CRC value)
+sys::Uint32_T updateBytewise(sys::Uint32_T crc,
+                             const sys::ubyte* data,
+                             size_t len)
+{
+    const sys::Uint32_T* const table = getTables().table[0];
+    for (size_t ii = 0; ii < len; ++ii)
+    {
+        crc = (crc >> 8) ^ table[(crc ^ data[ii]) & 0xff];
+    }
+    return crc;
+}
+
+inline sys::Uint32_T readLittleEndian(const sys::ubyte* data)
+{
+    return static_cast<sys::Uint32_T>(data[0]) |
+            (static_cast<sys::Uint32_T>(data[1]) << 8) |
+            (static_cast<sys::Uint32_T>(data[2]) << 16) |
+            (static_cast<sys::Uint32_T>(data[3]) << 24);
+}
+
+sys::Uint32_T updateSlicingBy8(sys::Uint32_T crc,
+                               const sys::ubyte* data,
+                               size_t len)
+{
+    const SlicingTables& tables = getTables();
+    const sys::Uint32_T (&t)[8][256] = tables.table;
+    while (len >= 8)
+    {
+        const sys::Uint32_T one = crc ^ readLittleEndian(data);
+        const sys::Uint32_T two = readLittleEndian(data + 4);
+        crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff] ^
+                t[5][(one >> 16) & 0xff] ^ t[4][one >> 24] ^
+                t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff] ^
+                t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+        data += 8;
+        len -= 8;
+    }
+    return updateBytewise(crc, data, len);
+}
+
+#ifdef ZIP_CRC32_CLMUL
+bool hasCLMul()
+{
+    // CPUID leaf 1, ECX: bit 1 is PCLMULQDQ, bit 19 is SSE4.1
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return false;
+    }
+#endif
+    return (ecx & (1 << 1)) && (ecx & (1 << 19));
+}
+
+/*
+ *  Folds 64 bytes per iteration with carry-less multiplies, then reduces
+ *  with Barrett's method.  The constants are powers of x modulo the
+ *  polynomial, bit-reflected, from Intel's "Fast CRC Computation for
+ *  Generic Polynomials Using PCLMULQDQ Instruction".
+ *  len must be a multiple of 16 and at least 64.
+ */
+ZIP_CRC32_CLMUL_TARGET
+sys::Uint32_T foldCLMul(sys::Uint32_T crc, const sys::ubyte* data, size_t len)
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+    const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124LL);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    data += 64;
+    len -= 64;
+
+    // Four independent lanes keep the multipliers busy
+    while (len >= 64)
+    {
+        const __m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        const __m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        const __m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        const __m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data + 16)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data + 32)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data + 48)));
+        data += 64;
+        len -= 64;
+    }
+
+    // Fold the four lanes into one, then any remaining 16-byte blocks
+    __m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+    while (len >= 16)
+    {
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data))), x5);
+        data += 16;
+        len -= 16;
+    }
+
+    // 128 bits to 64
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<sys::Uint32_T>(_mm_extract_epi32(x1, 1));
+}
+
+sys::Uint32_T updateCLMul(sys::Uint32_T crc, const sys::ubyte* data,
+                          size_t len)
+{
+    if (len >= 64)
+    {
+        const size_t foldLen = len & ~static_cast<size_t>(15);
+        crc = foldCLMul(crc, data, foldLen);
+        data += foldLen;
+        len -= foldLen;
+    }
+    return updateSlicingBy8(crc, data, len);
+}
+#endif
+
+zip::CRC32::Kernel findDefaultKernel()
+{
+    return zip::CRC32::isSupported(zip::CRC32::CLMUL) ?
+            zip::CRC32::CLMUL : zip::CRC32::SLICING_BY_8;
+}
+
+// (a * b) mod POLY, for reflected polynomials
+sys::Uint32_T multiplyModPoly(sys::Uint32_T a, sys::Uint32_T b)
+{
+    sys::Uint32_T product = 0;
+    for (sys::Uint32_T mask = 0x80000000; mask != 0; mask >>= 1)
+    {
+        if (a & mask)
+        {
+            product ^= b;
+        }
+        b = (b & 1) ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return product;
+}
+
+// powers[n] is x^(2^n) mod POLY.  x^(2^32) is x again for this
+// polynomial, so 32 of them cover every length.
+struct PowersOfX
+{
+    PowersOfX()
+    {
+        sys::Uint32_T power = 0x40000000;
+        for (size_t ii = 0; ii < 32; ++ii)
+        {
+            powers[ii] = power;
+            power = multiplyModPoly(power, power);
+        }
+    }
+
+    sys::Uint32_T powers[32];
+};
+
+// x^(8 * numBytes) mod POLY
+sys::Uint32_T shiftByBytes(sys::Uint64_T numBytes)
+{
+    static const PowersOfX x;
+    sys::Uint32_T result = 0x80000000;
+    for (size_t bit = 3; numBytes != 0; numBytes >>= 1, ++bit)
+    {
+        if (numBytes & 1)
+        {
+            result = multiplyModPoly(x.powers[bit & 31], result);
+        }
+    }
+    return result;
+}
+}
+
+namespace zip
+{
+bool CRC32::isSupported(Kernel kernel)
+{
+    switch (kernel)
+    {
+    case AUTO:
+    case BYTEWISE:
+    case SLICING_BY_8:
+        return true;
+    case CLMUL:
+#ifdef ZIP_CRC32_CLMUL
+    {
+        static const bool supported = hasCLMul();
+        return supported;
+    }
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+CRC32::Kernel CRC32::getDefaultKernel()
+{
+    static const Kernel kernel = findDefaultKernel();
+    return kernel;
+}
+
+sys::Uint32_T CRC32::update(sys::Uint32_T crc,
+                            const void* data,
+                            size_t len,
+                            Kernel kernel)
+{
+    if (kernel == AUTO)
+    {
+        kernel = getDefaultKernel();
+    }
+    else if (!isSupported(kernel))
+    {
+        throw except::NotImplementedException(Ctxt(
+                "CRC-32 kernel is not supported on this processor"));
+    }
+
+    const sys::ubyte* const bytes = static_cast<const sys::ubyte*>(data);
+    crc = ~crc;
+    switch (kernel)
+    {
+    case BYTEWISE:
+        crc = updateBytewise(crc, bytes, len);
+        break;
+#ifdef ZIP_CRC32_CLMUL
+    case CLMUL:
+        crc = updateCLMul(crc, bytes, len);
+        break;
+#endif
+    default:
+        crc = updateSlicingBy8(crc, bytes, len);
+        break;
+    }
+    return ~crc;
+}
+
+sys::Uint32_T CRC32::combine(sys::Uint32_T crc1,
+                             sys::Uint32_T crc2,
+                             sys::Uint64_T len2)
+{
+    return multiplyModPoly(shiftByBytes(len2), crc1) ^ crc2;
+}
+}
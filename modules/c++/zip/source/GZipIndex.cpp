@@ -0,0 +1,348 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include "zip/GZipIndex.h"
+
+using namespace zip;
+
+namespace
+{
+const size_t INPUT_CHUNK_SIZE = 65536;
+
+const char INDEX_MAGIC[8] = { 'G', 'Z', 'I', 'D', 'X', 0, 0, 2 };
+
+// The fixed part of each access point in an index file: its offsets, bits
+// and the size of its compressed window
+const size_t POINT_HEADER_SIZE = 4 * 8;
+
+void writeUint64(io::OutputStream& output, sys::Uint64_T value)
+{
+    sys::ubyte bytes[8];
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        bytes[ii] = static_cast<sys::ubyte>((value >> (8 * ii)) & 0xff);
+    }
+    output.write(bytes, sizeof(bytes));
+}
+
+sys::Uint64_T decodeUint64(const sys::ubyte* bytes)
+{
+    sys::Uint64_T value = 0;
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        value |= static_cast<sys::Uint64_T>(bytes[ii]) << (8 * ii);
+    }
+    return value;
+}
+
+sys::Uint64_T readUint64(io::InputStream& input)
+{
+    sys::ubyte bytes[8];
+    input.read(bytes, sizeof(bytes), true);
+    return decodeUint64(bytes);
+}
+
+// The gzip trailer of the last member: its CRC-32 and uncompressed size
+sys::Uint64_T readTrailer(sys::File& file, const std::string& pathname)
+{
+    const sys::Off_T length = file.length();
+    if (length < 8)
+    {
+        throw except::IOException(Ctxt(
+                "Too short to be a gzip file: " + pathname));
+    }
+    sys::ubyte bytes[8];
+    file.readAt(bytes, sizeof(bytes), length - 8);
+    return decodeUint64(bytes);
+}
+
+void throwZlibError(const std::string& what, int rv)
+{
+    std::ostringstream ostr;
+    ostr << what << ": zlib error " << rv;
+    throw except::IOException(Ctxt(ostr.str()));
+}
+
+struct UncompressedOffsetLess
+{
+    bool operator()(sys::Uint64_T offset,
+                    const GZipIndex::AccessPoint& point) const
+    {
+        return offset < point.uncompressedOffset;
+    }
+};
+}
+
+GZipIndex::GZipIndex() :
+    mSpan(DEFAULT_SPAN),
+    mUncompressedSize(0),
+    mCompressedSize(0),
+    mTrailer(0)
+{
+}
+
+void GZipIndex::build(const std::string& gzipPathname, size_t span)
+{
+    sys::File file(gzipPathname, sys::File::READ_ONLY, sys::File::EXISTING);
+    const sys::Uint64_T trailer = readTrailer(file, gzipPathname);
+    sys::Off_T remaining = file.length();
+    const sys::Uint64_T compressedSize = remaining;
+
+    std::vector<sys::byte> input(INPUT_CHUNK_SIZE);
+    std::vector<sys::byte> window(WINDOW_SIZE);
+    std::vector<AccessPoint> points;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    // 47 = automatic zlib/gzip header detection with a 32 KiB window
+    int rv = inflateInit2(&stream, 47);
+    if (rv != Z_OK)
+    {
+        throwZlibError("Failed to initialize inflate", rv);
+    }
+
+    sys::Uint64_T totalIn = 0;
+    sys::Uint64_T totalOut = 0;
+    sys::Uint64_T last = 0;
+    try
+    {
+        while (true)
+        {
+            if (stream.avail_in == 0)
+            {
+                const size_t numBytes = static_cast<size_t>(
+                        std::min<sys::Off_T>(remaining, input.size()));
+                if (numBytes == 0)
+                {
+                    if (rv == Z_STREAM_END)
+                    {
+                        break;
+                    }
+                    throw except::IOException(Ctxt(
+                            "Unexpected end of gzip file " + gzipPathname));
+                }
+                file.readInto(&input[0], numBytes);
+                remaining -= numBytes;
+                stream.next_in = reinterpret_cast<Bytef*>(&input[0]);
+                stream.avail_in = static_cast<uInt>(numBytes);
+            }
+
+            // The window is a ring buffer holding the last 32 KiB of output
+            if (stream.avail_out == 0)
+            {
+                stream.next_out = reinterpret_cast<Bytef*>(&window[0]);
+                stream.avail_out = WINDOW_SIZE;
+            }
+
+            // Z_BLOCK returns at each deflate block boundary
+            totalIn += stream.avail_in;
+            totalOut += stream.avail_out;
+            rv = inflate(&stream, Z_BLOCK);
+            totalIn -= stream.avail_in;
+            totalOut -= stream.avail_out;
+
+            if (rv == Z_STREAM_END)
+            {
+                // Another gzip member may follow
+                if (stream.avail_in > 0 || remaining > 0)
+                {
+                    inflateReset(&stream);
+                    rv = Z_OK;
+                }
+                continue;
+            }
+            if (rv != Z_OK && rv != Z_BUF_ERROR)
+            {
+                throwZlibError("Failed to decompress " + gzipPathname, rv);
+            }
+
+            // At the end of a block that isn't the last one, or just
+            // after the header
+            if ((stream.data_type & 128) && !(stream.data_type & 64) &&
+                (totalOut == 0 || totalOut - last >= span))
+            {
+                points.push_back(AccessPoint());
+                AccessPoint& point = points.back();
+                point.uncompressedOffset = totalOut;
+                point.compressedOffset = totalIn;
+                point.bits = stream.data_type & 7;
+
+                // Unroll the ring buffer, oldest byte first
+                const size_t left = stream.avail_out;
+                point.window.resize(WINDOW_SIZE);
+                std::copy(window.end() - left, window.end(),
+                          point.window.begin());
+                std::copy(window.begin(), window.end() - left,
+                          point.window.begin() + left);
+                last = totalOut;
+            }
+        }
+    }
+    catch (...)
+    {
+        inflateEnd(&stream);
+        throw;
+    }
+    inflateEnd(&stream);
+
+    mSpan = span;
+    mUncompressedSize = totalOut;
+    mCompressedSize = compressedSize;
+    mTrailer = trailer;
+    mPoints.swap(points);
+}
+
+void GZipIndex::load(const std::string& indexPathname,
+                     const std::string& gzipPathname)
+{
+    io::FileInputStream input(indexPathname);
+
+    char magic[sizeof(INDEX_MAGIC)];
+    input.read(magic, sizeof(magic), true);
+    if (memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0)
+    {
+        throw except::IOException(Ctxt(
+                "Not a gzip index file: " + indexPathname));
+    }
+
+    const size_t span = static_cast<size_t>(readUint64(input));
+    const sys::Uint64_T uncompressedSize = readUint64(input);
+    const sys::Uint64_T compressedSize = readUint64(input);
+    const sys::Uint64_T trailer = readUint64(input);
+    const sys::Uint64_T numPoints = readUint64(input);
+
+    // Offsets into a file that has changed would decode garbage
+    sys::File gzipFile(gzipPathname, sys::File::READ_ONLY,
+                       sys::File::EXISTING);
+    if (static_cast<sys::Uint64_T>(gzipFile.length()) != compressedSize ||
+        readTrailer(gzipFile, gzipPathname) != trailer)
+    {
+        throw except::IOException(Ctxt(
+                indexPathname + " is not an index of " + gzipPathname));
+    }
+
+    // Check the count against what's left of the file before allocating
+    // for it
+    const sys::Uint64_T remaining =
+            static_cast<sys::Uint64_T>(input.available());
+    if (numPoints > remaining / POINT_HEADER_SIZE)
+    {
+        throw except::IOException(Ctxt(
+                "Corrupt gzip index file " + indexPathname));
+    }
+
+    std::vector<AccessPoint> points(static_cast<size_t>(numPoints));
+    std::vector<sys::byte> compressed;
+    const sys::Uint64_T maxCompressedSize = compressBound(WINDOW_SIZE);
+    for (size_t ii = 0; ii < points.size(); ++ii)
+    {
+        AccessPoint& point = points[ii];
+        point.uncompressedOffset = readUint64(input);
+        point.compressedOffset = readUint64(input);
+        point.bits = static_cast<int>(readUint64(input));
+
+        const sys::Uint64_T compressedWindowSize = readUint64(input);
+        if (compressedWindowSize > maxCompressedSize ||
+            point.compressedOffset > compressedSize ||
+            point.uncompressedOffset > uncompressedSize)
+        {
+            throw except::IOException(Ctxt(
+                    "Corrupt gzip index file " + indexPathname));
+        }
+        compressed.resize(static_cast<size_t>(compressedWindowSize));
+        if (!compressed.empty())
+        {
+            input.read(&compressed[0], compressed.size(), true);
+        }
+
+        point.window.resize(WINDOW_SIZE);
+        uLongf windowSize = WINDOW_SIZE;
+        const int rv = uncompress(
+                reinterpret_cast<Bytef*>(&point.window[0]), &windowSize,
+                reinterpret_cast<const Bytef*>(compressed.data()),
+                static_cast<uLong>(compressed.size()));
+        if (rv != Z_OK || windowSize != WINDOW_SIZE)
+        {
+            throwZlibError("Corrupt gzip index file " + indexPathname, rv);
+        }
+    }
+    input.close();
+
+    mSpan = span;
+    mUncompressedSize = uncompressedSize;
+    mCompressedSize = compressedSize;
+    mTrailer = trailer;
+    mPoints.swap(points);
+}
+
+void GZipIndex::save(const std::string& indexPathname) const
+{
+    io::FileOutputStream output(indexPathname);
+    output.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    writeUint64(output, mSpan);
+    writeUint64(output, mUncompressedSize);
+    writeUint64(output, mCompressedSize);
+    writeUint64(output, mTrailer);
+    writeUint64(output, mPoints.size());
+
+    std::vector<sys::byte> compressed(compressBound(WINDOW_SIZE));
+    for (size_t ii = 0; ii < mPoints.size(); ++ii)
+    {
+        const AccessPoint& point = mPoints[ii];
+        writeUint64(output, point.uncompressedOffset);
+        writeUint64(output, point.compressedOffset);
+        writeUint64(output, static_cast<sys::Uint64_T>(point.bits));
+
+        uLongf compressedSize = static_cast<uLongf>(compressed.size());
+        const int rv = compress(
+                reinterpret_cast<Bytef*>(&compressed[0]), &compressedSize,
+                reinterpret_cast<const Bytef*>(&point.window[0]),
+                WINDOW_SIZE);
+        if (rv != Z_OK)
+        {
+            throwZlibError("Failed to compress gzip index window", rv);
+        }
+        writeUint64(output, compressedSize);
+        output.write(&compressed[0], compressedSize);
+    }
+    output.close();
+}
+
+const GZipIndex::AccessPoint*
+GZipIndex::findAccessPoint(sys::Uint64_T uncompressedOffset) const
+{
+    std::vector<AccessPoint>::const_iterator iter =
+            std::upper_bound(mPoints.begin(), mPoints.end(),
+                             uncompressedOffset, UncompressedOffsetLess());
+    if (iter == mPoints.begin())
+    {
+        return NULL;
+    }
+    return &*(iter - 1);
+}
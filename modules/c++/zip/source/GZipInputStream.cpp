@@ -20,11 +20,251 @@
  *
  */
 
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+
+#include "zip/GZipIndex.h"
 #include "zip/GZipInputStream.h"
 
 using namespace zip;
 
-GZipInputStream::GZipInputStream(const std::string& file)
+/*!
+ *  Decompresses straight from the file with inflate(), so that it can
+ *  resume from an access point in the middle of a deflate stream
+ */
+class GZipInputStream::IndexedReader
+{
+public:
+    explicit IndexedReader(const std::string& pathname) :
+        mFile(pathname, sys::File::READ_ONLY, sys::File::EXISTING),
+        mFileSize(mFile.length()),
+        mFileOffset(0),
+        mInput(INPUT_CHUNK_SIZE),
+        mInitialized(false),
+        mRaw(false),
+        mMemberDone(false),
+        mTrailerLeft(0),
+        mEOF(false),
+        mPosition(0)
+    {
+        memset(&mStream, 0, sizeof(mStream));
+    }
+
+    ~IndexedReader()
+    {
+        if (mInitialized)
+        {
+            inflateEnd(&mStream);
+        }
+    }
+
+    sys::Uint64_T tell() const
+    {
+        return mPosition;
+    }
+
+    void seek(const GZipIndex& index, sys::Uint64_T offset)
+    {
+        if (offset > index.getUncompressedSize())
+        {
+            std::ostringstream ostr;
+            ostr << "Cannot seek to " << offset << " in "
+                 << index.getUncompressedSize() << " bytes of data";
+            throw except::IOException(Ctxt(ostr.str()));
+        }
+
+        // Carry on from here if that's no further back than the access
+        // point is
+        const GZipIndex::AccessPoint* const point =
+                index.findAccessPoint(offset);
+        const sys::Uint64_T pointOffset =
+                point ? point->uncompressedOffset : 0;
+        if (!mInitialized || offset < mPosition || pointOffset > mPosition)
+        {
+            resume(point);
+        }
+
+        std::vector<sys::byte> scratch(static_cast<size_t>(
+                std::min<sys::Uint64_T>(offset - mPosition,
+                                        INPUT_CHUNK_SIZE)));
+        while (mPosition < offset)
+        {
+            const size_t numBytes = static_cast<size_t>(
+                    std::min<sys::Uint64_T>(offset - mPosition,
+                                            scratch.size()));
+            if (read(&scratch[0], numBytes) == io::InputStream::IS_EOF)
+            {
+                throw except::IOException(Ctxt(
+                        "Unexpected end of gzip data while seeking"));
+            }
+        }
+    }
+
+    sys::SSize_T read(void* buffer, size_t len)
+    {
+        if (len == 0)
+        {
+            return 0;
+        }
+
+        mStream.next_out = static_cast<Bytef*>(buffer);
+        mStream.avail_out = static_cast<uInt>(len);
+        while (mStream.avail_out > 0 && !mEOF)
+        {
+            if (mMemberDone)
+            {
+                // A raw deflate stream leaves the gzip trailer unread
+                while (mTrailerLeft > 0)
+                {
+                    if (mStream.avail_in == 0 && !fill())
+                    {
+                        throw except::IOException(Ctxt(
+                                "Unexpected end of gzip file"));
+                    }
+                    const size_t numBytes = std::min<size_t>(
+                            mStream.avail_in, mTrailerLeft);
+                    mStream.next_in += numBytes;
+                    mStream.avail_in -= static_cast<uInt>(numBytes);
+                    mTrailerLeft -= numBytes;
+                }
+
+                if (mStream.avail_in == 0 && !fill())
+                {
+                    mEOF = true;
+                    break;
+                }
+
+                // Another gzip member follows
+                inflateReset2(&mStream, 31);
+                mRaw = false;
+                mMemberDone = false;
+            }
+
+            if (mStream.avail_in == 0 && !fill())
+            {
+                throw except::IOException(Ctxt("Unexpected end of gzip file"));
+            }
+
+            const int rv = inflate(&mStream, Z_NO_FLUSH);
+            if (rv == Z_STREAM_END)
+            {
+                mMemberDone = true;
+                mTrailerLeft = mRaw ? 8 : 0;
+            }
+            else if (rv != Z_OK && rv != Z_BUF_ERROR)
+            {
+                std::ostringstream ostr;
+                ostr << "Failed to decompress gzip data: zlib error " << rv;
+                throw except::IOException(Ctxt(ostr.str()));
+            }
+        }
+
+        const size_t numBytes = len - mStream.avail_out;
+        mPosition += numBytes;
+        return (numBytes == 0) ?
+                static_cast<sys::SSize_T>(io::InputStream::IS_EOF) :
+                static_cast<sys::SSize_T>(numBytes);
+    }
+
+private:
+    enum
+    {
+        INPUT_CHUNK_SIZE = 65536
+    };
+
+    bool fill()
+    {
+        const size_t numBytes = static_cast<size_t>(
+                std::min<sys::Off_T>(mFileSize - mFileOffset, mInput.size()));
+        if (numBytes == 0)
+        {
+            return false;
+        }
+        mFile.readInto(&mInput[0], numBytes);
+        mFileOffset += numBytes;
+        mStream.next_in = reinterpret_cast<Bytef*>(&mInput[0]);
+        mStream.avail_in = static_cast<uInt>(numBytes);
+        return true;
+    }
+
+    void seekInput(sys::Off_T offset)
+    {
+        mFile.seekTo(offset, sys::File::FROM_START);
+        mFileOffset = offset;
+        mStream.next_in = Z_NULL;
+        mStream.avail_in = 0;
+    }
+
+    void resume(const GZipIndex::AccessPoint* point)
+    {
+        if (mInitialized)
+        {
+            inflateEnd(&mStream);
+            mInitialized = false;
+        }
+        memset(&mStream, 0, sizeof(mStream));
+
+        // From the start, the gzip header has to be parsed; from an access
+        // point, we're in the middle of raw deflate data
+        int rv = inflateInit2(&mStream, point ? -MAX_WBITS : 47);
+        if (rv != Z_OK)
+        {
+            throw except::IOException(Ctxt("Failed to initialize inflate"));
+        }
+        mInitialized = true;
+        mRaw = (point != NULL);
+        mMemberDone = false;
+        mTrailerLeft = 0;
+        mEOF = false;
+
+        if (!point)
+        {
+            seekInput(0);
+            mPosition = 0;
+            return;
+        }
+
+        seekInput(static_cast<sys::Off_T>(point->compressedOffset) -
+                  (point->bits ? 1 : 0));
+        if (point->bits)
+        {
+            if (!fill())
+            {
+                throw except::IOException(Ctxt("Gzip index is out of date"));
+            }
+            const int partial = *mStream.next_in;
+            ++mStream.next_in;
+            --mStream.avail_in;
+            inflatePrime(&mStream, point->bits, partial >> (8 - point->bits));
+        }
+
+        rv = inflateSetDictionary(
+                &mStream, reinterpret_cast<const Bytef*>(&point->window[0]),
+                GZipIndex::WINDOW_SIZE);
+        if (rv != Z_OK)
+        {
+            throw except::IOException(Ctxt("Failed to apply gzip index"));
+        }
+        mPosition = point->uncompressedOffset;
+    }
+
+    sys::File mFile;
+    const sys::Off_T mFileSize;
+    sys::Off_T mFileOffset;
+    std::vector<sys::byte> mInput;
+    z_stream mStream;
+    bool mInitialized;
+    bool mRaw;
+    bool mMemberDone;
+    size_t mTrailerLeft;
+    bool mEOF;
+    sys::Uint64_T mPosition;
+};
+
+GZipInputStream::GZipInputStream(const std::string& file) :
+    mPathname(file),
+    mIndex(NULL)
 {
     mFile = gzopen(file.c_str(), "rb");
     if (mFile == NULL)
@@ -34,14 +274,65 @@ GZipInputStream::GZipInputStream(const std::string& file)
     }
 }
 
+GZipInputStream::~GZipInputStream()
+{
+}
+
+void GZipInputStream::setIndex(const GZipIndex* index)
+{
+    mIndex = index;
+}
+
+sys::Off_T GZipInputStream::seek(sys::Off_T offset)
+{
+    if (mIndex)
+    {
+        if (!mIndexedReader.get())
+        {
+            mIndexedReader.reset(new IndexedReader(mPathname));
+        }
+        mIndexedReader->seek(*mIndex, static_cast<sys::Uint64_T>(offset));
+        return tell();
+    }
+
+    if (mIndexedReader.get())
+    {
+        throw except::IOException(Ctxt(
+                "Cannot seek without the index once it has been used"));
+    }
+
+    const z_off_t rv = gzseek(mFile, static_cast<z_off_t>(offset), SEEK_SET);
+    if (rv == -1)
+    {
+        int err;
+        throw except::IOException(Ctxt(gzerror(mFile, &err)));
+    }
+    return rv;
+}
+
+sys::Off_T GZipInputStream::tell()
+{
+    if (mIndexedReader.get())
+    {
+        return static_cast<sys::Off_T>(mIndexedReader->tell());
+    }
+    return gztell(mFile);
+}
+
 void GZipInputStream::close()
 {
+    mIndexedReader.reset();
     gzclose( mFile);
     mFile = NULL;
 }
 
 sys::SSize_T GZipInputStream::readImpl(void* buffer, size_t len)
 {
+    if (mIndexedReader.get())
+    {
+        return mIndexedReader->read(buffer, len);
+    }
+
     int rv = gzread(mFile, buffer, len);
     if (rv == -1)
     {
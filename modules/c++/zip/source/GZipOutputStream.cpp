@@ -20,13 +20,168 @@
  *
  */
 
+#include <algorithm>
+#include <sstream>
+
+#include <io/FileOutputStream.h>
+#include <mt/BalancedRunnable1D.h>
+#include "zip/CRC32.h"
 #include "zip/GZipOutputStream.h"
 
 using namespace zip;
 
-GZipOutputStream::GZipOutputStream(const std::string& file)
+namespace
+{
+// Deflate can look this far back, so this much of the previous block
+// primes the next one
+const size_t DICTIONARY_SIZE = 32 * 1024;
+
+// Blocks deflated per thread before the results are written out
+const size_t BLOCKS_PER_THREAD = 4;
+
+struct DeflatedBlock
+{
+    std::vector<sys::byte> data;
+    sys::Uint32_T crc;
+};
+
+class DeflateOp
+{
+public:
+    DeflateOp(const std::vector<std::vector<sys::byte> >& blocks,
+              const std::vector<sys::byte>& dictionary,
+              int level,
+              bool finish,
+              std::vector<DeflatedBlock>& results) :
+        mBlocks(blocks),
+        mDictionary(dictionary),
+        mLevel(level),
+        mFinish(finish),
+        mResults(results)
+    {
+    }
+
+    void operator()(size_t index) const
+    {
+        const std::vector<sys::byte>& input = mBlocks[index];
+        DeflatedBlock& result = mResults[index];
+
+        result.crc = input.empty() ? 0 :
+                CRC32::update(0, &input[0], input.size());
+
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+
+        // Raw deflate; the gzip header and trailer are written separately
+        if (deflateInit2(&stream, mLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw except::IOException(Ctxt("Failed to initialize deflate"));
+        }
+
+        const std::vector<sys::byte>& previous =
+                (index == 0) ? mDictionary : mBlocks[index - 1];
+        if (!previous.empty())
+        {
+            const size_t dictSize = std::min(previous.size(), DICTIONARY_SIZE);
+            deflateSetDictionary(
+                    &stream,
+                    reinterpret_cast<const Bytef*>(
+                            &previous[previous.size() - dictSize]),
+                    static_cast<uInt>(dictSize));
+        }
+
+        // Every block but the last ends in a sync flush, which leaves the
+        // output byte-aligned and without the final-block bit, so the
+        // blocks concatenate into a single deflate stream
+        const bool last = mFinish && index == mBlocks.size() - 1;
+        result.data.resize(deflateBound(&stream,
+                                        static_cast<uLong>(input.size())) +
+                           16);
+        stream.next_in = input.empty() ? Z_NULL :
+                const_cast<Bytef*>(
+                        reinterpret_cast<const Bytef*>(&input[0]));
+        stream.avail_in = static_cast<uInt>(input.size());
+
+        int rv = Z_OK;
+        do
+        {
+            if (stream.total_out == result.data.size())
+            {
+                result.data.resize(result.data.size() * 2);
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(
+                    &result.data[stream.total_out]);
+            stream.avail_out = static_cast<uInt>(
+                    result.data.size() - stream.total_out);
+            rv = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+        }
+        while (rv == Z_OK && stream.avail_out == 0);
+
+        const size_t numBytes = stream.total_out;
+        deflateEnd(&stream);
+        if (rv != (last ? Z_STREAM_END : Z_OK) && rv != Z_BUF_ERROR)
+        {
+            std::ostringstream ostr;
+            ostr << "Failed to deflate block: " << rv;
+            throw except::IOException(Ctxt(ostr.str()));
+        }
+        result.data.resize(numBytes);
+    }
+
+private:
+    const std::vector<std::vector<sys::byte> >& mBlocks;
+    const std::vector<sys::byte>& mDictionary;
+    const int mLevel;
+    const bool mFinish;
+    std::vector<DeflatedBlock>& mResults;
+};
+
+void writeLittleEndian(io::OutputStream& output, sys::Uint32_T value)
+{
+    const sys::ubyte bytes[] = {
+        static_cast<sys::ubyte>(value & 0xff),
+        static_cast<sys::ubyte>((value >> 8) & 0xff),
+        static_cast<sys::ubyte>((value >> 16) & 0xff),
+        static_cast<sys::ubyte>((value >> 24) & 0xff)
+    };
+    output.write(bytes, sizeof(bytes));
+}
+}
+
+GZipOutputStream::GZipOutputStream(const std::string& file,
+                                   int level,
+                                   size_t numThreads,
+                                   size_t blockSize) :
+    mFile(NULL),
+    mLevel(level),
+    mNumThreads(std::max<size_t>(numThreads, 1)),
+    mBlockSize(std::max<size_t>(blockSize, 1)),
+    mCrc(0),
+    mTotalIn(0)
 {
-    mFile = gzopen(file.c_str(), "wb");
+    if (mNumThreads > 1)
+    {
+        mOutput.reset(new io::FileOutputStream(file));
+
+        // ID1, ID2, CM = deflate, FLG, MTIME (none), XFL, OS = Unix
+        const sys::ubyte header[] = {
+            0x1f, 0x8b, 8, 0, 0, 0, 0, 0,
+            static_cast<sys::ubyte>(level == 9 ? 2 : (level == 1 ? 4 : 0)),
+            3
+        };
+        mOutput->write(header, sizeof(header));
+        return;
+    }
+
+    std::string mode("wb");
+    if (level >= 0 && level <= 9)
+    {
+        mode += static_cast<char>('0' + level);
+    }
+    mFile = gzopen(file.c_str(), mode.c_str());
     if (mFile == NULL)
     {
         throw except::IOException(Ctxt(
@@ -37,9 +192,34 @@ GZipOutputStream::GZipOutputStream(const std::string& file)
 
 void GZipOutputStream::write(const void* buffer, size_t len)
 {
+    const sys::byte* const bufferPtr = static_cast<const sys::byte*>(buffer);
+    if (mOutput.get())
+    {
+        size_t written = 0;
+        while (written < len)
+        {
+            if (mPending.empty() || mPending.back().size() == mBlockSize)
+            {
+                if (mPending.size() == mNumThreads * BLOCKS_PER_THREAD)
+                {
+                    deflatePending(false);
+                }
+                mPending.push_back(std::vector<sys::byte>());
+                mPending.back().reserve(mBlockSize);
+            }
+
+            std::vector<sys::byte>& block = mPending.back();
+            const size_t numBytes =
+                    std::min(len - written, mBlockSize - block.size());
+            block.insert(block.end(), bufferPtr + written,
+                         bufferPtr + written + numBytes);
+            written += numBytes;
+        }
+        return;
+    }
+
     size_t written = 0;
     int rv = 0;
-    const sys::byte* const bufferPtr = static_cast<const sys::byte*>(buffer);
     do
     {
         rv = gzwrite(mFile, bufferPtr + written, len - written);
@@ -56,8 +236,59 @@ void GZipOutputStream::write(const void* buffer, size_t len)
 
 }
 
+void GZipOutputStream::deflatePending(bool finish)
+{
+    std::vector<DeflatedBlock> results(mPending.size());
+    const size_t numThreads = std::min(mNumThreads, mPending.size());
+    mt::runBalanced1D(mPending.size(), numThreads,
+                      DeflateOp(mPending, mDictionary, mLevel, finish,
+                                results));
+
+    for (size_t ii = 0; ii < results.size(); ++ii)
+    {
+        if (!results[ii].data.empty())
+        {
+            mOutput->write(&results[ii].data[0], results[ii].data.size());
+        }
+        mCrc = CRC32::combine(mCrc, results[ii].crc, mPending[ii].size());
+        mTotalIn += mPending[ii].size();
+    }
+
+    const std::vector<sys::byte>& last = mPending.back();
+    const size_t dictSize = std::min(last.size(), DICTIONARY_SIZE);
+    mDictionary.assign(last.end() - dictSize, last.end());
+    mPending.clear();
+}
+
 void GZipOutputStream::close()
 {
+    if (mOutput.get())
+    {
+        if (!mPending.empty() && mPending.back().empty())
+        {
+            mPending.pop_back();
+        }
+
+        if (mPending.empty())
+        {
+            // An empty fixed-Huffman block with the final bit set
+            const sys::ubyte finalBlock[] = { 0x03, 0x00 };
+            mOutput->write(finalBlock, sizeof(finalBlock));
+        }
+        else
+        {
+            deflatePending(true);
+        }
+
+        // The trailer holds the CRC and the size modulo 2^32
+        writeLittleEndian(*mOutput, mCrc);
+        writeLittleEndian(*mOutput,
+                          static_cast<sys::Uint32_T>(mTotalIn & 0xffffffff));
+        mOutput->close();
+        mOutput.reset();
+        return;
+    }
+
     gzclose( mFile);
     mFile = NULL;
 }
@@ -20,6 +20,10 @@
  *
  */
 
+#include <algorithm>
+#include <vector>
+
+#include "zip/CRC32.h"
 #include "zip/ZipEntry.h"
 
 const static char* sZipFileMadeByStr[] = {
@@ -29,8 +33,44 @@ const static char* sZipFileMadeByStr[] = {
         "Acorn Risc", "VFAT", "alternative MVS", "BeOS", "Tandem", "OS/400",
         "OS/X (Darwin)", NULL };
 
+namespace
+{
+// Sums what's written to it and throws the bytes away
+class CRC32OutputStream : public io::OutputStream
+{
+public:
+    CRC32OutputStream() :
+        mCRC(0)
+    {
+    }
+
+    virtual void write(const void* buffer, size_t len)
+    {
+        mCRC = zip::CRC32::update(mCRC, buffer, len);
+    }
+
+    sys::Uint32_T getCRC() const
+    {
+        return mCRC;
+    }
+
+private:
+    sys::Uint32_T mCRC;
+};
+}
+
 namespace zip
 {
+void ZipEntry::checkCRC(sys::Uint32_T crc) const
+{
+    if (crc != mCRC32)
+    {
+        throw except::IOException(Ctxt(FmtX(
+                "CRC mismatch for %s: expected %08x, got %08x",
+                mFileName.c_str(), mCRC32, crc)));
+    }
+}
+
 void ZipEntry::inflate(sys::ubyte* out, sys::Size_T outLen, sys::ubyte* in,
         sys::Size_T inLen)
 {
@@ -40,9 +80,7 @@ void ZipEntry::inflate(sys::ubyte* out, sys::Size_T outLen, sys::ubyte* in,
     zstream.zfree = Z_NULL;
     zstream.opaque = Z_NULL;
     zstream.next_in = in;
-    zstream.avail_in = inLen;
     zstream.next_out = (Bytef*) out;
-    zstream.avail_out = outLen;
     zstream.data_type = Z_UNKNOWN;
 
     int zerr = inflateInit2(&zstream, -MAX_WBITS);
@@ -51,11 +89,38 @@ void ZipEntry::inflate(sys::ubyte* out, sys::Size_T outLen, sys::ubyte* in,
         throw except::IOException(Ctxt(FmtX("inflateInit2 failed [%d]", zerr)));
     }
 
-    // decompress
-    zerr = ::inflate(&zstream, Z_FINISH);
+    // zlib counts in uInt, so Zip64 entries are fed through in pieces
+    const sys::Size_T maxChunk = 1 << 30;
+    sys::Size_T inOffset = 0;
+    sys::Size_T outOffset = 0;
+    do
+    {
+        if (zstream.avail_in == 0 && inOffset < inLen)
+        {
+            const sys::Size_T chunk = std::min(maxChunk, inLen - inOffset);
+            zstream.next_in = in + inOffset;
+            zstream.avail_in = static_cast<uInt>(chunk);
+            inOffset += chunk;
+        }
+        if (zstream.avail_out == 0 && outOffset < outLen)
+        {
+            const sys::Size_T chunk = std::min(maxChunk, outLen - outOffset);
+            zstream.next_out = (Bytef*) out + outOffset;
+            zstream.avail_out = static_cast<uInt>(chunk);
+            outOffset += chunk;
+        }
+
+        const int flush = (inOffset == inLen && outOffset == outLen) ?
+                Z_FINISH : Z_NO_FLUSH;
+        zerr = ::inflate(&zstream, flush);
+    }
+    while (zerr == Z_OK ||
+           (zerr == Z_BUF_ERROR && zstream.avail_in == 0 && inOffset < inLen) ||
+           (zerr == Z_BUF_ERROR && zstream.avail_out == 0 && outOffset < outLen));
 
     if (zerr != Z_STREAM_END)
     {
+        inflateEnd(&zstream);
         throw except::IOException(Ctxt(FmtX(
                 "inflate failed [%d]: wanted: %d, got: %lu", zerr,
                 Z_STREAM_END, zstream.total_out)));
@@ -83,12 +148,123 @@ void ZipEntry::decompress(sys::ubyte* out, sys::Size_T outLen)
 {
     if (mCompressionMethod == COMP_STORED)
     {
-        memcpy(out, mCompressedData, outLen);
+        memcpy(out, mCompressedData, std::min(outLen, mCompressedSize));
     }
     else
     {
         inflate(out, outLen, mCompressedData, mCompressedSize);
     }
+
+    if (mVerifyCRC && outLen >= mUncompressedSize)
+    {
+        checkCRC(CRC32::update(0, out, mUncompressedSize));
+    }
+}
+
+bool ZipEntry::verify()
+{
+    if (mCompressionMethod == COMP_STORED)
+    {
+        return mCompressedSize == mUncompressedSize &&
+                CRC32::update(0, mCompressedData, mCompressedSize) == mCRC32;
+    }
+
+    CRC32OutputStream sink;
+    try
+    {
+        decompress(sink);
+    }
+    catch (const except::IOException&)
+    {
+        return false;
+    }
+    return sink.getCRC() == mCRC32;
+}
+
+void ZipEntry::decompress(io::OutputStream& out, sys::Size_T chunkSize)
+{
+    if (chunkSize == 0)
+        throw except::InvalidArgumentException(Ctxt("Chunk size must be > 0"));
+
+    if (mCompressionMethod == COMP_STORED)
+    {
+        sys::Uint32_T crc = 0;
+        for (sys::Size_T offset = 0; offset < mCompressedSize;
+                offset += chunkSize)
+        {
+            const sys::Size_T len =
+                    std::min(chunkSize, mCompressedSize - offset);
+            if (mVerifyCRC)
+                crc = CRC32::update(crc, mCompressedData + offset, len);
+            out.write(mCompressedData + offset, len);
+        }
+        if (mVerifyCRC)
+            checkCRC(crc);
+        return;
+    }
+
+    // zlib counts in uInt, so feed the input in pieces it can describe
+    const sys::Size_T maxInput = 1 << 30;
+    chunkSize = std::min(chunkSize, maxInput);
+    std::vector<sys::ubyte> buffer(chunkSize);
+
+    z_stream zstream;
+    memset(&zstream, 0, sizeof(zstream));
+    int zerr = inflateInit2(&zstream, -MAX_WBITS);
+    if (zerr != Z_OK)
+    {
+        throw except::IOException(Ctxt(FmtX("inflateInit2 failed [%d]", zerr)));
+    }
+
+    sys::Size_T inOffset = 0;
+    sys::Size_T outTotal = 0;
+    sys::Uint32_T crc = 0;
+    do
+    {
+        if (zstream.avail_in == 0 && inOffset < mCompressedSize)
+        {
+            const sys::Size_T inLen =
+                    std::min(maxInput, mCompressedSize - inOffset);
+            zstream.next_in = mCompressedData + inOffset;
+            zstream.avail_in = static_cast<uInt>(inLen);
+            inOffset += inLen;
+        }
+
+        zstream.next_out = &buffer[0];
+        zstream.avail_out = static_cast<uInt>(buffer.size());
+        zerr = ::inflate(&zstream, Z_NO_FLUSH);
+        if (zerr != Z_OK && zerr != Z_STREAM_END)
+        {
+            inflateEnd(&zstream);
+            throw except::IOException(Ctxt(FmtX(
+                    "inflate failed [%d] for %s", zerr, mFileName.c_str())));
+        }
+
+        const sys::Size_T numBytes = buffer.size() - zstream.avail_out;
+        if (numBytes == 0 && zerr != Z_STREAM_END &&
+            zstream.avail_in == 0 && inOffset == mCompressedSize)
+        {
+            inflateEnd(&zstream);
+            throw except::IOException(Ctxt(
+                    "Compressed data is truncated for " + mFileName));
+        }
+        if (mVerifyCRC)
+            crc = CRC32::update(crc, &buffer[0], numBytes);
+        out.write(&buffer[0], numBytes);
+        outTotal += numBytes;
+    }
+    while (zerr != Z_STREAM_END);
+    inflateEnd(&zstream);
+
+    if (outTotal != mUncompressedSize)
+    {
+        throw except::IOException(Ctxt(FmtX(
+                "Expected %lu uncompressed bytes for %s, got %lu",
+                static_cast<unsigned long>(mUncompressedSize),
+                mFileName.c_str(), static_cast<unsigned long>(outTotal))));
+    }
+    if (mVerifyCRC)
+        checkCRC(crc);
 }
 
 std::ostream& operator<<(std::ostream& os, const zip::ZipEntry& ze)
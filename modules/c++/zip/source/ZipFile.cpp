@@ -20,13 +20,187 @@
  *
  */
 
+#include <algorithm>
+
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include <mt/BalancedRunnable1D.h>
+#include <io/FileOutputStream.h>
 #include "zip/ZipFile.h"
 
 #define Z_READ_SHORT_INC(BUF, OFF) readShort(&BUF[OFF]); OFF += 2
 #define Z_READ_INT_INC(BUF, OFF) readInt(&BUF[OFF]); OFF += 4
+#define Z_READ_LONG_INC(BUF, OFF) readLong(&BUF[OFF]); OFF += 8
+
+namespace
+{
+const sys::Uint16_T ZIP64_SHORT = 0xFFFF;
+const sys::Uint32_T ZIP64_INT = 0xFFFFFFFF;
+
+// Orders entry indices largest first
+struct LargerEntry
+{
+    LargerEntry(const std::vector<zip::ZipEntry*>& entries) :
+        mEntries(entries)
+    {
+    }
+
+    bool operator()(size_t lhs, size_t rhs) const
+    {
+        return mEntries[lhs]->getUncompressedSize() >
+                mEntries[rhs]->getUncompressedSize();
+    }
+
+private:
+    const std::vector<zip::ZipEntry*>& mEntries;
+};
+
+std::vector<size_t> largestFirst(const std::vector<zip::ZipEntry*>& entries)
+{
+    std::vector<size_t> order(entries.size());
+    for (size_t ii = 0; ii < order.size(); ++ii)
+    {
+        order[ii] = ii;
+    }
+    std::stable_sort(order.begin(), order.end(), LargerEntry(entries));
+    return order;
+}
+
+size_t getNumThreads(size_t numThreads, size_t numEntries)
+{
+    if (numThreads == 0)
+    {
+        numThreads = sys::OS().getNumCPUs();
+    }
+    return std::max<size_t>(std::min(numThreads, numEntries), 1);
+}
+
+bool isDirectoryEntry(const std::string& fileName)
+{
+    return !fileName.empty() && fileName[fileName.size() - 1] == '/';
+}
+
+// Refuse names that would land outside of the extraction directory
+void checkEntryName(const std::string& fileName)
+{
+    bool bad = fileName.empty() || fileName[0] == '/' ||
+            fileName[0] == '\\' || fileName.find(':') != std::string::npos;
+
+    std::string::size_type start = 0;
+    while (!bad && start <= fileName.size())
+    {
+        std::string::size_type end = fileName.find_first_of("/\\", start);
+        if (end == std::string::npos)
+        {
+            end = fileName.size();
+        }
+        bad = (fileName.compare(start, end - start, "..") == 0);
+        start = end + 1;
+    }
+
+    if (bad)
+    {
+        throw except::IOException(Ctxt(
+                "Refusing to extract entry " + fileName));
+    }
+}
+
+struct DecompressOp
+{
+    DecompressOp(const std::vector<zip::ZipEntry*>& entries,
+                 const std::vector<size_t>& order,
+                 const std::vector<sys::ubyte*>& buffers) :
+        mEntries(entries),
+        mOrder(order),
+        mBuffers(buffers)
+    {
+    }
+
+    void operator()(size_t index) const
+    {
+        const size_t entry = mOrder[index];
+        mEntries[entry]->decompress(mBuffers[entry],
+                                    mEntries[entry]->getUncompressedSize());
+    }
+
+private:
+    const std::vector<zip::ZipEntry*>& mEntries;
+    const std::vector<size_t>& mOrder;
+    const std::vector<sys::ubyte*>& mBuffers;
+};
+
+struct VerifyOp
+{
+    VerifyOp(const std::vector<zip::ZipEntry*>& entries,
+             const std::vector<size_t>& order,
+             std::vector<char>& passed) :
+        mEntries(entries),
+        mOrder(order),
+        mPassed(passed)
+    {
+    }
+
+    void operator()(size_t index) const
+    {
+        const size_t entry = mOrder[index];
+        mPassed[entry] = mEntries[entry]->verify() ? 1 : 0;
+    }
+
+private:
+    const std::vector<zip::ZipEntry*>& mEntries;
+    const std::vector<size_t>& mOrder;
+    std::vector<char>& mPassed;
+};
+
+struct ExtractOp
+{
+    ExtractOp(const std::vector<zip::ZipEntry*>& entries,
+              const std::vector<size_t>& order,
+              const std::string& directory) :
+        mEntries(entries),
+        mOrder(order),
+        mDirectory(directory)
+    {
+    }
+
+    void operator()(size_t index) const
+    {
+        zip::ZipEntry* const entry = mEntries[mOrder[index]];
+        if (isDirectoryEntry(entry->getFileName()))
+        {
+            return;
+        }
+
+        io::FileOutputStream output(
+                sys::Path::joinPaths(mDirectory, entry->getFileName()));
+        entry->decompress(output);
+        output.close();
+    }
+
+private:
+    const std::vector<zip::ZipEntry*>& mEntries;
+    const std::vector<size_t>& mOrder;
+    const std::string mDirectory;
+};
+}
 
 namespace zip
 {
+ZipFile::ZipFile(const std::string& pathname) :
+    mSwapBytes(sys::isBigEndianSystem()),
+    mCompressed(NULL),
+    mCompressedLength(0),
+    mMapping(new io::MMapInputStream(pathname))
+{
+    // The mapping is never written through; ZipEntry just wants a
+    // non-const pointer for zlib's sake
+    mCompressed = reinterpret_cast<sys::ubyte*>(
+            const_cast<sys::byte*>(mMapping->get()));
+    mCompressedLength = mMapping->getSize();
+
+    readCentralDir();
+}
+
 ZipFile::~ZipFile()
 {
     for (size_t i = 0; i < mEntries.size(); ++i)
@@ -35,7 +209,7 @@ ZipFile::~ZipFile()
         delete mEntries[i];
     }
 
-    if (mCompressed)
+    if (mCompressed && !mMapping.get())
         delete[] mCompressed;
 }
 
@@ -67,6 +241,16 @@ sys::Uint16_T ZipFile::readShort(sys::ubyte* buf)
     return le;
 }
 
+sys::Uint64_T ZipFile::readLong(sys::ubyte* buf)
+{
+    sys::Uint64_T le;
+    memcpy(&le, buf, 8);
+
+    if (mSwapBytes)
+        le = sys::byteSwap(le);
+    return le;
+}
+
 ZipFile::Iterator ZipFile::lookup(std::string fileName) const
 {
     ZipFile::Iterator p;
@@ -120,10 +304,21 @@ void ZipFile::readCentralDir()
     // else still rockin'
     readCentralDirValues(eocd, (mCompressed + mCompressedLength) - eocd);
 
+    // Zip64 archives put a locator for the real values just before the EOCD
+    if (eocd - mCompressed >= ZIP64_LOCATOR_LEN &&
+        readInt(eocd - ZIP64_LOCATOR_LEN) ==
+                static_cast<sys::Uint32_T>(ZIP64_LOCATOR_SIGNATURE))
+    {
+        readZip64CentralDirValues(eocd - ZIP64_LOCATOR_LEN);
+    }
+
+    if (mCentralDirOffset > mCompressedLength)
+        throw except::IOException(Ctxt("Central directory is past EOF"));
+
     p = mCompressed + mCentralDirOffset;
-    sys::SSize_T len = (mCompressed + mCompressedLength) - p;
-    for (unsigned int i = 0; i < mEntries.size(); ++i)
+    for (size_t i = 0; i < mEntries.size(); ++i)
     {
+        const sys::SSize_T len = (mCompressed + mCompressedLength) - p;
         mEntries[i] = newCentralDirEntry(&p, len);
     }
 
@@ -150,26 +345,57 @@ ZipEntry* ZipFile::newCentralDirEntry(sys::ubyte** buf, sys::SSize_T len)
     sys::Uint16_T lastModifiedTime = Z_READ_SHORT_INC(p, off);
     sys::Uint16_T lastModifiedDate = Z_READ_SHORT_INC(p, off);
     sys::Uint32_T crc32 = Z_READ_INT_INC(p, off);
-    sys::Uint32_T compressedSize = Z_READ_INT_INC(p, off);
-    sys::Uint32_T uncompressedSize = Z_READ_INT_INC(p, off);
+    sys::Uint64_T compressedSize = Z_READ_INT_INC(p, off);
+    sys::Uint64_T uncompressedSize = Z_READ_INT_INC(p, off);
     sys::Uint16_T fileNameLength = Z_READ_SHORT_INC(p, off);
     sys::Uint16_T extraFieldLength = Z_READ_SHORT_INC(p, off);
     sys::Uint16_T fileCommentLength = Z_READ_SHORT_INC(p, off);
     Z_READ_SHORT_INC(p, off); // skipping diskNumberStart
     sys::Uint16_T internalAttrs = Z_READ_SHORT_INC(p, off);
     sys::Uint16_T externalAttrs = Z_READ_INT_INC(p, off);
-    sys::Uint32_T localHeaderRelOffset = readInt(&p[off]);
+    sys::Uint64_T localHeaderRelOffset = readInt(&p[off]);
     p += ENTRY_LEN;
 
+    if (ENTRY_LEN + fileNameLength + extraFieldLength + fileCommentLength >
+            len)
+        throw except::IOException(Ctxt("CDE entry is truncated"));
+
     std::string fileName;
     if (fileNameLength != 0)
         fileName = std::string((const char*) p, fileNameLength);
 
     p += fileNameLength;
 
-    // I dont know what extra field is, but skip it for now	    
-    if (extraFieldLength)
-        p += extraFieldLength;
+    // The only extra field we care about is Zip64's, which holds each
+    // value that didn't fit in its 32-bit field, in this order
+    for (size_t extraOff = 0; extraOff + 4 <= extraFieldLength;)
+    {
+        const sys::Uint16_T id = readShort(&p[extraOff]);
+        const sys::Uint16_T size = readShort(&p[extraOff + 2]);
+        if (size > extraFieldLength - extraOff - 4)
+            throw except::IOException(
+                    Ctxt("Extra field is truncated: " + fileName));
+
+        if (id == ZIP64_EXTRA_ID)
+        {
+            sys::ubyte* const field = p + extraOff + 4;
+            size_t fieldOff = 0;
+            if (uncompressedSize == ZIP64_INT && fieldOff + 8 <= size)
+            {
+                uncompressedSize = Z_READ_LONG_INC(field, fieldOff);
+            }
+            if (compressedSize == ZIP64_INT && fieldOff + 8 <= size)
+            {
+                compressedSize = Z_READ_LONG_INC(field, fieldOff);
+            }
+            if (localHeaderRelOffset == ZIP64_INT && fieldOff + 8 <= size)
+            {
+                localHeaderRelOffset = Z_READ_LONG_INC(field, fieldOff);
+            }
+        }
+        extraOff += 4 + size;
+    }
+    p += extraFieldLength;
 
     std::string fileComment;
     if (fileCommentLength)
@@ -179,12 +405,29 @@ ZipEntry* ZipFile::newCentralDirEntry(sys::ubyte** buf, sys::SSize_T len)
 
     *buf = p;
 
+    // Sizes and offsets come from the file, so test them in a way that
+    // can't wrap around
+    if (localHeaderRelOffset > mCompressedLength ||
+        LFH_SIZE > mCompressedLength - localHeaderRelOffset)
+        throw except::IOException(Ctxt("Local header is past EOF"));
+
     p = mCompressed + localHeaderRelOffset;
 
     extraFieldLength = readShort(&p[0x1c]);
 
-    sys::Size_T dataOffset = localHeaderRelOffset + LFH_SIZE + fileNameLength
-            + extraFieldLength;
+    const sys::Uint64_T dataOffset = localHeaderRelOffset + LFH_SIZE +
+            readShort(&p[0x1a]) + extraFieldLength;
+
+    if (compressedSize > mCompressedLength ||
+        dataOffset > mCompressedLength - compressedSize)
+        throw except::IOException(Ctxt("Entry data is past EOF: " + fileName));
+
+    // Stored data is copied out for the uncompressed size, so that has to
+    // be the size checked above
+    if (compressionMethod == ZipEntry::COMP_STORED &&
+        compressedSize != uncompressedSize)
+        throw except::IOException(Ctxt(
+                "Stored entry sizes don't match: " + fileName));
 
     return new ZipEntry(mCompressed + dataOffset, compressedSize,
             uncompressedSize, fileName, fileComment, versionMadeBy,
@@ -229,6 +472,110 @@ void ZipFile::readCentralDirValues(sys::ubyte* buf, sys::SSize_T len)
     mComment = std::string((const char*) (buf + EOCD_LEN), commentLength);
 }
 
+void ZipFile::readZip64CentralDirValues(sys::ubyte* locator)
+{
+    const sys::Uint64_T eocdOffset = readLong(&locator[8]);
+    if (eocdOffset > mCompressedLength ||
+        ZIP64_EOCD_LEN > mCompressedLength - eocdOffset)
+        throw except::IOException(Ctxt("Zip64 EOCD is past EOF"));
+
+    sys::ubyte* const buf = mCompressed + eocdOffset;
+    if (readInt(buf) != static_cast<sys::Uint32_T>(ZIP64_EOCD_SIGNATURE))
+        throw except::IOException(Ctxt("Did not find Zip64 EOCD signature"));
+
+    sys::Uint64_T off = 16;
+    const sys::Uint32_T diskNum = Z_READ_INT_INC(buf, off);
+    const sys::Uint32_T diskWithCentralDir = Z_READ_INT_INC(buf, off);
+    if (diskNum != 0 || diskWithCentralDir != 0)
+        throw except::IOException(Ctxt("disk number must be 0"));
+
+    const sys::Uint64_T entryCount = Z_READ_LONG_INC(buf, off);
+    const sys::Uint64_T totalEntries = Z_READ_LONG_INC(buf, off);
+    if (totalEntries != entryCount)
+        throw except::IOException(Ctxt("Total entries must match entries"));
+
+    // Every entry needs at least a fixed-size header in the directory
+    if (entryCount > mCompressedLength / ENTRY_LEN)
+        throw except::IOException(Ctxt("Zip64 entry count is too large"));
+
+    mEntries.resize(static_cast<size_t>(entryCount));
+    mCentralDirSize = Z_READ_LONG_INC(buf, off);
+    mCentralDirOffset = Z_READ_LONG_INC(buf, off);
+}
+
+void ZipFile::decompress(const std::vector<sys::ubyte*>& buffers,
+                         size_t numThreads) const
+{
+    if (buffers.size() != mEntries.size())
+    {
+        throw except::InvalidArgumentException(Ctxt(FmtX(
+                "Got %lu buffers for %lu entries",
+                static_cast<unsigned long>(buffers.size()),
+                static_cast<unsigned long>(mEntries.size()))));
+    }
+
+    const std::vector<size_t> order(largestFirst(mEntries));
+    mt::runBalanced1D(mEntries.size(),
+                      getNumThreads(numThreads, mEntries.size()),
+                      DecompressOp(mEntries, order, buffers));
+}
+
+void ZipFile::extract(const std::string& directory, size_t numThreads) const
+{
+    // Make every directory up front so the workers never race to
+    sys::OS os;
+    for (size_t ii = 0; ii < mEntries.size(); ++ii)
+    {
+        const std::string& fileName = mEntries[ii]->getFileName();
+        checkEntryName(fileName);
+
+        std::string::size_type slash = fileName.find('/');
+        while (slash != std::string::npos)
+        {
+            const std::string subdir =
+                    sys::Path::joinPaths(directory, fileName.substr(0, slash));
+            if (!os.isDirectory(subdir) && !os.makeDirectory(subdir))
+            {
+                throw except::IOException(Ctxt(
+                        "Unable to create directory " + subdir));
+            }
+            slash = fileName.find('/', slash + 1);
+        }
+    }
+
+    const std::vector<size_t> order(largestFirst(mEntries));
+    mt::runBalanced1D(mEntries.size(),
+                      getNumThreads(numThreads, mEntries.size()),
+                      ExtractOp(mEntries, order, directory));
+}
+
+void ZipFile::setVerifyCRC(bool verify)
+{
+    for (size_t ii = 0; ii < mEntries.size(); ++ii)
+    {
+        mEntries[ii]->setVerifyCRC(verify);
+    }
+}
+
+std::vector<std::string> ZipFile::verify(size_t numThreads) const
+{
+    std::vector<char> passed(mEntries.size(), 0);
+    const std::vector<size_t> order(largestFirst(mEntries));
+    mt::runBalanced1D(mEntries.size(),
+                      getNumThreads(numThreads, mEntries.size()),
+                      VerifyOp(mEntries, order, passed));
+
+    std::vector<std::string> failed;
+    for (size_t ii = 0; ii < mEntries.size(); ++ii)
+    {
+        if (!passed[ii])
+        {
+            failed.push_back(mEntries[ii]->getFileName());
+        }
+    }
+    return failed;
+}
+
 std::ostream& operator<<(std::ostream& os, const ZipFile& zf)
 {
     os << "central directory length: " << zf.getCentralDirSize() << std::endl;
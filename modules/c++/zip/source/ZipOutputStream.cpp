@@ -20,14 +20,60 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+
+#include <zip/CRC32.h>
 #include <zip/ZipOutputStream.h>
 #include <io/FileInputStream.h>
 #include <except/Exception.h>
 
+namespace
+{
+// minizip and zlib take unsigned lengths, so large buffers go in pieces
+const size_t MAX_CHUNK = 1 << 30;
+
+const size_t DEFLATE_BUFFER_SIZE = 65536;
+
+// AUTO stores entries whose sample deflates to more than this fraction
+const double AUTO_STORE_RATIO = 0.9;
+
+// Adds the time until it goes out of scope to a running total
+class ScopedTimer
+{
+public:
+    ScopedTimer(double& seconds) :
+        mSeconds(seconds),
+        mStart(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        mSeconds += std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - mStart).count();
+    }
+
+private:
+    double& mSeconds;
+    const std::chrono::steady_clock::time_point mStart;
+};
+}
+
 namespace zip
 {
-ZipOutputStream::ZipOutputStream(const std::string& pathname)
+ZipOutputStream::ZipOutputStream(const std::string& pathname, bool zip64) :
+    mZip64(zip64),
+    mRaw(false),
+    mDeflated(DEFLATE_BUFFER_SIZE),
+    mCRC(0),
+    mUncompressedSize(0),
+    mCompressedSize(0),
+    mCompression(DEFAULT),
+    mDeferred(false)
 {
+    memset(&mStream, 0, sizeof(mStream));
+
     mZip = zipOpen64(pathname.c_str(), APPEND_STATUS_CREATE);
     if (mZip == NULL)
         throw except::IOException(Ctxt("Failed to open zip stream " + 
@@ -35,44 +81,174 @@ ZipOutputStream::ZipOutputStream(const std::string& pathname)
 
 }
 
+ZipOutputStream::~ZipOutputStream()
+{
+    if (mRaw)
+    {
+        deflateEnd(&mStream);
+    }
+}
+
+void ZipOutputStream::setCompression(int compression)
+{
+    if (compression < AUTO || compression > BEST)
+        throw except::InvalidArgumentException(Ctxt(FmtX(
+                "Invalid compression %d", compression)));
+    mCompression = compression;
+}
+
 void ZipOutputStream::createFileInZip(const std::string& pathname,
                                       const std::string& comment,
                                       const std::string& password)
+{
+    mEntry = EntryStatistics();
+    mEntry.pathname = pathname;
+    mComment = comment;
+    mPassword = password;
+    mCRC = 0;
+    mUncompressedSize = 0;
+    mCompressedSize = 0;
+
+    if (mCompression == AUTO)
+    {
+        mDeferred = true;
+        mSample.clear();
+    }
+    else
+    {
+        ScopedTimer timer(mEntry.elapsedSeconds);
+        openFileInZip(mCompression);
+    }
+}
+
+void ZipOutputStream::openFileInZip(int compression)
 {
     zip_fileinfo zipFileInfo;
 
     memset(&zipFileInfo, 0, sizeof(zipFileInfo));
 
+    // minizip has to see the plain text to encrypt it, and it copies
+    // stored entries as cheaply as we could, so only unencrypted
+    // deflated entries are compressed here
+    const bool stored = (compression == STORED);
+    const bool raw = mPassword.empty() && !stored;
+    mEntry.method = stored ? 0 : Z_DEFLATED;
+    mEntry.level = compression;
+
     // Add the file
     sys::Int32_T results = zipOpenNewFileInZip3_64(
             mZip,
-            pathname.c_str(),
+            mEntry.pathname.c_str(),
             &zipFileInfo,
             NULL,
             0,
             NULL,
             0,
-            comment.empty() ? NULL : comment.c_str(),
-            Z_DEFLATED,
-            Z_DEFAULT_COMPRESSION,
-            0,
+            mComment.empty() ? NULL : mComment.c_str(),
+            mEntry.method,
+            compression,
+            raw ? 1 : 0,
             -MAX_WBITS,
             DEF_MEM_LEVEL,
             Z_DEFAULT_STRATEGY,
-            password.empty() ? NULL : password.c_str(),
+            mPassword.empty() ? NULL : mPassword.c_str(),
             0,
-            0);
+            mZip64 ? 1 : 0);
 
     if (results != Z_OK)
          throw except::IOException(Ctxt("Failed to create file " + 
-                pathname));
+                mEntry.pathname));
+
+    mRaw = raw;
+    if (mRaw)
+    {
+        memset(&mStream, 0, sizeof(mStream));
+        results = deflateInit2(&mStream, compression, Z_DEFLATED,
+                               -MAX_WBITS, DEF_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+        if (results != Z_OK)
+        {
+            zipCloseFileInZipRaw64(mZip, 0, 0);
+            mRaw = false;
+            throw except::IOException(Ctxt("Failed to initialize deflate for " +
+                    mEntry.pathname));
+        }
+    }
 }
 
-void ZipOutputStream::closeFileInZip()
+int ZipOutputStream::chooseCompression() const
 {
-    sys::Int32_T results = zipCloseFileInZip(mZip);
+    if (mSample.empty())
+    {
+        return STORED;
+    }
+
+    std::vector<Bytef> compressed(compressBound(
+            static_cast<uLong>(mSample.size())));
+    uLongf compressedSize = static_cast<uLongf>(compressed.size());
+    const int results = compress2(
+            &compressed[0], &compressedSize,
+            reinterpret_cast<const Bytef*>(&mSample[0]),
+            static_cast<uLong>(mSample.size()), FAST);
     if (results != Z_OK)
-         throw except::IOException(Ctxt("Failed to close file at zip location."));
+    {
+        return DEFAULT;
+    }
+
+    return (compressedSize > AUTO_STORE_RATIO * mSample.size()) ?
+            STORED : DEFAULT;
+}
+
+void ZipOutputStream::closeFileInZip()
+{
+    // The timer has to stop before the entry is recorded, or its last
+    // and often biggest piece of work is left out
+    {
+        ScopedTimer timer(mEntry.elapsedSeconds);
+        if (mDeferred)
+        {
+            mDeferred = false;
+            openFileInZip(chooseCompression());
+            if (!mSample.empty())
+            {
+                writeToEntry(&mSample[0], mSample.size());
+            }
+            mSample.clear();
+        }
+
+        sys::Int32_T results;
+        if (mRaw)
+        {
+            mRaw = false;
+            try
+            {
+                deflateInZip(NULL, 0, Z_FINISH);
+            }
+            catch (...)
+            {
+                deflateEnd(&mStream);
+                throw;
+            }
+            deflateEnd(&mStream);
+
+            results = zipCloseFileInZipRaw64(mZip, mUncompressedSize, mCRC);
+        }
+        else
+        {
+            results = zipCloseFileInZip(mZip);
+            if (mEntry.method == 0 && mPassword.empty())
+            {
+                mCompressedSize = mUncompressedSize;
+            }
+        }
+
+        if (results != Z_OK)
+            throw except::IOException(Ctxt(
+                    "Failed to close file at zip location."));
+    }
+
+    mEntry.uncompressedSize = mUncompressedSize;
+    mEntry.compressedSize = mCompressedSize;
+    mStatistics.push_back(mEntry);
 }
 
 void ZipOutputStream::write(const std::string& inputPathname,
@@ -86,12 +262,97 @@ void ZipOutputStream::write(const std::string& inputPathname,
 }
 
 void ZipOutputStream::write(const void* buffer, size_t len)
+{
+    ScopedTimer timer(mEntry.elapsedSeconds);
+    const sys::byte* bytes = static_cast<const sys::byte*>(buffer);
+    if (mDeferred)
+    {
+        const size_t sampleSize = AUTO_SAMPLE_SIZE;
+        const size_t numBytes = std::min(len, sampleSize - mSample.size());
+        mSample.insert(mSample.end(), bytes, bytes + numBytes);
+        bytes += numBytes;
+        len -= numBytes;
+        if (mSample.size() < sampleSize)
+        {
+            return;
+        }
+
+        mDeferred = false;
+        openFileInZip(chooseCompression());
+        writeToEntry(&mSample[0], mSample.size());
+        mSample.clear();
+    }
+
+    writeToEntry(bytes, len);
+}
+
+void ZipOutputStream::writeToEntry(const void* buffer, size_t len)
+{
+    mUncompressedSize += len;
+    if (mRaw)
+    {
+        mCRC = CRC32::update(mCRC, buffer, len);
+        deflateInZip(buffer, len, Z_NO_FLUSH);
+    }
+    else
+    {
+        writeInZip(buffer, len);
+    }
+}
+
+void ZipOutputStream::deflateInZip(const void* buffer, size_t len, int flush)
+{
+    const sys::byte* const bytes = static_cast<const sys::byte*>(buffer);
+    size_t offset = 0;
+    do
+    {
+        const size_t chunk = std::min(MAX_CHUNK, len - offset);
+        mStream.next_in = reinterpret_cast<Bytef*>(
+                const_cast<sys::byte*>(bytes + offset));
+        mStream.avail_in = static_cast<uInt>(chunk);
+        offset += chunk;
+
+        const int chunkFlush = (offset == len) ? flush : Z_NO_FLUSH;
+        int results;
+        do
+        {
+            mStream.next_out = reinterpret_cast<Bytef*>(&mDeflated[0]);
+            mStream.avail_out = static_cast<uInt>(mDeflated.size());
+            results = deflate(&mStream, chunkFlush);
+            if (results != Z_OK && results != Z_STREAM_END &&
+                results != Z_BUF_ERROR)
+            {
+                throw except::IOException(Ctxt(FmtX(
+                        "deflate failed [%d]", results)));
+            }
+
+            const size_t numBytes = mDeflated.size() - mStream.avail_out;
+            if (numBytes > 0)
+            {
+                writeInZip(&mDeflated[0], numBytes);
+                mCompressedSize += numBytes;
+            }
+        }
+        while (mStream.avail_out == 0 ||
+               (chunkFlush == Z_FINISH && results != Z_STREAM_END));
+    }
+    while (offset < len);
+}
+
+void ZipOutputStream::writeInZip(const void* buffer, size_t len)
 {
     // Write the contents to the location
-    const sys::Int32_T results = zipWriteInFileInZip(mZip, buffer, len);
+    const sys::byte* const bytes = static_cast<const sys::byte*>(buffer);
+    for (size_t offset = 0; offset < len; offset += MAX_CHUNK)
+    {
+        const sys::Int32_T results = zipWriteInFileInZip(
+                mZip, bytes + offset,
+                static_cast<unsigned int>(std::min(MAX_CHUNK, len - offset)));
 
-    if (results != Z_OK)
-         throw except::IOException(Ctxt("Failed to write file to zip location."));
+        if (results != Z_OK)
+             throw except::IOException(Ctxt(
+                     "Failed to write file to zip location."));
+    }
 }
 
 void ZipOutputStream::close()
@@ -0,0 +1,168 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <zlib.h>
+#include <zip/CRC32.h>
+
+// Benchmarks the CRC-32 kernels against zlib's crc32() on one large
+// buffer and on many small ones
+namespace
+{
+struct ZlibCRC
+{
+    sys::Uint32_T operator()(sys::Uint32_T crc,
+                             const sys::ubyte* data,
+                             size_t len) const
+    {
+        return static_cast<sys::Uint32_T>(
+                ::crc32(crc, data, static_cast<uInt>(len)));
+    }
+};
+
+struct KernelCRC
+{
+    KernelCRC(zip::CRC32::Kernel kernel) :
+        mKernel(kernel)
+    {
+    }
+
+    sys::Uint32_T operator()(sys::Uint32_T crc,
+                             const sys::ubyte* data,
+                             size_t len) const
+    {
+        return zip::CRC32::update(crc, data, len, mKernel);
+    }
+
+private:
+    const zip::CRC32::Kernel mKernel;
+};
+
+// Returns the elapsed time in ms
+template <typename CRCT>
+double BM_CRC(const CRCT& crc,
+              const std::vector<sys::ubyte>& data,
+              size_t blockSize,
+              size_t numPasses,
+              sys::Uint32_T& result)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t pass = 0; pass < numPasses; ++pass)
+    {
+        for (size_t offset = 0; offset < data.size(); offset += blockSize)
+        {
+            result += crc(0, &data[offset],
+                          std::min(blockSize, data.size() - offset));
+        }
+    }
+    return sw.stop();
+}
+
+template <typename CRCT>
+void printResult(const std::string& name,
+                 const CRCT& crc,
+                 const std::vector<sys::ubyte>& data,
+                 size_t blockSize,
+                 size_t numPasses)
+{
+    sys::Uint32_T result = 0;
+    const double elapsedMS = BM_CRC(crc, data, blockSize, numPasses, result);
+    const double totalMB = data.size() * numPasses / (1024.0 * 1024.0);
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0) << " "
+              << std::setw(10) << std::right << std::hex << result
+              << std::dec << std::endl;
+}
+
+void runBenchmarks(const std::string& label,
+                   const std::vector<sys::ubyte>& data,
+                   size_t blockSize,
+                   size_t numPasses)
+{
+    printResult(label + " zlib", ZlibCRC(), data, blockSize, numPasses);
+    printResult(label + " bytewise", KernelCRC(zip::CRC32::BYTEWISE),
+                data, blockSize, numPasses);
+    printResult(label + " slicing-by-8", KernelCRC(zip::CRC32::SLICING_BY_8),
+                data, blockSize, numPasses);
+    if (zip::CRC32::isSupported(zip::CRC32::CLMUL))
+    {
+        printResult(label + " clmul", KernelCRC(zip::CRC32::CLMUL),
+                    data, blockSize, numPasses);
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t sizeMB = (argc > 1) ? str::toType<size_t>(argv[1]) : 256;
+        const size_t numPasses =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 4;
+
+        std::vector<sys::ubyte> data(sizeMB * 1024 * 1024);
+        sys::Uint32_T state = 12345;
+        for (size_t ii = 0; ii < data.size(); ++ii)
+        {
+            state = state * 1103515245 + 12345;
+            data[ii] = static_cast<sys::ubyte>(state >> 24);
+        }
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << " "
+                  << std::setw(10) << std::right << "CRC" << std::endl;
+        std::cout << std::string(65, '-') << std::endl;
+
+        // The CRC column is the sum of every block's CRC; it must agree
+        // within each group
+        runBenchmarks("whole", data, data.size(), numPasses);
+        runBenchmarks("4 KiB", data, 4096, numPasses);
+        runBenchmarks("100 B", data, 100, 1);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <zip/GZipOutputStream.h>
+
+// Benchmarks GZipOutputStream throughput against the number of deflate
+// threads, writing compressible text-like data
+namespace
+{
+std::vector<sys::byte> makeData(size_t size)
+{
+    std::vector<sys::byte> data;
+    data.reserve(size);
+    sys::Uint32_T state = 12345;
+    while (data.size() < size)
+    {
+        state = state * 1103515245 + 12345;
+        const std::string line = "<pixel row=\"" +
+                str::toString((state >> 8) % 4096) + "\" value=\"" +
+                str::toString((state >> 4) % 997) + "\"/>\n";
+        data.insert(data.end(), line.begin(), line.end());
+    }
+    data.resize(size);
+    return data;
+}
+
+// Returns the elapsed time in ms
+double BM_Compress(const std::string& pathname,
+                   const std::vector<sys::byte>& data,
+                   int level,
+                   size_t numThreads)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    zip::GZipOutputStream output(pathname, level, numThreads);
+    const size_t writeSize = 1024 * 1024;
+    for (size_t offset = 0; offset < data.size(); offset += writeSize)
+    {
+        output.write(&data[offset], std::min(writeSize, data.size() - offset));
+    }
+    output.close();
+    return sw.stop();
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " outputFile [totalMB] [level] [maxThreads]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string pathname(argv[1]);
+        const size_t totalMB =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 256;
+        const int level = (argc > 3) ? str::toType<int>(argv[3]) : 6;
+        const size_t maxThreads = (argc > 4) ?
+                str::toType<size_t>(argv[4]) : sys::OS().getNumCPUs();
+
+        const std::vector<sys::byte> data = makeData(totalMB * 1024 * 1024);
+
+        std::cout << std::setw(12) << std::left << "Threads" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << " "
+                  << std::setw(12) << std::right << "Ratio" << std::endl;
+        std::cout << std::string(51, '-') << std::endl;
+
+        for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+        {
+            const double elapsedMS =
+                    BM_Compress(pathname, data, level, numThreads);
+            const double ratio = static_cast<double>(data.size()) /
+                    sys::OS().getSize(pathname);
+            std::cout << std::setw(12) << std::left << numThreads << " "
+                      << std::setw(12) << std::right << std::fixed
+                      << std::setprecision(2) << elapsedMS << " "
+                      << std::setw(12) << std::right << std::fixed
+                      << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+                      << " " << std::setw(12) << std::right << std::fixed
+                      << std::setprecision(2) << ratio << std::endl;
+        }
+        sys::OS().remove(pathname);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <zip/GZipIndex.h>
+#include <zip/GZipInputStream.h>
+#include <zip/GZipOutputStream.h>
+
+// Benchmarks seeking to random uncompressed offsets in a large gzip file,
+// with and without a GZipIndex
+namespace
+{
+void writeGZip(const std::string& pathname, size_t totalMB)
+{
+    // Text-like data; a fresh random sequence per chunk keeps deflate from
+    // finding long-range repeats
+    std::vector<sys::byte> chunk(16 * 1024 * 1024);
+    sys::Uint32_T state = 12345;
+    zip::GZipOutputStream output(pathname, 6, sys::OS().getNumCPUs());
+    for (size_t written = 0; written < totalMB; written += 16)
+    {
+        std::string text;
+        text.reserve(chunk.size());
+        while (text.size() < chunk.size())
+        {
+            state = state * 1103515245 + 12345;
+            text += "<pixel row=\"" + str::toString((state >> 8) % 4096) +
+                    "\" value=\"" + str::toString((state >> 4) % 997) +
+                    "\"/>\n";
+        }
+        output.write(text.data(),
+                     std::min<size_t>(chunk.size(),
+                                      (totalMB - written) * 1024 * 1024));
+    }
+    output.close();
+}
+
+// Returns per-seek times in ms
+std::vector<double> BM_Seek(const std::string& pathname,
+                            const zip::GZipIndex* index,
+                            sys::Uint64_T size,
+                            size_t numSeeks)
+{
+    zip::GZipInputStream input(pathname);
+    input.setIndex(index);
+
+    std::vector<sys::byte> buffer(64 * 1024);
+    std::vector<double> times;
+    sys::Uint64_T state = 42;
+    for (size_t ii = 0; ii < numSeeks; ++ii)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const sys::Uint64_T offset = (state >> 16) % (size - buffer.size());
+
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        input.seek(static_cast<sys::Off_T>(offset));
+        input.read(&buffer[0], buffer.size(), true);
+        times.push_back(sw.stop());
+    }
+    input.close();
+    return times;
+}
+
+void printTimes(const std::string& name, std::vector<double> times)
+{
+    std::sort(times.begin(), times.end());
+    double total = 0;
+    for (size_t ii = 0; ii < times.size(); ++ii)
+    {
+        total += times[ii];
+    }
+    std::cout << std::setw(20) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << total / times.size() << " "
+              << std::setw(12) << std::right << times[times.size() / 2] << " "
+              << std::setw(12) << std::right << times.back() << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [totalMB] [numSeeks] [spanKB]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t totalMB =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 2048;
+        const size_t numSeeks =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 100;
+        const size_t span = 1024 * ((argc > 4) ?
+                str::toType<size_t>(argv[4]) : 1024);
+
+        const std::string pathname =
+                sys::Path::joinPaths(workDir, "seek_benchmark.gz");
+        const std::string indexPathname = pathname + "idx";
+        writeGZip(pathname, totalMB);
+
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        zip::GZipIndex index;
+        index.build(pathname, span);
+        const double buildMS = sw.stop();
+        index.save(indexPathname);
+
+        sw.clear();
+        sw.start();
+        zip::GZipIndex loaded;
+        loaded.load(indexPathname, pathname);
+        const double loadMS = sw.stop();
+
+        sys::OS os;
+        std::cout << "Compressed size:   " << os.getSize(pathname) << std::endl
+                  << "Access points:     " << index.getNumAccessPoints()
+                  << std::endl
+                  << "Index file size:   " << os.getSize(indexPathname)
+                  << std::endl
+                  << "Build index (ms):  " << buildMS << std::endl
+                  << "Load index (ms):   " << loadMS << std::endl
+                  << std::endl;
+
+        std::cout << std::setw(20) << std::left << "Seek + 64 KiB read"
+                  << " " << std::setw(12) << std::right << "Mean (ms)"
+                  << " " << std::setw(12) << std::right << "Median (ms)"
+                  << " " << std::setw(12) << std::right << "Max (ms)"
+                  << std::endl;
+        std::cout << std::string(59, '-') << std::endl;
+
+        const sys::Uint64_T size = loaded.getUncompressedSize();
+        printTimes("indexed", BM_Seek(pathname, &loaded, size, numSeeks));
+        printTimes("unindexed",
+                   BM_Seek(pathname, NULL, size,
+                           std::max<size_t>(numSeeks / 20, 2)));
+
+        os.remove(pathname);
+        os.remove(indexPathname);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <zip/ZipOutputStream.h>
+
+// Benchmarks packaging a mix of incompressible imagery and XML metadata
+// with each ZipOutputStream compression setting
+namespace
+{
+struct Payload
+{
+    std::string pathname;
+    std::vector<sys::byte> data;
+    bool imagery;
+};
+
+// Imagery stands in for already-compressed (e.g. JPEG 2000) data, so it's
+// noise; metadata is repetitive XML
+std::vector<Payload> makePayloads(size_t numImages,
+                                  size_t imageMB,
+                                  size_t numXML,
+                                  size_t xmlKB)
+{
+    std::vector<Payload> payloads;
+    sys::Uint32_T state = 12345;
+    for (size_t ii = 0; ii < numImages; ++ii)
+    {
+        Payload payload;
+        payload.pathname = "imagery/image_" + str::toString(ii) + ".j2k";
+        payload.imagery = true;
+        payload.data.resize(imageMB * 1024 * 1024);
+        for (size_t jj = 0; jj < payload.data.size(); ++jj)
+        {
+            state = state * 1103515245 + 12345;
+            payload.data[jj] = static_cast<sys::byte>(state >> 24);
+        }
+        payloads.push_back(payload);
+    }
+    for (size_t ii = 0; ii < numXML; ++ii)
+    {
+        Payload payload;
+        payload.pathname = "metadata/product_" + str::toString(ii) + ".xml";
+        payload.imagery = false;
+        std::string xml = "<product>\n";
+        while (xml.size() < xmlKB * 1024)
+        {
+            state = state * 1103515245 + 12345;
+            xml += "  <tiePoint row=\"" + str::toString((state >> 8) % 8192) +
+                   "\" col=\"" + str::toString((state >> 4) % 8192) +
+                   "\" lat=\"39." + str::toString(state % 100000) +
+                   "\" lon=\"-104." + str::toString((state >> 12) % 100000) +
+                   "\"/>\n";
+        }
+        xml += "</product>\n";
+        payload.data.assign(xml.begin(), xml.end());
+        payloads.push_back(payload);
+    }
+    return payloads;
+}
+
+void BM_Package(const std::string& name,
+                const std::string& pathname,
+                const std::vector<Payload>& payloads,
+                int imageryCompression,
+                int xmlCompression)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    zip::ZipOutputStream output(pathname);
+    for (size_t ii = 0; ii < payloads.size(); ++ii)
+    {
+        output.setCompression(payloads[ii].imagery ? imageryCompression :
+                                                     xmlCompression);
+        output.createFileInZip(payloads[ii].pathname);
+        output.write(&payloads[ii].data[0], payloads[ii].data.size());
+        output.closeFileInZip();
+    }
+    output.close();
+    const double elapsedMS = sw.stop();
+
+    // Split the per-entry reports by kind
+    double imagerySeconds = 0;
+    double xmlSeconds = 0;
+    const std::vector<zip::ZipOutputStream::EntryStatistics>& stats =
+            output.getEntryStatistics();
+    for (size_t ii = 0; ii < stats.size(); ++ii)
+    {
+        (payloads[ii].imagery ? imagerySeconds : xmlSeconds) +=
+                stats[ii].elapsedSeconds;
+    }
+
+    std::cout << std::setw(24) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << imagerySeconds * 1000 << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << xmlSeconds * 1000 << " "
+              << std::setw(10) << std::right << std::fixed
+              << std::setprecision(1)
+              << sys::OS().getSize(pathname) / (1024.0 * 1024.0)
+              << std::endl;
+    sys::OS().remove(pathname);
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [numImages] [imageMB] [numXML] [xmlKB]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string pathname = sys::Path::joinPaths(
+                argv[1], "zipCompressionBenchmark.zip");
+        const size_t numImages =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 8;
+        const size_t imageMB = (argc > 3) ? str::toType<size_t>(argv[3]) : 32;
+        const size_t numXML = (argc > 4) ? str::toType<size_t>(argv[4]) : 200;
+        const size_t xmlKB = (argc > 5) ? str::toType<size_t>(argv[5]) : 256;
+        const std::vector<Payload> payloads =
+                makePayloads(numImages, imageMB, numXML, xmlKB);
+
+        std::cout << std::setw(24) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Total (ms)" << " "
+                  << std::setw(12) << std::right << "Imagery (ms)" << " "
+                  << std::setw(12) << std::right << "XML (ms)" << " "
+                  << std::setw(10) << std::right << "Size (MB)" << std::endl;
+        std::cout << std::string(74, '-') << std::endl;
+
+        typedef zip::ZipOutputStream ZOS;
+        BM_Package("default", pathname, payloads, ZOS::DEFAULT, ZOS::DEFAULT);
+        BM_Package("fast", pathname, payloads, ZOS::FAST, ZOS::FAST);
+        BM_Package("best", pathname, payloads, ZOS::BEST, ZOS::BEST);
+        BM_Package("stored imagery", pathname, payloads,
+                   ZOS::STORED, ZOS::DEFAULT);
+        BM_Package("auto", pathname, payloads, ZOS::AUTO, ZOS::AUTO);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
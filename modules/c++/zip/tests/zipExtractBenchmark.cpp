@@ -0,0 +1,166 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <zip/ZipFile.h>
+#include <zip/ZipOutputStream.h>
+
+// Benchmarks ZipFile::decompress() into memory and ZipFile::extract() to
+// disk on an archive of many entries, by thread count
+namespace
+{
+void writeZip(const std::string& pathname,
+              size_t numEntries,
+              size_t entrySize)
+{
+    std::vector<sys::byte> entry(entrySize);
+    sys::Uint32_T state = 12345;
+
+    zip::ZipOutputStream output(pathname);
+    for (size_t ii = 0; ii < numEntries; ++ii)
+    {
+        for (size_t jj = 0; jj < entry.size(); ++jj)
+        {
+            state = state * 1103515245 + 12345;
+            entry[jj] = static_cast<sys::byte>((state >> 28) + 'a');
+        }
+        output.createFileInZip("dir_" + str::toString(ii % 16) + "/entry_" +
+                               str::toString(ii) + ".bin");
+        output.write(&entry[0], entry.size());
+        output.closeFileInZip();
+    }
+    output.close();
+}
+
+double BM_Decompress(const zip::ZipFile& zipFile,
+                     const std::vector<sys::ubyte*>& buffers,
+                     size_t numThreads)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    zipFile.decompress(buffers, numThreads);
+    return sw.stop();
+}
+
+double BM_Extract(const zip::ZipFile& zipFile,
+                  const std::string& directory,
+                  size_t numThreads)
+{
+    sys::OS os;
+    if (os.exists(directory))
+    {
+        os.remove(directory);
+    }
+    os.makeDirectory(directory);
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    zipFile.extract(directory, numThreads);
+    return sw.stop();
+}
+
+void printResult(const std::string& name, double elapsedMS, double totalMB)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1) << totalMB / (elapsedMS / 1000.0)
+              << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [numEntries] [entryKB] [maxThreads]"
+                      << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t numEntries =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 2000;
+        const size_t entrySize = 1024 *
+                ((argc > 3) ? str::toType<size_t>(argv[3]) : 256);
+        const size_t maxThreads = (argc > 4) ?
+                str::toType<size_t>(argv[4]) : sys::OS().getNumCPUs();
+        const double totalMB = numEntries * entrySize / (1024.0 * 1024.0);
+
+        const std::string pathname =
+                sys::Path::joinPaths(workDir, "zipExtractBenchmark.zip");
+        const std::string directory =
+                sys::Path::joinPaths(workDir, "zipExtractBenchmark");
+        writeZip(pathname, numEntries, entrySize);
+
+        const zip::ZipFile zipFile(pathname);
+        std::vector<sys::ubyte> storage(numEntries * entrySize);
+        std::vector<sys::ubyte*> buffers(numEntries);
+        for (size_t ii = 0; ii < numEntries; ++ii)
+        {
+            buffers[ii] = &storage[ii * entrySize];
+        }
+
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(12) << std::right << "MB/s" << std::endl;
+        std::cout << std::string(54, '-') << std::endl;
+
+        for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+        {
+            const std::string threads =
+                    " (" + str::toString(numThreads) + " thr)";
+            printResult("decompress" + threads,
+                        BM_Decompress(zipFile, buffers, numThreads), totalMB);
+            printResult("extract" + threads,
+                        BM_Extract(zipFile, directory, numThreads), totalMB);
+        }
+
+        sys::OS().remove(directory);
+        sys::OS().remove(pathname);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/str.h>
+#include <import/except.h>
+#include <io/FileInputStream.h>
+#include <io/NullStreams.h>
+#include <zip/ZipFile.h>
+#include <zip/ZipOutputStream.h>
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+// Opens a large zip archive by reading it through an io::InputStream and
+// by pathname, reporting the open time and peak resident memory of each.
+// Each run happens in its own child process so the peak memory of one
+// doesn't hide the other's.
+namespace
+{
+void writeZip(const std::string& pathname, size_t totalMB, size_t numEntries)
+{
+    const size_t entrySize = totalMB * 1024 * 1024 / numEntries;
+    std::vector<sys::byte> block(1024 * 1024);
+    sys::Uint32_T state = 12345;
+
+    zip::ZipOutputStream output(pathname);
+    for (size_t ii = 0; ii < numEntries; ++ii)
+    {
+        output.createFileInZip("entry_" + str::toString(ii) + ".bin");
+        for (size_t written = 0; written < entrySize; written += block.size())
+        {
+            // Noisy low bits keep deflate honest without being incompressible
+            for (size_t jj = 0; jj < block.size(); ++jj)
+            {
+                state = state * 1103515245 + 12345;
+                block[jj] = static_cast<sys::byte>((state >> 28) + 'a');
+            }
+            output.write(&block[0],
+                         std::min(block.size(), entrySize - written));
+        }
+        output.closeFileInZip();
+    }
+    output.close();
+}
+
+double peakMemoryMB()
+{
+#if defined(WIN32) || defined(_WIN32)
+    return 0;
+#else
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+void printResult(const std::string& name, double elapsedMS)
+{
+    std::cout << std::setw(28) << std::left << name << " "
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(2) << elapsedMS << " "
+              << std::setw(14) << std::right << std::fixed
+              << std::setprecision(1) << peakMemoryMB() << std::endl;
+}
+
+void runBenchmark(const std::string& pathname, bool mapped, bool extract)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    std::unique_ptr<io::FileInputStream> input;
+    std::unique_ptr<zip::ZipFile> zipFile;
+    if (mapped)
+    {
+        zipFile.reset(new zip::ZipFile(pathname));
+    }
+    else
+    {
+        input.reset(new io::FileInputStream(pathname));
+        zipFile.reset(new zip::ZipFile(input.get()));
+    }
+
+    std::string label = mapped ? "by pathname" : "InputStream";
+    if (extract)
+    {
+        io::NullOutputStream output;
+        (*zipFile->begin())->decompress(output);
+        label += " + extract";
+    }
+    else
+    {
+        label += " open";
+    }
+    printResult(label, sw.stop());
+}
+
+void runInChild(const std::string& pathname, bool mapped, bool extract)
+{
+#if defined(WIN32) || defined(_WIN32)
+    runBenchmark(pathname, mapped, extract);
+#else
+    std::cout.flush();
+    const pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        try
+        {
+            runBenchmark(pathname, mapped, extract);
+        }
+        catch (const except::Exception& ex)
+        {
+            std::cerr << ex.toString() << std::endl;
+        }
+        std::cout.flush();
+        ::_exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+#endif
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                      << " workDir [totalMB] [numEntries]" << std::endl;
+            return 1;
+        }
+
+        const std::string workDir(argv[1]);
+        const size_t totalMB =
+                (argc > 2) ? str::toType<size_t>(argv[2]) : 1024;
+        const size_t numEntries =
+                (argc > 3) ? str::toType<size_t>(argv[3]) : 64;
+        const std::string pathname =
+                sys::Path::joinPaths(workDir, "zipFileBenchmark.zip");
+        writeZip(pathname, totalMB, numEntries);
+
+        std::cout << "Archive: " << totalMB << " MB uncompressed, "
+                  << numEntries << " entries, "
+                  << sys::OS().getSize(pathname) / (1024 * 1024)
+                  << " MB on disk" << std::endl;
+        std::cout << std::setw(28) << std::left << "Benchmark" << " "
+                  << std::setw(12) << std::right << "Time (ms)" << " "
+                  << std::setw(14) << std::right << "Peak RSS (MB)"
+                  << std::endl;
+        std::cout << std::string(56, '-') << std::endl;
+
+        runInChild(pathname, false, false);
+        runInChild(pathname, true, false);
+        runInChild(pathname, false, true);
+        runInChild(pathname, true, true);
+
+        sys::OS().remove(pathname);
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "An exception occurred!" << std::endl;
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
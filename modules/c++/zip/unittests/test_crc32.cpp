@@ -0,0 +1,169 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+#include <zip/CRC32.h>
+#include "TestCase.h"
+
+namespace
+{
+std::vector<sys::ubyte> makeData(size_t size)
+{
+    std::vector<sys::ubyte> data(size);
+    sys::Uint32_T state = 12345;
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        state = state * 1103515245 + 12345;
+        data[ii] = static_cast<sys::ubyte>(state >> 24);
+    }
+    return data;
+}
+
+sys::Uint32_T zlibCRC(const sys::ubyte* data, size_t len)
+{
+    return static_cast<sys::Uint32_T>(
+            ::crc32(0, data, static_cast<uInt>(len)));
+}
+
+std::vector<zip::CRC32::Kernel> getKernels()
+{
+    std::vector<zip::CRC32::Kernel> kernels;
+    kernels.push_back(zip::CRC32::AUTO);
+    kernels.push_back(zip::CRC32::BYTEWISE);
+    kernels.push_back(zip::CRC32::SLICING_BY_8);
+    if (zip::CRC32::isSupported(zip::CRC32::CLMUL))
+    {
+        kernels.push_back(zip::CRC32::CLMUL);
+    }
+    return kernels;
+}
+
+TEST_CASE(testCheckValue)
+{
+    const std::string check = "123456789";
+    const std::vector<zip::CRC32::Kernel> kernels = getKernels();
+    for (size_t ii = 0; ii < kernels.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(zip::CRC32::update(0, check.data(), check.size(),
+                                          kernels[ii]), 0xCBF43926);
+        TEST_ASSERT_EQ(zip::CRC32::update(0, NULL, 0, kernels[ii]), 0);
+    }
+}
+
+TEST_CASE(testMatchesZlib)
+{
+    // Every length and alignment around the kernels' block sizes
+    const std::vector<sys::ubyte> data = makeData(4096 + 64);
+    const std::vector<zip::CRC32::Kernel> kernels = getKernels();
+    for (size_t kk = 0; kk < kernels.size(); ++kk)
+    {
+        for (size_t offset = 0; offset < 16; ++offset)
+        {
+            for (size_t len = 0; len <= 300; ++len)
+            {
+                TEST_ASSERT_EQ(zip::CRC32::update(0, &data[offset], len,
+                                                  kernels[kk]),
+                               zlibCRC(&data[offset], len));
+            }
+            TEST_ASSERT_EQ(zip::CRC32::update(0, &data[offset], 4096,
+                                              kernels[kk]),
+                           zlibCRC(&data[offset], 4096));
+        }
+    }
+}
+
+TEST_CASE(testIncremental)
+{
+    const std::vector<sys::ubyte> data = makeData(100000);
+    const sys::Uint32_T expected = zlibCRC(&data[0], data.size());
+    const std::vector<zip::CRC32::Kernel> kernels = getKernels();
+    for (size_t kk = 0; kk < kernels.size(); ++kk)
+    {
+        sys::Uint32_T crc = 0;
+        size_t offset = 0;
+        for (size_t step = 1; offset < data.size(); step = step * 3 + 1)
+        {
+            const size_t len = std::min(step, data.size() - offset);
+            crc = zip::CRC32::update(crc, &data[offset], len, kernels[kk]);
+            offset += len;
+        }
+        TEST_ASSERT_EQ(crc, expected);
+    }
+}
+
+TEST_CASE(testCombine)
+{
+    const std::vector<sys::ubyte> data = makeData(70000);
+    const sys::Uint32_T whole = zlibCRC(&data[0], data.size());
+    const size_t splits[] = { 0, 1, 63, 4096, 65536, 70000 };
+    for (size_t ii = 0; ii < sizeof(splits) / sizeof(splits[0]); ++ii)
+    {
+        const size_t split = splits[ii];
+        const sys::Uint32_T crc1 = zip::CRC32::update(0, &data[0], split);
+        const sys::Uint32_T crc2 = zip::CRC32::update(
+                0, &data[0] + split, data.size() - split);
+        TEST_ASSERT_EQ(zip::CRC32::combine(crc1, crc2, data.size() - split),
+                       whole);
+    }
+
+    // Lengths past 4 GB: appending zeros in two steps must match one
+    // step, and agree with zlib where its offsets are 64 bits
+    const sys::Uint64_T fourGB = static_cast<sys::Uint64_T>(1) << 32;
+    const sys::Uint64_T hugeLen = 5 * fourGB + 7;
+    TEST_ASSERT_EQ(zip::CRC32::combine(0x12345678, 0, hugeLen),
+                   zip::CRC32::combine(
+                           zip::CRC32::combine(0x12345678, 0, fourGB),
+                           0, hugeLen - fourGB));
+    TEST_ASSERT_EQ(zip::CRC32::combine(0x12345678, 0x9abcdef0, hugeLen),
+                   zip::CRC32::combine(0x12345678, 0, hugeLen) ^ 0x9abcdef0);
+    if (sizeof(z_off_t) >= 8)
+    {
+        TEST_ASSERT_EQ(zip::CRC32::combine(0x12345678, 0x9abcdef0, hugeLen),
+                       static_cast<sys::Uint32_T>(::crc32_combine(
+                               0x12345678, 0x9abcdef0,
+                               static_cast<z_off_t>(hugeLen))));
+    }
+}
+
+TEST_CASE(testUnsupportedKernel)
+{
+    if (!zip::CRC32::isSupported(zip::CRC32::CLMUL))
+    {
+        TEST_EXCEPTION(zip::CRC32::update(0, "abc", 3, zip::CRC32::CLMUL));
+    }
+    TEST_ASSERT(zip::CRC32::isSupported(zip::CRC32::getDefaultKernel()));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testCheckValue);
+    TEST_CHECK(testMatchesZlib);
+    TEST_CHECK(testIncremental);
+    TEST_CHECK(testCombine);
+    TEST_CHECK(testUnsupportedKernel);
+    return 0;
+}
@@ -0,0 +1,313 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <str/Convert.h>
+#include <sys/OS.h>
+#include <io/FileOutputStream.h>
+#include <io/ReadUtils.h>
+#include <zip/GZipIndex.h>
+#include <zip/GZipInputStream.h>
+#include <zip/GZipOutputStream.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const GZIP_FILE = "test_gzip_output.gz";
+const char* const INDEX_FILE = "test_gzip_output.gzidx";
+
+// Text-like data with enough repetition to compress, and enough variety
+// that blocks really depend on their dictionaries
+std::string makeData(size_t size)
+{
+    std::string data;
+    data.reserve(size);
+    sys::Uint32_T state = 12345;
+    while (data.size() < size)
+    {
+        state = state * 1103515245 + 12345;
+        data += "record " + str::toString((state >> 8) % 1000) + " value " +
+                str::toString((state >> 4) % 97) + "\n";
+    }
+    data.resize(size);
+    return data;
+}
+
+std::string readGZip(const std::string& pathname)
+{
+    zip::GZipInputStream input(pathname);
+    std::string contents;
+    std::vector<sys::byte> buffer(65536);
+    sys::SSize_T numBytes;
+    while ((numBytes = input.read(&buffer[0], buffer.size())) > 0)
+    {
+        contents.append(buffer.begin(), buffer.begin() + numBytes);
+    }
+    input.close();
+    return contents;
+}
+
+void writeGZip(const std::string& data, int level, size_t numThreads,
+               size_t blockSize, size_t writeSize)
+{
+    zip::GZipOutputStream output(GZIP_FILE, level, numThreads, blockSize);
+    for (size_t offset = 0; offset < data.size(); offset += writeSize)
+    {
+        output.write(data.data() + offset,
+                     std::min(writeSize, data.size() - offset));
+    }
+    output.close();
+}
+
+TEST_CASE(testSerialRoundTrip)
+{
+    const std::string data = makeData(500000);
+    writeGZip(data, 6, 1, zip::GZipOutputStream::DEFAULT_BLOCK_SIZE, 4096);
+    TEST_ASSERT(readGZip(GZIP_FILE) == data);
+    sys::OS().remove(GZIP_FILE);
+}
+
+TEST_CASE(testParallelRoundTrip)
+{
+    const std::string data = makeData(1000000);
+    const size_t blockSizes[] = { 1000, 65536, 250000, 1000000, 2000000 };
+    for (size_t numThreads = 2; numThreads <= 4; ++numThreads)
+    {
+        for (size_t ii = 0; ii < sizeof(blockSizes) / sizeof(size_t); ++ii)
+        {
+            writeGZip(data, 6, numThreads, blockSizes[ii], 7777);
+            TEST_ASSERT(readGZip(GZIP_FILE) == data);
+        }
+    }
+    sys::OS().remove(GZIP_FILE);
+}
+
+TEST_CASE(testParallelLevels)
+{
+    const std::string data = makeData(300000);
+    for (int level = 0; level <= 9; level += 3)
+    {
+        writeGZip(data, level, 3, 32768, data.size());
+        TEST_ASSERT(readGZip(GZIP_FILE) == data);
+    }
+    sys::OS().remove(GZIP_FILE);
+}
+
+TEST_CASE(testParallelRatio)
+{
+    // Priming each block with its predecessor keeps the output close to
+    // the size of a single stream
+    const std::string data = makeData(1000000);
+    writeGZip(data, 6, 1, 0, data.size());
+    const sys::Off_T serialSize = sys::OS().getSize(GZIP_FILE);
+    writeGZip(data, 6, 4, 65536, data.size());
+    const sys::Off_T parallelSize = sys::OS().getSize(GZIP_FILE);
+    TEST_ASSERT(parallelSize < serialSize + serialSize / 50);
+    sys::OS().remove(GZIP_FILE);
+}
+
+TEST_CASE(testParallelEmpty)
+{
+    writeGZip("", 6, 4, 1024, 1);
+    TEST_ASSERT(readGZip(GZIP_FILE).empty());
+
+    // Input that exactly fills its blocks
+    const std::string data = makeData(4096);
+    writeGZip(data, 6, 2, 1024, 512);
+    TEST_ASSERT(readGZip(GZIP_FILE) == data);
+    sys::OS().remove(GZIP_FILE);
+}
+
+void checkSeeks(const std::string& testName,
+                zip::GZipInputStream& input,
+                const std::string& data)
+{
+    const size_t offsets[] = { 900000, 12345, 0, 250000, 250001, 999000,
+                               65536, 65535, 500000, 1000000 };
+    std::vector<sys::byte> buffer(3000);
+    for (size_t ii = 0; ii < sizeof(offsets) / sizeof(size_t); ++ii)
+    {
+        TEST_ASSERT_EQ(static_cast<size_t>(input.seek(offsets[ii])),
+                       offsets[ii]);
+        const size_t expected = std::min(buffer.size(),
+                                         data.size() - offsets[ii]);
+        const sys::SSize_T numBytes = input.read(&buffer[0], buffer.size());
+        if (expected == 0)
+        {
+            TEST_ASSERT_EQ(numBytes, io::InputStream::IS_EOF);
+            continue;
+        }
+        TEST_ASSERT_EQ(static_cast<size_t>(numBytes), expected);
+        TEST_ASSERT(std::string(buffer.begin(), buffer.begin() + numBytes) ==
+                    data.substr(offsets[ii], expected));
+        TEST_ASSERT_EQ(static_cast<size_t>(input.tell()),
+                       offsets[ii] + expected);
+    }
+}
+
+TEST_CASE(testIndexedSeek)
+{
+    const std::string data = makeData(1000000);
+    for (size_t numThreads = 1; numThreads <= 2; ++numThreads)
+    {
+        writeGZip(data, 6, numThreads, 100000, 65536);
+
+        zip::GZipIndex index;
+        index.build(GZIP_FILE, 65536);
+        TEST_ASSERT_EQ(index.getUncompressedSize(), data.size());
+        TEST_ASSERT(index.getNumAccessPoints() > 5);
+
+        zip::GZipInputStream input(GZIP_FILE);
+        input.setIndex(&index);
+        checkSeeks(testName, input, data);
+        input.close();
+    }
+    sys::OS().remove(GZIP_FILE);
+}
+
+TEST_CASE(testIndexSaveLoad)
+{
+    const std::string data = makeData(1000000);
+    writeGZip(data, 9, 1, 0, data.size());
+
+    zip::GZipIndex built;
+    built.build(GZIP_FILE, 100000);
+    built.save(INDEX_FILE);
+
+    zip::GZipIndex loaded;
+    loaded.load(INDEX_FILE, GZIP_FILE);
+    TEST_ASSERT_EQ(loaded.getUncompressedSize(), data.size());
+    TEST_ASSERT_EQ(loaded.getNumAccessPoints(), built.getNumAccessPoints());
+
+    zip::GZipInputStream input(GZIP_FILE);
+    input.setIndex(&loaded);
+    checkSeeks(testName, input, data);
+    input.close();
+
+    sys::OS().remove(GZIP_FILE);
+    sys::OS().remove(INDEX_FILE);
+}
+
+TEST_CASE(testIndexLoadChecks)
+{
+    const std::string data = makeData(300000);
+    writeGZip(data, 6, 1, 0, data.size());
+    zip::GZipIndex built;
+    built.build(GZIP_FILE, 50000);
+    built.save(INDEX_FILE);
+
+    std::string index;
+    io::readFileContents(INDEX_FILE, index);
+
+    // A point count too big for the file is caught before allocating
+    std::string corrupt = index;
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        corrupt[40 + ii] = static_cast<char>(0xFF);
+    }
+    {
+        io::FileOutputStream output(INDEX_FILE);
+        output.write(corrupt);
+        output.close();
+    }
+    zip::GZipIndex loaded;
+    TEST_EXCEPTION(loaded.load(INDEX_FILE, GZIP_FILE));
+
+    // An index of a gzip file that has since changed is rejected
+    {
+        io::FileOutputStream output(INDEX_FILE);
+        output.write(index);
+        output.close();
+    }
+    loaded.load(INDEX_FILE, GZIP_FILE);
+    std::string changed = data;
+    changed[1000] = static_cast<char>(changed[1000] + 1);
+    writeGZip(changed, 6, 1, 0, changed.size());
+    TEST_EXCEPTION(loaded.load(INDEX_FILE, GZIP_FILE));
+    TEST_EXCEPTION(loaded.load(INDEX_FILE, INDEX_FILE));
+
+    sys::OS().remove(GZIP_FILE);
+    sys::OS().remove(INDEX_FILE);
+}
+
+TEST_CASE(testIndexedSeekMultiMember)
+{
+    // Concatenated gzip files are one valid gzip file
+    const std::string data = makeData(1000000);
+    writeGZip(data.substr(0, 400000), 6, 1, 0, 400000);
+    std::string contents;
+    io::readFileContents(GZIP_FILE, contents);
+    writeGZip(data.substr(400000), 6, 1, 0, 600000);
+    std::string second;
+    io::readFileContents(GZIP_FILE, second);
+    contents += second;
+    {
+        io::FileOutputStream output(GZIP_FILE);
+        output.write(contents);
+        output.close();
+    }
+
+    zip::GZipIndex index;
+    index.build(GZIP_FILE, 50000);
+    TEST_ASSERT_EQ(index.getUncompressedSize(), data.size());
+
+    zip::GZipInputStream input(GZIP_FILE);
+    input.setIndex(&index);
+    checkSeeks(testName, input, data);
+
+    // Read across the member boundary
+    input.seek(399000);
+    std::vector<sys::byte> buffer(2000);
+    TEST_ASSERT_EQ(input.read(&buffer[0], buffer.size(), true), 2000);
+    TEST_ASSERT(std::string(buffer.begin(), buffer.end()) ==
+                data.substr(399000, 2000));
+    input.close();
+    sys::OS().remove(GZIP_FILE);
+}
+
+TEST_CASE(testUnindexedSeek)
+{
+    const std::string data = makeData(1000000);
+    writeGZip(data, 6, 1, 0, data.size());
+    zip::GZipInputStream input(GZIP_FILE);
+    checkSeeks(testName, input, data);
+    input.close();
+    sys::OS().remove(GZIP_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testSerialRoundTrip);
+    TEST_CHECK(testParallelRoundTrip);
+    TEST_CHECK(testParallelLevels);
+    TEST_CHECK(testParallelRatio);
+    TEST_CHECK(testParallelEmpty);
+    TEST_CHECK(testIndexedSeek);
+    TEST_CHECK(testIndexSaveLoad);
+    TEST_CHECK(testIndexLoadChecks);
+    TEST_CHECK(testIndexedSeekMultiMember);
+    TEST_CHECK(testUnindexedSeek);
+    return 0;
+}
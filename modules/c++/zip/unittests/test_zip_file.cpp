@@ -0,0 +1,709 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <str/Convert.h>
+#include <sys/OS.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include <io/StringStream.h>
+#include <sys/Path.h>
+#include <sys/StopWatch.h>
+#include <zip/ZipFile.h>
+#include <zip/ZipOutputStream.h>
+#include "TestCase.h"
+
+namespace
+{
+const char* const ZIP_FILE = "test_zip_file_output.zip";
+const size_t NUM_ENTRIES = 5;
+
+std::string makeData(size_t index, size_t size)
+{
+    std::string data;
+    data.reserve(size);
+    sys::Uint32_T state = 1234 + static_cast<sys::Uint32_T>(index);
+    while (data.size() < size)
+    {
+        state = state * 1103515245 + 12345;
+        data += "entry " + str::toString(index) + " line " +
+                str::toString((state >> 8) % 1000) + "\n";
+    }
+    data.resize(size);
+    return data;
+}
+
+std::string getEntryName(size_t index)
+{
+    return "dir/entry_" + str::toString(index) + ".txt";
+}
+
+std::vector<std::string> writeZip()
+{
+    std::vector<std::string> contents(NUM_ENTRIES);
+    zip::ZipOutputStream output(ZIP_FILE);
+    for (size_t ii = 0; ii < NUM_ENTRIES; ++ii)
+    {
+        // Include an empty entry and one larger than a decompress chunk
+        contents[ii] = makeData(ii, ii * ii * 100000);
+        output.createFileInZip(getEntryName(ii));
+        output.write(contents[ii].data(), contents[ii].size());
+        output.closeFileInZip();
+    }
+    output.close();
+    return contents;
+}
+
+std::string decompress(zip::ZipEntry& entry)
+{
+    std::vector<sys::ubyte> buffer(entry.getUncompressedSize() + 1);
+    entry.decompress(&buffer[0], entry.getUncompressedSize());
+    return std::string(buffer.begin(),
+                       buffer.begin() + entry.getUncompressedSize());
+}
+
+void putShort(std::string& buf, sys::Uint16_T value)
+{
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        buf += static_cast<char>((value >> (ii * 8)) & 0xFF);
+    }
+}
+
+void putInt(std::string& buf, sys::Uint32_T value)
+{
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        buf += static_cast<char>((value >> (ii * 8)) & 0xFF);
+    }
+}
+
+void putLong(std::string& buf, sys::Uint64_T value)
+{
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        buf += static_cast<char>((value >> (ii * 8)) & 0xFF);
+    }
+}
+
+// A one-entry stored archive laid out the way a Zip64 writer lays out a
+// huge one: every size, offset and count is in Zip64 records
+std::string makeZip64Archive(const std::string& name, const std::string& data)
+{
+    const sys::Uint32_T crc = static_cast<sys::Uint32_T>(::crc32(
+            0, reinterpret_cast<const Bytef*>(data.data()),
+            static_cast<uInt>(data.size())));
+
+    std::string archive;
+    putInt(archive, 0x04034b50);
+    putShort(archive, 45);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putInt(archive, crc);
+    putInt(archive, 0xFFFFFFFF);
+    putInt(archive, 0xFFFFFFFF);
+    putShort(archive, static_cast<sys::Uint16_T>(name.size()));
+    putShort(archive, 20);
+    archive += name;
+    putShort(archive, 0x0001);
+    putShort(archive, 16);
+    putLong(archive, data.size());
+    putLong(archive, data.size());
+    archive += data;
+
+    const sys::Uint64_T cdOffset = archive.size();
+    putInt(archive, 0x02014b50);
+    putShort(archive, 45);
+    putShort(archive, 45);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putInt(archive, crc);
+    putInt(archive, 0xFFFFFFFF);
+    putInt(archive, 0xFFFFFFFF);
+    putShort(archive, static_cast<sys::Uint16_T>(name.size()));
+    putShort(archive, 28);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putInt(archive, 0);
+    putInt(archive, 0xFFFFFFFF);
+    archive += name;
+    putShort(archive, 0x0001);
+    putShort(archive, 24);
+    putLong(archive, data.size());
+    putLong(archive, data.size());
+    putLong(archive, 0);
+    const sys::Uint64_T cdSize = archive.size() - cdOffset;
+
+    const sys::Uint64_T eocdOffset = archive.size();
+    putInt(archive, 0x06064b50);
+    putLong(archive, 44);
+    putShort(archive, 45);
+    putShort(archive, 45);
+    putInt(archive, 0);
+    putInt(archive, 0);
+    putLong(archive, 1);
+    putLong(archive, 1);
+    putLong(archive, cdSize);
+    putLong(archive, cdOffset);
+
+    putInt(archive, 0x07064b50);
+    putInt(archive, 0);
+    putLong(archive, eocdOffset);
+    putInt(archive, 1);
+
+    putInt(archive, 0x06054b50);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putShort(archive, 0xFFFF);
+    putShort(archive, 0xFFFF);
+    putInt(archive, 0xFFFFFFFF);
+    putInt(archive, 0xFFFFFFFF);
+    putShort(archive, 0);
+    return archive;
+}
+
+void writeFile(const std::string& pathname, const std::string& data)
+{
+    io::FileOutputStream output(pathname);
+    output.write(data.data(), data.size());
+    output.close();
+}
+
+std::string readFile(const std::string& pathname)
+{
+    io::FileInputStream input(pathname);
+    std::string data(static_cast<size_t>(input.available()), '\0');
+    if (!data.empty())
+    {
+        input.read(&data[0], data.size());
+    }
+    input.close();
+    return data;
+}
+
+TEST_CASE(testOpenByPathname)
+{
+    const std::vector<std::string> contents = writeZip();
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    TEST_ASSERT_EQ(zipFile.getNumEntries(), NUM_ENTRIES);
+    for (size_t ii = 0; ii < NUM_ENTRIES; ++ii)
+    {
+        zip::ZipFile::Iterator iter = zipFile.lookup(getEntryName(ii));
+        TEST_ASSERT(iter != zipFile.end());
+        TEST_ASSERT_EQ((*iter)->getUncompressedSize(), contents[ii].size());
+        TEST_ASSERT(decompress(**iter) == contents[ii]);
+    }
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testMatchesStreamReader)
+{
+    writeZip();
+
+    io::FileInputStream input(ZIP_FILE);
+    zip::ZipFile streamed(&input);
+    input.close();
+    zip::ZipFile mapped(ZIP_FILE);
+
+    TEST_ASSERT_EQ(streamed.getNumEntries(), mapped.getNumEntries());
+    TEST_ASSERT_EQ(streamed.getCentralDirOffset(),
+                   mapped.getCentralDirOffset());
+    TEST_ASSERT_EQ(streamed.getCentralDirSize(), mapped.getCentralDirSize());
+
+    zip::ZipFile::Iterator lhs = streamed.begin();
+    zip::ZipFile::Iterator rhs = mapped.begin();
+    for (; lhs != streamed.end(); ++lhs, ++rhs)
+    {
+        TEST_ASSERT_EQ((*lhs)->getFileName(), (*rhs)->getFileName());
+        TEST_ASSERT_EQ((*lhs)->getCRC32(), (*rhs)->getCRC32());
+        TEST_ASSERT(decompress(**lhs) == decompress(**rhs));
+    }
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testStreamingDecompress)
+{
+    const std::vector<std::string> contents = writeZip();
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    for (size_t ii = 0; ii < NUM_ENTRIES; ++ii)
+    {
+        zip::ZipEntry* const entry = *zipFile.lookup(getEntryName(ii));
+
+        // A small chunk size forces many inflate() calls per entry
+        io::StringStream output;
+        entry->decompress(output, 4096);
+        TEST_ASSERT(output.stream().str() == contents[ii]);
+    }
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testNotAZip)
+{
+    {
+        io::FileOutputStream output(ZIP_FILE);
+        const std::string data = makeData(0, 100000);
+        output.write(data.data(), data.size());
+        output.close();
+    }
+    TEST_EXCEPTION(zip::ZipFile(std::string(ZIP_FILE)));
+
+    {
+        io::FileOutputStream output(ZIP_FILE);
+        output.close();
+    }
+    TEST_EXCEPTION(zip::ZipFile(std::string(ZIP_FILE)));
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testTruncated)
+{
+    writeZip();
+
+    // Drop the back half of the entry data, but keep the central
+    // directory so the EOCD is still found
+    std::string archive;
+    {
+        io::FileInputStream input(ZIP_FILE);
+        archive.resize(static_cast<size_t>(input.available()));
+        input.read(&archive[0], archive.size());
+        input.close();
+    }
+    size_t cdOffset;
+    {
+        zip::ZipFile original(ZIP_FILE);
+        cdOffset = original.getCentralDirOffset();
+    }
+    const std::string truncated =
+            archive.substr(0, cdOffset / 2) + archive.substr(cdOffset);
+
+    {
+        io::FileOutputStream output(ZIP_FILE);
+        output.write(truncated.data(), truncated.size());
+        output.close();
+    }
+    TEST_EXCEPTION(zip::ZipFile(std::string(ZIP_FILE)));
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testZip64Records)
+{
+    const std::string data = makeData(7, 12345);
+    writeFile(ZIP_FILE, makeZip64Archive("zip64.txt", data));
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    TEST_ASSERT_EQ(zipFile.getNumEntries(), 1);
+    zip::ZipEntry* const entry = *zipFile.begin();
+    TEST_ASSERT_EQ(entry->getFileName(), "zip64.txt");
+    TEST_ASSERT_EQ(entry->getUncompressedSize(), data.size());
+    TEST_ASSERT_EQ(entry->getCompressedSize(), data.size());
+    TEST_ASSERT(decompress(*entry) == data);
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testZip64CraftedSizes)
+{
+    // Sizes and offsets so large that adding them to a small offset wraps
+    // around must still be caught as past EOF
+    const std::string name = "zip64.txt";
+    const std::string data = makeData(7, 100);
+    const std::string archive = makeZip64Archive(name, data);
+    const size_t cdOffset = 30 + name.size() + 20 + data.size();
+    const size_t cdExtraOffset = cdOffset + 46 + name.size() + 4;
+    const sys::Uint64_T huge = static_cast<sys::Uint64_T>(-16);
+
+    // The compressed size, then the local header offset
+    const size_t fieldOffsets[] = { cdExtraOffset + 8, cdExtraOffset + 16 };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        std::string field;
+        putLong(field, huge);
+        std::string crafted = archive;
+        crafted.replace(fieldOffsets[ii], field.size(), field);
+        writeFile(ZIP_FILE, crafted);
+        TEST_EXCEPTION(zip::ZipFile(std::string(ZIP_FILE)));
+    }
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testStoredSizeMismatch)
+{
+    // A stored entry is read for its uncompressed size, so one that claims
+    // more than its compressed size would read past the end of the file
+    const std::string name = "zip64.txt";
+    const std::string data = makeData(7, 100);
+    std::string archive = makeZip64Archive(name, data);
+    const size_t cdOffset = 30 + name.size() + 20 + data.size();
+    std::string field;
+    putLong(field, 200 * 1024 * 1024);
+    archive.replace(cdOffset + 46 + name.size() + 4, field.size(), field);
+    writeFile(ZIP_FILE, archive);
+    TEST_EXCEPTION(zip::ZipFile(std::string(ZIP_FILE)));
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testBadExtraField)
+{
+    // An extra field that claims more than the extra data holds.  Its
+    // size used to wrap the offset back to 0 and loop forever.
+    const std::string name = "zip64.txt";
+    const std::string data = makeData(7, 100);
+    std::string archive = makeZip64Archive(name, data);
+    const size_t cdOffset = 30 + name.size() + 20 + data.size();
+    std::string field;
+    putShort(field, 0x1234);
+    putShort(field, 0xFFFC);
+    archive.replace(cdOffset + 46 + name.size(), field.size(), field);
+    writeFile(ZIP_FILE, archive);
+    TEST_EXCEPTION(zip::ZipFile(std::string(ZIP_FILE)));
+
+    // A Zip64 field that claims more than the extra data holds
+    field.clear();
+    putShort(field, 0x0001);
+    putShort(field, 32);
+    archive.replace(cdOffset + 46 + name.size(), field.size(), field);
+    writeFile(ZIP_FILE, archive);
+    TEST_EXCEPTION(zip::ZipFile(std::string(ZIP_FILE)));
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testZip64EntryCount)
+{
+    // More entries than the 16-bit EOCD fields can count
+    const size_t numEntries = 70000;
+    {
+        zip::ZipOutputStream output(ZIP_FILE);
+        for (size_t ii = 0; ii < numEntries; ++ii)
+        {
+            const std::string data = str::toString(ii);
+            output.createFileInZip(str::toString(ii) + ".txt");
+            output.write(data.data(), data.size());
+            output.closeFileInZip();
+        }
+        output.close();
+    }
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    TEST_ASSERT_EQ(zipFile.getNumEntries(), numEntries);
+    zip::ZipFile::Iterator iter = zipFile.lookup("69999.txt");
+    TEST_ASSERT(iter != zipFile.end());
+    TEST_ASSERT(decompress(**iter) == "69999");
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testParallelDecompress)
+{
+    const std::vector<std::string> contents = writeZip();
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    std::vector<std::vector<sys::ubyte> > storage(zipFile.getNumEntries());
+    std::vector<sys::ubyte*> buffers(zipFile.getNumEntries());
+    size_t ii = 0;
+    for (zip::ZipFile::Iterator iter = zipFile.begin();
+         iter != zipFile.end(); ++iter, ++ii)
+    {
+        storage[ii].resize((*iter)->getUncompressedSize() + 1);
+        buffers[ii] = &storage[ii][0];
+    }
+    zipFile.decompress(buffers, 3);
+
+    ii = 0;
+    for (zip::ZipFile::Iterator iter = zipFile.begin();
+         iter != zipFile.end(); ++iter, ++ii)
+    {
+        const std::string expected = contents[ii];
+        TEST_ASSERT_EQ((*iter)->getFileName(), getEntryName(ii));
+        TEST_ASSERT(std::string(storage[ii].begin(),
+                                storage[ii].end() - 1) == expected);
+    }
+
+    buffers.pop_back();
+    TEST_EXCEPTION(zipFile.decompress(buffers, 3));
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testExtract)
+{
+    const std::vector<std::string> contents = writeZip();
+    const std::string directory = "test_zip_file_extract";
+    sys::OS os;
+    if (os.exists(directory))
+    {
+        os.remove(directory);
+    }
+    os.makeDirectory(directory);
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    zipFile.extract(directory, 4);
+    for (size_t ii = 0; ii < NUM_ENTRIES; ++ii)
+    {
+        const std::string pathname =
+                sys::Path::joinPaths(directory, getEntryName(ii));
+        TEST_ASSERT(os.exists(pathname));
+        TEST_ASSERT(readFile(pathname) == contents[ii]);
+    }
+    os.remove(directory);
+    os.remove(ZIP_FILE);
+}
+
+TEST_CASE(testExtractRejectsTraversal)
+{
+    {
+        zip::ZipOutputStream output(ZIP_FILE);
+        output.createFileInZip("ok/../../evil.txt");
+        output.write("evil", 4);
+        output.closeFileInZip();
+        output.close();
+    }
+
+    const std::string directory = "test_zip_file_extract";
+    sys::OS os;
+    if (!os.exists(directory))
+    {
+        os.makeDirectory(directory);
+    }
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    TEST_EXCEPTION(zipFile.extract(directory));
+    TEST_ASSERT(!os.exists("evil.txt"));
+    os.remove(directory);
+    os.remove(ZIP_FILE);
+}
+
+TEST_CASE(testVerifyCRC)
+{
+    const std::vector<std::string> contents = writeZip();
+    std::string archive = readFile(ZIP_FILE);
+
+    size_t cdOffset;
+    {
+        zip::ZipFile zipFile(ZIP_FILE);
+        TEST_ASSERT(zipFile.verify(2).empty());
+        cdOffset = static_cast<size_t>(zipFile.getCentralDirOffset());
+    }
+
+    // Walk the central directory to entry 2 and flip a bit of its CRC
+    size_t record = cdOffset;
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        const size_t nameLength = static_cast<sys::ubyte>(archive[record + 28]);
+        const size_t extraLength =
+                static_cast<sys::ubyte>(archive[record + 30]);
+        record += 46 + nameLength + extraLength;
+    }
+    archive[record + 16] ^= 0x01;
+    writeFile(ZIP_FILE, archive);
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    const std::vector<std::string> failed = zipFile.verify(2);
+    TEST_ASSERT_EQ(failed.size(), 1);
+    TEST_ASSERT_EQ(failed[0], getEntryName(2));
+
+    // Decompression only checks when asked to
+    zip::ZipEntry* const entry = *zipFile.lookup(getEntryName(2));
+    TEST_ASSERT(decompress(*entry) == contents[2]);
+    zipFile.setVerifyCRC(true);
+    TEST_EXCEPTION(decompress(*entry));
+    io::StringStream output;
+    TEST_EXCEPTION(entry->decompress(output));
+    TEST_ASSERT(decompress(**zipFile.lookup(getEntryName(3))) == contents[3]);
+    sys::OS().remove(ZIP_FILE);
+}
+
+std::string makeNoise(size_t size)
+{
+    std::string data(size, '\0');
+    sys::Uint32_T state = 98765;
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        state = state * 1103515245 + 12345;
+        data[ii] = static_cast<char>(state >> 24);
+    }
+    return data;
+}
+
+void writeEntry(zip::ZipOutputStream& output,
+                const std::string& pathname,
+                const std::string& data)
+{
+    output.createFileInZip(pathname);
+    // Several writes, so AUTO has to gather its sample
+    for (size_t offset = 0; offset < data.size(); offset += 100000)
+    {
+        output.write(data.data() + offset,
+                     std::min<size_t>(100000, data.size() - offset));
+    }
+    output.closeFileInZip();
+}
+
+TEST_CASE(testCompressionLevels)
+{
+    const std::string data = makeData(3, 500000);
+    const int levels[] = { zip::ZipOutputStream::STORED,
+                           zip::ZipOutputStream::FAST,
+                           zip::ZipOutputStream::DEFAULT,
+                           zip::ZipOutputStream::BEST };
+    const size_t numLevels = sizeof(levels) / sizeof(levels[0]);
+    {
+        zip::ZipOutputStream output(ZIP_FILE);
+        for (size_t ii = 0; ii < numLevels; ++ii)
+        {
+            output.setCompression(levels[ii]);
+            TEST_ASSERT_EQ(output.getCompression(), levels[ii]);
+            writeEntry(output, "level_" + str::toString(ii), data);
+        }
+
+        const std::vector<zip::ZipOutputStream::EntryStatistics>& stats =
+                output.getEntryStatistics();
+        TEST_ASSERT_EQ(stats.size(), numLevels);
+        for (size_t ii = 0; ii < numLevels; ++ii)
+        {
+            TEST_ASSERT_EQ(stats[ii].pathname, "level_" + str::toString(ii));
+            TEST_ASSERT_EQ(stats[ii].level, levels[ii]);
+            TEST_ASSERT_EQ(stats[ii].uncompressedSize, data.size());
+            TEST_ASSERT(stats[ii].elapsedSeconds > 0);
+        }
+        TEST_ASSERT_EQ(stats[0].method, 0);
+        TEST_ASSERT_EQ(stats[0].compressedSize, data.size());
+        TEST_ASSERT_EQ(stats[1].method, Z_DEFLATED);
+        TEST_ASSERT(stats[1].compressedSize < data.size());
+        TEST_ASSERT(stats[3].compressedSize <= stats[1].compressedSize);
+        output.close();
+    }
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    TEST_ASSERT(zipFile.verify().empty());
+    size_t ii = 0;
+    for (zip::ZipFile::Iterator iter = zipFile.begin();
+         iter != zipFile.end(); ++iter, ++ii)
+    {
+        TEST_ASSERT_EQ((*iter)->getCompressionMethod(),
+                       (ii == 0) ? 0 : Z_DEFLATED);
+        TEST_ASSERT(decompress(**iter) == data);
+
+        io::StringStream output;
+        (*iter)->decompress(output, 4096);
+        TEST_ASSERT(output.stream().str() == data);
+    }
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testAutoCompression)
+{
+    const std::string noise = makeNoise(600000);
+    const std::string text = makeData(4, 600000);
+    const std::string smallText = makeData(5, 1000);
+    {
+        zip::ZipOutputStream output(ZIP_FILE);
+        output.setCompression(zip::ZipOutputStream::AUTO);
+        writeEntry(output, "noise.bin", noise);
+        writeEntry(output, "text.xml", text);
+        writeEntry(output, "small.xml", smallText);
+        writeEntry(output, "empty.txt", "");
+
+        const std::vector<zip::ZipOutputStream::EntryStatistics>& stats =
+                output.getEntryStatistics();
+        TEST_ASSERT_EQ(stats.size(), 4);
+        TEST_ASSERT_EQ(stats[0].method, 0);
+        TEST_ASSERT_EQ(stats[1].method, Z_DEFLATED);
+        TEST_ASSERT_EQ(stats[2].method, Z_DEFLATED);
+        TEST_ASSERT_EQ(stats[3].method, 0);
+        TEST_ASSERT_EQ(stats[0].uncompressedSize, noise.size());
+        TEST_ASSERT_EQ(stats[1].uncompressedSize, text.size());
+        output.close();
+    }
+
+    zip::ZipFile zipFile(ZIP_FILE);
+    TEST_ASSERT(zipFile.verify().empty());
+    TEST_ASSERT(decompress(**zipFile.lookup("noise.bin")) == noise);
+    TEST_ASSERT(decompress(**zipFile.lookup("text.xml")) == text);
+    TEST_ASSERT(decompress(**zipFile.lookup("small.xml")) == smallText);
+    TEST_ASSERT(decompress(**zipFile.lookup("empty.txt")).empty());
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testElapsedIncludesClose)
+{
+    // An AUTO entry smaller than its sample is all compressed when it's
+    // closed, so that's where nearly all of its time goes
+    const std::string text = makeData(6,
+            zip::ZipOutputStream::AUTO_SAMPLE_SIZE - 1000);
+    zip::ZipOutputStream output(ZIP_FILE);
+    output.setCompression(zip::ZipOutputStream::AUTO);
+    output.createFileInZip("text.xml");
+    output.write(text.data(), text.size());
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    output.closeFileInZip();
+    const double closeSeconds = sw.stop() / 1000.0;
+
+    const std::vector<zip::ZipOutputStream::EntryStatistics>& stats =
+            output.getEntryStatistics();
+    TEST_ASSERT_EQ(stats.size(), 1);
+    TEST_ASSERT_EQ(stats[0].method, Z_DEFLATED);
+    TEST_ASSERT(stats[0].elapsedSeconds >= closeSeconds / 2);
+    output.close();
+    sys::OS().remove(ZIP_FILE);
+}
+
+TEST_CASE(testInvalidCompression)
+{
+    zip::ZipOutputStream output(ZIP_FILE);
+    TEST_EXCEPTION(output.setCompression(10));
+    TEST_EXCEPTION(output.setCompression(-3));
+    output.close();
+    sys::OS().remove(ZIP_FILE);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testOpenByPathname);
+    TEST_CHECK(testMatchesStreamReader);
+    TEST_CHECK(testStreamingDecompress);
+    TEST_CHECK(testNotAZip);
+    TEST_CHECK(testTruncated);
+    TEST_CHECK(testZip64Records);
+    TEST_CHECK(testZip64CraftedSizes);
+    TEST_CHECK(testBadExtraField);
+    TEST_CHECK(testStoredSizeMismatch);
+    TEST_CHECK(testZip64EntryCount);
+    TEST_CHECK(testParallelDecompress);
+    TEST_CHECK(testExtract);
+    TEST_CHECK(testExtractRejectsTraversal);
+    TEST_CHECK(testVerifyCRC);
+    TEST_CHECK(testCompressionLevels);
+    TEST_CHECK(testAutoCompression);
+    TEST_CHECK(testElapsedIncludesClose);
+    TEST_CHECK(testInvalidCompression);
+    return 0;
+}